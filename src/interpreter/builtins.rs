@@ -18,8 +18,9 @@
 
 use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
+use crate::memory::heap_profile::AllocOrigin;
 use crate::memory::value::Value;
-use crate::parser::ast::{AstNode, SourceLocation, UnOp};
+use crate::parser::ast::{AstNode, NodeId, SourceLocation};
 
 fn expect_int_arg(
     args: &[Value],
@@ -46,7 +47,7 @@ fn expect_int_arg(
 impl Interpreter {
     pub(crate) fn builtin_printf(
         &mut self,
-        args: &[AstNode],
+        args: &[NodeId],
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         if args.is_empty() {
@@ -56,7 +57,7 @@ impl Interpreter {
             });
         }
 
-        let format_str = match &args[0] {
+        let format_str = match &self.ast[args[0]] {
             AstNode::StringLiteral(s, _) => s.clone(),
             _ => {
                 return Err(RuntimeError::InvalidPrintfFormat {
@@ -68,7 +69,7 @@ impl Interpreter {
         };
 
         let mut arg_values = Vec::new();
-        for arg in &args[1..] {
+        for &arg in &args[1..] {
             arg_values.push(self.evaluate_expr(arg)?);
         }
 
@@ -79,7 +80,7 @@ impl Interpreter {
     }
 
     fn format_printf(
-        &self,
+        &mut self,
         format: &str,
         args: &[Value],
         location: SourceLocation,
@@ -194,7 +195,7 @@ impl Interpreter {
     }
 
     pub(crate) fn read_string_from_heap(
-        &self,
+        &mut self,
         addr: u64,
         location: SourceLocation,
     ) -> Result<String, RuntimeError> {
@@ -231,7 +232,7 @@ impl Interpreter {
 
     pub(crate) fn builtin_scanf(
         &mut self,
-        args: &[AstNode],
+        args: &[NodeId],
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         if args.is_empty() {
@@ -243,7 +244,7 @@ impl Interpreter {
             });
         }
 
-        let format_str = match &args[0] {
+        let format_str = match &self.ast[args[0]] {
             AstNode::StringLiteral(s, _) => s.clone(),
             _ => {
                 return Err(RuntimeError::InvalidPrintfFormat {
@@ -266,7 +267,7 @@ impl Interpreter {
     fn parse_scanf_input(
         &mut self,
         format: &str,
-        args: &[AstNode],
+        args: &[NodeId],
         location: SourceLocation,
     ) -> Result<usize, RuntimeError> {
         let initial_index = self.stdin_token_index;
@@ -299,7 +300,7 @@ impl Interpreter {
                 'd' | 'i' => {
                     if let Ok(n) = token.parse::<i64>() {
                         let val = Value::Int(n as i32);
-                        self.write_scanf_value(val, &args[arg_idx], location)?;
+                        self.write_scanf_value(val, args[arg_idx], location)?;
                         matched += 1;
                     }
                     arg_idx += 1;
@@ -307,7 +308,7 @@ impl Interpreter {
                 'u' => {
                     if let Ok(n) = token.parse::<u64>() {
                         let val = Value::Int(n as i32);
-                        self.write_scanf_value(val, &args[arg_idx], location)?;
+                        self.write_scanf_value(val, args[arg_idx], location)?;
                         matched += 1;
                     }
                     arg_idx += 1;
@@ -319,7 +320,7 @@ impl Interpreter {
                         .unwrap_or(token.as_str());
                     if let Ok(n) = u32::from_str_radix(stripped, 16) {
                         let val = Value::Int(n as i32);
-                        self.write_scanf_value(val, &args[arg_idx], location)?;
+                        self.write_scanf_value(val, args[arg_idx], location)?;
                         matched += 1;
                     }
                     arg_idx += 1;
@@ -327,13 +328,13 @@ impl Interpreter {
                 'c' => {
                     if let Some(c) = token.chars().next() {
                         let val = Value::Char(c as i8);
-                        self.write_scanf_value(val, &args[arg_idx], location)?;
+                        self.write_scanf_value(val, args[arg_idx], location)?;
                         matched += 1;
                     }
                     arg_idx += 1;
                 }
                 's' => {
-                    self.write_scanf_string(&token, &args[arg_idx], location)?;
+                    self.write_scanf_string(&token, args[arg_idx], location)?;
                     matched += 1;
                     arg_idx += 1;
                 }
@@ -356,19 +357,14 @@ impl Interpreter {
 
     /// Write a single scalar value to the lvalue pointed to by a scanf argument.
     /// The argument is expected to be an address-of expression (e.g. `&x`), so we
-    /// synthesise a dereference lvalue `*(arg)` and delegate to `assign_to_lvalue`.
+    /// assign through it exactly as `*(arg) = value` would.
     fn write_scanf_value(
         &mut self,
         value: Value,
-        arg: &AstNode,
+        arg: NodeId,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
-        let deref_lvalue = AstNode::UnaryOp {
-            op: UnOp::Deref,
-            operand: Box::new(arg.clone()),
-            location,
-        };
-        self.assign_to_lvalue(&deref_lvalue, value, location)
+        self.assign_to_dereference(arg, value, location)
     }
 
     /// Write a null-terminated string to the buffer pointed to by a scanf `%s` argument.
@@ -376,32 +372,29 @@ impl Interpreter {
     fn write_scanf_string(
         &mut self,
         s: &str,
-        arg: &AstNode,
+        arg: NodeId,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         // Write each character then the null terminator via arr[i] = c
         for (i, c) in s.chars().enumerate() {
-            let index_node = AstNode::IntLiteral(i as i32, location);
-            let lvalue = AstNode::ArrayAccess {
-                array: Box::new(arg.clone()),
-                index: Box::new(index_node),
+            self.assign_to_array_element(
+                arg,
+                i as i32,
+                Value::Char(c as i8),
                 location,
-            };
-            self.assign_to_lvalue(&lvalue, Value::Char(c as i8), location)?;
+            )?;
         }
-        // Null terminator
-        let null_index = AstNode::IntLiteral(s.len() as i32, location);
-        let null_lvalue = AstNode::ArrayAccess {
-            array: Box::new(arg.clone()),
-            index: Box::new(null_index),
+        self.assign_to_array_element(
+            arg,
+            s.len() as i32,
+            Value::Char(0),
             location,
-        };
-        self.assign_to_lvalue(&null_lvalue, Value::Char(0), location)
+        )
     }
 
     pub(crate) fn builtin_malloc(
         &mut self,
-        args: &[AstNode],
+        args: &[NodeId],
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         if args.len() != 1 {
@@ -413,7 +406,7 @@ impl Interpreter {
             });
         }
 
-        let size_val = self.evaluate_expr(&args[0])?;
+        let size_val = self.evaluate_expr(args[0])?;
         let size = match size_val {
             Value::Int(n) if n > 0 => n as usize,
             Value::Int(n) => {
@@ -437,13 +430,44 @@ impl Interpreter {
                 limit: self.heap.max_size(),
             }
         })?;
+        self.record_allocation(addr, size, location);
 
         Ok(Value::Pointer(addr))
     }
 
+    /// Tag a fresh heap block with its allocation site and count it in the
+    /// heap profile
+    pub(crate) fn record_allocation(
+        &mut self,
+        addr: u64,
+        size: usize,
+        site: SourceLocation,
+    ) {
+        let origin = AllocOrigin {
+            site,
+            call_depth: self.stack.depth(),
+            step: self.history_position,
+        };
+        if let Ok(block) = self.heap.get_block_mut(addr) {
+            block.origin = Some(origin);
+        }
+        self.heap_profile.record_alloc(origin, size);
+        self.guest_profile.record_alloc(site.line, size);
+        self.counters.allocations += 1;
+        self.counters.peak_heap_bytes = self
+            .counters
+            .peak_heap_bytes
+            .max(self.heap.total_allocated());
+        if let Some(trace) = &mut self.trace {
+            let step = self.history_position;
+            trace.alloc(step, addr, size, site.line);
+            trace.heap_bytes(step, self.heap.total_allocated());
+        }
+    }
+
     pub(crate) fn builtin_free(
         &mut self,
-        args: &[AstNode],
+        args: &[NodeId],
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         if args.len() != 1 {
@@ -455,7 +479,7 @@ impl Interpreter {
             });
         }
 
-        let ptr_val = self.evaluate_expr(&args[0])?;
+        let ptr_val = self.evaluate_expr(args[0])?;
         let addr = match ptr_val {
             Value::Pointer(a) => a,
             Value::Null => {
@@ -470,12 +494,18 @@ impl Interpreter {
             }
         };
 
-        self.heap.free(addr).map_err(|e| {
+        let (origin, size) = match self.heap.get_block(addr) {
+            Ok(block) => (block.origin.map(|o| o.site), block.size),
+            Err(_) => (None, 0),
+        };
+        let step = self.history_position;
+        self.heap.free(addr, location, step).map_err(|e| {
             if e.contains("Double free") {
-                RuntimeError::DoubleFree {
+                self.with_free_site(RuntimeError::DoubleFree {
                     address: addr,
                     location,
-                }
+                    freed_at: None,
+                })
             } else {
                 RuntimeError::InvalidFree {
                     address: addr,
@@ -483,6 +513,14 @@ impl Interpreter {
                 }
             }
         })?;
+        self.counters.frees += 1;
+        if let Some(site) = origin {
+            self.heap_profile.record_free(site, size);
+        }
+        if let Some(trace) = &mut self.trace {
+            trace.free(step, addr, size, location.line);
+            trace.heap_bytes(step, self.heap.total_allocated());
+        }
 
         Ok(Value::Int(0))
     }
@@ -7,7 +7,7 @@
 //! | Region | Base address  | Direction |
 //! |--------|---------------|-----------|
 //! | Stack  | `0x0000_0004` | grows up (sequential variable IDs) |
-//! | Heap   | `0x7fff_0000` | grows up (first-fit allocator) |
+//! | Heap   | `0x7fff_0000` | grows up (best-fit allocator, freed ranges reused) |
 
 /// Starting address for heap allocations.
 ///
@@ -31,3 +31,47 @@ pub const STACK_ADDRESS_START: u64 = 0x0000_0004;
 /// instead. The limit is far deeper than any pedagogical example needs while
 /// staying well below the host stack's true capacity.
 pub const MAX_CALL_DEPTH: usize = 1000;
+
+/// Granularity of heap block storage, in bytes.
+///
+/// Each heap block is split into pages of this size that are materialized on
+/// first write and shared copy-on-write between snapshots, so a large but
+/// sparsely touched allocation only costs memory for the pages it actually
+/// uses. Small enough that copying a page on the first write after a snapshot
+/// stays cheap; the last page of a block is trimmed to the block's size.
+pub const HEAP_PAGE_SIZE: usize = 256;
+
+/// Alignment of heap blocks, in bytes.
+///
+/// Every block occupies its size rounded up to this multiple, plus one more
+/// multiple of padding, so freed ranges split and coalesce on aligned
+/// boundaries, neighbouring blocks never share a word, and a one-past-the-end
+/// pointer never equals the next block's base.
+pub const HEAP_ALIGNMENT: usize = 8;
+
+/// Bit position of the generation tag in heap pointers.
+///
+/// When the allocator places a block on addresses that were used before, the
+/// pointer it returns carries a fresh generation in the bits above this shift.
+/// Blocks on never-used addresses have generation 0, so their pointers look
+/// like plain addresses. The 24 tag bits above bit 40 leave 1 TiB of heap
+/// address space and about 16.7 million generations before one repeats.
+pub const HEAP_GENERATION_SHIFT: u32 = 40;
+
+/// Reserved native stack for threads that run the interpreter, in bytes.
+///
+/// The tree-walking interpreter recurses through the host stack in proportion
+/// to the C program's call depth, so a deeply recursive program can consume far
+/// more stack than the default main-thread allowance. Running the program on a
+/// thread with a generous stack guarantees the call-depth cap
+/// ([`MAX_CALL_DEPTH`]) surfaces as a clean `RuntimeError` instead of ever
+/// overflowing the native stack.
+pub const INTERPRETER_STACK_SIZE: usize = 256 * 1024 * 1024;
+
+/// Statements an expression probe may execute per evaluation.
+///
+/// Probes evaluate a user expression (which may call program functions)
+/// against every recorded snapshot, so a call that never returns must fail
+/// rather than stall the worker. Each statement or loop iteration counts
+/// once, the same events that would take a snapshot during a recorded run.
+pub const PROBE_STEP_LIMIT: usize = 100_000;
@@ -20,10 +20,15 @@
 //! - [`super::ops::assign`]: Memory operations and struct field access
 //! - [`super::type_system`]: Type inference and compatibility
 
-use crate::interpreter::constants::STACK_ADDRESS_START;
+use crate::interpreter::constants::{PROBE_STEP_LIMIT, STACK_ADDRESS_START};
 use crate::interpreter::errors::RuntimeError;
+use crate::interpreter::exec_log::ExecLog;
+use crate::interpreter::profiler::GuestProfile;
+use crate::interpreter::stats::{InterpreterStats, RunCounters};
+use crate::interpreter::trace::TraceWriter;
 use crate::memory::{
     heap::Heap,
+    heap_profile::HeapProfile,
     sizeof_type,
     stack::{LocalVar, Stack},
     value::Value,
@@ -32,6 +37,8 @@ use crate::parser::ast::{StructDef as AstStructDef, *};
 use crate::snapshot::{MockTerminal, Snapshot, SnapshotManager};
 use rustc_hash::FxHashMap;
 use std::collections::BTreeMap;
+use std::io;
+use std::sync::Arc;
 
 #[derive(Debug, Clone, PartialEq, Default)]
 pub(crate) enum ControlFlow {
@@ -46,6 +53,10 @@ pub(crate) enum ControlFlow {
 
 /// The main interpreter that executes a C program
 pub struct Interpreter {
+    /// Node arena of the parsed program; statements and expressions refer to
+    /// their children by [`NodeId`]
+    pub(crate) ast: Arc<Ast>,
+
     /// Call stack
     pub(crate) stack: Stack,
 
@@ -71,7 +82,7 @@ pub struct Interpreter {
     pub(crate) struct_defs: FxHashMap<String, AstStructDef>,
 
     /// Function definitions (name -> FunctionDef)
-    pub(crate) function_defs: FxHashMap<String, FunctionDef>,
+    pub(crate) function_defs: FxHashMap<String, Arc<FunctionDef>>,
 
     /// Current execution control flow state
     pub(crate) control_flow: ControlFlow,
@@ -85,9 +96,6 @@ pub struct Interpreter {
     /// Return value from the last function call
     pub(crate) return_value: Option<Value>,
 
-    /// Mapping from heap pointer addresses to their types
-    pub(crate) pointer_types: FxHashMap<u64, Type>,
-
     /// Cache for struct field info: (struct_name, field_name) -> (offset, type)
     pub(crate) field_info_cache: FxHashMap<(String, String), (usize, Type)>,
 
@@ -108,6 +116,29 @@ pub struct Interpreter {
 
     /// Memory limit for snapshots (stored so we can recreate the manager on rerun)
     pub(crate) snapshot_memory_limit: usize,
+
+    /// Allocation-site statistics for the current run
+    pub(crate) heap_profile: HeapProfile,
+
+    /// Step and allocation costs per line and function for the current run
+    pub(crate) guest_profile: GuestProfile,
+
+    /// Statements, expressions and heap operations of the current run
+    pub(crate) counters: RunCounters,
+
+    /// Trace Event Format output (`--trace-out`), if enabled
+    pub(crate) trace: Option<TraceWriter>,
+
+    /// JSON Lines step log (`--log-out`), if enabled
+    pub(crate) exec_log: Option<ExecLog>,
+
+    /// Whether steps are kept as snapshots; without history the program
+    /// only runs forward (for headless logging of long runs)
+    pub(crate) record_history: bool,
+
+    /// Statements a [`Probe`](super::probe::Probe) may still execute;
+    /// `None` while recording history
+    pub(crate) probe_steps: Option<usize>,
 }
 
 impl Interpreter {
@@ -117,8 +148,8 @@ impl Interpreter {
         let mut function_defs = FxHashMap::default();
 
         // Index structs and functions for fast lookup
-        for node in &program.nodes {
-            match node {
+        for &id in &program.nodes {
+            match &program.ast[id] {
                 AstNode::StructDef { name, fields, .. } => {
                     struct_defs.insert(
                         name.clone(),
@@ -137,19 +168,35 @@ impl Interpreter {
                 } => {
                     function_defs.insert(
                         name.clone(),
-                        FunctionDef {
+                        Arc::new(FunctionDef {
                             params: params.clone(),
                             body: body.clone(),
                             return_type: return_type.clone(),
                             location: *location,
-                        },
+                        }),
                     );
                 }
                 _ => {}
             }
         }
 
+        Self::with_defs(
+            Arc::new(program.ast),
+            struct_defs,
+            function_defs,
+            snapshot_memory_limit,
+        )
+    }
+
+    /// An interpreter for an already indexed program
+    pub(crate) fn with_defs(
+        ast: Arc<Ast>,
+        struct_defs: FxHashMap<String, AstStructDef>,
+        function_defs: FxHashMap<String, Arc<FunctionDef>>,
+        snapshot_memory_limit: usize,
+    ) -> Self {
         Interpreter {
+            ast,
             stack: Stack::new(),
             heap: Heap::default(),
             terminal: MockTerminal::new(),
@@ -163,7 +210,6 @@ impl Interpreter {
             stack_address_map: BTreeMap::new(),
             next_stack_address: STACK_ADDRESS_START,
             return_value: None,
-            pointer_types: FxHashMap::default(),
             field_info_cache: FxHashMap::default(),
             last_runtime_error: None,
             stdin_tokens: Vec::new(),
@@ -171,6 +217,13 @@ impl Interpreter {
             paused_at_scanf: false,
             execution_finished: false,
             snapshot_memory_limit,
+            heap_profile: HeapProfile::new(),
+            guest_profile: GuestProfile::new(),
+            counters: RunCounters::default(),
+            trace: None,
+            exec_log: None,
+            record_history: true,
+            probe_steps: None,
         }
     }
 
@@ -180,23 +233,101 @@ impl Interpreter {
 
     /// Run the program from start to finish (or until a scanf needs input)
     pub fn run(&mut self) -> Result<(), RuntimeError> {
+        let result = self.run_main();
+        // Calls cut short by an error or a pending scanf still count
+        self.guest_profile.finish();
+        if !self.paused_at_scanf {
+            self.trace_finish_run(result.as_ref().err());
+        }
+        result
+    }
+
+    /// Write trace events to `trace` from the next run on
+    pub fn set_trace(&mut self, trace: TraceWriter) {
+        self.trace = Some(trace);
+    }
+
+    /// Log every step to `log` from the next run on
+    pub fn set_exec_log(&mut self, log: ExecLog) {
+        self.exec_log = Some(log);
+    }
+
+    /// Flush the step log and wait for its writer, if one is being written
+    pub fn finish_exec_log(&mut self) -> io::Result<()> {
+        match self.exec_log.take() {
+            Some(mut log) => log.finish(),
+            None => Ok(()),
+        }
+    }
+
+    /// Keep (the default) or drop execution history. Without history no
+    /// snapshots are recorded, so stepping backward and seeking are
+    /// unavailable, but memory stays flat however long the program runs;
+    /// profiles, stats, trace and step log are still produced.
+    pub fn set_record_history(&mut self, record: bool) {
+        self.record_history = record;
+    }
+
+    /// Close and flush the trace, if one is being written
+    pub fn finish_trace(&mut self) -> io::Result<()> {
+        match self.trace.take() {
+            Some(mut trace) => trace.finish(),
+            None => Ok(()),
+        }
+    }
+
+    /// Trace the start of a call, now that its frame has been pushed
+    pub(crate) fn trace_enter(&mut self, name: &str, line: usize) {
+        if let Some(trace) = &mut self.trace {
+            trace.begin_call(name, self.history_position, line);
+            trace.stack_depth(self.history_position, self.stack.depth());
+        }
+    }
+
+    /// Trace the return from a call, before its frame is popped
+    pub(crate) fn trace_exit(&mut self) {
+        if let Some(trace) = &mut self.trace {
+            trace.end_call(self.history_position);
+            trace.stack_depth(self.history_position, self.stack.depth() - 1);
+        }
+    }
+
+    /// Trace the end of the program: the error that stopped it, if any, and
+    /// the return from every call still on the stack
+    fn trace_finish_run(&mut self, error: Option<&RuntimeError>) {
+        let Some(trace) = &mut self.trace else {
+            return;
+        };
+        let step = self.history_position;
+        if let Some(error) = error {
+            trace.error(step, &error.to_string(), self.current_location.line);
+        }
+        for depth in (0..self.stack.depth()).rev() {
+            trace.end_call(step);
+            trace.stack_depth(step, depth);
+        }
+    }
+
+    fn run_main(&mut self) -> Result<(), RuntimeError> {
         // Find main function
         let main_fn = self
             .function_defs
             .get("main")
-            .ok_or(RuntimeError::NoMainFunction)?
-            .clone();
+            .map(Arc::clone)
+            .ok_or(RuntimeError::NoMainFunction)?;
 
         // Take initial snapshot
         self.take_snapshot()?;
 
         // Push initial stack frame for main
         self.stack.push_frame("main".to_string(), None);
+        self.guest_profile.enter_function("main");
+        self.trace_enter("main", main_fn.location.line);
 
         // Execute main function body
         self.snapshot_at(main_fn.location)?;
 
-        for stmt in &main_fn.body {
+        for &stmt in &main_fn.body {
             match self.execute_statement(stmt) {
                 Ok(needs_snapshot) => {
                     // Only snapshot if we're continuing normal execution
@@ -216,7 +347,10 @@ impl Interpreter {
                     // still point at the last body statement (e.g. printf) when
                     // scanf appears in a loop condition.
                     self.current_location = location;
+                    // Not logged: the rerun with input records this step
+                    let log = self.exec_log.take();
                     let _ = self.take_snapshot();
+                    self.exec_log = log;
                     self.paused_at_scanf = true;
                     return Ok(());
                 }
@@ -261,12 +395,20 @@ impl Interpreter {
         self.stack_address_map = BTreeMap::new();
         self.next_stack_address = STACK_ADDRESS_START;
         self.return_value = None;
-        self.pointer_types = FxHashMap::default();
         self.last_runtime_error = None;
         self.stdin_token_index = 0;
         self.paused_at_scanf = false;
         self.execution_finished = false;
         self.current_location = SourceLocation::new(1, 1);
+        self.heap_profile = HeapProfile::new();
+        self.guest_profile = GuestProfile::new();
+        self.counters = RunCounters::default();
+        if let Some(trace) = &mut self.trace {
+            trace.restart();
+        }
+        if let Some(log) = &mut self.exec_log {
+            log.restart();
+        }
     }
 
     /// Provide a line of stdin input. The line is split by whitespace and tokens are appended
@@ -289,7 +431,7 @@ impl Interpreter {
         let target =
             position_before.min(self.snapshot_manager.len().saturating_sub(1));
         if let Some(snapshot) = self.snapshot_manager.get(target).cloned() {
-            self.restore_snapshot(&snapshot);
+            self.restore_snapshot(snapshot);
         }
         Ok(())
     }
@@ -346,12 +488,36 @@ impl Interpreter {
         }
     }
 
-    /// Execute a single statement
+    /// Execute a single statement, counting it and charging it to its line
+    /// in the [`GuestProfile`]
     /// Returns true if a snapshot should be taken after this statement
     pub(crate) fn execute_statement(
         &mut self,
-        stmt: &AstNode,
+        stmt: NodeId,
     ) -> Result<bool, RuntimeError> {
+        // Statements skipped while searching for a goto label cost nothing
+        let line = match self.control_flow {
+            ControlFlow::Goto(_) => None,
+            _ => Self::get_location(&self.ast[stmt]).map(|loc| loc.line),
+        };
+        let Some(line) = line else {
+            return self.dispatch_statement(stmt);
+        };
+        self.counters.statements += 1;
+        self.guest_profile.enter_line(line);
+        let result = self.dispatch_statement(stmt);
+        self.guest_profile.exit_line();
+        result.map_err(|e| self.with_free_site(e))
+    }
+
+    /// Execute a single statement without profiling it
+    fn dispatch_statement(
+        &mut self,
+        stmt: NodeId,
+    ) -> Result<bool, RuntimeError> {
+        let ast = Arc::clone(&self.ast);
+        let stmt = &ast[stmt];
+
         // If searching for a goto label, skip statements until we find the target
         if let ControlFlow::Goto(ref target) = self.control_flow {
             if let AstNode::Label { name, location } = stmt {
@@ -376,17 +542,12 @@ impl Interpreter {
                 init,
                 location,
             } => {
-                self.execute_var_decl(
-                    name,
-                    var_type,
-                    init.as_deref(),
-                    *location,
-                )?;
+                self.execute_var_decl(name, var_type, *init, *location)?;
                 Ok(true)
             }
 
             AstNode::Assignment { lhs, rhs, location } => {
-                self.execute_assignment(lhs, rhs, *location)?;
+                self.execute_assignment(*lhs, *rhs, *location)?;
                 Ok(true)
             }
 
@@ -396,12 +557,12 @@ impl Interpreter {
                 rhs,
                 location,
             } => {
-                self.execute_compound_assignment(lhs, op, rhs, *location)?;
+                self.execute_compound_assignment(*lhs, op, *rhs, *location)?;
                 Ok(true)
             }
 
             AstNode::Return { expr, location } => {
-                self.execute_return(expr.as_deref(), *location)?;
+                self.execute_return(*expr, *location)?;
                 Ok(false)
             }
 
@@ -412,9 +573,9 @@ impl Interpreter {
                 location,
             } => {
                 self.execute_if(
-                    condition,
+                    *condition,
                     then_branch,
-                    else_branch.as_ref().map(|v| v.as_slice()),
+                    else_branch.as_deref(),
                     *location,
                 )?;
                 Ok(false)
@@ -425,7 +586,7 @@ impl Interpreter {
                 body,
                 location,
             } => {
-                self.execute_while(condition, body, *location)?;
+                self.execute_while(*condition, body, *location)?;
                 Ok(false)
             }
 
@@ -434,7 +595,7 @@ impl Interpreter {
                 condition,
                 location,
             } => {
-                self.execute_do_while(body, condition, *location)?;
+                self.execute_do_while(body, *condition, *location)?;
                 Ok(false)
             }
 
@@ -446,11 +607,7 @@ impl Interpreter {
                 location,
             } => {
                 self.execute_for(
-                    init.as_deref(),
-                    condition.as_deref(),
-                    increment.as_deref(),
-                    body,
-                    *location,
+                    *init, *condition, *increment, body, *location,
                 )?;
                 Ok(false)
             }
@@ -460,7 +617,7 @@ impl Interpreter {
                 location: _,
             } => {
                 self.enter_scope();
-                for stmt in statements {
+                for &stmt in statements {
                     let needs_snapshot = self.execute_statement(stmt)?;
                     if self.should_exit_block() {
                         self.exit_scope();
@@ -484,7 +641,7 @@ impl Interpreter {
             }
 
             AstNode::ExpressionStatement { expr, .. } => {
-                self.evaluate_expr(expr)?;
+                self.evaluate_expr(*expr)?;
                 Ok(true)
             }
 
@@ -503,7 +660,7 @@ impl Interpreter {
                 cases,
                 location,
             } => {
-                self.execute_switch(expr, cases, *location)?;
+                self.execute_switch(*expr, cases, *location)?;
                 Ok(false)
             }
 
@@ -526,46 +683,90 @@ impl Interpreter {
         }
     }
 
-    /// Take a snapshot of the current execution state
+    /// Take a snapshot of the current execution state, completing a step.
+    /// Without history the step is only profiled, traced and logged.
     pub(crate) fn take_snapshot(&mut self) -> Result<(), RuntimeError> {
-        let snapshot = Snapshot {
-            stack: self.stack.clone(),
-            heap: self.heap.clone(),
-            terminal: self.terminal.clone(),
-            current_statement_index: self.history_position,
-            source_location: self.current_location,
-            return_value: self.return_value.clone(),
-            pointer_types: self.pointer_types.clone(),
-            stack_address_map: self.stack_address_map.clone(),
-            next_stack_address: self.next_stack_address,
-            execution_depth: self.execution_depth,
-        };
+        if let Some(steps) = &mut self.probe_steps {
+            // Probes record nothing; they only count statements
+            *steps = steps.checked_sub(1).ok_or_else(|| {
+                RuntimeError::UnsupportedOperation {
+                    message: format!(
+                        "Expression did not finish within {} statements",
+                        PROBE_STEP_LIMIT
+                    ),
+                    location: self.current_location,
+                }
+            })?;
+            return Ok(());
+        }
+        self.guest_profile.record_step(self.current_location.line);
+        if let Some(log) = &mut self.exec_log {
+            log.record(
+                self.history_position,
+                self.current_location.line,
+                &self.stack,
+                &self.terminal,
+            );
+        }
+        if self.record_history {
+            let snapshot = Snapshot {
+                stack: self.stack.clone(),
+                heap: self.heap.clone(),
+                terminal: self.terminal.clone(),
+                current_statement_index: self.history_position,
+                source_location: self.current_location,
+                return_value: self.return_value.clone(),
+                stack_address_map: self.stack_address_map.clone(),
+                next_stack_address: self.next_stack_address,
+                execution_depth: self.execution_depth,
+            };
+            // Pages are now shared with the snapshot; later writes belong to the next one
+            self.heap.mark_snapshotted();
 
-        self.snapshot_manager.push(snapshot).map_err(|_| {
-            RuntimeError::SnapshotLimitExceeded {
-                current: self.snapshot_manager.memory_usage(),
-                limit: self.snapshot_manager.memory_limit(),
-            }
-        })?;
+            self.snapshot_manager.push(snapshot).map_err(|_| {
+                RuntimeError::SnapshotLimitExceeded {
+                    current: self.snapshot_manager.memory_usage(),
+                    limit: self.snapshot_manager.memory_limit(),
+                }
+            })?;
+        }
 
         self.history_position += 1;
+        // Writes from here on show up in the next snapshot
+        self.stack.set_write_step(self.history_position);
+        self.heap.set_write_step(self.history_position);
         Ok(())
     }
 
-    /// Restore execution state from a snapshot
-    fn restore_snapshot(&mut self, snapshot: &Snapshot) {
-        self.stack = snapshot.stack.clone();
-        self.heap = snapshot.heap.clone();
-        self.terminal = snapshot.terminal.clone();
+    /// Restore execution state from a (cloned) snapshot
+    pub(crate) fn restore_snapshot(&mut self, snapshot: Snapshot) {
+        self.stack = snapshot.stack;
+        self.heap = snapshot.heap;
+        self.heap.mark_snapshotted();
+        self.terminal = snapshot.terminal;
         self.current_location = snapshot.source_location;
         self.history_position = snapshot.current_statement_index;
-        self.return_value = snapshot.return_value.clone();
-        self.pointer_types = snapshot.pointer_types.clone();
-        self.stack_address_map = snapshot.stack_address_map.clone();
+        self.return_value = snapshot.return_value;
+        self.stack_address_map = snapshot.stack_address_map;
         self.next_stack_address = snapshot.next_stack_address;
         self.execution_depth = snapshot.execution_depth;
     }
 
+    /// Jump straight to history position `position` with a single restore,
+    /// however far away it is
+    pub fn seek(&mut self, position: usize) -> Result<(), RuntimeError> {
+        match self.snapshot_manager.get(position).cloned() {
+            Some(snapshot) => {
+                self.restore_snapshot(snapshot);
+                Ok(())
+            }
+            None => Err(RuntimeError::HistoryOperationFailed {
+                message: format!("No snapshot at step {}", position),
+                location: self.current_location,
+            }),
+        }
+    }
+
     /// Step backward in execution (restore previous snapshot)
     pub fn step_backward(&mut self) -> Result<(), RuntimeError> {
         if self.history_position == 0 {
@@ -577,10 +778,10 @@ impl Interpreter {
 
         self.history_position -= 1;
 
-        if let Some(snapshot) = self.snapshot_manager.get(self.history_position)
+        if let Some(snapshot) =
+            self.snapshot_manager.get(self.history_position).cloned()
         {
-            let snapshot = snapshot.clone();
-            self.restore_snapshot(&snapshot);
+            self.restore_snapshot(snapshot);
             Ok(())
         } else {
             Err(RuntimeError::HistoryOperationFailed {
@@ -592,12 +793,12 @@ impl Interpreter {
 
     /// Step forward in execution (restore next snapshot if available)
     pub fn step_forward(&mut self) -> Result<(), RuntimeError> {
-        if let Some(snapshot) =
-            self.snapshot_manager.get(self.history_position + 1)
+        if let Some(snapshot) = self
+            .snapshot_manager
+            .get(self.history_position + 1)
+            .cloned()
         {
-            self.history_position += 1;
-            let snapshot = snapshot.clone();
-            self.restore_snapshot(&snapshot);
+            self.restore_snapshot(snapshot);
             Ok(())
         } else if let Some(ref error) = self.last_runtime_error {
             Err(error.clone())
@@ -614,12 +815,12 @@ impl Interpreter {
         let starting_depth = self.execution_depth;
 
         loop {
-            if let Some(snapshot) =
-                self.snapshot_manager.get(self.history_position + 1)
+            if let Some(snapshot) = self
+                .snapshot_manager
+                .get(self.history_position + 1)
+                .cloned()
             {
-                self.history_position += 1;
-                let snapshot = snapshot.clone();
-                self.restore_snapshot(&snapshot);
+                self.restore_snapshot(snapshot);
 
                 if self.execution_depth <= starting_depth {
                     return Ok(());
@@ -660,6 +861,27 @@ impl Interpreter {
         &self.heap
     }
 
+    /// Allocation-site statistics for the whole run (not the current step)
+    pub fn heap_profile(&self) -> &HeapProfile {
+        &self.heap_profile
+    }
+
+    /// Per-line and per-function costs of the current run
+    pub fn guest_profile(&self) -> &GuestProfile {
+        &self.guest_profile
+    }
+
+    /// Work counters and history memory for the current run
+    pub fn stats(&self) -> InterpreterStats {
+        InterpreterStats::new(
+            self.counters,
+            self.snapshot_manager.len(),
+            self.snapshot_manager.retained(),
+            self.snapshot_manager.memory_limit(),
+            self.heap.total_allocated(),
+        )
+    }
+
     pub fn return_value(&self) -> Option<&Value> {
         self.return_value.as_ref()
     }
@@ -706,10 +928,6 @@ impl Interpreter {
         })
     }
 
-    pub fn pointer_types(&self) -> &FxHashMap<u64, Type> {
-        &self.pointer_types
-    }
-
     pub fn history_position(&self) -> usize {
         self.history_position
     }
@@ -718,14 +936,24 @@ impl Interpreter {
         self.snapshot_manager.len()
     }
 
+    /// Shared handle to the snapshot at history position `position`
+    pub fn snapshot(&self, position: usize) -> Option<Arc<Snapshot>> {
+        self.snapshot_manager.get_shared(position)
+    }
+
     pub fn struct_defs(&self) -> &FxHashMap<String, AstStructDef> {
         &self.struct_defs
     }
 
-    pub fn function_defs(&self) -> &FxHashMap<String, FunctionDef> {
+    pub fn function_defs(&self) -> &FxHashMap<String, Arc<FunctionDef>> {
         &self.function_defs
     }
 
+    /// Node arena of the program being executed
+    pub fn ast(&self) -> &Ast {
+        &self.ast
+    }
+
     /// Rewind to the beginning of execution history
     pub fn rewind_to_start(&mut self) -> Result<(), RuntimeError> {
         if self.snapshot_manager.is_empty() {
@@ -737,7 +965,7 @@ impl Interpreter {
 
         self.history_position = 0;
         if let Some(snapshot) = self.snapshot_manager.get(0).cloned() {
-            self.restore_snapshot(&snapshot);
+            self.restore_snapshot(snapshot);
             Ok(())
         } else {
             Err(RuntimeError::HistoryOperationFailed {
@@ -747,6 +975,84 @@ impl Interpreter {
         }
     }
 
+    /// Jump to the last snapshot in execution history
+    pub fn jump_to_end(&mut self) -> Result<(), RuntimeError> {
+        let last =
+            self.snapshot_manager.len().checked_sub(1).ok_or_else(|| {
+                RuntimeError::HistoryOperationFailed {
+                    message: "No snapshots available".to_string(),
+                    location: self.current_location,
+                }
+            })?;
+        if let Some(snapshot) = self.snapshot_manager.get(last).cloned() {
+            self.restore_snapshot(snapshot);
+        }
+        Ok(())
+    }
+
+    /// Number of earlier snapshots at the current source line, i.e. which
+    /// visit of the line the current position is (0 for the first)
+    pub fn line_visit(&self) -> usize {
+        let line = self.current_location.line;
+        (0..self.history_position)
+            .filter_map(|i| self.snapshot_manager.get(i))
+            .filter(|snapshot| snapshot.source_location.line == line)
+            .count()
+    }
+
+    /// Jump to the `visit`-th snapshot at `line`, or to its last visit if the
+    /// line ran fewer times. Returns false, without moving, if the line never
+    /// ran.
+    pub fn seek_line(&mut self, line: usize, visit: usize) -> bool {
+        let mut target = None;
+        let mut remaining = visit;
+        for i in 0..self.snapshot_manager.len() {
+            let Some(snapshot) = self.snapshot_manager.get(i) else {
+                break;
+            };
+            if snapshot.source_location.line == line {
+                target = Some(i);
+                if remaining == 0 {
+                    break;
+                }
+                remaining -= 1;
+            }
+        }
+        match target.and_then(|i| self.snapshot_manager.get(i).cloned()) {
+            Some(snapshot) => {
+                self.restore_snapshot(snapshot);
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Jump to the first snapshot after the current position that is at
+    /// `line` ("run to cursor"). Returns false, without moving, if the line
+    /// does not run again in the recorded history.
+    pub fn seek_next_line(&mut self, line: usize) -> bool {
+        let next = (self.history_position + 1..self.snapshot_manager.len())
+            .find(|&i| {
+                self.snapshot_manager
+                    .get(i)
+                    .is_some_and(|s| s.source_location.line == line)
+            });
+        match next.and_then(|i| self.snapshot_manager.get(i).cloned()) {
+            Some(snapshot) => {
+                self.restore_snapshot(snapshot);
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Queue stdin input ahead of [`run`](Self::run), so `scanf` consumes it
+    /// without pausing
+    pub fn queue_stdin(&mut self, input: &str) {
+        self.stdin_tokens
+            .extend(input.split_whitespace().map(|s| s.to_string()));
+    }
+
     /// Get source location from an AST node
     #[inline]
     pub(crate) fn get_location(node: &AstNode) -> Option<SourceLocation> {
@@ -785,7 +1091,9 @@ impl Interpreter {
 
     /// Convert a heap string error into the appropriate RuntimeError variant.
     /// Detects use-after-free errors and produces `RuntimeError::UseAfterFree`
-    /// instead of the generic `InvalidMemoryOperation`.
+    /// instead of the generic `InvalidMemoryOperation`. The free site is
+    /// filled in later by [`Interpreter::with_free_site`], which can borrow
+    /// the heap.
     pub(crate) fn map_heap_error(
         error: String,
         location: SourceLocation,
@@ -801,6 +1109,7 @@ impl Interpreter {
                 return RuntimeError::UseAfterFree {
                     address: addr,
                     location,
+                    freed_at: None,
                 };
             }
         }
@@ -809,6 +1118,32 @@ impl Interpreter {
             location,
         }
     }
+
+    /// Add the free site of the block a use-after-free or double-free
+    /// error refers to, from its tombstone (if the range was not reused)
+    pub(crate) fn with_free_site(&self, error: RuntimeError) -> RuntimeError {
+        match error {
+            RuntimeError::UseAfterFree {
+                address,
+                location,
+                freed_at: None,
+            } => RuntimeError::UseAfterFree {
+                address,
+                location,
+                freed_at: self.heap.tombstone_at(address).map(|t| t.freed_at),
+            },
+            RuntimeError::DoubleFree {
+                address,
+                location,
+                freed_at: None,
+            } => RuntimeError::DoubleFree {
+                address,
+                location,
+                freed_at: self.heap.tombstone_at(address).map(|t| t.freed_at),
+            },
+            error => error,
+        }
+    }
 }
 
 /// Represents a parsed C function, stored by the interpreter after its initial scan of the AST.
@@ -820,7 +1155,7 @@ pub struct FunctionDef {
     /// Formal parameters in declaration order.
     pub params: Vec<Param>,
     /// Statement body of the function.
-    pub body: Vec<AstNode>,
+    pub body: Vec<NodeId>,
     /// Declared return type.
     pub return_type: Type,
     /// Source location of the opening brace (used for stepping into the function).
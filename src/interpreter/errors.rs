@@ -63,12 +63,16 @@ pub enum RuntimeError {
     UseAfterFree {
         address: u64,
         location: SourceLocation,
+        /// Where the block was freed, if its range has not been reused since
+        freed_at: Option<SourceLocation>,
     },
 
     /// Double free
     DoubleFree {
         address: u64,
         location: SourceLocation,
+        /// Where the block was first freed, if still known
+        freed_at: Option<SourceLocation>,
     },
 
     /// Invalid free (freeing non-allocated memory)
@@ -298,19 +302,35 @@ impl fmt::Display for RuntimeError {
                     current, limit
                 )
             }
-            RuntimeError::UseAfterFree { address, location } => {
+            RuntimeError::UseAfterFree {
+                address,
+                location,
+                freed_at,
+            } => {
                 write!(
                     f,
                     "Use-after-free: address 0x{:x} at line {}",
                     address, location.line
-                )
+                )?;
+                if let Some(site) = freed_at {
+                    write!(f, " (freed at line {})", site.line)?;
+                }
+                Ok(())
             }
-            RuntimeError::DoubleFree { address, location } => {
+            RuntimeError::DoubleFree {
+                address,
+                location,
+                freed_at,
+            } => {
                 write!(
                     f,
                     "Double free at address 0x{:x} at line {}",
                     address, location.line
-                )
+                )?;
+                if let Some(site) = freed_at {
+                    write!(f, " (first freed at line {})", site.line)?;
+                }
+                Ok(())
             }
             RuntimeError::InvalidFree { address, location } => {
                 write!(
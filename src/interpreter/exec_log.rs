@@ -0,0 +1,194 @@
+//! Streaming JSON Lines execution log (`--log-out`)
+//!
+//! [`ExecLog`] writes one compact JSON object per executed step, as the
+//! interpreter records it:
+//!
+//! ```json
+//! {"step":12,"line":7,"function":"main","depth":1,"changed":[{"frame":0,"name":"i","value":3}],"output":"i = 2\n"}
+//! ```
+//!
+//! `changed` lists the stack variables written during the step (found from
+//! their modification stamps, see [`crate::memory::stack`]), and `output`
+//! is the text appended to the terminal since the previous step.
+//!
+//! Records are formatted on the interpreter thread into a chunk buffer.
+//! Full chunks go over a bounded channel to a background thread that owns
+//! the buffered writer. A slow file or pipe does not stall execution until
+//! [`PENDING_CHUNKS`] chunks are waiting; then the interpreter blocks
+//! instead of buffering the rest of the log in memory. The log needs no
+//! snapshots, so it works in no-history mode.
+//!
+//! A scanf rerun replays the program from the start; steps already written
+//! are formatted again (to keep the terminal position in sync) but not
+//! sent.
+
+use super::json::{write_json_string, write_json_value};
+use crate::memory::stack::Stack;
+use crate::snapshot::MockTerminal;
+use std::fmt::Write as _;
+use std::fs::File;
+use std::io::{self, BufWriter, Write};
+use std::path::Path;
+use std::sync::mpsc::{self, SyncSender};
+use std::thread::JoinHandle;
+
+/// Bytes of records collected before they are handed to the writer thread
+const CHUNK_BYTES: usize = 64 * 1024;
+
+/// Chunks waiting for the writer thread before the interpreter blocks
+/// (4 MiB of records)
+const PENDING_CHUNKS: usize = 64;
+
+/// JSON Lines log of executed steps, written on a background thread
+pub struct ExecLog {
+    sender: Option<SyncSender<String>>,
+    writer: Option<JoinHandle<io::Result<()>>>,
+    /// Records not yet sent to the writer thread
+    chunk: String,
+    /// Steps below this were written before the last restart
+    written_until: usize,
+    /// Step after the last one formatted
+    next_step: usize,
+    /// Terminal position already logged: line index and byte offset in it
+    terminal_line: usize,
+    terminal_offset: usize,
+}
+
+impl ExecLog {
+    /// A log written to `out` by a new background thread
+    pub fn new(out: impl Write + Send + 'static) -> io::Result<Self> {
+        let (sender, receiver) = mpsc::sync_channel::<String>(PENDING_CHUNKS);
+        let writer = std::thread::Builder::new()
+            .name("crustty-log".to_string())
+            .spawn(move || {
+                let mut out = BufWriter::new(out);
+                for chunk in receiver {
+                    out.write_all(chunk.as_bytes())?;
+                }
+                out.flush()
+            })?;
+        Ok(ExecLog {
+            sender: Some(sender),
+            writer: Some(writer),
+            chunk: String::with_capacity(CHUNK_BYTES),
+            written_until: 0,
+            next_step: 0,
+            terminal_line: 0,
+            terminal_offset: 0,
+        })
+    }
+
+    /// A log written to a new file at `path` (which may be a named pipe)
+    pub fn create(path: impl AsRef<Path>) -> io::Result<Self> {
+        Self::new(File::create(path)?)
+    }
+
+    /// The run starts over: skip the steps already written
+    pub fn restart(&mut self) {
+        self.written_until = self.written_until.max(self.next_step);
+        self.next_step = 0;
+        self.terminal_line = 0;
+        self.terminal_offset = 0;
+    }
+
+    /// Log step `step`, taken at `line` with the given state
+    pub fn record(
+        &mut self,
+        step: usize,
+        line: usize,
+        stack: &Stack,
+        terminal: &MockTerminal,
+    ) {
+        self.next_step = step + 1;
+        let skip = step < self.written_until;
+        let out = &mut self.chunk;
+        let start = out.len();
+
+        let function = stack
+            .current_frame()
+            .map_or("", |frame| frame.function_name.as_str());
+        let _ =
+            write!(out, "{{\"step\":{},\"line\":{},\"function\":", step, line);
+        write_json_string(out, function);
+        let _ = write!(out, ",\"depth\":{},\"changed\":[", stack.depth());
+        let mut first = true;
+        for (depth, frame) in stack.frames().iter().enumerate() {
+            for name in &frame.insertion_order {
+                let Some(var) = frame.get_var(name) else {
+                    continue;
+                };
+                if var.modified_step != step {
+                    continue;
+                }
+                if !first {
+                    out.push(',');
+                }
+                first = false;
+                let _ = write!(out, "{{\"frame\":{},\"name\":", depth);
+                write_json_string(out, name);
+                out.push_str(",\"value\":");
+                write_json_value(out, &var.value);
+                out.push('}');
+            }
+        }
+        out.push_str("],\"output\":");
+
+        // Text appended to the terminal since the last logged step
+        let mut output = String::new();
+        for (i, text_line) in
+            terminal.lines.iter().enumerate().skip(self.terminal_line)
+        {
+            let from = if i == self.terminal_line {
+                self.terminal_offset.min(text_line.text.len())
+            } else {
+                0
+            };
+            output.push_str(&text_line.text[from..]);
+        }
+        if let Some(last) = terminal.lines.last() {
+            self.terminal_line = terminal.lines.len() - 1;
+            self.terminal_offset = last.text.len();
+        }
+        write_json_string(out, &output);
+        out.push_str("}\n");
+
+        if skip {
+            out.truncate(start);
+        } else if out.len() >= CHUNK_BYTES {
+            self.send_chunk();
+        }
+    }
+
+    /// Send the remaining records, wait for the writer thread and report
+    /// the first write error
+    pub fn finish(&mut self) -> io::Result<()> {
+        self.send_chunk();
+        self.sender = None;
+        match self.writer.take().map(JoinHandle::join) {
+            Some(Ok(result)) => result,
+            Some(Err(_)) => Err(io::Error::other("log writer thread panicked")),
+            None => Ok(()),
+        }
+    }
+
+    fn send_chunk(&mut self) {
+        if self.chunk.is_empty() {
+            return;
+        }
+        let chunk = std::mem::replace(
+            &mut self.chunk,
+            String::with_capacity(CHUNK_BYTES),
+        );
+        if let Some(sender) = &self.sender {
+            // A failed send means the writer stopped on an error, which
+            // `finish` reports
+            let _ = sender.send(chunk);
+        }
+    }
+}
+
+impl Drop for ExecLog {
+    fn drop(&mut self) {
+        let _ = self.finish();
+    }
+}
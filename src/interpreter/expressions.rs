@@ -26,13 +26,17 @@ use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
 use crate::memory::{sizeof_type, value::Value};
 use crate::parser::ast::*;
+use std::sync::Arc;
 
 impl Interpreter {
     /// Evaluate an expression and return its value
     pub(crate) fn evaluate_expr(
         &mut self,
-        expr: &AstNode,
+        expr: NodeId,
     ) -> Result<Value, RuntimeError> {
+        self.counters.expressions += 1;
+        let ast = Arc::clone(&self.ast);
+        let expr = &ast[expr];
         let location =
             Self::get_location(expr).unwrap_or(self.current_location);
 
@@ -50,14 +54,16 @@ impl Interpreter {
                             limit: self.heap.max_size(),
                         }
                     })?;
+                // Literals are static storage in C: not a malloc site,
+                // leak or allocation for the profiles, stats and trace
 
-                for (i, &byte) in bytes.iter().enumerate() {
-                    self.heap
-                        .write_byte(addr + i as u64, byte)
-                        .map_err(|e| Self::map_heap_error(e, *loc))?;
-                }
-                self.heap
-                    .write_byte(addr + bytes.len() as u64, 0)
+                let (block, _) = self
+                    .heap
+                    .block_at_mut(addr)
+                    .map_err(|e| Self::map_heap_error(e, *loc))?;
+                block
+                    .write_bytes(0, bytes)
+                    .and_then(|()| block.write_bytes(bytes.len(), &[0]))
                     .map_err(|e| Self::map_heap_error(e, *loc))?;
 
                 Ok(Value::Pointer(addr))
@@ -78,7 +84,10 @@ impl Interpreter {
                             location: *loc,
                         });
                     }
-                    Ok(var.value.clone())
+                    let value = var.value.clone();
+                    let frame = self.stack.depth().saturating_sub(1);
+                    self.stack.record_read(frame, name);
+                    Ok(value)
                 }
             }
 
@@ -88,11 +97,11 @@ impl Interpreter {
                 right,
                 location,
             } => {
-                let left_val = self.evaluate_expr(left)?;
+                let left_val = self.evaluate_expr(*left)?;
                 if !Self::value_to_bool(&left_val, *location)? {
                     Ok(Value::Int(0))
                 } else {
-                    let right_val = self.evaluate_expr(right)?;
+                    let right_val = self.evaluate_expr(*right)?;
                     let right_bool =
                         Self::value_to_bool(&right_val, *location)?;
                     Ok(Value::Int(if right_bool { 1 } else { 0 }))
@@ -105,11 +114,11 @@ impl Interpreter {
                 right,
                 location,
             } => {
-                let left_val = self.evaluate_expr(left)?;
+                let left_val = self.evaluate_expr(*left)?;
                 if Self::value_to_bool(&left_val, *location)? {
                     Ok(Value::Int(1))
                 } else {
-                    let right_val = self.evaluate_expr(right)?;
+                    let right_val = self.evaluate_expr(*right)?;
                     let right_bool =
                         Self::value_to_bool(&right_val, *location)?;
                     Ok(Value::Int(if right_bool { 1 } else { 0 }))
@@ -121,13 +130,13 @@ impl Interpreter {
                 left,
                 right,
                 location,
-            } => self.evaluate_binary_op(op, left, right, *location),
+            } => self.evaluate_binary_op(op, *left, *right, *location),
 
             AstNode::UnaryOp {
                 op,
                 operand,
                 location,
-            } => self.evaluate_unary_op(op, operand, *location),
+            } => self.evaluate_unary_op(op, *operand, *location),
 
             AstNode::TernaryOp {
                 condition,
@@ -135,13 +144,13 @@ impl Interpreter {
                 false_expr,
                 location,
             } => {
-                let cond_val = self.evaluate_expr(condition)?;
+                let cond_val = self.evaluate_expr(*condition)?;
                 let cond_int = Self::value_to_bool(&cond_val, *location)?;
 
                 if cond_int {
-                    self.evaluate_expr(true_expr)
+                    self.evaluate_expr(*true_expr)
                 } else {
-                    self.evaluate_expr(false_expr)
+                    self.evaluate_expr(*false_expr)
                 }
             }
 
@@ -156,13 +165,13 @@ impl Interpreter {
                 expr,
                 location: _,
             } => {
-                let val = self.evaluate_expr(expr)?;
+                let val = self.evaluate_expr(*expr)?;
 
                 if let Value::Pointer(addr) = val {
                     if target_type.pointer_depth > 0 {
                         let mut pointee_type = target_type.clone();
                         pointee_type.pointer_depth -= 1;
-                        self.pointer_types.insert(addr, pointee_type);
+                        self.record_heap_pointee(addr, pointee_type);
                     }
                 }
 
@@ -173,23 +182,25 @@ impl Interpreter {
                 object,
                 member,
                 location,
-            } => self.evaluate_member_access(object, member, *location),
+            } => self.evaluate_member_access(*object, member, *location),
 
             AstNode::PointerMemberAccess {
                 object,
                 member,
                 location,
-            } => self.evaluate_pointer_member_access(object, member, *location),
+            } => {
+                self.evaluate_pointer_member_access(*object, member, *location)
+            }
 
             AstNode::ArrayAccess {
                 array,
                 index,
                 location,
-            } => self.evaluate_array_access(array, index, *location),
+            } => self.evaluate_array_access(*array, *index, *location),
 
             AstNode::Assignment { lhs, rhs, location } => {
-                let value = self.evaluate_expr(rhs)?;
-                self.assign_to_lvalue(lhs, value.clone(), *location)?;
+                let value = self.evaluate_expr(*rhs)?;
+                self.assign_to_lvalue(*lhs, value.clone(), *location)?;
                 Ok(value)
             }
 
@@ -203,7 +214,7 @@ impl Interpreter {
             }
 
             AstNode::SizeofExpr { expr, location } => {
-                let expr_type = self.infer_expr_type(expr)?;
+                let expr_type = self.infer_expr_type(*expr)?;
                 self.ensure_type_complete(&expr_type, *location)?;
                 let size = sizeof_type(&expr_type, &self.struct_defs);
                 Ok(Value::Int(size as i32))
@@ -215,8 +226,8 @@ impl Interpreter {
                 rhs,
                 location,
             } => {
-                self.execute_compound_assignment(lhs, op, rhs, *location)?;
-                self.evaluate_expr(lhs)
+                self.execute_compound_assignment(*lhs, op, *rhs, *location)?;
+                self.evaluate_expr(*lhs)
             }
 
             _ => Err(RuntimeError::UnsupportedOperation {
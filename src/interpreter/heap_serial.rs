@@ -1,7 +1,15 @@
+//! Value ↔ heap byte serialization
+//!
+//! Values are packed sequentially with no padding (see [`sizeof_type`]). Each
+//! value is resolved to its heap block once and then encoded or decoded
+//! directly against the block's storage, so reading or writing a struct or
+//! array costs one block lookup rather than one per byte.
+
 use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
+use crate::memory::heap::{Heap, HeapBlock};
 use crate::memory::{sizeof_type, value::Value};
-use crate::parser::ast::{BaseType, SourceLocation, Type};
+use crate::parser::ast::{BaseType, SourceLocation, StructDef, Type};
 use rustc_hash::FxHashMap;
 
 impl Interpreter {
@@ -13,169 +21,181 @@ impl Interpreter {
         base_addr: u64,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
-        match value {
-            Value::Int(n) => {
-                // Write 4 bytes (little-endian)
-                let bytes = n.to_le_bytes();
-                for (i, byte) in bytes.iter().enumerate() {
-                    self.heap
-                        .write_byte(base_addr + i as u64, *byte)
-                        .map_err(|e| Self::map_heap_error(e, location))?;
-                }
-                Ok(())
-            }
-            Value::Char(c) => {
-                // Write 1 byte (c is already i8)
-                self.heap
-                    .write_byte(base_addr, *c as u8)
-                    .map_err(|e| Self::map_heap_error(e, location))?;
-                Ok(())
-            }
-            Value::Uninitialized => {
-                // Don't write anything for uninitialized values
-                // The heap already marks bytes as uninitialized by default
-                Ok(())
-            }
-            Value::Pointer(addr) => {
-                // Write 8 bytes (little-endian)
-                let bytes = addr.to_le_bytes();
-                for (i, byte) in bytes.iter().enumerate() {
-                    self.heap
-                        .write_byte(base_addr + i as u64, *byte)
-                        .map_err(|e| Self::map_heap_error(e, location))?;
+        // Uninitialized values leave the heap untouched, even at a bad address
+        if matches!(value, Value::Uninitialized) {
+            return Ok(());
+        }
+        let (block, offset) = self
+            .heap
+            .block_at_mut(base_addr)
+            .map_err(|e| Self::map_heap_error(e, location))?;
+        store_value(
+            block,
+            offset,
+            value,
+            value_type,
+            &self.struct_defs,
+            location,
+        )
+    }
+
+    /// Deserialize a value from heap bytes, counting one load from its block
+    pub(crate) fn deserialize_value_from_heap(
+        &mut self,
+        value_type: &Type,
+        base_addr: u64,
+        location: SourceLocation,
+    ) -> Result<Value, RuntimeError> {
+        let (block, offset) = self
+            .heap
+            .load_at(base_addr)
+            .map_err(|e| Self::map_heap_error(e, location))?;
+        let reader = BlockReader {
+            block,
+            block_addr: base_addr - offset as u64,
+            struct_defs: &self.struct_defs,
+            location,
+        };
+        reader.load(value_type, offset)
+    }
+}
+
+/// Encode `value` into `block` at `offset`
+fn store_value(
+    block: &mut HeapBlock,
+    offset: usize,
+    value: &Value,
+    value_type: &Type,
+    struct_defs: &FxHashMap<String, StructDef>,
+    location: SourceLocation,
+) -> Result<(), RuntimeError> {
+    let write = |block: &mut HeapBlock, bytes: &[u8]| {
+        block
+            .write_bytes(offset, bytes)
+            .map_err(|e| Interpreter::map_heap_error(e, location))
+    };
+    match value {
+        // Little-endian, 4 bytes
+        Value::Int(n) => write(block, &n.to_le_bytes()),
+        // c is already i8
+        Value::Char(c) => write(block, &[*c as u8]),
+        // Don't write anything; the heap marks bytes uninitialized by default
+        Value::Uninitialized => Ok(()),
+        // Little-endian, 8 bytes
+        Value::Pointer(addr) => write(block, &addr.to_le_bytes()),
+        Value::Null => write(block, &[0; 8]),
+        Value::Struct(fields) => {
+            let struct_name = match &value_type.base {
+                BaseType::Struct(name) => name,
+                _ => {
+                    return Err(RuntimeError::TypeError {
+                        expected: "struct type".to_string(),
+                        got: format!("{:?}", value_type.base),
+                        location,
+                    });
                 }
-                Ok(())
-            }
-            Value::Null => {
-                // Write 8 bytes of zeros
-                for i in 0..8 {
-                    self.heap
-                        .write_byte(base_addr + i, 0)
-                        .map_err(|e| Self::map_heap_error(e, location))?;
+            };
+            let struct_def = struct_defs.get(struct_name).ok_or_else(|| {
+                RuntimeError::StructNotDefined {
+                    name: struct_name.to_string(),
+                    location,
                 }
-                Ok(())
-            }
-            Value::Struct(fields) => {
-                // Get struct name from type
-                let struct_name = match &value_type.base {
-                    BaseType::Struct(name) => name,
-                    _ => {
-                        return Err(RuntimeError::TypeError {
-                            expected: "struct type".to_string(),
-                            got: format!("{:?}", value_type.base),
-                            location,
-                        });
-                    }
-                };
+            })?;
 
-                // Get struct definition
-                let struct_def = self
-                    .struct_defs
-                    .get(struct_name)
-                    .ok_or_else(|| RuntimeError::StructNotDefined {
-                        name: struct_name.to_string(),
+            // Write each field sequentially
+            let mut field_offset = offset;
+            for field in &struct_def.fields {
+                if let Some(field_value) = fields.get(&field.name) {
+                    store_value(
+                        block,
+                        field_offset,
+                        field_value,
+                        &field.field_type,
+                        struct_defs,
                         location,
-                    })?
-                    .clone(); // Clone to avoid borrow checker issues
-
-                // Write each field sequentially
-                let mut offset = 0;
-                for field in &struct_def.fields {
-                    if let Some(field_value) = fields.get(&field.name) {
-                        self.serialize_value_to_heap(
-                            field_value,
-                            &field.field_type,
-                            base_addr + offset as u64,
-                            location,
-                        )?;
-                    }
-                    offset += sizeof_type(&field.field_type, &self.struct_defs);
+                    )?;
                 }
-                Ok(())
+                field_offset += sizeof_type(&field.field_type, struct_defs);
             }
-            Value::Array(elements) => {
-                // Get element type
-                let elem_type = match &value_type.base {
-                    BaseType::Int => Type {
-                        base: BaseType::Int,
-                        pointer_depth: 0,
-                        is_const: false,
-                        array_dims: Vec::new(),
-                    },
-                    BaseType::Char => Type {
-                        base: BaseType::Char,
-                        pointer_depth: 0,
-                        is_const: false,
-                        array_dims: Vec::new(),
-                    },
-                    BaseType::Struct(name) => Type {
-                        base: BaseType::Struct(name.clone()),
-                        pointer_depth: 0,
-                        is_const: false,
-                        array_dims: Vec::new(),
-                    },
-                    _ => {
-                        return Err(RuntimeError::UnsupportedOperation {
-                            message: format!(
-                                "Unsupported array element type: {:?}",
-                                value_type.base
-                            ),
-                            location,
-                        });
-                    }
-                };
-
-                let elem_size = sizeof_type(&elem_type, &self.struct_defs);
-                for (i, elem) in elements.iter().enumerate() {
-                    self.serialize_value_to_heap(
-                        elem,
-                        &elem_type,
-                        base_addr + (i * elem_size) as u64,
+            Ok(())
+        }
+        Value::Array(elements) => {
+            let elem_type = match &value_type.base {
+                BaseType::Int | BaseType::Char | BaseType::Struct(_) => {
+                    Type::new(value_type.base.clone())
+                }
+                _ => {
+                    return Err(RuntimeError::UnsupportedOperation {
+                        message: format!(
+                            "Unsupported array element type: {:?}",
+                            value_type.base
+                        ),
                         location,
-                    )?;
+                    });
                 }
-                Ok(())
+            };
+
+            let elem_size = sizeof_type(&elem_type, struct_defs);
+            for (i, elem) in elements.iter().enumerate() {
+                store_value(
+                    block,
+                    offset + i * elem_size,
+                    elem,
+                    &elem_type,
+                    struct_defs,
+                    location,
+                )?;
             }
+            Ok(())
         }
     }
+}
 
-    /// Deserialize a value from heap bytes
-    pub(crate) fn deserialize_value_from_heap(
+/// Decodes values from a single heap block
+struct BlockReader<'a> {
+    block: &'a HeapBlock,
+    /// Address of offset 0 in `block`, for error messages
+    block_addr: u64,
+    struct_defs: &'a FxHashMap<String, StructDef>,
+    location: SourceLocation,
+}
+
+impl BlockReader<'_> {
+    /// Read `N` initialized bytes at `offset`
+    fn bytes<const N: usize>(
+        &self,
+        offset: usize,
+    ) -> Result<[u8; N], RuntimeError> {
+        let mut bytes = [0u8; N];
+        self.block
+            .read_initialized(offset, &mut bytes)
+            .map_err(|bad| {
+                Interpreter::map_heap_error(
+                    Heap::bad_read_error(
+                        self.block_addr + bad as u64,
+                        bad < self.block.size,
+                    ),
+                    self.location,
+                )
+            })?;
+        Ok(bytes)
+    }
+
+    fn load(
         &self,
         value_type: &Type,
-        base_addr: u64,
-        location: SourceLocation,
+        offset: usize,
     ) -> Result<Value, RuntimeError> {
         match &value_type.base {
             BaseType::Int if value_type.pointer_depth == 0 => {
-                // Read 4 bytes (little-endian)
-                let mut bytes = [0u8; 4];
-                for (i, byte) in bytes.iter_mut().enumerate() {
-                    *byte = self
-                        .heap
-                        .read_byte(base_addr + i as u64)
-                        .map_err(|e| Self::map_heap_error(e, location))?;
-                }
-                Ok(Value::Int(i32::from_le_bytes(bytes)))
+                Ok(Value::Int(i32::from_le_bytes(self.bytes(offset)?)))
             }
             BaseType::Char if value_type.pointer_depth == 0 => {
-                // Read 1 byte
-                let byte = self
-                    .heap
-                    .read_byte(base_addr)
-                    .map_err(|e| Self::map_heap_error(e, location))?;
+                let [byte] = self.bytes(offset)?;
                 Ok(Value::Char(byte as i8))
             }
             _ if value_type.pointer_depth > 0 => {
-                // Read 8 bytes (pointer)
-                let mut bytes = [0u8; 8];
-                for (i, byte) in bytes.iter_mut().enumerate() {
-                    *byte = self
-                        .heap
-                        .read_byte(base_addr + i as u64)
-                        .map_err(|e| Self::map_heap_error(e, location))?;
-                }
-                let addr = u64::from_le_bytes(bytes);
+                let addr = u64::from_le_bytes(self.bytes(offset)?);
                 if addr == 0 {
                     Ok(Value::Null)
                 } else {
@@ -183,26 +203,22 @@ impl Interpreter {
                 }
             }
             BaseType::Struct(struct_name) if value_type.pointer_depth == 0 => {
-                // Read struct fields
-                let struct_def = self
-                    .struct_defs
-                    .get(struct_name)
-                    .ok_or_else(|| RuntimeError::StructNotDefined {
-                        name: struct_name.to_string(),
-                        location,
-                    })?
-                    .clone(); // Clone to avoid borrow checker issues
+                let struct_def =
+                    self.struct_defs.get(struct_name).ok_or_else(|| {
+                        RuntimeError::StructNotDefined {
+                            name: struct_name.to_string(),
+                            location: self.location,
+                        }
+                    })?;
 
                 let mut fields = FxHashMap::default();
-                let mut offset = 0;
+                let mut field_offset = offset;
                 for field in &struct_def.fields {
-                    let field_value = self.deserialize_value_from_heap(
-                        &field.field_type,
-                        base_addr + offset as u64,
-                        location,
-                    )?;
+                    let field_value =
+                        self.load(&field.field_type, field_offset)?;
                     fields.insert(field.name.clone(), field_value);
-                    offset += sizeof_type(&field.field_type, &self.struct_defs);
+                    field_offset +=
+                        sizeof_type(&field.field_type, self.struct_defs);
                 }
                 Ok(Value::Struct(fields))
             }
@@ -211,7 +227,7 @@ impl Interpreter {
                     "Deserialization not yet implemented for type: {:?}",
                     value_type
                 ),
-                location,
+                location: self.location,
             }),
         }
     }
@@ -0,0 +1,91 @@
+//! Minimal JSON encoding for the machine-readable outputs (`--stats`,
+//! `--trace-out`, `--log-out`)
+//!
+//! The outputs are flat records of numbers and strings, so they are written
+//! by hand with these helpers instead of pulling in a serializer.
+
+use crate::memory::value::Value;
+use std::fmt::Write;
+
+/// Append `s` to `out` as a JSON string literal
+pub(crate) fn write_json_string(out: &mut String, s: &str) {
+    out.push('"');
+    for c in s.chars() {
+        match c {
+            '"' => out.push_str("\\\""),
+            '\\' => out.push_str("\\\\"),
+            '\n' => out.push_str("\\n"),
+            '\r' => out.push_str("\\r"),
+            '\t' => out.push_str("\\t"),
+            c if (c as u32) < 0x20 => {
+                let _ = write!(out, "\\u{:04x}", c as u32);
+            }
+            c => out.push(c),
+        }
+    }
+    out.push('"');
+}
+
+/// Append a guest value to `out`: numbers for `int` and `char`, hex
+/// strings for pointers, `null` for NULL and uninitialized values, and
+/// objects and arrays for structs and arrays
+pub(crate) fn write_json_value(out: &mut String, value: &Value) {
+    match value {
+        Value::Int(n) => {
+            let _ = write!(out, "{}", n);
+        }
+        Value::Char(c) => {
+            let _ = write!(out, "{}", c);
+        }
+        Value::Pointer(addr) => {
+            let _ = write!(out, "\"0x{:x}\"", addr);
+        }
+        Value::Null | Value::Uninitialized => out.push_str("null"),
+        Value::Struct(fields) => {
+            // Sorted so records are stable across runs
+            let mut fields: Vec<_> = fields.iter().collect();
+            fields.sort_by(|a, b| a.0.cmp(b.0));
+            out.push('{');
+            for (i, (name, value)) in fields.into_iter().enumerate() {
+                if i > 0 {
+                    out.push(',');
+                }
+                write_json_string(out, name);
+                out.push(':');
+                write_json_value(out, value);
+            }
+            out.push('}');
+        }
+        Value::Array(items) => {
+            out.push('[');
+            for (i, item) in items.iter().enumerate() {
+                if i > 0 {
+                    out.push(',');
+                }
+                write_json_value(out, item);
+            }
+            out.push(']');
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_strings_and_values_are_escaped() {
+        let mut out = String::new();
+        write_json_string(&mut out, "a\"b\\c\n\u{1}");
+        assert_eq!(out, "\"a\\\"b\\\\c\\n\\u0001\"");
+
+        out.clear();
+        let value = Value::Array(vec![
+            Value::Int(-3),
+            Value::Pointer(0x10),
+            Value::Uninitialized,
+        ]);
+        write_json_value(&mut out, &value);
+        assert_eq!(out, "[-3,\"0x10\",null]");
+    }
+}
@@ -7,7 +7,7 @@
 use crate::interpreter::engine::{ControlFlow, Interpreter};
 use crate::interpreter::errors::RuntimeError;
 use crate::memory::value::Value;
-use crate::parser::ast::{AstNode, CaseNode, SourceLocation};
+use crate::parser::ast::{CaseNode, NodeId, SourceLocation};
 
 impl Interpreter {
     /// Executes a `return` statement, capturing a snapshot at the return site.
@@ -17,7 +17,7 @@ impl Interpreter {
     /// [`ControlFlow::Return`] so callers unwind the statement loop.
     pub(crate) fn execute_return(
         &mut self,
-        expr: Option<&AstNode>,
+        expr: Option<NodeId>,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         if let Some(ret_expr) = expr {
@@ -40,7 +40,7 @@ impl Interpreter {
     /// fall-through semantics until a `break` (or end of case list) is reached.
     pub(crate) fn execute_switch(
         &mut self,
-        expr: &AstNode,
+        expr: NodeId,
         cases: &[CaseNode],
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
@@ -54,7 +54,7 @@ impl Interpreter {
         for (i, case) in cases.iter().enumerate() {
             match case {
                 CaseNode::Case { value, .. } => {
-                    let case_val = self.evaluate_expr(value)?;
+                    let case_val = self.evaluate_expr(*value)?;
                     if self.values_equal(&switch_val, &case_val) {
                         match_index = Some(i);
                         break;
@@ -83,7 +83,7 @@ impl Interpreter {
                     CaseNode::Default { statements, .. } => statements,
                 };
 
-                for stmt in statements {
+                for &stmt in statements {
                     let needs_snapshot = self.execute_statement(stmt)?;
 
                     if !matches!(self.control_flow, ControlFlow::Normal) {
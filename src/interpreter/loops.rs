@@ -10,7 +10,7 @@
 
 use crate::interpreter::engine::{ControlFlow, Interpreter};
 use crate::interpreter::errors::RuntimeError;
-use crate::parser::ast::{AstNode, SourceLocation};
+use crate::parser::ast::{NodeId, SourceLocation};
 
 /// Result returned by [`Interpreter::execute_loop_body`] to signal how the body ended.
 pub(crate) enum LoopBodyResult {
@@ -31,10 +31,10 @@ impl Interpreter {
     /// [`LoopBodyResult::Exit`] for any other control-flow signal (`return`, `goto`).
     pub(crate) fn execute_loop_body(
         &mut self,
-        body: &[AstNode],
+        body: &[NodeId],
     ) -> Result<LoopBodyResult, RuntimeError> {
         self.enter_scope();
-        for stmt in body {
+        for &stmt in body {
             let needs_snapshot = self.execute_statement(stmt)?;
             if !matches!(self.control_flow, ControlFlow::Normal) {
                 if matches!(self.control_flow, ControlFlow::Break) {
@@ -67,8 +67,8 @@ impl Interpreter {
     /// when it first becomes false (loop exit point).
     pub(crate) fn execute_while(
         &mut self,
-        condition: &AstNode,
-        body: &[AstNode],
+        condition: NodeId,
+        body: &[NodeId],
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         self.execution_depth += 1;
@@ -103,8 +103,8 @@ impl Interpreter {
     /// iteration.
     pub(crate) fn execute_do_while(
         &mut self,
-        body: &[AstNode],
-        condition: &AstNode,
+        body: &[NodeId],
+        condition: NodeId,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         self.execution_depth += 1;
@@ -140,10 +140,10 @@ impl Interpreter {
     /// variable share a single scope that is exited when the loop ends.
     pub(crate) fn execute_for(
         &mut self,
-        init: Option<&AstNode>,
-        condition: Option<&AstNode>,
-        increment: Option<&AstNode>,
-        body: &[AstNode],
+        init: Option<NodeId>,
+        condition: Option<NodeId>,
+        increment: Option<NodeId>,
+        body: &[NodeId],
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         self.enter_scope(); // Scope for init and loop variable
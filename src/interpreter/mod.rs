@@ -10,6 +10,12 @@
 //! - [`expressions`]: Expression evaluation, operators, and arithmetic
 //! - [`builtins`]: Built-in function implementations (printf, malloc, free)
 //! - [`ops::assign`]: Memory operations, assignments, heap serialization, struct field access
+//! - [`profiler`]: Per-line and per-function step and allocation costs
+//! - [`exec_log`]: Streaming JSON Lines log of every executed step
+//! - [`json`]: Hand-written JSON encoding for the machine-readable outputs
+//! - [`probe`]: Evaluating an expression against recorded snapshots
+//! - [`stats`]: Work counters and history memory accounting
+//! - [`trace`]: Streaming Trace Event Format export of calls and heap events
 //! - [`type_system`]: Type inference for expressions and type compatibility
 //! - [`errors`]: Comprehensive runtime error types
 //! - [`constants`]: Interpreter constants (address spaces, size limits)
@@ -59,10 +65,16 @@ pub mod builtins;
 pub mod constants;
 pub mod engine;
 pub mod errors;
+pub mod exec_log;
 pub mod expressions;
 pub mod heap_serial;
+pub mod json;
 pub mod jumps;
 pub mod loops;
 pub mod ops;
+pub mod probe;
+pub mod profiler;
 pub mod statements;
+pub mod stats;
+pub mod trace;
 pub mod type_system;
@@ -2,12 +2,12 @@ use crate::interpreter::constants::HEAP_ADDRESS_START;
 use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
 use crate::memory::{sizeof_type, value::Value};
-use crate::parser::ast::{AstNode, BaseType, SourceLocation};
+use crate::parser::ast::{BaseType, NodeId, SourceLocation};
 
 impl Interpreter {
     pub(crate) fn evaluate_member_access(
         &mut self,
-        object: &AstNode,
+        object: NodeId,
         member: &str,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
@@ -40,7 +40,7 @@ impl Interpreter {
 
     pub(crate) fn evaluate_pointer_member_access(
         &mut self,
-        object: &AstNode,
+        object: NodeId,
         member: &str,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
@@ -51,6 +51,7 @@ impl Interpreter {
                 if addr < HEAP_ADDRESS_START {
                     let (_base_addr, frame_depth, var_name) =
                         self.resolve_stack_pointer(addr, location)?;
+                    self.stack.record_read(frame_depth, &var_name);
 
                     let frame =
                         self.stack.frames().get(frame_depth).ok_or(
@@ -87,7 +88,7 @@ impl Interpreter {
                         }),
                     }
                 } else {
-                    let pointee_type = self.pointer_types.get(&addr)
+                    let pointee_type = self.heap_pointee_type(addr, location)?
                         .ok_or_else(|| RuntimeError::InvalidPointer {
                             message: format!("Unknown type for pointer 0x{:x}. Did you cast the result of malloc?", addr),
                             address: Some(addr),
@@ -131,8 +132,8 @@ impl Interpreter {
 
     pub(crate) fn evaluate_array_access(
         &mut self,
-        array: &AstNode,
-        index: &AstNode,
+        array: NodeId,
+        index: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         let arr_val = self.evaluate_expr(array)?;
@@ -168,6 +169,7 @@ impl Interpreter {
                 if addr < HEAP_ADDRESS_START {
                     let (base_addr, frame_depth, var_name) =
                         self.resolve_stack_pointer(addr, location)?;
+                    self.stack.record_read(frame_depth, &var_name);
 
                     let frame =
                         self.stack.frames().get(frame_depth).ok_or(
@@ -223,7 +225,7 @@ impl Interpreter {
                         }
                     }
                 } else if let Some(elem_type) =
-                    self.pointer_types.get(&addr).cloned()
+                    self.heap_pointee_type(addr, location)?
                 {
                     let elem_size = sizeof_type(&elem_type, &self.struct_defs);
 
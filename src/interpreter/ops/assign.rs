@@ -23,15 +23,18 @@ use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
 use crate::memory::{sizeof_type, value::Value};
 use crate::parser::ast::*;
+use std::sync::Arc;
 
 impl Interpreter {
     /// Assign a value to an l-value (variable, array element, struct field, etc.)
     pub(crate) fn assign_to_lvalue(
         &mut self,
-        lvalue: &AstNode,
+        lvalue: NodeId,
         value: Value,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
+        let ast = Arc::clone(&self.ast);
+        let lvalue = &ast[lvalue];
         match lvalue {
             AstNode::Variable(name, _) => {
                 self.assign_to_variable(name, value, location)
@@ -41,27 +44,27 @@ impl Interpreter {
                 object,
                 member,
                 location: _,
-            } => self.assign_to_member_access(object, member, value, location),
+            } => self.assign_to_member_access(*object, member, value, location),
 
             AstNode::PointerMemberAccess {
                 object,
                 member,
                 location: _,
             } => self.assign_to_pointer_member_access(
-                object, member, value, location,
+                *object, member, value, location,
             ),
 
             AstNode::UnaryOp {
                 op: UnOp::Deref,
                 operand,
                 location: _,
-            } => self.assign_to_dereference(operand, value, location),
+            } => self.assign_to_dereference(*operand, value, location),
 
             AstNode::ArrayAccess {
                 array,
                 index,
                 location: _,
-            } => self.assign_to_array_access(array, index, value, location),
+            } => self.assign_to_array_access(*array, *index, value, location),
 
             _ => Err(RuntimeError::UnsupportedOperation {
                 message: format!(
@@ -107,7 +110,7 @@ impl Interpreter {
 
     fn assign_to_member_access(
         &mut self,
-        object: &AstNode,
+        object: NodeId,
         member: &str,
         value: Value,
         location: SourceLocation,
@@ -136,7 +139,7 @@ impl Interpreter {
 
     fn assign_to_pointer_member_access(
         &mut self,
-        object: &AstNode,
+        object: NodeId,
         member: &str,
         value: Value,
         location: SourceLocation,
@@ -246,18 +249,17 @@ impl Interpreter {
     ) -> Result<(), RuntimeError> {
         // Heap address - write struct field to heap
         // Look up the pointer type
-        let pointee_type = self
-            .pointer_types
-            .get(&addr)
-            .ok_or_else(|| RuntimeError::InvalidPointer {
-                message: format!(
-                    "Unknown type for pointer 0x{:x}. Did you cast the result of malloc?",
-                    addr
-                ),
-                address: Some(addr),
-                location,
-            })?
-            .clone(); // Clone to avoid borrow checker issues
+        let pointee_type =
+            self.heap_pointee_type(addr, location)?.ok_or_else(|| {
+                RuntimeError::InvalidPointer {
+                    message: format!(
+                        "Unknown type for pointer 0x{:x}. Did you cast the result of malloc?",
+                        addr
+                    ),
+                    address: Some(addr),
+                    location,
+                }
+            })?;
 
         // Ensure it's a struct type
         let struct_name = match &pointee_type.base {
@@ -288,9 +290,9 @@ impl Interpreter {
         Ok(())
     }
 
-    fn assign_to_dereference(
+    pub(crate) fn assign_to_dereference(
         &mut self,
-        operand: &AstNode,
+        operand: NodeId,
         value: Value,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
@@ -359,48 +361,28 @@ impl Interpreter {
                     // Heap address
                     // Determine the type of value we're writing
                     // For now, handle basic types (int, char, pointer)
-                    match &value {
+                    let written = match &value {
                         Value::Int(n) => {
-                            let bytes = n.to_le_bytes();
-                            for (i, &byte) in bytes.iter().enumerate() {
-                                self.heap
-                                    .write_byte(addr + i as u64, byte)
-                                    .map_err(|e| Self::map_heap_error(e, location))?;
-                            }
-                            Ok(())
+                            self.heap.write_bytes_at(addr, &n.to_le_bytes())
                         }
                         Value::Char(c) => {
-                            self.heap
-                                .write_byte(addr, *c as u8)
-                                .map_err(|e| Self::map_heap_error(e, location))?;
-                            Ok(())
-                        }
-                        Value::Pointer(ptr_addr) => {
-                            let bytes = ptr_addr.to_le_bytes();
-                            for (i, &byte) in bytes.iter().enumerate() {
-                                self.heap
-                                    .write_byte(addr + i as u64, byte)
-                                    .map_err(|e| Self::map_heap_error(e, location))?;
-                            }
-                            Ok(())
+                            self.heap.write_bytes_at(addr, &[*c as u8])
                         }
-                        Value::Null => {
-                            let bytes = 0u64.to_le_bytes();
-                            for (i, &byte) in bytes.iter().enumerate() {
-                                self.heap
-                                    .write_byte(addr + i as u64, byte)
-                                    .map_err(|e| Self::map_heap_error(e, location))?;
-                            }
-                            Ok(())
+                        Value::Pointer(ptr_addr) => self
+                            .heap
+                            .write_bytes_at(addr, &ptr_addr.to_le_bytes()),
+                        Value::Null => self.heap.write_bytes_at(addr, &[0; 8]),
+                        _ => {
+                            return Err(RuntimeError::UnsupportedOperation {
+                                message: format!(
+                                    "Cannot assign value of type {:?} through pointer dereference",
+                                    value
+                                ),
+                                location,
+                            })
                         }
-                        _ => Err(RuntimeError::UnsupportedOperation {
-                            message: format!(
-                                "Cannot assign value of type {:?} through pointer dereference",
-                                value
-                            ),
-                            location,
-                        }),
-                    }
+                    };
+                    written.map_err(|e| Self::map_heap_error(e, location))
                 }
             }
             Value::Null => Err(RuntimeError::NullDereference { location }),
@@ -414,13 +396,12 @@ impl Interpreter {
 
     fn assign_to_array_access(
         &mut self,
-        array: &AstNode,
-        index: &AstNode,
+        array: NodeId,
+        index: NodeId,
         value: Value,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         // Assign to an array element: arr[idx] = value
-        // Recursive read-modify-write approach
         let idx_val = self.evaluate_expr(index)?;
         let idx = match idx_val {
             Value::Int(i) => i,
@@ -432,7 +413,18 @@ impl Interpreter {
                 });
             }
         };
+        self.assign_to_array_element(array, idx, value, location)
+    }
 
+    /// Assign to element `idx` of the array (or pointer) expression `array`.
+    /// Recursive read-modify-write approach
+    pub(crate) fn assign_to_array_element(
+        &mut self,
+        array: NodeId,
+        idx: i32,
+        value: Value,
+        location: SourceLocation,
+    ) -> Result<(), RuntimeError> {
         let mut array_val = self.evaluate_expr(array)?;
 
         // Track whether we need to write back the modified value
@@ -529,7 +521,7 @@ impl Interpreter {
                 } else {
                     // Heap pointer assignment
                     if let Some(elem_type) =
-                        self.pointer_types.get(&addr).cloned()
+                        self.heap_pointee_type(addr, location)?
                     {
                         let elem_size =
                             sizeof_type(&elem_type, &self.struct_defs);
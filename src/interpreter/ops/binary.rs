@@ -14,7 +14,7 @@ use crate::interpreter::constants::HEAP_ADDRESS_START;
 use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
 use crate::memory::{sizeof_type, value::Value};
-use crate::parser::ast::{AstNode, BinOp, SourceLocation};
+use crate::parser::ast::{BinOp, NodeId, SourceLocation};
 
 impl Interpreter {
     /// Helper to coerce numeric types (Char, Int) to i32
@@ -31,7 +31,7 @@ impl Interpreter {
     /// Returns the size in bytes of the type pointed to by `addr`.
     ///
     /// For stack pointers, the pointee type is looked up from the owning stack frame.
-    /// For heap pointers, the pointee type is looked up from `self.pointer_types`.
+    /// For heap pointers, the pointee type comes from the block's shadow layout.
     /// Used to scale integer offsets in pointer arithmetic expressions.
     pub(crate) fn get_pointer_scale(
         &self,
@@ -60,14 +60,14 @@ impl Interpreter {
                 Ok(sizeof_type(&var.var_type, &self.struct_defs) as u64)
             }
         } else {
-            let pointee = self.pointer_types.get(&addr).ok_or(
+            let pointee = self.heap_pointee_type(addr, location)?.ok_or(
                 RuntimeError::InvalidPointer {
                     message: format!("Unknown type for pointer 0x{:x}", addr),
                     address: Some(addr),
                     location,
                 },
             )?;
-            Ok(sizeof_type(pointee, &self.struct_defs) as u64)
+            Ok(sizeof_type(&pointee, &self.struct_defs) as u64)
         }
     }
 
@@ -352,8 +352,8 @@ impl Interpreter {
     pub(crate) fn evaluate_binary_op(
         &mut self,
         op: &BinOp,
-        left: &AstNode,
-        right: &AstNode,
+        left: NodeId,
+        right: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         use BinOp::*;
@@ -10,7 +10,7 @@ impl Interpreter {
     pub(crate) fn evaluate_unary_op(
         &mut self,
         op: &UnOp,
-        operand: &AstNode,
+        operand: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         use UnOp::*;
@@ -29,7 +29,7 @@ impl Interpreter {
 
     fn evaluate_neg_op(
         &mut self,
-        operand: &AstNode,
+        operand: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         let val = self.evaluate_expr(operand)?;
@@ -51,7 +51,7 @@ impl Interpreter {
 
     fn evaluate_not_op(
         &mut self,
-        operand: &AstNode,
+        operand: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         let val = self.evaluate_expr(operand)?;
@@ -61,7 +61,7 @@ impl Interpreter {
 
     fn evaluate_bitnot_op(
         &mut self,
-        operand: &AstNode,
+        operand: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         let val = self.evaluate_expr(operand)?;
@@ -78,7 +78,7 @@ impl Interpreter {
     fn evaluate_inc_dec_op(
         &mut self,
         op: &UnOp,
-        operand: &AstNode,
+        operand: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         use UnOp::*;
@@ -106,7 +106,7 @@ impl Interpreter {
 
     fn evaluate_deref_op(
         &mut self,
-        operand: &AstNode,
+        operand: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         let val = self.evaluate_expr(operand)?;
@@ -134,6 +134,7 @@ impl Interpreter {
     ) -> Result<Value, RuntimeError> {
         let (base_addr, frame_depth, var_name) =
             self.resolve_stack_pointer(addr, location)?;
+        self.stack.record_read(frame_depth, &var_name);
 
         let frame = self
             .stack
@@ -174,7 +175,7 @@ impl Interpreter {
         addr: u64,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
-        let pointee_type = self.pointer_types.get(&addr).cloned();
+        let pointee_type = self.heap_pointee_type(addr, location)?;
 
         if let Some(ptr_type) = pointee_type {
             self.deserialize_value_from_heap(&ptr_type, addr, location)
@@ -204,10 +205,10 @@ impl Interpreter {
 
     fn evaluate_addr_of_op(
         &mut self,
-        operand: &AstNode,
+        operand: NodeId,
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
-        match operand {
+        match &self.ast[operand] {
             AstNode::Variable(name, _) => {
                 let var = self.get_current_frame_var(name, location)?;
 
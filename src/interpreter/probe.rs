@@ -0,0 +1,107 @@
+//! Expression probes over recorded history
+//!
+//! A [`Probe`] evaluates one C expression — `i`, `list->value`,
+//! `list_length(head)` — in the state of any recorded snapshot. It is a
+//! detached interpreter for the same program: the expression is parsed into
+//! a copy of the program's node arena, each evaluation restores the snapshot
+//! into the probe and evaluates there, and history recording is switched
+//! off, so calls made by the expression never touch the debugged run.
+//!
+//! Snapshots are immutable and a probe owns all of its state, so a series
+//! over the whole history can be computed by several probes (see
+//! [`Probe::fork`]) on separate threads.
+
+use crate::interpreter::constants::PROBE_STEP_LIMIT;
+use crate::interpreter::engine::{ControlFlow, Interpreter};
+use crate::interpreter::errors::RuntimeError;
+use crate::interpreter::profiler::GuestProfile;
+use crate::interpreter::stats::RunCounters;
+use crate::memory::heap_profile::HeapProfile;
+use crate::memory::value::Value;
+use crate::parser::ast::NodeId;
+use crate::parser::parse::{ParseError, Parser};
+use crate::snapshot::Snapshot;
+use std::sync::Arc;
+
+/// An expression that can be evaluated against recorded snapshots
+pub struct Probe {
+    interpreter: Interpreter,
+    expr: NodeId,
+}
+
+impl Interpreter {
+    /// A probe evaluating `expression` in this interpreter's program
+    pub fn probe(&self, expression: &str) -> Result<Probe, ParseError> {
+        let mut parser = Parser::new(expression)?;
+        let (ast, expr) =
+            parser.parse_expression_into(self.ast.as_ref().clone())?;
+        let interpreter = Interpreter::with_defs(
+            Arc::new(ast),
+            self.struct_defs.clone(),
+            self.function_defs.clone(),
+            0,
+        );
+        Ok(Probe { interpreter, expr })
+    }
+}
+
+impl Probe {
+    /// Another probe for the same expression, sharing the parsed program
+    pub fn fork(&self) -> Probe {
+        let interpreter = Interpreter::with_defs(
+            Arc::clone(&self.interpreter.ast),
+            self.interpreter.struct_defs.clone(),
+            self.interpreter.function_defs.clone(),
+            0,
+        );
+        Probe {
+            interpreter,
+            expr: self.expr,
+        }
+    }
+
+    /// Value of the expression in the state recorded by `snapshot`
+    pub fn evaluate(
+        &mut self,
+        snapshot: &Snapshot,
+    ) -> Result<Value, RuntimeError> {
+        let interpreter = &mut self.interpreter;
+        interpreter.restore_snapshot(snapshot.clone());
+        interpreter.control_flow = ControlFlow::Normal;
+        // Calls cut short by an error stay open in the profile, so every
+        // evaluation starts from empty profiles
+        interpreter.heap_profile = HeapProfile::new();
+        interpreter.guest_profile = GuestProfile::new();
+        interpreter.counters = RunCounters::default();
+        interpreter.probe_steps = Some(PROBE_STEP_LIMIT);
+        interpreter.evaluate_expr(self.expr)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_failed_calls_do_not_accumulate() {
+        let source = "int read(int *p) { return *p; }
+            int main() { int *p = NULL; return 0; }";
+        let mut parser = Parser::new(source).unwrap();
+        let program = parser.parse_program().unwrap();
+        let mut interpreter = Interpreter::new(program, 1024 * 1024);
+        interpreter.run().unwrap();
+        let last = interpreter
+            .snapshot(interpreter.total_snapshots() - 1)
+            .unwrap();
+
+        let mut probe = interpreter.probe("read(p)").unwrap();
+        assert!(probe.evaluate(&last).is_err());
+        let counters = probe.interpreter.counters;
+        for _ in 0..3 {
+            assert!(probe.evaluate(&last).is_err());
+        }
+        let profile = &probe.interpreter.guest_profile;
+        assert_eq!(profile.function("read").unwrap().count, 1);
+        assert_eq!(probe.interpreter.counters, counters);
+    }
+}
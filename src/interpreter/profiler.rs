@@ -0,0 +1,359 @@
+//! Per-line and per-function guest profiler
+//!
+//! [`GuestProfile`] charges every execution step (one recorded snapshot) and
+//! every allocated heap byte to the source line and the C function that were
+//! running at the time. Each line and function gets:
+//!
+//! - **exclusive** figures: steps and bytes charged to it directly
+//! - **inclusive** figures: steps and bytes from its entry to its exit,
+//!   including everything it called
+//! - a **count** of how often it was entered
+//!
+//! `execute_statement` and `call_user_function` open and close entries on
+//! two small stacks, and the step hook bumps three counters, so the profiler
+//! stays on for every run. Inclusive figures are only added when the
+//! outermost active instance of a line or function exits, so recursion does
+//! not count the same steps twice.
+//!
+//! Like the [`HeapProfile`](crate::memory::heap_profile::HeapProfile), the
+//! profile covers the whole run, not the current history position.
+
+use rustc_hash::FxHashMap;
+use std::fmt::Write;
+
+/// Costs charged to one source line or function
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct CostStats {
+    /// Times the line was executed or the function was called
+    pub count: u64,
+    /// Steps taken while this was the innermost line or function
+    pub steps: u64,
+    /// Steps from entry to exit, including callees
+    pub inclusive_steps: u64,
+    /// Heap bytes allocated directly here
+    pub heap_bytes: u64,
+    /// Heap bytes allocated from entry to exit, including callees
+    pub inclusive_heap_bytes: u64,
+    /// Instances currently running (greater than 1 under recursion)
+    active: u32,
+}
+
+/// Ordering for [`GuestProfile::top_lines`] and
+/// [`GuestProfile::top_functions`]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ProfileOrder {
+    /// Steps including callees
+    Inclusive,
+    /// Steps charged directly
+    Exclusive,
+    /// Executions or calls
+    Count,
+    /// Heap bytes allocated, including callees
+    HeapBytes,
+}
+
+impl ProfileOrder {
+    /// Cycle to the next ordering (for the TUI)
+    pub fn next(self) -> Self {
+        match self {
+            ProfileOrder::Inclusive => ProfileOrder::Exclusive,
+            ProfileOrder::Exclusive => ProfileOrder::Count,
+            ProfileOrder::Count => ProfileOrder::HeapBytes,
+            ProfileOrder::HeapBytes => ProfileOrder::Inclusive,
+        }
+    }
+
+    /// Short column label
+    pub fn label(self) -> &'static str {
+        match self {
+            ProfileOrder::Inclusive => "incl",
+            ProfileOrder::Exclusive => "excl",
+            ProfileOrder::Count => "count",
+            ProfileOrder::HeapBytes => "heap",
+        }
+    }
+
+    fn key(self, stats: &CostStats) -> u64 {
+        match self {
+            ProfileOrder::Inclusive => stats.inclusive_steps,
+            ProfileOrder::Exclusive => stats.steps,
+            ProfileOrder::Count => stats.count,
+            ProfileOrder::HeapBytes => stats.inclusive_heap_bytes,
+        }
+    }
+}
+
+/// A line or function that has been entered and not yet exited
+#[derive(Debug, Clone, Copy)]
+struct OpenEntry {
+    /// Line number or index into `functions`
+    index: usize,
+    steps_at_entry: u64,
+    bytes_at_entry: u64,
+}
+
+/// Step and allocation costs per source line and per function for a run
+#[derive(Debug, Clone, Default)]
+pub struct GuestProfile {
+    /// Indexed by 1-based line number; index 0 is unused
+    lines: Vec<CostStats>,
+    functions: Vec<(String, CostStats)>,
+    function_index: FxHashMap<String, usize>,
+    open_lines: Vec<OpenEntry>,
+    open_functions: Vec<OpenEntry>,
+    total_steps: u64,
+    total_bytes: u64,
+}
+
+impl GuestProfile {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Start a call to the function `name`
+    pub fn enter_function(&mut self, name: &str) {
+        let index = match self.function_index.get(name) {
+            Some(&index) => index,
+            None => {
+                let index = self.functions.len();
+                self.functions
+                    .push((name.to_string(), CostStats::default()));
+                self.function_index.insert(name.to_string(), index);
+                index
+            }
+        };
+        let stats = &mut self.functions[index].1;
+        stats.count += 1;
+        stats.active += 1;
+        self.open_functions.push(OpenEntry {
+            index,
+            steps_at_entry: self.total_steps,
+            bytes_at_entry: self.total_bytes,
+        });
+    }
+
+    /// Return from the innermost open function call
+    pub fn exit_function(&mut self) {
+        if let Some(entry) = self.open_functions.pop() {
+            let stats = &mut self.functions[entry.index].1;
+            close(stats, entry, self.total_steps, self.total_bytes);
+        }
+    }
+
+    /// Start executing a statement on `line`
+    pub fn enter_line(&mut self, line: usize) {
+        if line >= self.lines.len() {
+            self.lines.resize(line + 1, CostStats::default());
+        }
+        let stats = &mut self.lines[line];
+        stats.count += 1;
+        stats.active += 1;
+        self.open_lines.push(OpenEntry {
+            index: line,
+            steps_at_entry: self.total_steps,
+            bytes_at_entry: self.total_bytes,
+        });
+    }
+
+    /// Finish the innermost open statement
+    pub fn exit_line(&mut self) {
+        if let Some(entry) = self.open_lines.pop() {
+            let stats = &mut self.lines[entry.index];
+            close(stats, entry, self.total_steps, self.total_bytes);
+        }
+    }
+
+    /// Charge one execution step to `line` and the innermost function.
+    ///
+    /// Steps before `main` is entered are not charged. Every step counts as
+    /// inclusive for its own line too, so inclusive never falls below
+    /// exclusive.
+    pub fn record_step(&mut self, line: usize) {
+        let Some(function) = self.open_functions.last() else {
+            return;
+        };
+        self.functions[function.index].1.steps += 1;
+        if line >= self.lines.len() {
+            self.lines.resize(line + 1, CostStats::default());
+        }
+        let stats = &mut self.lines[line];
+        stats.steps += 1;
+        // The snapshot after a statement is taken once it has exited
+        if stats.active == 0 {
+            stats.inclusive_steps += 1;
+        }
+        self.total_steps += 1;
+    }
+
+    /// Charge `size` allocated bytes to `line` and the innermost function
+    pub fn record_alloc(&mut self, line: usize, size: usize) {
+        let size = size as u64;
+        if let Some(function) = self.open_functions.last() {
+            self.functions[function.index].1.heap_bytes += size;
+        }
+        if line >= self.lines.len() {
+            self.lines.resize(line + 1, CostStats::default());
+        }
+        self.lines[line].heap_bytes += size;
+        self.total_bytes += size;
+    }
+
+    /// Close every entry still open, e.g. when the program stops in the
+    /// middle of a call because of a runtime error or a pending scanf
+    pub fn finish(&mut self) {
+        while !self.open_lines.is_empty() {
+            self.exit_line();
+        }
+        while !self.open_functions.is_empty() {
+            self.exit_function();
+        }
+    }
+
+    /// Steps charged so far
+    pub fn total_steps(&self) -> u64 {
+        self.total_steps
+    }
+
+    /// Costs of `line`, if anything ran there
+    pub fn line(&self, line: usize) -> Option<&CostStats> {
+        self.lines.get(line).filter(|s| **s != CostStats::default())
+    }
+
+    /// Costs of the function `name`, if it was called
+    pub fn function(&self, name: &str) -> Option<&CostStats> {
+        self.function_index
+            .get(name)
+            .map(|&index| &self.functions[index].1)
+    }
+
+    /// Up to `limit` lines with a non-zero `order` key, largest first
+    pub fn top_lines(
+        &self,
+        order: ProfileOrder,
+        limit: usize,
+    ) -> Vec<(usize, &CostStats)> {
+        let mut lines: Vec<(usize, &CostStats)> = self
+            .lines
+            .iter()
+            .enumerate()
+            .filter(|(_, s)| order.key(s) > 0)
+            .collect();
+        lines.sort_by(|a, b| {
+            order.key(b.1).cmp(&order.key(a.1)).then(a.0.cmp(&b.0))
+        });
+        lines.truncate(limit);
+        lines
+    }
+
+    /// Up to `limit` functions with a non-zero `order` key, largest first
+    pub fn top_functions(
+        &self,
+        order: ProfileOrder,
+        limit: usize,
+    ) -> Vec<(&str, &CostStats)> {
+        let mut functions: Vec<(&str, &CostStats)> = self
+            .functions
+            .iter()
+            .filter(|(_, s)| order.key(s) > 0)
+            .map(|(name, s)| (name.as_str(), s))
+            .collect();
+        functions.sort_by(|a, b| {
+            order.key(b.1).cmp(&order.key(a.1)).then(a.0.cmp(b.0))
+        });
+        functions.truncate(limit);
+        functions
+    }
+
+    /// Plain-text report of the top `limit` functions and lines, for
+    /// headless mode
+    pub fn report(&self, limit: usize) -> String {
+        let mut out = String::new();
+        let _ = writeln!(
+            out,
+            "Guest profile: {} step(s), {} function(s)",
+            self.total_steps,
+            self.functions.len()
+        );
+        let header = |out: &mut String, first: &str| {
+            let _ = writeln!(
+                out,
+                "{:>16}  {:>10}  {:>10}  {:>8}  {:>10}  {:>10}",
+                first, "incl", "excl", "count", "heap", "incl heap"
+            );
+        };
+        let row = |out: &mut String, first: &str, s: &CostStats| {
+            let _ = writeln!(
+                out,
+                "{:>16}  {:>10}  {:>10}  {:>8}  {:>10}  {:>10}",
+                first,
+                s.inclusive_steps,
+                s.steps,
+                s.count,
+                s.heap_bytes,
+                s.inclusive_heap_bytes
+            );
+        };
+
+        let functions = self.top_functions(ProfileOrder::Inclusive, limit);
+        if !functions.is_empty() {
+            header(&mut out, "function");
+            for (name, stats) in functions {
+                row(&mut out, name, stats);
+            }
+        }
+        let lines = self.top_lines(ProfileOrder::Exclusive, limit);
+        if !lines.is_empty() {
+            header(&mut out, "line");
+            for (line, stats) in lines {
+                row(&mut out, &line.to_string(), stats);
+            }
+        }
+        out
+    }
+}
+
+/// Leave one instance of `stats`, adding its inclusive costs if it was the
+/// outermost one
+fn close(stats: &mut CostStats, entry: OpenEntry, steps: u64, bytes: u64) {
+    stats.active = stats.active.saturating_sub(1);
+    if stats.active == 0 {
+        stats.inclusive_steps += steps - entry.steps_at_entry;
+        stats.inclusive_heap_bytes += bytes - entry.bytes_at_entry;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_recursion_is_not_counted_twice() {
+        let mut profile = GuestProfile::new();
+        profile.enter_function("main");
+        profile.record_step(1);
+        profile.enter_function("fact");
+        profile.record_step(5);
+        profile.enter_function("fact");
+        profile.record_step(5);
+        profile.record_alloc(6, 8);
+        profile.exit_function();
+        profile.record_step(7);
+        profile.finish();
+
+        let fact = profile.function("fact").unwrap();
+        assert_eq!(fact.count, 2);
+        assert_eq!(fact.steps, 3);
+        assert_eq!(fact.inclusive_steps, 3);
+        assert_eq!(fact.inclusive_heap_bytes, 8);
+
+        let main = profile.function("main").unwrap();
+        assert_eq!(main.steps, 1);
+        assert_eq!(main.inclusive_steps, 4);
+        assert_eq!(profile.line(5).unwrap().steps, 2);
+        assert_eq!(profile.line(6).unwrap().heap_bytes, 8);
+
+        let top = profile.top_functions(ProfileOrder::Inclusive, 10);
+        assert_eq!(top[0].0, "main");
+        assert_eq!(profile.top_lines(ProfileOrder::HeapBytes, 10).len(), 0);
+    }
+}
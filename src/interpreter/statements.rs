@@ -25,6 +25,7 @@ use crate::interpreter::errors::RuntimeError;
 use crate::memory::{sizeof_type, value::Value};
 use crate::parser::ast::*;
 use rustc_hash::FxHashMap;
+use std::sync::Arc;
 
 impl Interpreter {
     /// Verify that `ty` is a *complete* type — every struct it names (directly
@@ -93,7 +94,7 @@ impl Interpreter {
         &mut self,
         name: &str,
         var_type: &Type,
-        init: Option<&AstNode>,
+        init: Option<NodeId>,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         // Check that we have a stack frame
@@ -228,7 +229,7 @@ impl Interpreter {
                             pointer_depth: var_type.pointer_depth - 1,
                             array_dims: var_type.array_dims.clone(),
                         };
-                        self.pointer_types.insert(addr, pointed_to_type);
+                        self.record_heap_pointee(addr, pointed_to_type);
                     }
                 }
             }
@@ -239,8 +240,8 @@ impl Interpreter {
 
     pub(crate) fn execute_assignment(
         &mut self,
-        lhs: &AstNode,
-        rhs: &AstNode,
+        lhs: NodeId,
+        rhs: NodeId,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         let value = self.evaluate_expr(rhs)?;
@@ -249,9 +250,9 @@ impl Interpreter {
 
     pub(crate) fn execute_compound_assignment(
         &mut self,
-        lhs: &AstNode,
+        lhs: NodeId,
         op: &BinOp,
-        rhs: &AstNode,
+        rhs: NodeId,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         let rhs_val = self.evaluate_expr(rhs)?;
@@ -287,12 +288,9 @@ impl Interpreter {
         self.assign_to_lvalue(lhs, result_val, location)
     }
 
-    fn execute_branch(
-        &mut self,
-        stmts: &[AstNode],
-    ) -> Result<(), RuntimeError> {
+    fn execute_branch(&mut self, stmts: &[NodeId]) -> Result<(), RuntimeError> {
         self.enter_scope();
-        for stmt in stmts {
+        for &stmt in stmts {
             let needs_snapshot = self.execute_statement(stmt)?;
             if self.should_exit_block() {
                 self.exit_scope();
@@ -309,9 +307,9 @@ impl Interpreter {
 
     pub(crate) fn execute_if(
         &mut self,
-        condition: &AstNode,
-        then_branch: &[AstNode],
-        else_branch: Option<&[AstNode]>,
+        condition: NodeId,
+        then_branch: &[NodeId],
+        else_branch: Option<&[NodeId]>,
         location: SourceLocation,
     ) -> Result<(), RuntimeError> {
         self.snapshot_at(location)?;
@@ -331,7 +329,7 @@ impl Interpreter {
     pub(crate) fn execute_function_call(
         &mut self,
         name: &str,
-        args: &[AstNode],
+        args: &[NodeId],
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         match name {
@@ -346,17 +344,18 @@ impl Interpreter {
     pub(crate) fn call_user_function(
         &mut self,
         name: &str,
-        args: &[AstNode],
+        args: &[NodeId],
         location: SourceLocation,
     ) -> Result<Value, RuntimeError> {
         self.snapshot_at(location)?;
 
-        let func_def =
-            self.function_defs.get(name).cloned().ok_or_else(|| {
-                RuntimeError::UndefinedFunction {
-                    name: name.to_string(),
-                    location,
-                }
+        let func_def = self
+            .function_defs
+            .get(name)
+            .map(Arc::clone)
+            .ok_or_else(|| RuntimeError::UndefinedFunction {
+                name: name.to_string(),
+                location,
             })?;
 
         if args.len() != func_def.params.len() {
@@ -379,12 +378,14 @@ impl Interpreter {
         }
 
         let mut arg_values = Vec::new();
-        for arg in args {
+        for &arg in args {
             arg_values.push(self.evaluate_expr(arg)?);
         }
 
         self.execution_depth += 1;
         self.stack.push_frame(name.to_string(), Some(location));
+        self.guest_profile.enter_function(name);
+        self.trace_enter(name, func_def.location.line);
 
         for (param, value) in func_def.params.iter().zip(arg_values.iter()) {
             let address = self.next_stack_address;
@@ -413,7 +414,7 @@ impl Interpreter {
 
         self.snapshot_at(func_def.location)?;
 
-        for stmt in &func_def.body {
+        for &stmt in &func_def.body {
             let needs_snapshot = self.execute_statement(stmt)?;
             if !matches!(self.control_flow, ControlFlow::Normal) {
                 break;
@@ -434,6 +435,8 @@ impl Interpreter {
         }
 
         let return_val = self.return_value.clone().unwrap_or(Value::Int(0));
+        self.guest_profile.exit_function();
+        self.trace_exit();
         self.stack.pop_frame();
         self.execution_depth -= 1;
         self.control_flow = saved_control_flow;
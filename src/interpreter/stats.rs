@@ -0,0 +1,125 @@
+//! Interpreter statistics
+//!
+//! [`Interpreter::stats`](super::engine::Interpreter::stats) gathers the
+//! run's work counters and the bytes retained by execution history into an
+//! [`InterpreterStats`]. The counters are plain increments on the hot paths,
+//! and history bytes are summed as each snapshot is recorded, so collecting
+//! the stats costs nothing per frame. The figures are for sizing the
+//! snapshot memory limit from data rather than guesses.
+
+use crate::snapshot::HistoryBytes;
+use std::fmt::Write;
+
+/// Work counters for the current run
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub(crate) struct RunCounters {
+    pub statements: u64,
+    pub expressions: u64,
+    pub allocations: u64,
+    pub frees: u64,
+    pub peak_heap_bytes: usize,
+}
+
+/// Execution and memory statistics for a run
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct InterpreterStats {
+    /// Snapshots recorded in history
+    pub snapshots: usize,
+    /// Bytes retained by history, per component
+    pub history: HistoryBytes,
+    /// Snapshot memory limit the history is checked against
+    pub memory_limit: usize,
+    /// Statements executed
+    pub statements: u64,
+    /// Expressions evaluated, including subexpressions
+    pub expressions: u64,
+    /// Successful `malloc` calls
+    pub allocations: u64,
+    /// Successful `free` calls
+    pub frees: u64,
+    /// Bytes allocated on the heap at the current history position
+    pub heap_bytes: usize,
+    /// Most bytes allocated at once during the run
+    pub peak_heap_bytes: usize,
+}
+
+impl InterpreterStats {
+    pub(crate) fn new(
+        counters: RunCounters,
+        snapshots: usize,
+        history: HistoryBytes,
+        memory_limit: usize,
+        heap_bytes: usize,
+    ) -> Self {
+        InterpreterStats {
+            snapshots,
+            history,
+            memory_limit,
+            statements: counters.statements,
+            expressions: counters.expressions,
+            allocations: counters.allocations,
+            frees: counters.frees,
+            heap_bytes,
+            peak_heap_bytes: counters.peak_heap_bytes,
+        }
+    }
+
+    /// The stats as one compact JSON object, for `--stats`
+    pub fn to_json(&self) -> String {
+        let mut out = String::new();
+        let _ = write!(
+            out,
+            "{{\"snapshots\":{},\"memory_limit\":{},\
+             \"history_bytes\":{{\"stack\":{},\"heap\":{},\"terminal\":{},\
+             \"side_tables\":{},\"total\":{}}},\
+             \"statements\":{},\"expressions\":{},\
+             \"heap\":{{\"allocations\":{},\"frees\":{},\"live_bytes\":{},\
+             \"peak_bytes\":{}}}}}",
+            self.snapshots,
+            self.memory_limit,
+            self.history.stack,
+            self.history.heap,
+            self.history.terminal,
+            self.history.side_tables,
+            self.history.total(),
+            self.statements,
+            self.expressions,
+            self.allocations,
+            self.frees,
+            self.heap_bytes,
+            self.peak_heap_bytes
+        );
+        out
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_json_has_every_field() {
+        let counters = RunCounters {
+            statements: 3,
+            expressions: 7,
+            allocations: 1,
+            frees: 1,
+            peak_heap_bytes: 16,
+        };
+        let history = HistoryBytes {
+            stack: 10,
+            heap: 20,
+            terminal: 30,
+            side_tables: 40,
+        };
+        let json =
+            InterpreterStats::new(counters, 5, history, 1000, 0).to_json();
+        assert_eq!(
+            json,
+            "{\"snapshots\":5,\"memory_limit\":1000,\"history_bytes\":\
+             {\"stack\":10,\"heap\":20,\"terminal\":30,\"side_tables\":40,\
+             \"total\":100},\"statements\":3,\"expressions\":7,\"heap\":\
+             {\"allocations\":1,\"frees\":1,\"live_bytes\":0,\"peak_bytes\":16}}"
+        );
+    }
+}
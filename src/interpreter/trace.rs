@@ -0,0 +1,218 @@
+//! Trace Event Format export (`--trace-out`)
+//!
+//! [`TraceWriter`] streams guest events in the JSON array flavour of the
+//! Trace Event Format, which Perfetto, `chrome://tracing` and Speedscope all
+//! open:
+//!
+//! - a `B`/`E` duration pair per function call, from `call_user_function`
+//!   entry to return (plus one for `main`)
+//! - instant events for `malloc`, `free` and runtime errors
+//! - counter tracks for heap bytes in use and call-stack depth
+//!
+//! Timestamps are execution steps (history positions), shown by viewers as
+//! microseconds, so traces are deterministic and free of interpreter
+//! overhead. Each event goes straight to a buffered writer; nothing is kept
+//! in memory, so traces of millions of calls cost no more than small ones.
+//!
+//! A scanf rerun replays the program from the start. The replayed prefix
+//! produces exactly the events already written, so [`TraceWriter::restart`]
+//! skips that many before writing again.
+
+use super::json::write_json_string;
+use std::fmt::Write as _;
+use std::fs::File;
+use std::io::{self, BufWriter, Write};
+use std::path::Path;
+
+/// Streaming writer of Trace Event Format JSON
+pub struct TraceWriter {
+    out: BufWriter<Box<dyn Write + Send>>,
+    /// Reused for formatting each event
+    line: String,
+    /// Events produced since the (re)start of the run
+    events: u64,
+    /// Events a rerun must reproduce before writing resumes
+    skip: u64,
+    /// Whether any event has been written (for the separating commas)
+    started: bool,
+    /// First write error; later events are dropped
+    error: Option<io::Error>,
+}
+
+impl TraceWriter {
+    /// A trace written to `out`
+    pub fn new(out: impl Write + Send + 'static) -> Self {
+        TraceWriter {
+            out: BufWriter::new(Box::new(out)),
+            line: String::new(),
+            events: 0,
+            skip: 0,
+            started: false,
+            error: None,
+        }
+    }
+
+    /// A trace written to a new file at `path`
+    pub fn create(path: impl AsRef<Path>) -> io::Result<Self> {
+        Ok(Self::new(File::create(path)?))
+    }
+
+    /// The run starts over: skip the events it will replay
+    pub fn restart(&mut self) {
+        self.skip = self.skip.max(self.events);
+        self.events = 0;
+    }
+
+    /// Start of a call to `name`
+    pub fn begin_call(&mut self, name: &str, step: usize, line: usize) {
+        self.event(name, "call", "B", step, |out| {
+            let _ = write!(out, ",\"args\":{{\"line\":{}}}", line);
+        });
+    }
+
+    /// Return from the innermost call
+    pub fn end_call(&mut self, step: usize) {
+        self.event("", "call", "E", step, |_| {});
+    }
+
+    /// A `malloc` of `size` bytes at `address`
+    pub fn alloc(
+        &mut self,
+        step: usize,
+        address: u64,
+        size: usize,
+        line: usize,
+    ) {
+        self.heap_event("malloc", step, address, size, line);
+    }
+
+    /// A `free` of `size` bytes at `address`
+    pub fn free(
+        &mut self,
+        step: usize,
+        address: u64,
+        size: usize,
+        line: usize,
+    ) {
+        self.heap_event("free", step, address, size, line);
+    }
+
+    /// A runtime error that stopped the program
+    pub fn error(&mut self, step: usize, message: &str, line: usize) {
+        self.event("runtime error", "error", "i", step, |out| {
+            out.push_str(",\"s\":\"g\",\"args\":{\"message\":");
+            write_json_string(out, message);
+            let _ = write!(out, ",\"line\":{}}}", line);
+        });
+    }
+
+    /// Value of the heap bytes counter track
+    pub fn heap_bytes(&mut self, step: usize, bytes: usize) {
+        self.event("heap", "memory", "C", step, |out| {
+            let _ = write!(out, ",\"args\":{{\"bytes\":{}}}", bytes);
+        });
+    }
+
+    /// Value of the stack depth counter track
+    pub fn stack_depth(&mut self, step: usize, depth: usize) {
+        self.event("stack", "memory", "C", step, |out| {
+            let _ = write!(out, ",\"args\":{{\"depth\":{}}}", depth);
+        });
+    }
+
+    /// Close the JSON array and flush, reporting the first write error
+    pub fn finish(&mut self) -> io::Result<()> {
+        if let Some(error) = self.error.take() {
+            return Err(error);
+        }
+        let close = if self.started { "\n]\n" } else { "[]\n" };
+        self.out.write_all(close.as_bytes())?;
+        self.out.flush()
+    }
+
+    fn heap_event(
+        &mut self,
+        name: &str,
+        step: usize,
+        address: u64,
+        size: usize,
+        line: usize,
+    ) {
+        self.event(name, "heap", "i", step, |out| {
+            let _ = write!(
+                out,
+                ",\"s\":\"t\",\"args\":{{\"address\":\"0x{:x}\",\
+                 \"size\":{},\"line\":{}}}",
+                address, size, line
+            );
+        });
+    }
+
+    fn event(
+        &mut self,
+        name: &str,
+        category: &str,
+        phase: &str,
+        step: usize,
+        args: impl FnOnce(&mut String),
+    ) {
+        self.events += 1;
+        if self.events <= self.skip || self.error.is_some() {
+            return;
+        }
+        self.line.clear();
+        self.line.push_str(if self.started { ",\n" } else { "[\n" });
+        self.line.push_str("{\"name\":");
+        write_json_string(&mut self.line, name);
+        let _ = write!(
+            self.line,
+            ",\"cat\":\"{}\",\"ph\":\"{}\",\"ts\":{},\"pid\":1,\"tid\":1",
+            category, phase, step
+        );
+        args(&mut self.line);
+        self.line.push('}');
+        self.started = true;
+        if let Err(error) = self.out.write_all(self.line.as_bytes()) {
+            self.error = Some(error);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::{Arc, Mutex};
+
+    /// Writer that keeps what it is given, shared with the test
+    #[derive(Clone, Default)]
+    struct Shared(Arc<Mutex<Vec<u8>>>);
+
+    impl Write for Shared {
+        fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+            self.0.lock().unwrap().extend_from_slice(buf);
+            Ok(buf.len())
+        }
+        fn flush(&mut self) -> io::Result<()> {
+            Ok(())
+        }
+    }
+
+    #[test]
+    fn test_restart_skips_replayed_events() {
+        let shared = Shared::default();
+        let mut trace = TraceWriter::new(shared.clone());
+        trace.begin_call("main", 1, 1);
+        trace.stack_depth(1, 1);
+        trace.restart();
+        trace.begin_call("main", 1, 1);
+        trace.stack_depth(1, 1);
+        trace.error(4, "say \"hi\"\n", 3);
+        trace.finish().unwrap();
+
+        let text = String::from_utf8(shared.0.lock().unwrap().clone()).unwrap();
+        assert_eq!(text.matches("\"ph\":\"B\"").count(), 1);
+        assert!(text.starts_with("[\n{\"name\":\"main\""));
+        assert!(text.contains("\"message\":\"say \\\"hi\\\"\\n\""));
+        assert!(text.ends_with("}\n]\n"));
+    }
+}
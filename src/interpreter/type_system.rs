@@ -14,18 +14,45 @@
 //! - Pointer dereference yields the pointed-to type
 //! - Struct member access yields the field's type
 
+use crate::interpreter::constants::HEAP_ADDRESS_START;
 use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
+use crate::memory::sizeof_type;
 use crate::memory::value::Value;
 use crate::parser::ast::*;
+use std::sync::Arc;
 
 impl Interpreter {
+    /// Record `pointee` as the element type of the heap block `addr` points
+    /// into (see [`crate::memory::heap::BlockLayout`]). Stack addresses are
+    /// typed by their variables and are ignored.
+    pub(crate) fn record_heap_pointee(&mut self, addr: u64, pointee: Type) {
+        if addr >= HEAP_ADDRESS_START {
+            let stride = sizeof_type(&pointee, &self.struct_defs);
+            self.heap.set_layout(addr, pointee, stride);
+        }
+    }
+
+    /// Type of the value a heap pointer points at, from its block's layout.
+    /// `Ok(None)` means the block has not been typed yet.
+    pub(crate) fn heap_pointee_type(
+        &self,
+        addr: u64,
+        location: SourceLocation,
+    ) -> Result<Option<Type>, RuntimeError> {
+        self.heap
+            .pointee_type(addr, &self.struct_defs)
+            .map_err(|e| Self::map_heap_error(e, location))
+    }
+
     /// Infer the type of an expression
     /// This is needed for sizeof(expr) to work properly
     pub(crate) fn infer_expr_type(
         &mut self,
-        expr: &AstNode,
+        expr: NodeId,
     ) -> Result<Type, RuntimeError> {
+        let ast = Arc::clone(&self.ast);
+        let expr = &ast[expr];
         match expr {
             AstNode::IntLiteral(_, _) => Ok(Type::new(BaseType::Int)),
 
@@ -58,8 +85,8 @@ impl Interpreter {
                 match op {
                     BinOp::Add | BinOp::Sub => {
                         // Check if either operand is a pointer
-                        let left_type = self.infer_expr_type(left)?;
-                        let right_type = self.infer_expr_type(right)?;
+                        let left_type = self.infer_expr_type(*left)?;
+                        let right_type = self.infer_expr_type(*right)?;
 
                         if left_type.pointer_depth > 0 {
                             Ok(left_type)
@@ -81,7 +108,7 @@ impl Interpreter {
                 match op {
                     UnOp::Deref => {
                         // *ptr: if operand is T*, result is T
-                        let operand_type = self.infer_expr_type(operand)?;
+                        let operand_type = self.infer_expr_type(*operand)?;
                         if operand_type.pointer_depth == 0 {
                             return Err(RuntimeError::TypeError {
                                 expected: "pointer".to_string(),
@@ -95,7 +122,7 @@ impl Interpreter {
                     }
                     UnOp::AddrOf => {
                         // &var: if operand is T, result is T*
-                        let operand_type = self.infer_expr_type(operand)?;
+                        let operand_type = self.infer_expr_type(*operand)?;
                         let mut result_type = operand_type;
                         result_type.pointer_depth += 1;
                         Ok(result_type)
@@ -107,7 +134,7 @@ impl Interpreter {
                     | UnOp::PostInc
                     | UnOp::PostDec => {
                         // ++/-- returns the type of the operand
-                        self.infer_expr_type(operand)
+                        self.infer_expr_type(*operand)
                     }
                 }
             }
@@ -115,7 +142,7 @@ impl Interpreter {
             AstNode::TernaryOp { true_expr, .. } => {
                 // Ternary operator returns the type of the true branch (simplified)
                 // In real C, it's more complex with implicit conversions
-                self.infer_expr_type(true_expr)
+                self.infer_expr_type(*true_expr)
             }
 
             AstNode::FunctionCall { name, location, .. } => {
@@ -134,7 +161,7 @@ impl Interpreter {
                 array, location, ..
             } => {
                 // arr[i]: if arr is T[], result is T
-                let array_type = self.infer_expr_type(array)?;
+                let array_type = self.infer_expr_type(*array)?;
 
                 if !array_type.array_dims.is_empty() {
                     // Array type - remove one dimension
@@ -161,7 +188,7 @@ impl Interpreter {
                 location,
             } => {
                 // obj.field: get the field type from the struct definition
-                let object_type = self.infer_expr_type(object)?;
+                let object_type = self.infer_expr_type(*object)?;
 
                 let struct_name = match &object_type.base {
                     BaseType::Struct(name) => name,
@@ -185,7 +212,7 @@ impl Interpreter {
                 location,
             } => {
                 // ptr->field: dereference pointer then get field type
-                let pointer_type = self.infer_expr_type(object)?;
+                let pointer_type = self.infer_expr_type(*object)?;
 
                 if pointer_type.pointer_depth == 0 {
                     return Err(RuntimeError::TypeError {
@@ -6,18 +6,30 @@
 //!
 //! # Execution sequence
 //!
-//! 1. Parse CLI arguments → source path or `"default"` keyword
+//! 1. Parse CLI arguments → source path or `"default"` keyword, plus flags
 //! 2. Lex + parse source → `Program` AST (parse errors are surfaced in the TUI)
 //! 3. `Interpreter::run()` → executes fully, building snapshot history
 //! 4. `interpreter.rewind_to_start()` → reset cursor to snapshot 0
 //! 5. `App::run()` → ratatui event loop until the user quits
+//!
+//! With `--headless` steps 4–5 are replaced by printing the program's output
+//! to stdout (scanf input is read from stdin). `--heap-profile` prints the
+//! allocation-site report to stderr once the run (or the TUI) ends, and
+//! `--profile` the per-function and per-line costs; `--stats` prints the
+//! interpreter statistics as one JSON object. `--trace-out <file>` streams
+//! function calls, heap events and errors to a Trace Event Format file, and
+//! `--log-out <file>` one JSON line per executed step. `--no-history` (with
+//! `--headless`) records no snapshots, so long runs can be logged in
+//! constant memory. With
+//! `--watch` the TUI re-parses and re-runs the file whenever it is saved.
 
 use crustty::interpreter;
 use crustty::parser;
+use crustty::snapshot;
 use crustty::ui;
 
 use std::fs;
-use std::io;
+use std::io::{self, BufRead};
 use std::path::Path;
 
 use crossterm::{
@@ -29,21 +41,166 @@ use crossterm::{
 };
 use ratatui::{backend::CrosstermBackend, Terminal};
 
+use interpreter::constants::INTERPRETER_STACK_SIZE;
 use interpreter::engine::Interpreter;
+use interpreter::errors::RuntimeError;
+use interpreter::exec_log::ExecLog;
+use interpreter::trace::TraceWriter;
 use parser::ast::Program;
+use parser::incremental::IncrementalParser;
 use parser::parse::Parser;
+use snapshot::TerminalLineKind;
 use ui::app::ErrorState;
+use ui::watch::Watcher;
 use ui::App;
 
-/// Reserved native stack for the interpreter thread.
-///
-/// The tree-walking interpreter recurses through the host stack in proportion
-/// to the C program's call depth, so a deeply recursive program can consume far
-/// more stack than the default main-thread allowance. Running the whole program
-/// on a thread with a generous stack guarantees the interpreter's call-depth cap
-/// (`MAX_CALL_DEPTH`) surfaces as a clean `RuntimeError` instead of ever
-/// overflowing the native stack.
-const INTERPRETER_STACK_SIZE: usize = 256 * 1024 * 1024;
+/// Number of allocation sites listed by `--heap-profile`
+const HEAP_PROFILE_SITES: usize = 20;
+
+/// Number of functions and of lines listed by `--profile`
+const GUEST_PROFILE_ENTRIES: usize = 20;
+
+/// Parsed command-line arguments
+struct CliOptions {
+    /// Source path or bundled example name
+    input: String,
+    /// Run without the TUI, printing program output to stdout
+    headless: bool,
+    /// Print the allocation-site heap profile to stderr at exit
+    heap_profile: bool,
+    /// Print the per-function and per-line guest profile to stderr at exit
+    profile: bool,
+    /// Print interpreter statistics as JSON to stderr at exit
+    stats: bool,
+    /// Write a Trace Event Format file of calls and heap events here
+    trace_out: Option<String>,
+    /// Write a JSON Lines record per executed step here
+    log_out: Option<String>,
+    /// Record no snapshots (headless only)
+    no_history: bool,
+    /// Re-run the program in the TUI whenever the file changes
+    watch: bool,
+}
+
+fn print_usage(program_name: &str) {
+    eprintln!("Usage: {} [options] <file.c> | <example>", program_name);
+    eprintln!();
+    eprintln!("Options:");
+    eprintln!("  --headless       Run without the TUI; output goes to stdout");
+    eprintln!("  --heap-profile   Print per-allocation-site heap statistics");
+    eprintln!(
+        "  --profile        Print steps and heap bytes per function/line"
+    );
+    eprintln!("  --stats          Print interpreter statistics as JSON");
+    eprintln!("  --trace-out F    Write calls and heap events to trace file F");
+    eprintln!("  --log-out F      Write one JSON line per executed step to F");
+    eprintln!(
+        "  --no-history     Keep no snapshots (with --headless; saves memory)"
+    );
+    eprintln!(
+        "  --watch          Re-run the program whenever the file is saved"
+    );
+    eprintln!();
+    eprintln!("Examples:");
+    eprintln!(
+        "  {} default                 # Run the comprehensive example",
+        program_name
+    );
+    eprintln!(
+        "  {} myprogram.c             # Run your own C program",
+        program_name
+    );
+    eprintln!();
+}
+
+/// Parse `std::env::args()`, exiting with usage on error
+fn parse_args() -> CliOptions {
+    let args: Vec<String> = std::env::args().collect();
+    let program_name = args.first().map(|s| s.as_str()).unwrap_or("crustty");
+
+    let mut input = None;
+    let mut headless = false;
+    let mut heap_profile = false;
+    let mut profile = false;
+    let mut stats = false;
+    let mut trace_out = None;
+    let mut log_out = None;
+    let mut no_history = false;
+    let mut watch = false;
+    let mut rest = args.iter().skip(1);
+    while let Some(arg) = rest.next() {
+        match arg.as_str() {
+            "--headless" => headless = true,
+            "--heap-profile" => heap_profile = true,
+            "--profile" => profile = true,
+            "--stats" => stats = true,
+            "--trace-out" | "--log-out" => {
+                let Some(path) = rest.next() else {
+                    eprintln!("Error: {} needs a file name", arg);
+                    eprintln!();
+                    print_usage(program_name);
+                    std::process::exit(1);
+                };
+                if arg == "--trace-out" {
+                    trace_out = Some(path.clone());
+                } else {
+                    log_out = Some(path.clone());
+                }
+            }
+            "--no-history" => no_history = true,
+            "--watch" => watch = true,
+            flag if flag.starts_with("--") => {
+                eprintln!("Error: Unknown option '{}'", flag);
+                eprintln!();
+                print_usage(program_name);
+                std::process::exit(1);
+            }
+            _ if input.is_none() => input = Some(arg.clone()),
+            _ => {
+                eprintln!("Error: Unexpected argument '{}'", arg);
+                eprintln!();
+                print_usage(program_name);
+                std::process::exit(1);
+            }
+        }
+    }
+
+    let Some(input) = input else {
+        eprintln!("Error: No input file provided");
+        eprintln!();
+        print_usage(program_name);
+        std::process::exit(1);
+    };
+
+    if no_history && !headless {
+        eprintln!("Error: --no-history needs --headless");
+        eprintln!();
+        print_usage(program_name);
+        std::process::exit(1);
+    }
+
+    let writes_files = trace_out.is_some() || log_out.is_some();
+    if watch && (headless || input == "default" || writes_files) {
+        eprintln!(
+            "Error: --watch needs a source file and the TUI, without output files"
+        );
+        eprintln!();
+        print_usage(program_name);
+        std::process::exit(1);
+    }
+
+    CliOptions {
+        input,
+        headless,
+        heap_profile,
+        profile,
+        stats,
+        trace_out,
+        log_out,
+        no_history,
+        watch,
+    }
+}
 
 fn main() -> Result<(), Box<dyn std::error::Error>> {
     // Run everything on a worker thread with a large stack (see
@@ -61,32 +218,8 @@ fn main() -> Result<(), Box<dyn std::error::Error>> {
 }
 
 fn run_app() -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
-    // Parse command-line arguments
-    let args: Vec<String> = std::env::args().collect();
-
-    // Get the first argument
-    let arg = if args.len() < 2 {
-        // If no arguments, check if we should run an example or show help
-        let program_name =
-            args.first().map(|s| s.as_str()).unwrap_or("crustty");
-        eprintln!("Error: No input file provided");
-        eprintln!();
-        eprintln!("Usage: {} <file.c> | <example>", program_name);
-        eprintln!();
-        eprintln!("Examples:");
-        eprintln!(
-            "  {} default                 # Run the comprehensive example",
-            program_name
-        );
-        eprintln!(
-            "  {} myprogram.c             # Run your own C program",
-            program_name
-        );
-        eprintln!();
-        std::process::exit(1);
-    } else {
-        &args[1]
-    };
+    let options = parse_args();
+    let arg = &options.input;
 
     // Determine source code and filename for display
     let (source, filename) = match arg.as_str() {
@@ -106,55 +239,73 @@ fn run_app() -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
 
     // Parse the source code
     eprintln!("Parsing {}...", filename);
-    let (program, parse_error) = match Parser::new(&source) {
-        Ok(mut parser) => match parser.parse_program() {
-            Ok(prog) => {
-                eprintln!(
-                    "Parsed successfully. Found {} top-level declarations.",
-                    prog.nodes.len()
-                );
-                (prog, None)
-            }
-            Err(e) => {
-                eprintln!("Parser error: {}", e);
-                eprintln!("Entering TUI to show error...");
-                // Create empty program and store error
-                let error = ErrorState::ParseError {
-                    message: e.message.clone(),
-                    location: e.location,
-                };
-                (Program { nodes: Vec::new() }, Some(error))
-            }
-        },
+    // Watch mode parses incrementally from the start, so the first edit can
+    // reuse the unchanged declarations
+    let mut incremental = options.watch.then(IncrementalParser::new);
+    let parsed = match incremental.as_mut() {
+        Some(parser) => parser.parse(&source).map(|reparse| reparse.program),
+        None => {
+            Parser::new(&source).and_then(|mut parser| parser.parse_program())
+        }
+    };
+    let (program, parse_error) = match parsed {
+        Ok(prog) => {
+            eprintln!(
+                "Parsed successfully. Found {} top-level declarations.",
+                prog.nodes.len()
+            );
+            (prog, None)
+        }
         Err(e) => {
-            eprintln!("Parser initialization error: {}", e);
+            eprintln!("Parser error: {}", e);
             eprintln!("Entering TUI to show error...");
             // Create empty program and store error
             let error = ErrorState::ParseError {
                 message: e.message.clone(),
                 location: e.location,
             };
-            (Program { nodes: Vec::new() }, Some(error))
+            (Program::new(), Some(error))
         }
     };
 
     // Create interpreter with snapshot memory limit (1 GB)
     let snapshot_limit = 1024 * 1024 * 1024;
     let mut interpreter = Interpreter::new(program, snapshot_limit);
+    if let Some(path) = &options.trace_out {
+        match TraceWriter::create(path) {
+            Ok(trace) => interpreter.set_trace(trace),
+            Err(e) => {
+                eprintln!("Error: Cannot create trace file '{}': {}", path, e);
+                std::process::exit(1);
+            }
+        }
+    }
+    if let Some(path) = &options.log_out {
+        match ExecLog::create(path) {
+            Ok(log) => interpreter.set_exec_log(log),
+            Err(e) => {
+                eprintln!("Error: Cannot create log file '{}': {}", path, e);
+                std::process::exit(1);
+            }
+        }
+    }
+    interpreter.set_record_history(!options.no_history);
 
     // Run execution to build history
     // Note: We intentionally don't pass runtime errors to the App initially.
     // The error will be shown when the user steps forward to the line where it occurred.
+    let mut run_result = Ok(());
     if parse_error.is_none() {
         eprintln!("Executing program...");
-        match interpreter.run() {
+        run_result = interpreter.run();
+        match &run_result {
             Ok(()) => {
-                if interpreter.is_paused_at_scanf() {
+                if interpreter.is_paused_at_scanf() && !options.headless {
                     eprintln!(
                         "Execution paused at scanf (waiting for input in TUI). Snapshots so far: {}",
                         interpreter.total_snapshots()
                     );
-                } else {
+                } else if !interpreter.is_paused_at_scanf() {
                     eprintln!("Execution completed successfully.");
                     eprintln!(
                         "Total snapshots: {}",
@@ -162,13 +313,23 @@ fn run_app() -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
                     );
                 }
             }
-            Err(e) => {
-                eprintln!("Runtime error: {:?}", e);
+            // Headless runs report the error after printing the output
+            Err(e) if !options.headless => {
+                eprintln!("Runtime error: {}", e);
                 eprintln!("Error will be shown when stepping to the error line in TUI...");
             }
+            Err(_) => {}
         }
     }
 
+    if options.headless {
+        if let Some(error) = parse_error {
+            eprintln!("{}", error.message());
+            std::process::exit(1);
+        }
+        return run_headless(interpreter, run_result, &options);
+    }
+
     // Rewind to the beginning for TUI
     if let Err(e) = interpreter.rewind_to_start() {
         eprintln!("Warning: Failed to rewind to start: {:?}", e);
@@ -188,6 +349,9 @@ fn run_app() -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
     } else {
         App::new(interpreter, source)
     };
+    if let Some(parser) = incremental {
+        app = app.with_watcher(Watcher::new(arg, parser, snapshot_limit));
+    }
     let res = app.run(&mut terminal);
 
     // Restore terminal
@@ -199,5 +363,72 @@ fn run_app() -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
         eprintln!("Error: {:?}", err);
     }
 
+    print_reports(&mut app.interpreter, &options);
+    Ok(())
+}
+
+/// Print the reports requested on the command line to stderr and close the
+/// trace and log files
+fn print_reports(interpreter: &mut Interpreter, options: &CliOptions) {
+    if let Err(e) = interpreter.finish_trace() {
+        eprintln!("Error: Writing trace file failed: {}", e);
+    }
+    if let Err(e) = interpreter.finish_exec_log() {
+        eprintln!("Error: Writing log file failed: {}", e);
+    }
+    if options.heap_profile {
+        eprint!(
+            "{}",
+            interpreter.heap_profile().report(
+                HEAP_PROFILE_SITES,
+                interpreter.is_execution_complete()
+            )
+        );
+    }
+    if options.profile {
+        eprint!(
+            "{}",
+            interpreter.guest_profile().report(GUEST_PROFILE_ENTRIES)
+        );
+    }
+    if options.stats {
+        eprintln!("{}", interpreter.stats().to_json());
+    }
+}
+
+/// Finish a run without the TUI: feed scanf from stdin, then print the
+/// program's output (and the requested reports). `result` is the outcome of
+/// the initial run; a runtime error exits with status 1.
+fn run_headless(
+    mut interpreter: Interpreter,
+    mut result: Result<(), RuntimeError>,
+    options: &CliOptions,
+) -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
+    let mut stdin = io::stdin().lock();
+    while result.is_ok() && interpreter.is_paused_at_scanf() {
+        let mut line = String::new();
+        if stdin.read_line(&mut line)? == 0 {
+            eprintln!("Execution paused at scanf: end of input");
+            break;
+        }
+        result = interpreter.provide_scanf_input(line.trim_end().to_string());
+        if result.is_err() {
+            break;
+        }
+    }
+
+    // A runtime error leaves the last good state as the final snapshot
+    let _ = interpreter.jump_to_end();
+    for (text, kind) in interpreter.terminal().get_output() {
+        if kind == TerminalLineKind::Output {
+            println!("{}", text);
+        }
+    }
+
+    print_reports(&mut interpreter, options);
+    if let Err(e) = result {
+        eprintln!("Runtime error: {}", e);
+        std::process::exit(1);
+    }
     Ok(())
 }
@@ -0,0 +1,69 @@
+//! Memory access counters for the heatmap overlay
+//!
+//! Every heap block and every stack variable carries an [`AccessCounts`]
+//! that the interpreter bumps once per value loaded or stored, whatever its
+//! size. The counters live inside the block or variable, so each snapshot
+//! holds the counts up to its own step at no extra cost, and the UI can
+//! color regions by how often they have been touched so far.
+
+use super::heap::Heap;
+use super::stack::Stack;
+
+/// Number of heat levels, including level 0 (never accessed)
+pub const HEAT_LEVELS: usize = 4;
+
+/// Reads and writes of one heap block or stack variable
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct AccessCounts {
+    pub reads: u64,
+    pub writes: u64,
+}
+
+impl AccessCounts {
+    /// Reads plus writes
+    pub fn total(&self) -> u64 {
+        self.reads + self.writes
+    }
+
+    /// Heat level in `0..HEAT_LEVELS` relative to the hottest region, `max`.
+    ///
+    /// Levels are logarithmic, so a loop counter touched millions of times
+    /// does not wash out everything else. Any access gives at least level 1.
+    pub fn heat(&self, max: u64) -> usize {
+        let total = self.total();
+        if total == 0 || max == 0 {
+            return 0;
+        }
+        let bits = |n: u64| (u64::BITS - n.leading_zeros()) as usize;
+        (bits(total) * (HEAT_LEVELS - 1) / bits(max.max(total))).max(1)
+    }
+}
+
+/// Highest access count of any live heap block or stack variable, used to
+/// scale [`AccessCounts::heat`]
+pub fn hottest(stack: &Stack, heap: &Heap) -> u64 {
+    let heap_max = heap.blocks().map(|(_, b)| b.access.total()).max();
+    let stack_max = stack
+        .frames()
+        .iter()
+        .flat_map(|frame| frame.locals.values())
+        .map(|var| var.access.total())
+        .max();
+    heap_max.max(stack_max).unwrap_or(0)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_heat_is_logarithmic_and_bounded() {
+        let counts = |reads| AccessCounts { reads, writes: 0 };
+        assert_eq!(counts(0).heat(1000), 0);
+        assert_eq!(counts(1).heat(1000), 1);
+        assert_eq!(counts(1000).heat(1000), HEAT_LEVELS - 1);
+        assert_eq!(counts(40).heat(1000), 1);
+        assert_eq!(counts(100).heat(1000), 2);
+        assert_eq!(counts(5).heat(0), 0);
+    }
+}
@@ -2,9 +2,43 @@
 //!
 //! This module provides heap memory management with:
 //! - Explicit allocation/deallocation (malloc/free)
-//! - Tombstone tracking for freed blocks (enables reverse execution)
+//! - Tombstone records for freed blocks (address, size, free site and step)
 //! - Per-byte initialization tracking
 //! - Use-after-free and double-free detection
+//! - A typed shadow layout per block, so any interior pointer can be typed
+//! - Address reuse through a coalescing best-fit free list, with generation
+//!   tags so dangling pointers into reused memory are still caught
+//!
+//! Generations are a global 24-bit counter (see
+//! [`HEAP_GENERATION_SHIFT`]), so after about 16.7 million reuses a tag comes
+//! round again; a pointer kept dangling for that long can then alias a live
+//! block of the same generation without being reported.
+//!
+//! # Paged Storage
+//!
+//! Block contents are split into [`HEAP_PAGE_SIZE`]-byte pages that are only
+//! materialized on first write. Untouched pages read as uninitialized zeros
+//! without allocating anything. Pages (and each block's page table) are held
+//! behind [`Arc`]s, so cloning the heap for a snapshot shares every page with
+//! the live heap; the first write to a shared page copies just that page.
+//! Memory therefore scales with the bytes a program actually touches, not with
+//! the sizes it passes to `malloc`.
+//!
+//! # Modification Stamps
+//!
+//! Each page, and each block as a whole, records the history step of its
+//! last write (a block also counts its allocation). The interpreter advances
+//! the step with [`Heap::set_write_step`]. The UI asks
+//! [`HeapBlock::modified_since`] to highlight recently changed rows, which
+//! costs a page-table lookup per row instead of a diff of two snapshots.
+//!
+//! # Access Counts
+//!
+//! Each block counts the values loaded from and stored to it
+//! ([`HeapBlock::access`]). Stores are counted by the mutable accessors
+//! ([`Heap::write_byte`], [`Heap::block_at_mut`]); loads by the counted read
+//! paths ([`Heap::read_byte`], [`Heap::load_at`]). [`Heap::block_at`] and
+//! [`Heap::get_block`] are for inspection and count nothing.
 //!
 //! # Error Handling
 //!
@@ -13,32 +47,254 @@
 //! `RuntimeError` at the interpreter boundary. Refactoring to a custom type would
 //! require changes to 50+ call sites with minimal functional benefit.
 
+use super::access::AccessCounts;
+use super::heap_profile::AllocOrigin;
+use super::sizeof_type;
 use super::value::Address;
-use crate::interpreter::constants::HEAP_ADDRESS_START;
+use crate::interpreter::constants::{
+    HEAP_ADDRESS_START, HEAP_ALIGNMENT, HEAP_GENERATION_SHIFT, HEAP_PAGE_SIZE,
+};
+use crate::parser::ast::{BaseType, SourceLocation, StructDef, Type};
+use std::collections::btree_map::Entry;
+use std::collections::{BTreeMap, BTreeSet, HashMap};
+use std::hash::BuildHasher;
+use std::ops::Range;
+use std::sync::Arc;
+
+/// Generations fit in the bits above [`HEAP_GENERATION_SHIFT`]
+const GENERATION_MASK: u32 = (1 << (64 - HEAP_GENERATION_SHIFT)) - 1;
+
+/// Approximate bytes per page-table entry (key, pointer and tree overhead),
+/// charged when a shared page table has to be copied.
+const PAGE_TABLE_ENTRY_BYTES: usize = 32;
+
+/// Record of a freed block, kept so later misuse can be diagnosed
+///
+/// The block's contents are dropped on `free`; earlier snapshots still hold
+/// them through their shared pages, which is all reverse execution needs.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Tombstone {
+    /// Pointer that was freed, including its generation tag
+    pub address: Address,
+    pub size: usize,
+    /// Location of the `free` call
+    pub freed_at: SourceLocation,
+    /// Execution step at which the block was freed
+    pub freed_step: usize,
+}
+
+/// Freed bytes still attributed to a [`Tombstone`]: `key..end`
+///
+/// A block that reuses part of a freed range trims its records to the bytes
+/// it does not cover, so a dangling pointer into the rest of the old block is
+/// still reported as use-after-free.
+#[derive(Debug, Clone, Copy)]
+struct FreedRange {
+    end: Address,
+    tombstone: Tombstone,
+}
+
+/// Typed shadow layout of a heap block: a run of `elem_type` values laid out
+/// from offset 0 every `stride` bytes
+///
+/// Recorded when a pointer into the block is cast or assigned to a typed
+/// pointer variable, and consulted by [`Heap::pointee_type`] for any address
+/// inside the block.
+#[derive(Debug, Clone, PartialEq)]
+pub struct BlockLayout {
+    pub elem_type: Type,
+    pub stride: usize,
+}
+
+/// Find the type that starts exactly `offset` bytes into a value of type `typ`,
+/// descending into struct fields and array elements
+fn type_at_offset<S: BuildHasher>(
+    typ: &Type,
+    offset: usize,
+    struct_defs: &HashMap<String, StructDef, S>,
+) -> Option<Type> {
+    if offset == 0 {
+        return Some(typ.clone());
+    }
+    if typ.pointer_depth > 0 {
+        return None;
+    }
+    if !typ.array_dims.is_empty() {
+        let elem = typ.element_type();
+        let size = sizeof_type(&elem, struct_defs);
+        return type_at_offset(&elem, offset.checked_rem(size)?, struct_defs);
+    }
+    let BaseType::Struct(name) = &typ.base else {
+        return None;
+    };
+    let mut field_start = 0;
+    for field in &struct_defs.get(name)?.fields {
+        let size = sizeof_type(&field.field_type, struct_defs);
+        if offset < field_start + size {
+            return type_at_offset(
+                &field.field_type,
+                offset - field_start,
+                struct_defs,
+            );
+        }
+        field_start += size;
+    }
+    None
+}
+
+/// One materialized page of a heap block: raw bytes plus an init bitmap
+#[derive(Debug, Clone)]
+struct HeapPage {
+    data: Box<[u8]>,
+    init: Box<[u64]>,
+    /// History step of the last write to this page
+    modified_step: usize,
+}
+
+impl HeapPage {
+    fn zeroed(len: usize) -> Self {
+        HeapPage {
+            data: vec![0; len].into_boxed_slice(),
+            init: vec![0; len.div_ceil(64)].into_boxed_slice(),
+            modified_step: 0,
+        }
+    }
+
+    #[inline]
+    fn is_init(&self, i: usize) -> bool {
+        (self.init[i / 64] >> (i % 64)) & 1 == 1
+    }
+
+    #[inline]
+    fn set_init(&mut self, i: usize, initialized: bool) {
+        if initialized {
+            self.init[i / 64] |= 1 << (i % 64);
+        } else {
+            self.init[i / 64] &= !(1 << (i % 64));
+        }
+    }
 
-/// State of a heap block
-#[derive(Debug, Clone, PartialEq, Eq)]
-pub enum BlockState {
-    Allocated,
-    Tombstone, // Freed but kept for reverse execution
+    /// Bytes of storage owned by this page
+    fn footprint(&self) -> usize {
+        self.data.len() + self.init.len() * 8
+    }
 }
 
 /// A block of heap memory
+///
+/// Storage is paged and copy-on-write (see the module docs); use the accessor
+/// methods rather than assuming contiguous backing memory.
 #[derive(Debug, Clone)]
 pub struct HeapBlock {
-    pub data: Vec<u8>, // Raw bytes
+    /// Materialized pages keyed by page index; missing pages are all-uninit
+    pages: Arc<BTreeMap<usize, Arc<HeapPage>>>,
     pub size: usize,
-    pub state: BlockState,
-    pub init_map: Vec<bool>, // Per-byte initialization tracking
+    /// Generation tag carried in the upper bits of pointers to this block
+    pub generation: u32,
+    /// Element type and stride, once the program has told us what it stores
+    pub layout: Option<Arc<BlockLayout>>,
+    /// Where the block was allocated (see [`super::heap_profile`])
+    pub origin: Option<AllocOrigin>,
+    /// Bytes materialized or copied since the last snapshot
+    unshared_bytes: usize,
+    /// History step of the allocation or the last write to any page
+    pub modified_step: usize,
+    /// Step stamped on pages written from now on (set by [`Heap`])
+    write_step: usize,
+    /// Values loaded from and stored to this block so far
+    pub access: AccessCounts,
 }
 
 impl HeapBlock {
     pub fn new(size: usize) -> Self {
         HeapBlock {
-            data: vec![0; size],
+            pages: Arc::new(BTreeMap::new()),
             size,
-            state: BlockState::Allocated,
-            init_map: vec![false; size],
+            generation: 0,
+            layout: None,
+            origin: None,
+            unshared_bytes: 0,
+            modified_step: 0,
+            write_step: 0,
+            access: AccessCounts::default(),
+        }
+    }
+
+    /// Length of page `index` (the last page is trimmed to the block size)
+    #[inline]
+    fn page_len(&self, index: usize) -> usize {
+        HEAP_PAGE_SIZE.min(self.size - index * HEAP_PAGE_SIZE)
+    }
+
+    /// Get a page for writing, materializing it or breaking sharing as needed,
+    /// and stamp it as written at the current step
+    fn page_mut(&mut self, index: usize) -> &mut HeapPage {
+        let len = self.page_len(index);
+        let step = self.write_step;
+        self.modified_step = step;
+        if Arc::strong_count(&self.pages) > 1 {
+            self.unshared_bytes += self.pages.len() * PAGE_TABLE_ENTRY_BYTES;
+        }
+        let pages = Arc::make_mut(&mut self.pages);
+        let page = match pages.entry(index) {
+            Entry::Vacant(slot) => {
+                let page = HeapPage::zeroed(len);
+                self.unshared_bytes += page.footprint();
+                slot.insert(Arc::new(page))
+            }
+            Entry::Occupied(slot) => {
+                let page = slot.into_mut();
+                if Arc::strong_count(page) > 1 {
+                    self.unshared_bytes += page.footprint();
+                }
+                page
+            }
+        };
+        let page = Arc::make_mut(page);
+        page.modified_step = step;
+        page
+    }
+
+    /// Whether any byte of `range` was written at `step` or later; the block
+    /// header (allocation) is covered by `modified_step`
+    pub fn modified_since(&self, range: Range<usize>, step: usize) -> bool {
+        if self.modified_step < step || range.is_empty() {
+            return false;
+        }
+        let first = range.start / HEAP_PAGE_SIZE;
+        let last = (range.end - 1) / HEAP_PAGE_SIZE;
+        self.pages
+            .range(first..=last)
+            .any(|(_, page)| page.modified_step >= step)
+    }
+
+    /// Read one byte as `(value, initialized)`; unmaterialized bytes are `(0, false)`
+    #[inline]
+    fn get(&self, offset: usize) -> (u8, bool) {
+        match self.pages.get(&(offset / HEAP_PAGE_SIZE)) {
+            Some(page) => {
+                let i = offset % HEAP_PAGE_SIZE;
+                (page.data[i], page.is_init(i))
+            }
+            None => (0, false),
+        }
+    }
+
+    /// Set the initialization flag for a byte range, skipping pages that
+    /// would stay all-uninitialized
+    fn set_init_range(
+        &mut self,
+        offset: usize,
+        size: usize,
+        initialized: bool,
+    ) {
+        for pos in offset..offset + size {
+            let index = pos / HEAP_PAGE_SIZE;
+            if !initialized && !self.pages.contains_key(&index) {
+                continue;
+            }
+            self.page_mut(index)
+                .set_init(pos % HEAP_PAGE_SIZE, initialized);
         }
     }
 
@@ -47,31 +303,52 @@ impl HeapBlock {
         if offset + size > self.size {
             return false;
         }
-        self.init_map[offset..offset + size].iter().all(|&b| b)
+        (offset..offset + size).all(|pos| self.get(pos).1)
     }
 
     /// Mark a byte range as initialized
     pub fn mark_initialized(&mut self, offset: usize, size: usize) {
         if offset + size <= self.size {
-            for i in offset..offset + size {
-                self.init_map[i] = true;
-            }
+            self.set_init_range(offset, size, true);
         }
     }
 
     /// Mark a byte range as uninitialized
     pub fn mark_uninitialized(&mut self, offset: usize, size: usize) {
         if offset + size <= self.size {
-            for i in offset..offset + size {
-                self.init_map[i] = false;
-            }
+            self.set_init_range(offset, size, false);
+        }
+    }
+
+    /// Read an initialized byte, or `None` if it is uninitialized or out of range
+    #[inline]
+    pub fn byte_at(&self, offset: usize) -> Option<u8> {
+        if offset >= self.size {
+            return None;
+        }
+        match self.get(offset) {
+            (byte, true) => Some(byte),
+            (_, false) => None,
         }
     }
 
-    /// Read bytes from the block
-    pub fn read_bytes(&self, offset: usize, size: usize) -> Option<&[u8]> {
+    /// Copy out a byte range together with its per-byte initialization flags.
+    ///
+    /// The range is clamped to the block; used by the UI, which formats values
+    /// from contiguous slices.
+    pub fn read_range(
+        &self,
+        offset: usize,
+        len: usize,
+    ) -> (Vec<u8>, Vec<bool>) {
+        let end = (offset + len).min(self.size);
+        (offset.min(end)..end).map(|pos| self.get(pos)).unzip()
+    }
+
+    /// Read raw bytes from the block (uninitialized bytes read as their stored value)
+    pub fn read_bytes(&self, offset: usize, size: usize) -> Option<Vec<u8>> {
         if offset + size <= self.size {
-            Some(&self.data[offset..offset + size])
+            Some((offset..offset + size).map(|pos| self.get(pos).0).collect())
         } else {
             None
         }
@@ -91,32 +368,146 @@ impl HeapBlock {
                 self.size
             ));
         }
-        self.data[offset..offset + bytes.len()].copy_from_slice(bytes);
-        self.mark_initialized(offset, bytes.len());
+        let end = offset + bytes.len();
+        let mut pos = offset;
+        while pos < end {
+            let index = pos / HEAP_PAGE_SIZE;
+            let start = pos % HEAP_PAGE_SIZE;
+            let n = (self.page_len(index) - start).min(end - pos);
+            let src = &bytes[pos - offset..pos - offset + n];
+            let page = self.page_mut(index);
+            page.data[start..start + n].copy_from_slice(src);
+            for i in start..start + n {
+                page.set_init(i, true);
+            }
+            pos += n;
+        }
+        Ok(())
+    }
+
+    /// Copy an initialized byte range into `out`.
+    ///
+    /// On failure returns the offset of the first byte that is uninitialized
+    /// or past the end of the block.
+    pub fn read_initialized(
+        &self,
+        offset: usize,
+        out: &mut [u8],
+    ) -> Result<(), usize> {
+        let end = offset + out.len();
+        let mut pos = offset;
+        while pos < end {
+            if pos >= self.size {
+                return Err(pos);
+            }
+            let index = pos / HEAP_PAGE_SIZE;
+            let start = pos % HEAP_PAGE_SIZE;
+            let n = (self.page_len(index) - start).min(end - pos);
+            let page = self.pages.get(&index).ok_or(pos)?;
+            if let Some(i) = (start..start + n).find(|&i| !page.is_init(i)) {
+                return Err(pos + (i - start));
+            }
+            out[pos - offset..pos - offset + n]
+                .copy_from_slice(&page.data[start..start + n]);
+            pos += n;
+        }
         Ok(())
     }
+
+    /// Write a single byte and mark it initialized
+    #[inline]
+    fn write_byte(&mut self, offset: usize, byte: u8) {
+        let page = self.page_mut(offset / HEAP_PAGE_SIZE);
+        let i = offset % HEAP_PAGE_SIZE;
+        page.data[i] = byte;
+        page.set_init(i, true);
+    }
+
+    /// Bytes of page storage currently materialized for this block
+    pub fn resident_bytes(&self) -> usize {
+        self.pages.values().map(|page| page.footprint()).sum()
+    }
+}
+
+/// Split a heap pointer into its untagged address and generation tag
+#[inline]
+fn untag(addr: Address) -> (Address, u32) {
+    (
+        addr & ((1 << HEAP_GENERATION_SHIFT) - 1),
+        (addr >> HEAP_GENERATION_SHIFT) as u32,
+    )
+}
+
+/// Build the pointer handed out for a block at `base` with `generation`
+#[inline]
+fn tag(base: Address, generation: u32) -> Address {
+    base | (u64::from(generation) << HEAP_GENERATION_SHIFT)
+}
+
+/// Address-space footprint of a block: its size rounded up to the alignment,
+/// plus one alignment unit of padding so that a one-past-the-end pointer
+/// never equals the base of the next block
+#[inline]
+fn span_of(size: usize) -> usize {
+    size.max(1).div_ceil(HEAP_ALIGNMENT) * HEAP_ALIGNMENT + HEAP_ALIGNMENT
 }
 
 /// The heap
+///
+/// A best-fit allocator over a contiguous address range starting at
+/// [`HEAP_ADDRESS_START`]. Freed ranges are coalesced with their neighbours
+/// and reused by later allocations; a free range that reaches the top of the
+/// heap lowers the bump pointer instead, so a program that frees what it
+/// allocates settles at a steady-state footprint.
+///
+/// Blocks placed on previously used addresses get a fresh generation, which
+/// is stored in the upper bits of the pointer returned by [`Heap::allocate`].
+/// Every access compares the pointer's tag with the block it lands in, so a
+/// dangling pointer into reused memory is still reported as use-after-free.
 #[derive(Debug, Clone)]
 pub struct Heap {
-    allocations: std::collections::HashMap<Address, HeapBlock>,
+    /// Live blocks keyed by untagged base address
+    blocks: BTreeMap<Address, HeapBlock>,
+    /// Freed bytes not yet reused, keyed by untagged start; one freed block
+    /// may be split into several ranges around blocks that reuse it
+    tombstones: BTreeMap<Address, FreedRange>,
+    /// Free ranges below `next_address`, keyed by start address
+    free_ranges: BTreeMap<Address, usize>,
+    /// The same free ranges ordered by `(length, start)` for best-fit lookup
+    free_by_size: BTreeSet<(usize, Address)>,
     next_address: Address,
+    /// Highest address ever handed out; memory below it has been used before
+    high_water: Address,
+    next_generation: u32,
     total_allocated_bytes: usize,
     max_heap_size: usize,
+    /// Step stamped on blocks allocated or written from now on
+    write_step: usize,
 }
 
 impl Heap {
     /// Create a new heap with a maximum size limit
     pub fn new(max_heap_size: usize) -> Self {
         Heap {
-            allocations: std::collections::HashMap::new(),
+            blocks: BTreeMap::new(),
+            tombstones: BTreeMap::new(),
+            free_ranges: BTreeMap::new(),
+            free_by_size: BTreeSet::new(),
             next_address: HEAP_ADDRESS_START, // Start heap at high address
+            high_water: HEAP_ADDRESS_START,
+            next_generation: 1,
             total_allocated_bytes: 0,
             max_heap_size,
+            write_step: 0,
         }
     }
 
+    /// Set the history step that later allocations and writes are stamped
+    /// with
+    pub fn set_write_step(&mut self, step: usize) {
+        self.write_step = step;
+    }
+
     /// Allocate a block of memory
     pub fn allocate(&mut self, size: usize) -> Result<Address, String> {
         if self.total_allocated_bytes + size > self.max_heap_size {
@@ -126,40 +517,209 @@ impl Heap {
             ));
         }
 
-        let addr = self.next_address;
-        self.next_address += size as u64;
-        self.allocations.insert(addr, HeapBlock::new(size));
+        let span = span_of(size);
+        let base = match self.take_free_range(span) {
+            Some(base) => base,
+            None => {
+                let base = self.next_address;
+                self.next_address += span as u64;
+                base
+            }
+        };
+
+        self.trim_tombstones(base, base + span as u64);
+
+        let generation = if base < self.high_water {
+            let generation = self.next_generation;
+            self.next_generation = (self.next_generation + 1) & GENERATION_MASK;
+            self.next_generation = self.next_generation.max(1);
+            generation
+        } else {
+            0
+        };
+        self.high_water = self.high_water.max(base + span as u64);
+
+        let mut block = HeapBlock::new(size);
+        block.generation = generation;
+        block.modified_step = self.write_step;
+        block.write_step = self.write_step;
+        self.blocks.insert(base, block);
         self.total_allocated_bytes += size;
 
-        Ok(addr)
+        Ok(tag(base, generation))
+    }
+
+    /// Drop freed-block records for `start..end`, which a new block now
+    /// covers, keeping the parts of each record outside it
+    fn trim_tombstones(&mut self, start: Address, end: Address) {
+        // Ranges are disjoint and sorted, so their ends are sorted too
+        let overlapping: Vec<Address> = self
+            .tombstones
+            .range(..end)
+            .rev()
+            .take_while(|(_, range)| range.end > start)
+            .map(|(&key, _)| key)
+            .collect();
+        for key in overlapping {
+            let Some(range) = self.tombstones.remove(&key) else {
+                continue;
+            };
+            if key < start {
+                self.tombstones.insert(
+                    key,
+                    FreedRange {
+                        end: start,
+                        ..range
+                    },
+                );
+            }
+            if range.end > end {
+                self.tombstones.insert(end, range);
+            }
+        }
+    }
+
+    /// Remove and return the start of the smallest free range that fits
+    /// `span` bytes, returning any remainder to the free lists
+    fn take_free_range(&mut self, span: usize) -> Option<Address> {
+        let &(len, start) = self.free_by_size.range((span, 0)..).next()?;
+        self.free_by_size.remove(&(len, start));
+        self.free_ranges.remove(&start);
+        if len > span {
+            let rest = start + span as u64;
+            self.free_ranges.insert(rest, len - span);
+            self.free_by_size.insert((len - span, rest));
+        }
+        Some(start)
+    }
+
+    /// Return a range to the free lists, coalescing with adjacent free ranges
+    /// and with the top of the heap
+    fn release_range(&mut self, mut start: Address, mut len: usize) {
+        if let Some((&prev, &prev_len)) =
+            self.free_ranges.range(..start).next_back()
+        {
+            if prev + prev_len as u64 == start {
+                self.free_ranges.remove(&prev);
+                self.free_by_size.remove(&(prev_len, prev));
+                start = prev;
+                len += prev_len;
+            }
+        }
+        let end = start + len as u64;
+        if let Some(next_len) = self.free_ranges.remove(&end) {
+            self.free_by_size.remove(&(next_len, end));
+            len += next_len;
+        }
+
+        if start + len as u64 == self.next_address {
+            self.next_address = start;
+        } else {
+            self.free_ranges.insert(start, len);
+            self.free_by_size.insert((len, start));
+        }
     }
 
-    /// Free a block of memory (mark as tombstone)
-    pub fn free(&mut self, addr: Address) -> Result<(), String> {
-        match self.allocations.get_mut(&addr) {
-            Some(block) if block.state == BlockState::Allocated => {
-                block.state = BlockState::Tombstone;
+    /// Free a block of memory, leaving a tombstone record behind
+    ///
+    /// `site` and `step` identify the `free` call for later diagnostics.
+    pub fn free(
+        &mut self,
+        addr: Address,
+        site: SourceLocation,
+        step: usize,
+    ) -> Result<(), String> {
+        let (base, generation) = untag(addr);
+        match self.blocks.get(&base) {
+            Some(block) if block.generation == generation => {
+                let size = block.size;
+                self.blocks.remove(&base);
+                self.tombstones.insert(
+                    base,
+                    FreedRange {
+                        end: base + size.max(1) as u64,
+                        tombstone: Tombstone {
+                            address: addr,
+                            size,
+                            freed_at: site,
+                            freed_step: step,
+                        },
+                    },
+                );
+                self.total_allocated_bytes -= size;
+                self.release_range(base, span_of(size));
                 Ok(())
             }
-            Some(block) if block.state == BlockState::Tombstone => {
+            // Freed, and its address since reused
+            Some(_) => {
                 Err(format!("Double free detected at address 0x{:x}", addr))
             }
-            None => Err(format!(
-                "Invalid free: address 0x{:x} was never allocated",
-                addr
-            )),
-            _ => unreachable!(),
+            None => match self.freed_block(base) {
+                Some(tombstone) => Err(format!(
+                    "Double free detected at address 0x{:x}{}",
+                    addr,
+                    Self::free_site_suffix(tombstone)
+                )),
+                None => Err(format!(
+                    "Invalid free: address 0x{:x} was never allocated",
+                    addr
+                )),
+            },
         }
     }
 
-    /// Get a heap block (returns error if tombstone or doesn't exist)
+    /// Describe where a tombstone was freed, for appending to error text
+    fn free_site_suffix(tombstone: &Tombstone) -> String {
+        format!(
+            " (freed at line {}, column {}, step {})",
+            tombstone.freed_at.line,
+            tombstone.freed_at.column,
+            tombstone.freed_step
+        )
+    }
+
+    /// Build the use-after-free error for `addr`, naming the free site when
+    /// the freed range has not been reused yet
+    fn use_after_free_error(&self, addr: Address) -> String {
+        let site = self
+            .tombstone_at(addr)
+            .map(Self::free_site_suffix)
+            .unwrap_or_default();
+        format!(
+            "Use-after-free: address 0x{:x} has been freed{}",
+            addr, site
+        )
+    }
+
+    /// Find the freed block record containing `addr`, if that byte has not
+    /// been reused
+    pub fn tombstone_at(&self, addr: Address) -> Option<&Tombstone> {
+        let untagged = untag(addr).0;
+        self.tombstones
+            .range(..=untagged)
+            .next_back()
+            .filter(|(_, range)| untagged < range.end)
+            .map(|(_, range)| &range.tombstone)
+    }
+
+    /// The record of a freed block whose base is the untagged `base`, if its
+    /// first byte has not been reused
+    fn freed_block(&self, base: Address) -> Option<&Tombstone> {
+        self.tombstones
+            .get(&base)
+            .map(|range| &range.tombstone)
+            .filter(|tombstone| untag(tombstone.address).0 == base)
+    }
+
+    /// Get a heap block (returns error if freed or doesn't exist)
     pub fn get_block(&self, addr: Address) -> Result<&HeapBlock, String> {
-        match self.allocations.get(&addr) {
-            Some(block) if block.state == BlockState::Allocated => Ok(block),
-            Some(_) => Err(format!(
-                "Use-after-free: address 0x{:x} has been freed",
-                addr
-            )),
+        let (base, generation) = untag(addr);
+        match self.blocks.get(&base) {
+            Some(block) if block.generation == generation => Ok(block),
+            Some(_) => Err(self.use_after_free_error(addr)),
+            None if self.freed_block(base).is_some() => {
+                Err(self.use_after_free_error(addr))
+            }
             None => Err(format!(
                 "Invalid pointer: address 0x{:x} not allocated",
                 addr
@@ -172,27 +732,151 @@ impl Heap {
         &mut self,
         addr: Address,
     ) -> Result<&mut HeapBlock, String> {
-        match self.allocations.get_mut(&addr) {
-            Some(block) if block.state == BlockState::Allocated => Ok(block),
-            Some(_) => Err(format!(
-                "Use-after-free: address 0x{:x} has been freed",
-                addr
-            )),
+        let (base, generation) = untag(addr);
+        match self.blocks.get(&base) {
+            Some(block) if block.generation == generation => {}
+            Some(_) => return Err(self.use_after_free_error(addr)),
+            None if self.freed_block(base).is_some() => {
+                return Err(self.use_after_free_error(addr))
+            }
+            None => {
+                return Err(format!(
+                    "Invalid pointer: address 0x{:x} not allocated",
+                    addr
+                ))
+            }
+        }
+        let block = self.blocks.get_mut(&base).ok_or_else(|| {
+            format!("Invalid pointer: address 0x{:x} not allocated", addr)
+        })?;
+        block.write_step = self.write_step;
+        Ok(block)
+    }
+
+    /// Find the live block containing `addr`, returning its untagged base and
+    /// the offset of `addr` within it. `op` names the access for error text.
+    fn locate(
+        &self,
+        addr: Address,
+        op: &str,
+    ) -> Result<(Address, usize), String> {
+        self.locate_in(addr, op, false)
+    }
+
+    /// Like [`Heap::locate`], but with `past_end` also resolves the
+    /// one-past-the-end address of a block to that block, for typing
+    /// pointers such as `p + n` that are compared or subtracted but not read
+    fn locate_in(
+        &self,
+        addr: Address,
+        op: &str,
+        past_end: bool,
+    ) -> Result<(Address, usize), String> {
+        let (untagged, generation) = untag(addr);
+        let live = self.blocks.range(..=untagged).next_back().filter(
+            |(&base, block)| {
+                let end = base + block.size as u64;
+                untagged < end || (past_end && untagged == end)
+            },
+        );
+        match live {
+            Some((&base, block)) if block.generation == generation => {
+                Ok((base, (untagged - base) as usize))
+            }
+            Some(_) => Err(self.use_after_free_error(addr)),
+            None if self.tombstone_at(addr).is_some() => {
+                Err(self.use_after_free_error(addr))
+            }
             None => Err(format!(
-                "Invalid pointer: address 0x{:x} not allocated",
-                addr
+                "Invalid {}: address 0x{:x} not in any allocated block",
+                op, addr
             )),
         }
     }
 
-    /// Get all allocations (for UI display, includes tombstones)
-    pub fn allocations(
+    /// Record that the block containing `addr` holds values of `elem_type`,
+    /// `stride` bytes apart.
+    ///
+    /// A block that already has a layout is only retyped through its base
+    /// address, so walking an interior pointer (`p + i`) never changes it;
+    /// a one-past-the-end pointer only types a block that has no layout yet.
+    /// Addresses outside any live block are ignored; the access that follows
+    /// reports the problem.
+    pub fn set_layout(
+        &mut self,
+        addr: Address,
+        elem_type: Type,
+        stride: usize,
+    ) {
+        if stride == 0 {
+            return;
+        }
+        let Ok((base, offset)) = self.locate_in(addr, "cast", true) else {
+            return;
+        };
+        if let Some(block) = self.blocks.get_mut(&base) {
+            let retype = match &block.layout {
+                None => true,
+                Some(layout) => offset == 0 && layout.elem_type != elem_type,
+            };
+            if retype {
+                block.layout =
+                    Some(Arc::new(BlockLayout { elem_type, stride }));
+            }
+        }
+    }
+
+    /// Type of the value at `addr`, derived from its block's layout.
+    ///
+    /// Works for any interior address, and for the address one past the end
+    /// of a block (typed as the block it ends, so `end - p` and `end - 1`
+    /// scale correctly): the offset is reduced modulo the stride and resolved
+    /// through struct fields and array elements. Returns `Ok(None)` for
+    /// untyped blocks or offsets that do not start a value, and `Err` if
+    /// `addr` is not inside a live block.
+    pub fn pointee_type<S: BuildHasher>(
         &self,
-    ) -> &std::collections::HashMap<Address, HeapBlock> {
-        &self.allocations
+        addr: Address,
+        struct_defs: &HashMap<String, StructDef, S>,
+    ) -> Result<Option<Type>, String> {
+        let (base, offset) = self.locate_in(addr, "read", true)?;
+        let layout =
+            match self.blocks.get(&base).and_then(|b| b.layout.as_ref()) {
+                Some(layout) => layout,
+                None => return Ok(None),
+            };
+        Ok(type_at_offset(
+            &layout.elem_type,
+            offset % layout.stride,
+            struct_defs,
+        ))
+    }
+
+    /// Iterate over live blocks in address order, paired with the (tagged)
+    /// pointer that `malloc` returned for them
+    pub fn blocks(&self) -> impl Iterator<Item = (Address, &HeapBlock)> {
+        self.blocks
+            .iter()
+            .map(|(&base, block)| (tag(base, block.generation), block))
+    }
+
+    /// Number of live blocks
+    pub fn block_count(&self) -> usize {
+        self.blocks.len()
+    }
+
+    /// Iterate over freed-block records in address order
+    pub fn tombstones(&self) -> impl Iterator<Item = &Tombstone> {
+        self.tombstones.values().map(|range| &range.tombstone)
     }
 
-    /// Get total allocated bytes
+    /// Number of freed ranges still tracked (a partly reused block counts
+    /// once per remaining piece)
+    pub fn tombstone_count(&self) -> usize {
+        self.tombstones.len()
+    }
+
+    /// Get total allocated bytes (live blocks only)
     pub fn total_allocated(&self) -> usize {
         self.total_allocated_bytes
     }
@@ -202,87 +886,154 @@ impl Heap {
         self.max_heap_size
     }
 
+    /// Bytes of address space currently in use, including freed holes that
+    /// have not yet been reused
+    pub fn address_space_used(&self) -> usize {
+        (self.next_address - HEAP_ADDRESS_START) as usize
+    }
+
+    /// Bytes of page storage materialized across all blocks
+    pub fn resident_bytes(&self) -> usize {
+        self.blocks.values().map(|b| b.resident_bytes()).sum()
+    }
+
+    /// Bytes of page storage created or copied since [`Heap::mark_snapshotted`]
+    /// was last called — i.e. what a snapshot taken now does not share with
+    /// the previous one.
+    pub fn bytes_since_snapshot(&self) -> usize {
+        self.blocks.values().map(|b| b.unshared_bytes).sum()
+    }
+
+    /// Bytes a snapshot of the heap taken now holds on its own: the pages
+    /// counted by [`Heap::bytes_since_snapshot`], plus the block, tombstone
+    /// and free-range indexes, which every clone copies
+    pub fn retained_bytes(&self) -> usize {
+        use std::mem::size_of;
+        size_of::<Heap>()
+            + self.bytes_since_snapshot()
+            + self.blocks.len() * size_of::<(Address, HeapBlock)>()
+            + self.tombstones.len() * size_of::<(Address, FreedRange)>()
+            + self.free_ranges.len() * size_of::<(Address, usize)>()
+            + self.free_by_size.len() * size_of::<(usize, Address)>()
+    }
+
+    /// Reset the unshared-byte counters after the heap has been captured in a
+    /// snapshot; further writes are charged to the next snapshot.
+    pub fn mark_snapshotted(&mut self) {
+        for block in self.blocks.values_mut() {
+            block.unshared_bytes = 0;
+        }
+    }
+
     /// Write a single byte to an address
     pub fn write_byte(
         &mut self,
         addr: Address,
         byte: u8,
     ) -> Result<(), String> {
-        // Find the block containing this address
-        let mut target_block_addr = None;
-        for (&block_addr, block) in &self.allocations {
-            if addr >= block_addr && addr < block_addr + block.size as u64 {
-                target_block_addr = Some(block_addr);
-                break;
-            }
+        let (base, offset) = self.locate(addr, "write")?;
+        if let Some(block) = self.blocks.get_mut(&base) {
+            block.write_step = self.write_step;
+            block.access.writes += 1;
+            block.write_byte(offset, byte);
         }
+        Ok(())
+    }
 
-        let block_addr = target_block_addr.ok_or_else(|| {
+    /// Read a single byte from an address, counting it as a load
+    pub fn read_byte(&mut self, addr: Address) -> Result<u8, String> {
+        let (block, offset) = self.load_at(addr)?;
+        block.byte_at(offset).ok_or_else(|| {
+            format!("Uninitialized read at address 0x{:x}", addr)
+        })
+    }
+
+    /// Resolve `addr` to its live block and the offset within it, so a whole
+    /// value can be read with a single lookup
+    pub fn block_at(
+        &self,
+        addr: Address,
+    ) -> Result<(&HeapBlock, usize), String> {
+        let (base, offset) = self.locate(addr, "read")?;
+        let block = self.blocks.get(&base).ok_or_else(|| {
             format!(
-                "Invalid write: address 0x{:x} not in any allocated block",
+                "Invalid read: address 0x{:x} not in any allocated block",
                 addr
             )
         })?;
-
-        let block = self.get_block_mut(block_addr)?;
-        let offset = (addr - block_addr) as usize;
-        block.data[offset] = byte;
-        block.init_map[offset] = true;
-        Ok(())
+        Ok((block, offset))
     }
 
-    /// Read a single byte from an address
-    pub fn read_byte(&self, addr: Address) -> Result<u8, String> {
-        // Find the block containing this address
-        let mut target_block_addr = None;
-        for (&block_addr, block) in &self.allocations {
-            if addr >= block_addr && addr < block_addr + block.size as u64 {
-                target_block_addr = Some(block_addr);
-                break;
-            }
-        }
-
-        let block_addr = target_block_addr.ok_or_else(|| {
+    /// Like [`Heap::block_at`], but counts a load from the block; used by the
+    /// interpreter when it reads a value
+    pub fn load_at(
+        &mut self,
+        addr: Address,
+    ) -> Result<(&HeapBlock, usize), String> {
+        let (base, offset) = self.locate(addr, "read")?;
+        let block = self.blocks.get_mut(&base).ok_or_else(|| {
             format!(
                 "Invalid read: address 0x{:x} not in any allocated block",
                 addr
             )
         })?;
+        block.access.reads += 1;
+        Ok((block, offset))
+    }
 
-        let block = self.get_block(block_addr)?;
-        let offset = (addr - block_addr) as usize;
-
-        if !block.init_map[offset] {
-            return Err(format!("Uninitialized read at address 0x{:x}", addr));
-        }
-
-        Ok(block.data[offset])
+    /// Mutable counterpart of [`Heap::block_at`]; counts a store to the block
+    pub fn block_at_mut(
+        &mut self,
+        addr: Address,
+    ) -> Result<(&mut HeapBlock, usize), String> {
+        let (base, offset) = self.locate(addr, "write")?;
+        let block = self.blocks.get_mut(&base).ok_or_else(|| {
+            format!(
+                "Invalid write: address 0x{:x} not in any allocated block",
+                addr
+            )
+        })?;
+        block.write_step = self.write_step;
+        block.access.writes += 1;
+        Ok((block, offset))
     }
 
-    /// Write multiple bytes starting at an address
+    /// Write multiple bytes starting at an address (within one block)
     pub fn write_bytes_at(
         &mut self,
         addr: Address,
         bytes: &[u8],
     ) -> Result<(), String> {
-        for (i, &byte) in bytes.iter().enumerate() {
-            self.write_byte(addr + i as u64, byte)?;
-        }
-        Ok(())
+        let (block, offset) = self.block_at_mut(addr)?;
+        block.write_bytes(offset, bytes)
     }
 
-    /// Read multiple bytes starting at an address
+    /// Read multiple initialized bytes starting at an address (within one block)
     pub fn read_bytes_at(
-        &self,
+        &mut self,
         addr: Address,
         size: usize,
     ) -> Result<Vec<u8>, String> {
-        let mut bytes = Vec::with_capacity(size);
-        for i in 0..size {
-            bytes.push(self.read_byte(addr + i as u64)?);
-        }
+        let (block, offset) = self.load_at(addr)?;
+        let mut bytes = vec![0; size];
+        block.read_initialized(offset, &mut bytes).map_err(|bad| {
+            Self::bad_read_error(addr + (bad - offset) as u64, bad < block.size)
+        })?;
         Ok(bytes)
     }
+
+    /// Error text for a failed batched read at `addr`: uninitialized if the
+    /// byte is inside the block, otherwise out of bounds
+    pub fn bad_read_error(addr: Address, in_block: bool) -> String {
+        if in_block {
+            format!("Uninitialized read at address 0x{:x}", addr)
+        } else {
+            format!(
+                "Invalid read: address 0x{:x} not in any allocated block",
+                addr
+            )
+        }
+    }
 }
 
 impl Default for Heap {
@@ -291,3 +1042,228 @@ impl Default for Heap {
         Self::new(10 * 1024 * 1024)
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const SITE: SourceLocation = SourceLocation { line: 1, column: 1 };
+
+    #[test]
+    fn test_untouched_pages_are_not_materialized() {
+        let mut heap = Heap::default();
+        let addr = heap.allocate(4 * 1024 * 1024).unwrap();
+        assert_eq!(heap.resident_bytes(), 0);
+
+        heap.write_byte(addr + 1_000_000, 7).unwrap();
+        assert_eq!(heap.read_byte(addr + 1_000_000), Ok(7));
+        assert!(heap.read_byte(addr).is_err());
+        assert!(heap.resident_bytes() <= 2 * HEAP_PAGE_SIZE);
+    }
+
+    #[test]
+    fn test_snapshot_clone_shares_pages_copy_on_write() {
+        let mut heap = Heap::default();
+        let addr = heap.allocate(HEAP_PAGE_SIZE * 4).unwrap();
+        heap.write_bytes_at(addr, &[1, 2, 3, 4]).unwrap();
+        heap.mark_snapshotted();
+
+        let mut snapshot = heap.clone();
+        assert_eq!(heap.bytes_since_snapshot(), 0);
+
+        heap.write_byte(addr, 9).unwrap();
+        assert_eq!(heap.read_byte(addr), Ok(9));
+        assert_eq!(snapshot.read_byte(addr), Ok(1));
+        assert!(heap.bytes_since_snapshot() > 0);
+        assert!(heap.bytes_since_snapshot() < HEAP_PAGE_SIZE * 4);
+    }
+
+    #[test]
+    fn test_write_bytes_spans_pages() {
+        let mut block = HeapBlock::new(HEAP_PAGE_SIZE + 10);
+        let bytes: Vec<u8> = (0..20).collect();
+        block.write_bytes(HEAP_PAGE_SIZE - 10, &bytes).unwrap();
+        assert!(block.is_initialized(HEAP_PAGE_SIZE - 10, 20));
+        assert!(!block.is_initialized(0, 1));
+        assert_eq!(
+            block.read_bytes(HEAP_PAGE_SIZE - 10, 20).as_deref(),
+            Some(&bytes[..])
+        );
+        assert!(block.write_bytes(HEAP_PAGE_SIZE, &[0; 11]).is_err());
+    }
+
+    #[test]
+    fn test_freed_ranges_are_reused_and_coalesced() {
+        let mut heap = Heap::default();
+        let a = heap.allocate(16).unwrap();
+        let b = heap.allocate(16).unwrap();
+        let c = heap.allocate(16).unwrap();
+        heap.free(a, SITE, 0).unwrap();
+        heap.free(b, SITE, 0).unwrap();
+
+        // The two freed neighbours coalesce into one 32-byte hole
+        let d = heap.allocate(32).unwrap();
+        assert_eq!(untag(d).0, untag(a).0);
+        heap.free(d, SITE, 0).unwrap();
+        heap.free(c, SITE, 0).unwrap();
+        assert_eq!(heap.address_space_used(), 0);
+        assert_eq!(heap.total_allocated(), 0);
+    }
+
+    #[test]
+    fn test_reused_address_gets_new_generation() {
+        let mut heap = Heap::default();
+        let old = heap.allocate(8).unwrap();
+        heap.write_byte(old, 1).unwrap();
+        heap.free(old, SITE, 0).unwrap();
+
+        let new = heap.allocate(8).unwrap();
+        assert_eq!(untag(new).0, untag(old).0);
+        assert_ne!(new, old);
+        heap.write_byte(new, 2).unwrap();
+
+        assert!(heap.read_byte(old).unwrap_err().contains("Use-after-free"));
+        assert!(heap.write_byte(old + 1, 0).is_err());
+        assert!(heap.free(old, SITE, 0).unwrap_err().contains("Double free"));
+        assert_eq!(heap.read_byte(new), Ok(2));
+    }
+
+    #[test]
+    fn test_partial_reuse_keeps_tail_of_freed_block() {
+        let mut heap = Heap::default();
+        let old = heap.allocate(64).unwrap();
+        let _guard = heap.allocate(8).unwrap();
+        heap.free(old, SITE, 5).unwrap();
+        let new = heap.allocate(16).unwrap();
+        assert_eq!(untag(new).0, untag(old).0);
+
+        let err = heap.read_byte(old + 32).unwrap_err();
+        assert!(err.starts_with("Use-after-free"), "{}", err);
+        assert!(err.contains("step 5"));
+        assert!(heap.tombstone_at(old + 8).is_none());
+        assert!(heap.free(old, SITE, 6).unwrap_err().contains("Double free"));
+
+        // A second reuse trims the remaining piece again
+        let next = heap.allocate(16).unwrap();
+        assert_eq!(untag(next).0, untag(new).0 + span_of(16) as u64);
+        assert!(heap.read_byte(old + 56).unwrap_err().contains("freed at"));
+        assert!(heap.tombstone_at(next + 4).is_none());
+    }
+
+    #[test]
+    fn test_free_drops_payload_and_keeps_record() {
+        let mut heap = Heap::default();
+        let a = heap.allocate(HEAP_PAGE_SIZE * 2).unwrap();
+        let b = heap.allocate(8).unwrap();
+        heap.write_bytes_at(a, &[1; 64]).unwrap();
+        let site = SourceLocation::new(7, 5);
+        heap.free(a, site, 42).unwrap();
+
+        assert_eq!(heap.block_count(), 1);
+        assert_eq!(heap.resident_bytes(), 0);
+        let tombstone = heap.tombstone_at(a + 10).unwrap();
+        assert_eq!(tombstone.freed_at, site);
+        assert_eq!(tombstone.freed_step, 42);
+
+        let err = heap.read_byte(a + 10).unwrap_err();
+        assert!(err.starts_with("Use-after-free"));
+        assert!(err.contains("freed at line 7"));
+        assert!(heap.free(a, SITE, 43).unwrap_err().contains("Double free"));
+        assert!(heap.get_block(b).is_ok());
+    }
+
+    #[test]
+    fn test_modification_stamps_track_written_pages() {
+        let mut heap = Heap::default();
+        heap.set_write_step(3);
+        let a = heap.allocate(HEAP_PAGE_SIZE * 2).unwrap();
+        heap.write_bytes_at(a, &[1; 4]).unwrap();
+
+        heap.set_write_step(7);
+        let page2 = a + HEAP_PAGE_SIZE as u64;
+        heap.write_bytes_at(page2, &[2; 4]).unwrap();
+
+        let block = heap.get_block(a).unwrap();
+        assert_eq!(block.modified_step, 7);
+        assert!(block.modified_since(0..4, 3));
+        assert!(!block.modified_since(0..4, 4));
+        assert!(block.modified_since(HEAP_PAGE_SIZE..HEAP_PAGE_SIZE + 1, 7));
+        assert!(!block.modified_since(0..HEAP_PAGE_SIZE, 8));
+
+        // A snapshot keeps the stamps it was taken with
+        let snapshot = heap.clone();
+        heap.set_write_step(9);
+        heap.write_bytes_at(a, &[3; 4]).unwrap();
+        assert!(!snapshot.get_block(a).unwrap().modified_since(0..4, 9));
+        assert!(heap.get_block(a).unwrap().modified_since(0..4, 9));
+    }
+
+    #[test]
+    fn test_layout_types_interior_addresses() {
+        use crate::parser::ast::Field;
+        use rustc_hash::FxHashMap;
+
+        let mut struct_defs: FxHashMap<String, StructDef> =
+            FxHashMap::default();
+        struct_defs.insert(
+            "Pair".to_string(),
+            StructDef {
+                name: "Pair".to_string(),
+                fields: vec![
+                    Field {
+                        name: "a".to_string(),
+                        field_type: Type::new(BaseType::Int),
+                    },
+                    Field {
+                        name: "b".to_string(),
+                        field_type: Type::new(BaseType::Char),
+                    },
+                ],
+            },
+        );
+        let pair = Type::new(BaseType::Struct("Pair".to_string()));
+
+        let mut heap = Heap::default();
+        let addr = heap.allocate(15).unwrap();
+        assert_eq!(heap.pointee_type(addr, &struct_defs), Ok(None));
+
+        heap.set_layout(addr + 5, pair.clone(), 5);
+        assert_eq!(heap.pointee_type(addr + 10, &struct_defs), Ok(Some(pair)));
+        assert_eq!(
+            heap.pointee_type(addr + 9, &struct_defs),
+            Ok(Some(Type::new(BaseType::Char)))
+        );
+        assert_eq!(heap.pointee_type(addr + 2, &struct_defs), Ok(None));
+
+        // Interior casts do not retype an already typed block
+        heap.set_layout(addr + 4, Type::new(BaseType::Char), 1);
+        assert_eq!(
+            heap.pointee_type(addr + 4, &struct_defs),
+            Ok(Some(Type::new(BaseType::Char)))
+        );
+        assert_eq!(heap.pointee_type(addr + 2, &struct_defs), Ok(None));
+    }
+
+    #[test]
+    fn test_batched_read_reports_first_bad_byte() {
+        let mut heap = Heap::default();
+        let addr = heap.allocate(HEAP_PAGE_SIZE + 8).unwrap();
+        let bytes: Vec<u8> = (0..16).collect();
+        heap.write_bytes_at(addr + HEAP_PAGE_SIZE as u64 - 8, &bytes)
+            .unwrap();
+        assert_eq!(
+            heap.read_bytes_at(addr + HEAP_PAGE_SIZE as u64 - 8, 16),
+            Ok(bytes)
+        );
+
+        let err = heap.read_bytes_at(addr + 2, 8).unwrap_err();
+        assert_eq!(
+            err,
+            format!("Uninitialized read at address 0x{:x}", addr + 2)
+        );
+        let err = heap
+            .read_bytes_at(addr + HEAP_PAGE_SIZE as u64 + 4, 8)
+            .unwrap_err();
+        assert!(err.starts_with("Invalid read"));
+    }
+}
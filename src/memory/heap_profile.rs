@@ -0,0 +1,234 @@
+//! Allocation-site heap profiler
+//!
+//! Every heap block remembers where it was allocated ([`AllocOrigin`]), and
+//! [`HeapProfile`] aggregates allocations and frees per source location:
+//! bytes currently live, the peak, total turnover and what is still
+//! allocated when the program ends. Bookkeeping is one hash-map update per
+//! `malloc`/`free`, so the profiler is always on.
+//!
+//! The profile describes the whole run, not the current history position;
+//! live bytes at a given step can be recovered from the heap itself via
+//! [`HeapProfile::live_at`].
+
+use super::heap::Heap;
+use crate::parser::ast::SourceLocation;
+use rustc_hash::FxHashMap;
+use std::fmt::Write;
+
+/// Where and when a heap block was allocated
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct AllocOrigin {
+    /// Location of the `malloc` call
+    pub site: SourceLocation,
+    /// Call-stack depth at the time of the allocation
+    pub call_depth: usize,
+    /// Execution step at which the block was allocated
+    pub step: usize,
+}
+
+/// Aggregated statistics for one allocation site
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct SiteStats {
+    pub site: SourceLocation,
+    pub allocations: usize,
+    pub frees: usize,
+    pub bytes_allocated: usize,
+    pub bytes_freed: usize,
+    pub live_bytes: usize,
+    pub peak_live_bytes: usize,
+    /// Deepest call stack this site was reached from
+    pub max_call_depth: usize,
+    /// Step of the first allocation from this site
+    pub first_step: usize,
+}
+
+/// Ordering for [`HeapProfile::top_sites`]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum SiteOrder {
+    /// Bytes currently allocated (leaked bytes once the program has ended)
+    LiveBytes,
+    /// Highest live byte count ever reached
+    PeakBytes,
+    /// Bytes allocated and later freed again
+    Churn,
+}
+
+impl SiteOrder {
+    /// Cycle to the next ordering (for the TUI)
+    pub fn next(self) -> Self {
+        match self {
+            SiteOrder::LiveBytes => SiteOrder::PeakBytes,
+            SiteOrder::PeakBytes => SiteOrder::Churn,
+            SiteOrder::Churn => SiteOrder::LiveBytes,
+        }
+    }
+
+    /// Short column label
+    pub fn label(self) -> &'static str {
+        match self {
+            SiteOrder::LiveBytes => "live",
+            SiteOrder::PeakBytes => "peak",
+            SiteOrder::Churn => "churn",
+        }
+    }
+
+    fn key(self, stats: &SiteStats) -> usize {
+        match self {
+            SiteOrder::LiveBytes => stats.live_bytes,
+            SiteOrder::PeakBytes => stats.peak_live_bytes,
+            SiteOrder::Churn => stats.bytes_freed,
+        }
+    }
+}
+
+/// Per-site allocation statistics for a run
+#[derive(Debug, Clone, Default)]
+pub struct HeapProfile {
+    sites: FxHashMap<SourceLocation, SiteStats>,
+}
+
+impl HeapProfile {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Record a successful allocation of `size` bytes
+    pub fn record_alloc(&mut self, origin: AllocOrigin, size: usize) {
+        let stats = self.sites.entry(origin.site).or_insert(SiteStats {
+            site: origin.site,
+            allocations: 0,
+            frees: 0,
+            bytes_allocated: 0,
+            bytes_freed: 0,
+            live_bytes: 0,
+            peak_live_bytes: 0,
+            max_call_depth: 0,
+            first_step: origin.step,
+        });
+        stats.allocations += 1;
+        stats.bytes_allocated += size;
+        stats.live_bytes += size;
+        stats.peak_live_bytes = stats.peak_live_bytes.max(stats.live_bytes);
+        stats.max_call_depth = stats.max_call_depth.max(origin.call_depth);
+    }
+
+    /// Record that a block of `size` bytes allocated at `site` was freed
+    pub fn record_free(&mut self, site: SourceLocation, size: usize) {
+        if let Some(stats) = self.sites.get_mut(&site) {
+            stats.frees += 1;
+            stats.bytes_freed += size;
+            stats.live_bytes = stats.live_bytes.saturating_sub(size);
+        }
+    }
+
+    /// Statistics for one site, if it has allocated anything
+    pub fn site(&self, site: SourceLocation) -> Option<&SiteStats> {
+        self.sites.get(&site)
+    }
+
+    /// All sites, in no particular order
+    pub fn sites(&self) -> impl Iterator<Item = &SiteStats> {
+        self.sites.values()
+    }
+
+    /// Number of distinct allocation sites seen
+    pub fn site_count(&self) -> usize {
+        self.sites.len()
+    }
+
+    /// Up to `limit` sites with a non-zero `order` key, largest first
+    pub fn top_sites(&self, order: SiteOrder, limit: usize) -> Vec<&SiteStats> {
+        let mut sites: Vec<&SiteStats> =
+            self.sites.values().filter(|s| order.key(s) > 0).collect();
+        sites.sort_by(|a, b| {
+            order.key(b).cmp(&order.key(a)).then(a.site.cmp(&b.site))
+        });
+        sites.truncate(limit);
+        sites
+    }
+
+    /// Bytes live per allocation site in `heap` (e.g. at the current step)
+    pub fn live_at(heap: &Heap) -> FxHashMap<SourceLocation, usize> {
+        let mut live = FxHashMap::default();
+        for (_, block) in heap.blocks() {
+            if let Some(origin) = block.origin {
+                *live.entry(origin.site).or_insert(0) += block.size;
+            }
+        }
+        live
+    }
+
+    /// Plain-text report of the top `limit` sites, for headless mode.
+    ///
+    /// `finished` selects whether remaining live bytes are reported as leaked.
+    pub fn report(&self, limit: usize, finished: bool) -> String {
+        let mut out = String::new();
+        let live_label = if finished { "leaked" } else { "live" };
+        let _ = writeln!(
+            out,
+            "Heap profile: {} allocation site(s)",
+            self.site_count()
+        );
+        if self.sites.is_empty() {
+            return out;
+        }
+        let _ = writeln!(
+            out,
+            "{:>9}  {:>7}  {:>10}  {:>10}  {:>10}  {:>10}  {:>5}",
+            "site", "allocs", "frees", live_label, "peak", "churn", "depth"
+        );
+        let mut sites: Vec<&SiteStats> = self.sites.values().collect();
+        sites.sort_by(|a, b| {
+            (b.live_bytes, b.peak_live_bytes)
+                .cmp(&(a.live_bytes, a.peak_live_bytes))
+                .then(a.site.cmp(&b.site))
+        });
+        for s in sites.into_iter().take(limit) {
+            let _ = writeln!(
+                out,
+                "{:>9}  {:>7}  {:>10}  {:>10}  {:>10}  {:>10}  {:>5}",
+                format!("{}:{}", s.site.line, s.site.column),
+                s.allocations,
+                s.frees,
+                s.live_bytes,
+                s.peak_live_bytes,
+                s.bytes_freed,
+                s.max_call_depth
+            );
+        }
+        out
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn origin(line: usize) -> AllocOrigin {
+        AllocOrigin {
+            site: SourceLocation::new(line, 1),
+            call_depth: 1,
+            step: 0,
+        }
+    }
+
+    #[test]
+    fn test_sites_track_live_peak_and_churn() {
+        let mut profile = HeapProfile::new();
+        profile.record_alloc(origin(3), 16);
+        profile.record_alloc(origin(3), 16);
+        profile.record_free(SourceLocation::new(3, 1), 16);
+        profile.record_alloc(origin(7), 100);
+
+        let site = profile.site(SourceLocation::new(3, 1)).unwrap();
+        assert_eq!(site.live_bytes, 16);
+        assert_eq!(site.peak_live_bytes, 32);
+        assert_eq!(site.bytes_freed, 16);
+
+        let top = profile.top_sites(SiteOrder::LiveBytes, 10);
+        assert_eq!(top[0].site.line, 7);
+        let churn = profile.top_sites(SiteOrder::Churn, 10);
+        assert_eq!(churn.len(), 1);
+        assert_eq!(churn[0].site.line, 3);
+    }
+}
@@ -4,6 +4,8 @@
 //! - [`value`]: Runtime value representation (Int, Char, Pointer, Struct, Array)
 //! - [`stack`]: Call stack with frames and local variables
 //! - [`heap`]: Heap allocation with malloc/free and tombstone tracking
+//! - [`heap_profile`]: Per-allocation-site heap statistics
+//! - [`access`]: Per-block and per-variable access counters (heatmap)
 //!
 //! # Type Sizes
 //!
@@ -23,7 +25,9 @@
 //! Helper functions [`pointer_add`], [`pointer_sub`], and [`pointer_diff`] handle
 //! this scaling automatically.
 
+pub mod access;
 pub mod heap;
+pub mod heap_profile;
 pub mod stack;
 pub mod value;
 
@@ -13,10 +13,32 @@
 //! - Structs: per-field tracking with [`InitState::PartiallyInitialized`]
 //!
 //! This enables detection of uninitialized reads even for partially-initialized structs.
+//!
+//! # Modification Stamps
+//!
+//! Every [`LocalVar`] records the history step of its last write, so the UI
+//! can highlight recently changed variables without diffing snapshots. The
+//! interpreter advances the stamp with [`Stack::set_write_step`]; declaring a
+//! variable or taking it through [`StackFrame::get_var_mut`] stamps it.
+//!
+//! # Access Counts
+//!
+//! Variables also count their reads and writes for the heatmap overlay (see
+//! [`super::access`]). [`StackFrame::get_var_mut`] counts a write; reads are
+//! counted explicitly with [`Stack::record_read`], since the interpreter
+//! also looks variables up for type checks that are not accesses.
+//!
+//! # Memory Accounting
+//!
+//! Snapshots clone the whole stack, so [`Stack::retained_bytes`] adds up
+//! everything a clone owns: frames, variable names, values, types and
+//! initialization maps.
 
+use super::access::AccessCounts;
 use super::value::Value;
-use crate::parser::ast::{SourceLocation, Type};
+use crate::parser::ast::{BaseType, SourceLocation, Type};
 use std::collections::HashMap;
+use std::mem::size_of;
 
 /// Initialization state tracking for variables
 #[derive(Debug, Clone, PartialEq)]
@@ -63,6 +85,21 @@ impl InitState {
         }
     }
 
+    /// Bytes owned by this state beyond its inline size
+    fn owned_bytes(&self) -> usize {
+        match self {
+            InitState::PartiallyInitialized(map) => map
+                .iter()
+                .map(|(name, state)| {
+                    size_of::<(String, InitState)>()
+                        + name.len()
+                        + state.owned_bytes()
+                })
+                .sum(),
+            _ => 0,
+        }
+    }
+
     /// Check if a specific field is initialized
     pub fn is_field_initialized(&self, field: &str) -> bool {
         match self {
@@ -83,6 +120,10 @@ pub struct LocalVar {
     pub is_const: bool,
     pub init_state: InitState,
     pub address: u64, // Virtual address for this variable
+    /// History step of the last write (or of the declaration)
+    pub modified_step: usize,
+    /// Reads and writes of this variable so far
+    pub access: AccessCounts,
 }
 
 impl LocalVar {
@@ -93,8 +134,28 @@ impl LocalVar {
             is_const: var_type.is_const,
             init_state,
             address,
+            modified_step: 0,
+            access: AccessCounts::default(),
         }
     }
+
+    /// Bytes this variable occupies, including its value, type and
+    /// initialization state
+    pub fn retained_bytes(&self) -> usize {
+        size_of::<LocalVar>() - size_of::<Value>()
+            + self.value.retained_bytes()
+            + type_owned_bytes(&self.var_type)
+            + self.init_state.owned_bytes()
+    }
+}
+
+/// Bytes a [`Type`] owns beyond its inline size
+fn type_owned_bytes(typ: &Type) -> usize {
+    let name = match &typ.base {
+        BaseType::Struct(name) => name.len(),
+        _ => 0,
+    };
+    name + typ.array_dims.len() * size_of::<Option<usize>>()
 }
 
 /// Stack frame for a function call
@@ -105,6 +166,8 @@ pub struct StackFrame {
     pub return_location: Option<SourceLocation>, // Where to return to
     pub insertion_order: Vec<String>, // Track order of variable declarations
     scope_stack: Vec<ScopeData>,
+    /// Step stamped on variables written through this frame
+    write_step: usize,
 }
 
 #[derive(Debug, Clone)]
@@ -124,9 +187,39 @@ impl StackFrame {
             return_location,
             insertion_order: Vec::new(),
             scope_stack: Vec::new(),
+            write_step: 0,
         }
     }
 
+    /// Bytes a clone of this frame owns
+    pub fn retained_bytes(&self) -> usize {
+        let name = |name: &String| size_of::<String>() + name.len();
+        let locals: usize = self
+            .locals
+            .iter()
+            .map(|(n, var)| name(n) + var.retained_bytes())
+            .sum();
+        let order: usize = self.insertion_order.iter().map(name).sum();
+        let scopes: usize = self
+            .scope_stack
+            .iter()
+            .map(|scope| {
+                size_of::<ScopeData>()
+                    + scope
+                        .shadowed
+                        .iter()
+                        .map(|(n, var)| name(n) + var.retained_bytes())
+                        .sum::<usize>()
+                    + scope.declared.iter().map(name).sum::<usize>()
+            })
+            .sum();
+        size_of::<StackFrame>()
+            + self.function_name.len()
+            + locals
+            + order
+            + scopes
+    }
+
     /// Enter a new scope
     pub fn push_scope(&mut self) {
         self.scope_stack.push(ScopeData {
@@ -163,7 +256,8 @@ impl StackFrame {
         init_state: InitState, // Passed by value
         address: u64,
     ) {
-        let new_var = LocalVar::new(var_type, init_state, address);
+        let mut new_var = LocalVar::new(var_type, init_state, address);
+        new_var.modified_step = self.write_step;
 
         // Handle scoping if we are in a nested scope
         if let Some(scope) = self.scope_stack.last_mut() {
@@ -190,9 +284,13 @@ impl StackFrame {
         self.locals.get(name)
     }
 
-    /// Get a mutable reference to a local variable
+    /// Get a mutable reference to a local variable, stamping it as written
+    /// at the current step and counting the write
     pub fn get_var_mut(&mut self, name: &str) -> Option<&mut LocalVar> {
-        self.locals.get_mut(name)
+        let var = self.locals.get_mut(name)?;
+        var.modified_step = self.write_step;
+        var.access.writes += 1;
+        Some(var)
     }
 }
 
@@ -200,11 +298,21 @@ impl StackFrame {
 #[derive(Debug, Clone)]
 pub struct Stack {
     frames: Vec<StackFrame>,
+    /// Step stamped on variables written from now on
+    write_step: usize,
 }
 
 impl Stack {
     pub fn new() -> Self {
-        Stack { frames: Vec::new() }
+        Stack {
+            frames: Vec::new(),
+            write_step: 0,
+        }
+    }
+
+    /// Set the history step that later writes are stamped with
+    pub fn set_write_step(&mut self, step: usize) {
+        self.write_step = step;
     }
 
     /// Push a new stack frame
@@ -213,8 +321,9 @@ impl Stack {
         function_name: String,
         return_location: Option<SourceLocation>,
     ) {
-        self.frames
-            .push(StackFrame::new(function_name, return_location));
+        let mut frame = StackFrame::new(function_name, return_location);
+        frame.write_step = self.write_step;
+        self.frames.push(frame);
     }
 
     /// Pop the top stack frame
@@ -229,7 +338,9 @@ impl Stack {
 
     /// Get a mutable reference to the current frame
     pub fn current_frame_mut(&mut self) -> Option<&mut StackFrame> {
-        self.frames.last_mut()
+        let frame = self.frames.last_mut()?;
+        frame.write_step = self.write_step;
+        Some(frame)
     }
 
     /// Get all frames (for UI display)
@@ -242,14 +353,37 @@ impl Stack {
         self.frames.len()
     }
 
+    /// Bytes a clone of this stack owns (see the module docs)
+    pub fn retained_bytes(&self) -> usize {
+        size_of::<Stack>()
+            + self
+                .frames
+                .iter()
+                .map(StackFrame::retained_bytes)
+                .sum::<usize>()
+    }
+
     /// Check if stack is empty
     pub fn is_empty(&self) -> bool {
         self.frames.is_empty()
     }
 
+    /// Count a read of variable `name` in frame `index`
+    pub fn record_read(&mut self, index: usize, name: &str) {
+        if let Some(var) = self
+            .frames
+            .get_mut(index)
+            .and_then(|frame| frame.locals.get_mut(name))
+        {
+            var.access.reads += 1;
+        }
+    }
+
     /// Get a mutable reference to a specific frame by index
     pub fn frame_mut(&mut self, index: usize) -> Option<&mut StackFrame> {
-        self.frames.get_mut(index)
+        let frame = self.frames.get_mut(index)?;
+        frame.write_step = self.write_step;
+        Some(frame)
     }
 }
 
@@ -37,6 +37,25 @@ pub enum Value {
 pub type Address = u64;
 
 impl Value {
+    /// Bytes this value occupies, including the fields and elements it owns
+    pub fn retained_bytes(&self) -> usize {
+        std::mem::size_of::<Value>()
+            + match self {
+                Value::Struct(fields) => fields
+                    .iter()
+                    .map(|(name, value)| {
+                        std::mem::size_of::<String>()
+                            + name.len()
+                            + value.retained_bytes()
+                    })
+                    .sum(),
+                Value::Array(items) => {
+                    items.iter().map(Value::retained_bytes).sum()
+                }
+                _ => 0,
+            }
+    }
+
     /// Check if this value is initialized
     pub fn is_initialized(&self) -> bool {
         !matches!(self, Value::Uninitialized)
@@ -3,12 +3,107 @@
 //! All types produced by the parser and consumed by the interpreter live here.
 //! [`AstNode`] is the central enum covering both statements and expressions;
 //! [`Program`] is the top-level container returned by the parse phase.
+//!
+//! Nodes live in a single [`Ast`] arena and refer to their children by
+//! [`NodeId`]. The parser pushes children before their parents, so each
+//! function's nodes are contiguous. The arena is built once and shared
+//! by the interpreter, and a `NodeId` is stable for the lifetime of the
+//! program, so side tables can be keyed by it.
+//!
+//! Nodes are stored in fixed-size chunks behind [`Arc`]s, so cloning an
+//! arena shares its nodes. Appending to a clone copies at most the last,
+//! partly filled chunk, which lets watch mode extend the previous parse's
+//! arena while the previous program is still running.
+
+use std::ops::Index;
+use std::sync::Arc;
+
+/// Nodes per arena chunk (a power of two, so indexing is a shift and a mask)
+const CHUNK_BITS: u32 = 12;
+const CHUNK_NODES: usize = 1 << CHUNK_BITS;
+
+/// Index of a node in the [`Ast`] arena
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub struct NodeId(u32);
+
+impl NodeId {
+    /// Position of the node in the arena
+    #[inline]
+    pub fn index(self) -> usize {
+        self.0 as usize
+    }
+
+    /// The id of the node at position `index` in the arena
+    #[inline]
+    pub fn from_index(index: usize) -> Self {
+        NodeId(index as u32)
+    }
+}
 
-/// Unique identifier for AST nodes, used for tracking execution position
-pub type NodeId = usize;
+/// Arena holding every node of a program
+#[derive(Debug, Clone, Default)]
+pub struct Ast {
+    /// Every chunk but the last holds exactly `CHUNK_NODES` nodes
+    chunks: Vec<Arc<Vec<AstNode>>>,
+    len: usize,
+}
+
+impl Ast {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Append a node, returning its id
+    pub fn push(&mut self, node: AstNode) -> NodeId {
+        let id = NodeId(self.len as u32);
+        if self.len.is_multiple_of(CHUNK_NODES) {
+            self.chunks.push(Arc::new(Vec::with_capacity(CHUNK_NODES)));
+        }
+        if let Some(chunk) = self.chunks.last_mut() {
+            Arc::make_mut(chunk).push(node);
+        }
+        self.len += 1;
+        id
+    }
+
+    /// Mutable access to a node; copies its chunk if a clone shares it
+    pub fn get_mut(&mut self, id: NodeId) -> &mut AstNode {
+        let i = id.index();
+        &mut Arc::make_mut(&mut self.chunks[i >> CHUNK_BITS])
+            [i & (CHUNK_NODES - 1)]
+    }
+
+    /// Number of nodes in the arena
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// All nodes with their ids, in allocation order
+    pub fn iter(&self) -> impl Iterator<Item = (NodeId, &AstNode)> {
+        self.chunks
+            .iter()
+            .flat_map(|chunk| chunk.iter())
+            .enumerate()
+            .map(|(i, node)| (NodeId(i as u32), node))
+    }
+}
+
+impl Index<NodeId> for Ast {
+    type Output = AstNode;
+
+    #[inline]
+    fn index(&self, id: NodeId) -> &AstNode {
+        let i = id.index();
+        &self.chunks[i >> CHUNK_BITS][i & (CHUNK_NODES - 1)]
+    }
+}
 
 /// Source location information for error reporting
-#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
 pub struct SourceLocation {
     pub line: usize,
     pub column: usize,
@@ -151,12 +246,12 @@ pub struct StructDef {
 #[derive(Debug, Clone)]
 pub enum CaseNode {
     Case {
-        value: Box<AstNode>,
-        statements: Vec<AstNode>,
+        value: NodeId,
+        statements: Vec<NodeId>,
         location: SourceLocation,
     },
     Default {
-        statements: Vec<AstNode>,
+        statements: Vec<NodeId>,
         location: SourceLocation,
     },
 }
@@ -168,7 +263,7 @@ pub enum AstNode {
     FunctionDef {
         name: String,
         params: Vec<Param>,
-        body: Vec<AstNode>,
+        body: Vec<NodeId>,
         return_type: Type,
         location: SourceLocation,
     },
@@ -182,49 +277,49 @@ pub enum AstNode {
     VarDecl {
         name: String,
         var_type: Type,
-        init: Option<Box<AstNode>>,
+        init: Option<NodeId>,
         location: SourceLocation,
     },
     Assignment {
-        lhs: Box<AstNode>,
-        rhs: Box<AstNode>,
+        lhs: NodeId,
+        rhs: NodeId,
         location: SourceLocation,
     },
     CompoundAssignment {
-        lhs: Box<AstNode>,
+        lhs: NodeId,
         op: BinOp,
-        rhs: Box<AstNode>,
+        rhs: NodeId,
         location: SourceLocation,
     },
     Return {
-        expr: Option<Box<AstNode>>,
+        expr: Option<NodeId>,
         location: SourceLocation,
     },
     If {
-        condition: Box<AstNode>,
-        then_branch: Vec<AstNode>,
-        else_branch: Option<Vec<AstNode>>,
+        condition: NodeId,
+        then_branch: Vec<NodeId>,
+        else_branch: Option<Vec<NodeId>>,
         location: SourceLocation,
     },
     While {
-        condition: Box<AstNode>,
-        body: Vec<AstNode>,
+        condition: NodeId,
+        body: Vec<NodeId>,
         location: SourceLocation,
     },
     DoWhile {
-        body: Vec<AstNode>,
-        condition: Box<AstNode>,
+        body: Vec<NodeId>,
+        condition: NodeId,
         location: SourceLocation,
     },
     For {
-        init: Option<Box<AstNode>>,
-        condition: Option<Box<AstNode>>,
-        increment: Option<Box<AstNode>>,
-        body: Vec<AstNode>,
+        init: Option<NodeId>,
+        condition: Option<NodeId>,
+        increment: Option<NodeId>,
+        body: Vec<NodeId>,
         location: SourceLocation,
     },
     Switch {
-        expr: Box<AstNode>,
+        expr: NodeId,
         cases: Vec<CaseNode>,
         location: SourceLocation,
     },
@@ -239,7 +334,7 @@ pub enum AstNode {
         location: SourceLocation,
     },
     Block {
-        statements: Vec<AstNode>,
+        statements: Vec<NodeId>,
         location: SourceLocation,
     },
     Label {
@@ -247,7 +342,7 @@ pub enum AstNode {
         location: SourceLocation,
     },
     ExpressionStatement {
-        expr: Box<AstNode>,
+        expr: NodeId,
         location: SourceLocation,
     },
 
@@ -261,44 +356,44 @@ pub enum AstNode {
     Variable(String, SourceLocation),
     BinaryOp {
         op: BinOp,
-        left: Box<AstNode>,
-        right: Box<AstNode>,
+        left: NodeId,
+        right: NodeId,
         location: SourceLocation,
     },
     UnaryOp {
         op: UnOp,
-        operand: Box<AstNode>,
+        operand: NodeId,
         location: SourceLocation,
     },
     TernaryOp {
-        condition: Box<AstNode>,
-        true_expr: Box<AstNode>,
-        false_expr: Box<AstNode>,
+        condition: NodeId,
+        true_expr: NodeId,
+        false_expr: NodeId,
         location: SourceLocation,
     },
     FunctionCall {
         name: String,
-        args: Vec<AstNode>,
+        args: Vec<NodeId>,
         location: SourceLocation,
     },
     ArrayAccess {
-        array: Box<AstNode>,
-        index: Box<AstNode>,
+        array: NodeId,
+        index: NodeId,
         location: SourceLocation,
     },
     MemberAccess {
-        object: Box<AstNode>,
+        object: NodeId,
         member: String,
         location: SourceLocation,
     },
     PointerMemberAccess {
-        object: Box<AstNode>,
+        object: NodeId,
         member: String,
         location: SourceLocation,
     },
     Cast {
         target_type: Type,
-        expr: Box<AstNode>,
+        expr: NodeId,
         location: SourceLocation,
     },
     SizeofType {
@@ -306,7 +401,7 @@ pub enum AstNode {
         location: SourceLocation,
     },
     SizeofExpr {
-        expr: Box<AstNode>,
+        expr: NodeId,
         location: SourceLocation,
     },
 }
@@ -349,12 +444,65 @@ impl AstNode {
             AstNode::SizeofExpr { location, .. } => location,
         }
     }
+
+    /// Move this node (and, for a `switch`, its case labels) `delta` lines
+    /// down, for reusing a parsed item that moved in the source
+    pub fn shift_lines(&mut self, delta: isize) {
+        let shift = |location: &mut SourceLocation| {
+            location.line = location.line.saturating_add_signed(delta);
+        };
+        if let AstNode::Switch { cases, .. } = self {
+            for case in cases {
+                match case {
+                    CaseNode::Case { location, .. }
+                    | CaseNode::Default { location, .. } => shift(location),
+                }
+            }
+        }
+        let location = match self {
+            AstNode::FunctionDef { location, .. }
+            | AstNode::StructDef { location, .. }
+            | AstNode::VarDecl { location, .. }
+            | AstNode::Assignment { location, .. }
+            | AstNode::CompoundAssignment { location, .. }
+            | AstNode::Return { location, .. }
+            | AstNode::If { location, .. }
+            | AstNode::While { location, .. }
+            | AstNode::DoWhile { location, .. }
+            | AstNode::For { location, .. }
+            | AstNode::Switch { location, .. }
+            | AstNode::Break { location }
+            | AstNode::Continue { location }
+            | AstNode::Goto { location, .. }
+            | AstNode::Block { location, .. }
+            | AstNode::Label { location, .. }
+            | AstNode::ExpressionStatement { location, .. }
+            | AstNode::Null { location }
+            | AstNode::BinaryOp { location, .. }
+            | AstNode::UnaryOp { location, .. }
+            | AstNode::TernaryOp { location, .. }
+            | AstNode::FunctionCall { location, .. }
+            | AstNode::ArrayAccess { location, .. }
+            | AstNode::MemberAccess { location, .. }
+            | AstNode::PointerMemberAccess { location, .. }
+            | AstNode::Cast { location, .. }
+            | AstNode::SizeofType { location, .. }
+            | AstNode::SizeofExpr { location, .. } => location,
+            AstNode::IntLiteral(_, location)
+            | AstNode::CharLiteral(_, location)
+            | AstNode::StringLiteral(_, location)
+            | AstNode::Variable(_, location) => location,
+        };
+        shift(location);
+    }
 }
 
 /// Top-level program structure
 #[derive(Debug, Clone, Default)]
 pub struct Program {
-    pub nodes: Vec<AstNode>, // All top-level declarations (FunctionDef, StructDef)
+    /// Arena owning every node of the program
+    pub ast: Ast,
+    pub nodes: Vec<NodeId>, // All top-level declarations (FunctionDef, StructDef)
 }
 
 impl Program {
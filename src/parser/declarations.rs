@@ -19,33 +19,33 @@
 //! All parsing methods are implemented as `pub(crate)` methods on the [`Parser`] struct.
 
 use crate::parser::ast::*;
-use crate::parser::lexer::Token;
+use crate::parser::lexer::TokenKind;
 use crate::parser::parse::{ParseError, Parser};
 
-impl Parser {
+impl Parser<'_> {
     /// Parse a top-level declaration (function or struct definition)
     pub(crate) fn parse_top_level_declaration(
         &mut self,
-    ) -> Result<AstNode, ParseError> {
+    ) -> Result<NodeId, ParseError> {
         // Check for struct definition vs function with struct return type
         // We need to distinguish:
         //   struct Name { ... };           <- struct definition
         //   struct Name func_name(...) ... <- function with struct return type
-        if self.check(&Token::Struct(self.current_location())) {
+        if self.check(TokenKind::Struct) {
             // Look ahead to determine which it is
             // Save position to restore if needed
             let saved_pos = self.position;
             self.advance(); // consume 'struct'
 
-            if matches!(self.peek_token(), Token::Ident(_, _)) {
+            if self.check(TokenKind::Ident) {
                 self.advance(); // consume struct name
 
                 // Check what follows the struct name
-                if self.check(&Token::LBrace(self.current_location())) {
+                if self.check(TokenKind::LBrace) {
                     // It's a struct definition: struct Name { ... }
                     // Restore position and parse as struct def
                     self.position = saved_pos;
-                    self.match_token(&Token::Struct(self.current_location())); // consume 'struct' again
+                    self.match_token(TokenKind::Struct); // consume 'struct' again
                     return self.parse_struct_definition();
                 } else {
                     // It's a function with struct return type: struct Name func_name(...)
@@ -66,7 +66,7 @@ impl Parser {
     /// Parse struct definition: struct Name { fields };
     pub(crate) fn parse_struct_definition(
         &mut self,
-    ) -> Result<AstNode, ParseError> {
+    ) -> Result<NodeId, ParseError> {
         let loc = self.previous_location();
 
         let name = self.expect_identifier()?;
@@ -74,7 +74,7 @@ impl Parser {
         self.expect_lbrace("after struct name")?;
 
         let mut fields = Vec::new();
-        while !self.check(&Token::RBrace(self.current_location())) {
+        while !self.check(TokenKind::RBrace) {
             let field_type = self.parse_type()?;
             let field_name = self.expect_identifier()?;
             self.expect_semicolon("after struct field")?;
@@ -88,17 +88,17 @@ impl Parser {
         self.expect_rbrace("after struct fields")?;
         self.expect_semicolon("after struct definition")?;
 
-        Ok(AstNode::StructDef {
+        Ok(self.alloc(AstNode::StructDef {
             name,
             fields,
             location: loc,
-        })
+        }))
     }
 
     /// Parse function definition: type name(params) { body }
     pub(crate) fn parse_function_definition(
         &mut self,
-    ) -> Result<AstNode, ParseError> {
+    ) -> Result<NodeId, ParseError> {
         let return_type = self.parse_type()?;
         let name = self.expect_identifier()?;
         let loc = self.previous_location();
@@ -114,13 +114,13 @@ impl Parser {
 
         self.expect_rbrace("after function body")?;
 
-        Ok(AstNode::FunctionDef {
+        Ok(self.alloc(AstNode::FunctionDef {
             name,
             params,
             return_type,
             body,
             location: loc,
-        })
+        }))
     }
 
     /// Parse parameter list: (type name, type name, ...)
@@ -129,12 +129,12 @@ impl Parser {
     ) -> Result<Vec<Param>, ParseError> {
         let mut params = Vec::new();
 
-        if self.check(&Token::RParen(self.current_location())) {
+        if self.check(TokenKind::RParen) {
             return Ok(params);
         }
 
         // Special case: (void) means no parameters in C
-        if self.check(&Token::Void(self.current_location())) {
+        if self.check(TokenKind::Void) {
             self.advance(); // consume 'void'
             return Ok(params);
         }
@@ -147,7 +147,7 @@ impl Parser {
                 param_type,
             });
 
-            if !self.match_token(&Token::Comma(self.current_location())) {
+            if !self.match_token(TokenKind::Comma) {
                 break;
             }
         }
@@ -158,18 +158,18 @@ impl Parser {
     /// Parse type: `[const]` base\_type `[*]*` `[[size]]*`
     pub(crate) fn parse_type(&mut self) -> Result<Type, ParseError> {
         let mut is_const = false;
-        if self.match_token(&Token::Const(self.current_location())) {
+        if self.match_token(TokenKind::Const) {
             is_const = true;
         }
 
         // Parse base type
-        let base = if self.match_token(&Token::Int(self.current_location())) {
+        let base = if self.match_token(TokenKind::Int) {
             BaseType::Int
-        } else if self.match_token(&Token::Char(self.current_location())) {
+        } else if self.match_token(TokenKind::Char) {
             BaseType::Char
-        } else if self.match_token(&Token::Void(self.current_location())) {
+        } else if self.match_token(TokenKind::Void) {
             BaseType::Void
-        } else if self.match_token(&Token::Struct(self.current_location())) {
+        } else if self.match_token(TokenKind::Struct) {
             let name = self.expect_identifier()?;
             BaseType::Struct(name)
         } else {
@@ -180,13 +180,13 @@ impl Parser {
         };
 
         let mut pointer_depth = 0;
-        while self.match_token(&Token::Star(self.current_location())) {
+        while self.match_token(TokenKind::Star) {
             pointer_depth += 1;
         }
 
         let mut array_dims = Vec::new();
-        while self.match_token(&Token::LBracket(self.current_location())) {
-            if self.check(&Token::RBracket(self.current_location())) {
+        while self.match_token(TokenKind::LBracket) {
+            if self.check(TokenKind::RBracket) {
                 // Unsized array []
                 array_dims.push(None);
                 self.advance();
@@ -194,7 +194,7 @@ impl Parser {
                 // Sized array [N]
                 let size_expr = self.parse_expression()?;
                 // For now, require compile-time constant (int literal)
-                if let AstNode::IntLiteral(n, _) = size_expr {
+                if let AstNode::IntLiteral(n, _) = self.ast[size_expr] {
                     array_dims.push(Some(n as usize));
                 } else {
                     return Err(ParseError {
@@ -204,7 +204,7 @@ impl Parser {
                     });
                 }
                 self.expect_token(
-                    &Token::RBracket(self.current_location()),
+                    TokenKind::RBracket,
                     "Expected ']' after array size",
                 )?;
             }
@@ -22,77 +22,77 @@
 //! All parsing methods are implemented as `pub(crate)` methods on the [`Parser`] struct.
 
 use crate::parser::ast::*;
-use crate::parser::lexer::Token;
+use crate::parser::lexer::{Token, TokenKind};
 use crate::parser::parse::{ParseError, Parser};
 
-impl Parser {
+impl Parser<'_> {
     /// Parse expression (top-level entry point)
-    pub(crate) fn parse_expression(&mut self) -> Result<AstNode, ParseError> {
+    pub(crate) fn parse_expression(&mut self) -> Result<NodeId, ParseError> {
         self.parse_assignment()
     }
 
     /// Parse assignment or ternary (right-associative)
-    fn parse_assignment(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_assignment(&mut self) -> Result<NodeId, ParseError> {
         let expr = self.parse_ternary()?;
 
         // Check for assignment operators
         let loc = self.current_location();
-        if self.match_token(&Token::Eq(loc)) {
-            let rhs = Box::new(self.parse_assignment()?);
-            return Ok(AstNode::Assignment {
-                lhs: Box::new(expr),
+        if self.match_token(TokenKind::Eq) {
+            let rhs = self.parse_assignment()?;
+            return Ok(self.alloc(AstNode::Assignment {
+                lhs: expr,
                 rhs,
                 location: loc,
-            });
+            }));
         }
 
         // Compound assignments
-        let compound_op = if self.match_token(&Token::PlusEq(loc)) {
+        let compound_op = if self.match_token(TokenKind::PlusEq) {
             Some(BinOp::AddAssign)
-        } else if self.match_token(&Token::MinusEq(loc)) {
+        } else if self.match_token(TokenKind::MinusEq) {
             Some(BinOp::SubAssign)
-        } else if self.match_token(&Token::StarEq(loc)) {
+        } else if self.match_token(TokenKind::StarEq) {
             Some(BinOp::MulAssign)
-        } else if self.match_token(&Token::SlashEq(loc)) {
+        } else if self.match_token(TokenKind::SlashEq) {
             Some(BinOp::DivAssign)
-        } else if self.match_token(&Token::PercentEq(loc)) {
+        } else if self.match_token(TokenKind::PercentEq) {
             Some(BinOp::ModAssign)
         } else {
             None
         };
 
         if let Some(op) = compound_op {
-            let rhs = Box::new(self.parse_assignment()?);
-            return Ok(AstNode::CompoundAssignment {
-                lhs: Box::new(expr),
+            let rhs = self.parse_assignment()?;
+            return Ok(self.alloc(AstNode::CompoundAssignment {
+                lhs: expr,
                 op,
                 rhs,
                 location: loc,
-            });
+            }));
         }
 
         Ok(expr)
     }
 
     /// Parse ternary: condition ? true_expr : false_expr
-    fn parse_ternary(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_ternary(&mut self) -> Result<NodeId, ParseError> {
         let expr = self.parse_logical_or()?;
 
-        if self.match_token(&Token::Question(self.current_location())) {
+        if self.match_token(TokenKind::Question) {
             let loc = self.previous_location();
-            let true_expr = Box::new(self.parse_expression()?);
+            let true_expr = self.parse_expression()?;
             self.expect_token(
-                &Token::Colon(self.current_location()),
+                TokenKind::Colon,
                 "Expected ':' in ternary expression",
             )?;
-            let false_expr = Box::new(self.parse_ternary()?);
+            let false_expr = self.parse_ternary()?;
 
-            return Ok(AstNode::TernaryOp {
-                condition: Box::new(expr),
+            return Ok(self.alloc(AstNode::TernaryOp {
+                condition: expr,
                 true_expr,
                 false_expr,
                 location: loc,
-            });
+            }));
         }
 
         Ok(expr)
@@ -101,10 +101,10 @@ impl Parser {
     fn parse_left_assoc_binary<F>(
         &mut self,
         next_level_parser: F,
-        operators: &[(Token, BinOp)],
-    ) -> Result<AstNode, ParseError>
+        operators: &[(TokenKind, BinOp)],
+    ) -> Result<NodeId, ParseError>
     where
-        F: Fn(&mut Self) -> Result<AstNode, ParseError>,
+        F: Fn(&mut Self) -> Result<NodeId, ParseError>,
     {
         let mut left = next_level_parser(self)?;
 
@@ -112,21 +112,21 @@ impl Parser {
             let loc = self.current_location();
             let mut matched_op = None;
 
-            for (token, op) in operators {
-                if self.match_token(token) {
+            for (kind, op) in operators {
+                if self.match_token(*kind) {
                     matched_op = Some(op.clone());
                     break;
                 }
             }
 
             if let Some(op) = matched_op {
-                let right = Box::new(next_level_parser(self)?);
-                left = AstNode::BinaryOp {
+                let right = next_level_parser(self)?;
+                left = self.alloc(AstNode::BinaryOp {
                     op,
-                    left: Box::new(left),
+                    left,
                     right,
                     location: loc,
-                };
+                });
             } else {
                 break;
             }
@@ -136,242 +136,205 @@ impl Parser {
     }
 
     /// Parse logical OR (||)
-    fn parse_logical_or(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_logical_or(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_logical_and,
-            &[(Token::OrOr(dummy_loc), BinOp::Or)],
+            &[(TokenKind::OrOr, BinOp::Or)],
         )
     }
 
     /// Parse logical AND (&&)
-    fn parse_logical_and(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_logical_and(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_bitwise_or,
-            &[(Token::AndAnd(dummy_loc), BinOp::And)],
+            &[(TokenKind::AndAnd, BinOp::And)],
         )
     }
 
     /// Parse bitwise OR (|)
-    fn parse_bitwise_or(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_bitwise_or(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_bitwise_xor,
-            &[(Token::Pipe(dummy_loc), BinOp::BitOr)],
+            &[(TokenKind::Pipe, BinOp::BitOr)],
         )
     }
 
     /// Parse bitwise XOR (^)
-    fn parse_bitwise_xor(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_bitwise_xor(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_bitwise_and,
-            &[(Token::Caret(dummy_loc), BinOp::BitXor)],
+            &[(TokenKind::Caret, BinOp::BitXor)],
         )
     }
 
     /// Parse bitwise AND (&)
-    fn parse_bitwise_and(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_bitwise_and(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_equality,
-            &[(Token::Amp(dummy_loc), BinOp::BitAnd)],
+            &[(TokenKind::Amp, BinOp::BitAnd)],
         )
     }
 
     /// Parse equality (== !=)
-    fn parse_equality(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_equality(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_relational,
-            &[
-                (Token::EqEq(dummy_loc), BinOp::Eq),
-                (Token::NotEq(dummy_loc), BinOp::Ne),
-            ],
+            &[(TokenKind::EqEq, BinOp::Eq), (TokenKind::NotEq, BinOp::Ne)],
         )
     }
 
     /// Parse relational (< <= > >=)
-    fn parse_relational(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_relational(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_shift,
             &[
-                (Token::Lt(dummy_loc), BinOp::Lt),
-                (Token::Le(dummy_loc), BinOp::Le),
-                (Token::Gt(dummy_loc), BinOp::Gt),
-                (Token::Ge(dummy_loc), BinOp::Ge),
+                (TokenKind::Lt, BinOp::Lt),
+                (TokenKind::Le, BinOp::Le),
+                (TokenKind::Gt, BinOp::Gt),
+                (TokenKind::Ge, BinOp::Ge),
             ],
         )
     }
 
     /// Parse bitwise shift (<< >>)
-    fn parse_shift(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_shift(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_additive,
             &[
-                (Token::LtLt(dummy_loc), BinOp::BitShl),
-                (Token::GtGt(dummy_loc), BinOp::BitShr),
+                (TokenKind::LtLt, BinOp::BitShl),
+                (TokenKind::GtGt, BinOp::BitShr),
             ],
         )
     }
 
     /// Parse additive (+ -)
-    fn parse_additive(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_additive(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_multiplicative,
             &[
-                (Token::Plus(dummy_loc), BinOp::Add),
-                (Token::Minus(dummy_loc), BinOp::Sub),
+                (TokenKind::Plus, BinOp::Add),
+                (TokenKind::Minus, BinOp::Sub),
             ],
         )
     }
 
     /// Parse multiplicative (* / %)
-    fn parse_multiplicative(&mut self) -> Result<AstNode, ParseError> {
-        let dummy_loc = SourceLocation::new(0, 0);
+    fn parse_multiplicative(&mut self) -> Result<NodeId, ParseError> {
         self.parse_left_assoc_binary(
             Self::parse_cast,
             &[
-                (Token::Star(dummy_loc), BinOp::Mul),
-                (Token::Slash(dummy_loc), BinOp::Div),
-                (Token::Percent(dummy_loc), BinOp::Mod),
+                (TokenKind::Star, BinOp::Mul),
+                (TokenKind::Slash, BinOp::Div),
+                (TokenKind::Percent, BinOp::Mod),
             ],
         )
     }
 
     /// Parse cast: (Type*)expr
-    fn parse_cast(&mut self) -> Result<AstNode, ParseError> {
-        // Check for cast: ( followed by type keyword
-        if self.check(&Token::LParen(self.current_location())) {
-            let saved_pos = self.position;
-
-            // Try parsing as cast
-            if self.try_parse_cast().is_ok() {
-                // Restore and actually parse it
-                self.position = saved_pos;
-                self.advance(); // consume '('
-                let target_type = self.parse_type()?;
-                self.expect_token(
-                    &Token::RParen(self.current_location()),
-                    "Expected ')' after cast type",
-                )?;
-                let loc = self.previous_location();
-                let expr = Box::new(self.parse_cast()?);
+    fn parse_cast(&mut self) -> Result<NodeId, ParseError> {
+        // A cast is '(' followed by a type keyword; there are no typedefs, so
+        // one token of lookahead decides it without backtracking
+        let is_cast = self.check(TokenKind::LParen)
+            && self
+                .peek_ahead(1)
+                .is_some_and(|t| t.kind().is_type_keyword());
+
+        if is_cast {
+            self.advance(); // consume '('
+            let target_type = self.parse_type()?;
+            self.expect_token(
+                TokenKind::RParen,
+                "Expected ')' after cast type",
+            )?;
+            let loc = self.previous_location();
+            let expr = self.parse_cast()?;
 
-                return Ok(AstNode::Cast {
-                    target_type,
-                    expr,
-                    location: loc,
-                });
-            } else {
-                self.position = saved_pos;
-            }
+            return Ok(self.alloc(AstNode::Cast {
+                target_type,
+                expr,
+                location: loc,
+            }));
         }
 
         self.parse_unary()
     }
 
-    /// Try to parse cast (used for lookahead)
-    fn try_parse_cast(&mut self) -> Result<(), ParseError> {
-        if !self.match_token(&Token::LParen(self.current_location())) {
-            return Err(ParseError {
-                message: "Not a cast".to_string(),
-                location: self.current_location(),
-            });
-        }
-
-        self.parse_type()?;
-
-        if !self.match_token(&Token::RParen(self.current_location())) {
-            return Err(ParseError {
-                message: "Not a cast".to_string(),
-                location: self.current_location(),
-            });
-        }
-
-        Ok(())
-    }
-
     /// Parse unary (! ~ - + & * ++ -- sizeof)
-    fn parse_unary(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_unary(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.current_location();
 
         // Prefix operators
-        if self.match_token(&Token::Bang(loc)) {
-            let operand = Box::new(self.parse_unary()?);
-            return Ok(AstNode::UnaryOp {
+        if self.match_token(TokenKind::Bang) {
+            let operand = self.parse_unary()?;
+            return Ok(self.alloc(AstNode::UnaryOp {
                 op: UnOp::Not,
                 operand,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::Tilde(loc)) {
-            let operand = Box::new(self.parse_unary()?);
-            return Ok(AstNode::UnaryOp {
+        if self.match_token(TokenKind::Tilde) {
+            let operand = self.parse_unary()?;
+            return Ok(self.alloc(AstNode::UnaryOp {
                 op: UnOp::BitNot,
                 operand,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::Minus(loc)) {
-            let operand = Box::new(self.parse_unary()?);
-            return Ok(AstNode::UnaryOp {
+        if self.match_token(TokenKind::Minus) {
+            let operand = self.parse_unary()?;
+            return Ok(self.alloc(AstNode::UnaryOp {
                 op: UnOp::Neg,
                 operand,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::Plus(loc)) {
+        if self.match_token(TokenKind::Plus) {
             // Unary plus: just return the operand
             return self.parse_unary();
         }
 
-        if self.match_token(&Token::Amp(loc)) {
-            let operand = Box::new(self.parse_unary()?);
-            return Ok(AstNode::UnaryOp {
+        if self.match_token(TokenKind::Amp) {
+            let operand = self.parse_unary()?;
+            return Ok(self.alloc(AstNode::UnaryOp {
                 op: UnOp::AddrOf,
                 operand,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::Star(loc)) {
-            let operand = Box::new(self.parse_unary()?);
-            return Ok(AstNode::UnaryOp {
+        if self.match_token(TokenKind::Star) {
+            let operand = self.parse_unary()?;
+            return Ok(self.alloc(AstNode::UnaryOp {
                 op: UnOp::Deref,
                 operand,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::PlusPlus(loc)) {
-            let operand = Box::new(self.parse_unary()?);
-            return Ok(AstNode::UnaryOp {
+        if self.match_token(TokenKind::PlusPlus) {
+            let operand = self.parse_unary()?;
+            return Ok(self.alloc(AstNode::UnaryOp {
                 op: UnOp::PreInc,
                 operand,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::MinusMinus(loc)) {
-            let operand = Box::new(self.parse_unary()?);
-            return Ok(AstNode::UnaryOp {
+        if self.match_token(TokenKind::MinusMinus) {
+            let operand = self.parse_unary()?;
+            return Ok(self.alloc(AstNode::UnaryOp {
                 op: UnOp::PreDec,
                 operand,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::Sizeof(loc)) {
+        if self.match_token(TokenKind::Sizeof) {
             self.expect_token(
-                &Token::LParen(self.current_location()),
+                TokenKind::LParen,
                 "Expected '(' after 'sizeof'",
             )?;
 
@@ -379,86 +342,86 @@ impl Parser {
             let saved_pos = self.position;
             if self.is_type_keyword() {
                 let target_type = self.parse_type()?;
-                if self.match_token(&Token::RParen(self.current_location())) {
-                    return Ok(AstNode::SizeofType {
+                if self.match_token(TokenKind::RParen) {
+                    return Ok(self.alloc(AstNode::SizeofType {
                         target_type,
                         location: loc,
-                    });
+                    }));
                 }
             }
 
             // Otherwise, parse as expression
             self.position = saved_pos;
-            let expr = Box::new(self.parse_expression()?);
+            let expr = self.parse_expression()?;
             self.expect_token(
-                &Token::RParen(self.current_location()),
+                TokenKind::RParen,
                 "Expected ')' after sizeof expression",
             )?;
 
-            return Ok(AstNode::SizeofExpr {
+            return Ok(self.alloc(AstNode::SizeofExpr {
                 expr,
                 location: loc,
-            });
+            }));
         }
 
         self.parse_postfix()
     }
 
     /// Parse postfix (++ -- [] . -> ())
-    fn parse_postfix(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_postfix(&mut self) -> Result<NodeId, ParseError> {
         let mut expr = self.parse_primary()?;
 
         loop {
             let loc = self.current_location();
 
-            if self.match_token(&Token::PlusPlus(loc)) {
-                expr = AstNode::UnaryOp {
+            if self.match_token(TokenKind::PlusPlus) {
+                expr = self.alloc(AstNode::UnaryOp {
                     op: UnOp::PostInc,
-                    operand: Box::new(expr),
+                    operand: expr,
                     location: loc,
-                };
-            } else if self.match_token(&Token::MinusMinus(loc)) {
-                expr = AstNode::UnaryOp {
+                });
+            } else if self.match_token(TokenKind::MinusMinus) {
+                expr = self.alloc(AstNode::UnaryOp {
                     op: UnOp::PostDec,
-                    operand: Box::new(expr),
+                    operand: expr,
                     location: loc,
-                };
-            } else if self.match_token(&Token::LBracket(loc)) {
-                let index = Box::new(self.parse_expression()?);
+                });
+            } else if self.match_token(TokenKind::LBracket) {
+                let index = self.parse_expression()?;
                 self.expect_token(
-                    &Token::RBracket(self.current_location()),
+                    TokenKind::RBracket,
                     "Expected ']' after array index",
                 )?;
-                expr = AstNode::ArrayAccess {
-                    array: Box::new(expr),
+                expr = self.alloc(AstNode::ArrayAccess {
+                    array: expr,
                     index,
                     location: loc,
-                };
-            } else if self.match_token(&Token::Dot(loc)) {
+                });
+            } else if self.match_token(TokenKind::Dot) {
                 let member = self.expect_identifier()?;
-                expr = AstNode::MemberAccess {
-                    object: Box::new(expr),
+                expr = self.alloc(AstNode::MemberAccess {
+                    object: expr,
                     member,
                     location: loc,
-                };
-            } else if self.match_token(&Token::Arrow(loc)) {
+                });
+            } else if self.match_token(TokenKind::Arrow) {
                 let member = self.expect_identifier()?;
-                expr = AstNode::PointerMemberAccess {
-                    object: Box::new(expr),
+                expr = self.alloc(AstNode::PointerMemberAccess {
+                    object: expr,
                     member,
                     location: loc,
-                };
-            } else if self.match_token(&Token::LParen(loc)) {
+                });
+            } else if self.match_token(TokenKind::LParen) {
                 // Function call
                 let args = self.parse_argument_list()?;
                 self.expect_token(
-                    &Token::RParen(self.current_location()),
+                    TokenKind::RParen,
                     "Expected ')' after function arguments",
                 )?;
 
                 // Extract function name from expr
-                let name = if let AstNode::Variable(n, _) = expr {
-                    n
+                let name = if let AstNode::Variable(n, _) = &self.ast[expr] {
+                    n.clone()
                 } else {
                     return Err(ParseError {
                         message: "Function call must be on identifier"
@@ -467,11 +430,11 @@ impl Parser {
                     });
                 };
 
-                expr = AstNode::FunctionCall {
+                expr = self.alloc(AstNode::FunctionCall {
                     name,
                     args,
                     location: loc,
-                };
+                });
             } else {
                 break;
             }
@@ -481,17 +444,17 @@ impl Parser {
     }
 
     /// Parse argument list: (expr, expr, ...)
-    fn parse_argument_list(&mut self) -> Result<Vec<AstNode>, ParseError> {
+    fn parse_argument_list(&mut self) -> Result<Vec<NodeId>, ParseError> {
         let mut args = Vec::new();
 
-        if self.check(&Token::RParen(self.current_location())) {
+        if self.check(TokenKind::RParen) {
             return Ok(args);
         }
 
         loop {
             args.push(self.parse_expression()?);
 
-            if !self.match_token(&Token::Comma(self.current_location())) {
+            if !self.match_token(TokenKind::Comma) {
                 break;
             }
         }
@@ -500,43 +463,44 @@ impl Parser {
     }
 
     /// Parse primary (literals, variables, parenthesized expressions)
-    fn parse_primary(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_primary(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.current_location();
 
         // Integer literal
-        if let Token::IntLiteral(n, loc) = self.peek_token() {
+        if let Token::IntLiteral(n, loc) = *self.peek() {
             self.advance();
-            return Ok(AstNode::IntLiteral(n, loc));
+            return Ok(self.alloc(AstNode::IntLiteral(n, loc)));
         }
 
         // Character literal
-        if let Token::CharLiteral(c, loc) = self.peek_token() {
+        if let Token::CharLiteral(c, loc) = *self.peek() {
             self.advance();
-            return Ok(AstNode::CharLiteral(c, loc));
+            return Ok(self.alloc(AstNode::CharLiteral(c, loc)));
         }
 
         // String literal
-        if let Token::StringLiteral(s, loc) = self.peek_token() {
+        if let Token::StringLiteral(s, loc) = self.peek() {
+            let node = AstNode::StringLiteral(s.to_string(), *loc);
             self.advance();
-            return Ok(AstNode::StringLiteral(s, loc));
+            return Ok(self.alloc(node));
         }
 
         // NULL
-        if self.match_token(&Token::Null(loc)) {
-            return Ok(AstNode::Null { location: loc });
+        if self.match_token(TokenKind::Null) {
+            return Ok(self.alloc(AstNode::Null { location: loc }));
         }
 
         // Identifier
-        if let Token::Ident(name, loc) = self.peek_token() {
+        if let Token::Ident(name, loc) = *self.peek() {
             self.advance();
-            return Ok(AstNode::Variable(name, loc));
+            return Ok(self.alloc(AstNode::Variable(name.to_string(), loc)));
         }
 
         // Parenthesized expression
-        if self.match_token(&Token::LParen(loc)) {
+        if self.match_token(TokenKind::LParen) {
             let expr = self.parse_expression()?;
             self.expect_token(
-                &Token::RParen(self.current_location()),
+                TokenKind::RParen,
                 "Expected ')' after expression",
             )?;
             return Ok(expr);
@@ -0,0 +1,336 @@
+//! Incremental re-parsing for watch mode
+//!
+//! [`IncrementalParser`] keeps the arena of the previous parse and remembers
+//! which top-level declaration (function or struct) each root node came
+//! from. On a re-parse the new source is lexed and split into top-level
+//! items; items whose text is unchanged keep their existing nodes (and
+//! therefore their [`NodeId`]s), and only the others are parsed again,
+//! appending fresh nodes to the arena. An unchanged item that moved, e.g.
+//! below an inserted line, has the line numbers of its nodes shifted.
+//!
+//! The arena's chunks are shared with the returned [`Program`] (see
+//! [`Ast`]), so handing out a program costs no copy of the nodes.
+//!
+//! Nodes of replaced items stay in the arena as garbage until it is more
+//! than half garbage, at which point the next re-parse starts from an empty
+//! arena.
+
+use crate::parser::ast::*;
+use crate::parser::lexer::{Token, TokenKind};
+use crate::parser::parse::{ParseError, Parser};
+use rustc_hash::FxHashMap;
+use std::ops::Range;
+
+/// Arenas smaller than this are never compacted
+const MIN_COMPACT_NODES: usize = 4096;
+
+/// Identifies one top-level item by its text, independent of the line it
+/// starts on
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+struct ItemKey {
+    /// Column of the first token, telling apart items that share a line
+    column: usize,
+    /// Full source lines the item spans
+    text: String,
+}
+
+/// A parsed top-level item, found again by the full source lines it spans
+#[derive(Debug, Clone, Copy)]
+struct CachedItem {
+    root: NodeId,
+    /// First arena node of the item; its nodes are contiguous
+    first: usize,
+    /// Number of arena nodes the item occupies
+    nodes: usize,
+    /// Line the item started on when its nodes were last updated
+    line: usize,
+}
+
+/// Result of [`IncrementalParser::parse`]
+#[derive(Debug)]
+pub struct Reparse {
+    pub program: Program,
+    /// Top-level items whose nodes were kept from the previous parse
+    pub reused: usize,
+    /// Top-level items that were parsed again
+    pub reparsed: usize,
+}
+
+/// Parser that re-parses only the top-level items that changed
+#[derive(Debug, Default)]
+pub struct IncrementalParser {
+    ast: Ast,
+    /// Cached items by key; identical items (such as a duplicated
+    /// definition) share one
+    items: FxHashMap<ItemKey, Vec<CachedItem>>,
+}
+
+impl IncrementalParser {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Parse `source`, reusing unchanged items from the previous call.
+    ///
+    /// The returned program shares the arena; on error the state of the
+    /// previous successful parse is kept.
+    pub fn parse(&mut self, source: &str) -> Result<Reparse, ParseError> {
+        let mut parser = Parser::new(source)?;
+
+        let live: usize =
+            self.items.values().flatten().map(|item| item.nodes).sum();
+        if self.ast.len() > MIN_COMPACT_NODES && self.ast.len() > 2 * live {
+            self.ast = Ast::new();
+            self.items.clear();
+        }
+
+        let line_starts = line_starts(source);
+        let mut items: FxHashMap<ItemKey, Vec<CachedItem>> =
+            FxHashMap::default();
+        let mut nodes = Vec::new();
+        let mut reused = 0;
+        let mut reparsed = 0;
+        // Each cached item is matched at most once
+        let mut cached = std::mem::take(&mut self.items);
+
+        parser.ast = std::mem::take(&mut self.ast);
+        for span in item_spans(&parser.tokens) {
+            let (line, key) =
+                ItemKey::new(source, &line_starts, &parser.tokens, &span);
+            let hit = cached.get_mut(&key).and_then(|items| items.pop());
+            let item = match hit {
+                Some(mut item) => {
+                    if item.line != line {
+                        let delta = line as isize - item.line as isize;
+                        for i in item.first..item.first + item.nodes {
+                            parser
+                                .ast
+                                .get_mut(NodeId::from_index(i))
+                                .shift_lines(delta);
+                        }
+                        item.line = line;
+                    }
+                    reused += 1;
+                    item
+                }
+                None => {
+                    let first = parser.ast.len();
+                    parser.position = span.start;
+                    let root = match parser.parse_top_level_declaration() {
+                        Ok(root) => root,
+                        Err(e) => {
+                            // Items matched so far may have been moved, so
+                            // keep their updated records
+                            for (key, list) in items {
+                                cached.entry(key).or_default().extend(list);
+                            }
+                            self.ast = std::mem::take(&mut parser.ast);
+                            self.items = cached;
+                            return Err(e);
+                        }
+                    };
+                    if parser.position != span.end {
+                        // The item split disagrees with the grammar; give up
+                        // on reuse for this source
+                        return self.parse_from_scratch(source);
+                    }
+                    reparsed += 1;
+                    CachedItem {
+                        root,
+                        first,
+                        nodes: parser.ast.len() - first,
+                        line,
+                    }
+                }
+            };
+            nodes.push(item.root);
+            items.entry(key).or_default().push(item);
+        }
+        // Popping from the back matches repeated items in source order
+        for list in items.values_mut() {
+            list.reverse();
+        }
+
+        self.ast = parser.ast;
+        self.items = items;
+        Ok(Reparse {
+            program: Program {
+                ast: self.ast.clone(),
+                nodes,
+            },
+            reused,
+            reparsed,
+        })
+    }
+
+    /// Full parse that leaves nothing to reuse next time
+    fn parse_from_scratch(
+        &mut self,
+        source: &str,
+    ) -> Result<Reparse, ParseError> {
+        self.ast = Ast::new();
+        self.items.clear();
+        let program = Parser::new(source)?.parse_program()?;
+        let reparsed = program.nodes.len();
+        Ok(Reparse {
+            program,
+            reused: 0,
+            reparsed,
+        })
+    }
+}
+
+impl ItemKey {
+    /// Key of the item covering `span`, with the line it starts on
+    fn new(
+        source: &str,
+        line_starts: &[usize],
+        tokens: &[Token],
+        span: &Range<usize>,
+    ) -> (usize, Self) {
+        let start = tokens[span.start].location();
+        let end = tokens[span.end - 1].location().line;
+        let from = line_starts[start.line - 1];
+        let to = line_starts.get(end).copied().unwrap_or(source.len());
+        let key = ItemKey {
+            column: start.column,
+            text: source[from..to].to_string(),
+        };
+        (start.line, key)
+    }
+}
+
+/// Byte offset of the start of each line
+fn line_starts(source: &str) -> Vec<usize> {
+    let mut starts = vec![0];
+    starts.extend(
+        source
+            .bytes()
+            .enumerate()
+            .filter(|&(_, b)| b == b'\n')
+            .map(|(i, _)| i + 1),
+    );
+    starts
+}
+
+/// Token ranges of the top-level items: everything up to a `;` or closing
+/// `}` (plus a following `;`) at brace depth zero
+fn item_spans(tokens: &[Token]) -> Vec<Range<usize>> {
+    let mut spans = Vec::new();
+    let mut start = 0;
+    let mut depth = 0usize;
+    let mut i = 0;
+    while i < tokens.len() && tokens[i].kind() != TokenKind::Eof {
+        match tokens[i].kind() {
+            TokenKind::LBrace => depth += 1,
+            TokenKind::RBrace => {
+                depth = depth.saturating_sub(1);
+                if depth == 0 {
+                    let mut end = i + 1;
+                    if tokens.get(end).map(Token::kind)
+                        == Some(TokenKind::Semicolon)
+                    {
+                        end += 1;
+                    }
+                    spans.push(start..end);
+                    start = end;
+                    i = end;
+                    continue;
+                }
+            }
+            TokenKind::Semicolon if depth == 0 => {
+                spans.push(start..i + 1);
+                start = i + 1;
+            }
+            _ => {}
+        }
+        i += 1;
+    }
+    if start < i {
+        // Unterminated trailing item; parsing it reports the error
+        spans.push(start..i);
+    }
+    spans
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const SOURCE: &str = "struct P { int x; };\n\
+                          int f(int a) { return a + 1; }\n\
+                          int main() { return f(2); }\n";
+
+    #[test]
+    fn test_unchanged_items_keep_their_nodes() {
+        let mut parser = IncrementalParser::new();
+        let first = parser.parse(SOURCE).unwrap();
+        assert_eq!((first.reused, first.reparsed), (0, 3));
+
+        let edited = SOURCE.replace("f(2)", "f(3)");
+        let second = parser.parse(&edited).unwrap();
+        assert_eq!((second.reused, second.reparsed), (2, 1));
+        assert_eq!(second.program.nodes[..2], first.program.nodes[..2]);
+        assert_ne!(second.program.nodes[2], first.program.nodes[2]);
+        match &second.program.ast[second.program.nodes[2]] {
+            AstNode::FunctionDef { name, .. } => assert_eq!(name, "main"),
+            node => panic!("Expected main, got {:?}", node),
+        }
+
+        // Items below an inserted line keep their nodes at the new lines
+        let shifted = format!("\n{}", edited);
+        let third = parser.parse(&shifted).unwrap();
+        assert_eq!((third.reused, third.reparsed), (3, 0));
+        assert_eq!(third.program.nodes, second.program.nodes);
+        let main = &third.program.ast[third.program.nodes[2]];
+        assert_eq!(main.location().line, 4);
+        // The previous program still sees the old lines
+        assert_eq!(
+            second.program.ast[second.program.nodes[2]].location().line,
+            3
+        );
+        match main {
+            AstNode::FunctionDef { body, .. } => {
+                assert_eq!(third.program.ast[body[0]].location().line, 4)
+            }
+            node => panic!("Expected main, got {:?}", node),
+        }
+    }
+
+    #[test]
+    fn test_repeated_items_are_reused_once_each() {
+        let source = "int g() { return 1; }\nint g() { return 1; }\nint main() { return 0; }\n";
+        let mut parser = IncrementalParser::new();
+        let first = parser.parse(source).unwrap();
+        let second = parser.parse(&format!("\n{}", source)).unwrap();
+        assert_eq!((second.reused, second.reparsed), (3, 0));
+        assert_ne!(second.program.nodes[0], second.program.nodes[1]);
+        assert_eq!(second.program.nodes, first.program.nodes);
+        for (i, &id) in second.program.nodes.iter().enumerate() {
+            assert_eq!(second.program.ast[id].location().line, i + 2);
+        }
+    }
+
+    #[test]
+    fn test_items_sharing_a_line_are_told_apart() {
+        let source = "struct P { int x; }; int main() { return 0; }\n";
+        let mut parser = IncrementalParser::new();
+        let first = parser.parse(source).unwrap();
+        let second = parser.parse(&format!("\n\n{}", source)).unwrap();
+        assert_eq!((second.reused, second.reparsed), (2, 0));
+        assert_eq!(second.program.nodes, first.program.nodes);
+        assert!(matches!(
+            second.program.ast[second.program.nodes[0]],
+            AstNode::StructDef { .. }
+        ));
+    }
+
+    #[test]
+    fn test_parse_error_keeps_previous_state() {
+        let mut parser = IncrementalParser::new();
+        parser.parse(SOURCE).unwrap();
+        assert!(parser.parse(&SOURCE.replace("a + 1;", "a +;")).is_err());
+        let again = parser.parse(SOURCE).unwrap();
+        assert_eq!((again.reused, again.reparsed), (3, 0));
+    }
+}
@@ -5,21 +5,23 @@
 //! parsed, matching the interpreter's no-preprocessor policy.
 
 use super::ast::SourceLocation;
+use std::borrow::Cow;
 use std::fmt;
 
 /// All token variants produced by the lexer.
 ///
 /// Every variant carries a [`SourceLocation`] so that parse errors can report
 /// an accurate line and column without a separate token→location table.
+/// Identifier and string payloads borrow from the source text.
 #[derive(Debug, Clone, PartialEq)]
-pub enum Token {
+pub enum Token<'a> {
     // Literals
     IntLiteral(i32, SourceLocation),
     CharLiteral(i8, SourceLocation),
-    StringLiteral(String, SourceLocation),
+    StringLiteral(Cow<'a, str>, SourceLocation),
 
     // Identifiers
-    Ident(String, SourceLocation),
+    Ident(&'a str, SourceLocation),
 
     // Keywords
     Int(SourceLocation),
@@ -105,7 +107,161 @@ pub enum Token {
     Eof(SourceLocation),
 }
 
-impl Token {
+/// Payload-free token discriminant, for cheap comparisons in the parser
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum TokenKind {
+    IntLiteral,
+    CharLiteral,
+    StringLiteral,
+    Ident,
+    Int,
+    Char,
+    Void,
+    Struct,
+    Const,
+    If,
+    Else,
+    While,
+    Do,
+    For,
+    Switch,
+    Case,
+    Default,
+    Break,
+    Continue,
+    Return,
+    Goto,
+    Sizeof,
+    Null,
+    Plus,
+    Minus,
+    Star,
+    Slash,
+    Percent,
+    EqEq,
+    NotEq,
+    Lt,
+    Le,
+    Gt,
+    Ge,
+    AndAnd,
+    OrOr,
+    Bang,
+    Amp,
+    Pipe,
+    Caret,
+    Tilde,
+    LtLt,
+    GtGt,
+    Eq,
+    PlusEq,
+    MinusEq,
+    StarEq,
+    SlashEq,
+    PercentEq,
+    PlusPlus,
+    MinusMinus,
+    Dot,
+    Arrow,
+    Question,
+    Colon,
+    LParen,
+    RParen,
+    LBrace,
+    RBrace,
+    LBracket,
+    RBracket,
+    Semicolon,
+    Comma,
+    Eof,
+}
+
+impl TokenKind {
+    /// Whether this token can start a type (`int`, `char`, `void`,
+    /// `struct`, `const`)
+    pub fn is_type_keyword(self) -> bool {
+        matches!(
+            self,
+            TokenKind::Int
+                | TokenKind::Char
+                | TokenKind::Void
+                | TokenKind::Struct
+                | TokenKind::Const
+        )
+    }
+}
+
+impl Token<'_> {
+    /// The token's kind, without payload or location.
+    pub fn kind(&self) -> TokenKind {
+        match self {
+            Token::IntLiteral(..) => TokenKind::IntLiteral,
+            Token::CharLiteral(..) => TokenKind::CharLiteral,
+            Token::StringLiteral(..) => TokenKind::StringLiteral,
+            Token::Ident(..) => TokenKind::Ident,
+            Token::Int(_) => TokenKind::Int,
+            Token::Char(_) => TokenKind::Char,
+            Token::Void(_) => TokenKind::Void,
+            Token::Struct(_) => TokenKind::Struct,
+            Token::Const(_) => TokenKind::Const,
+            Token::If(_) => TokenKind::If,
+            Token::Else(_) => TokenKind::Else,
+            Token::While(_) => TokenKind::While,
+            Token::Do(_) => TokenKind::Do,
+            Token::For(_) => TokenKind::For,
+            Token::Switch(_) => TokenKind::Switch,
+            Token::Case(_) => TokenKind::Case,
+            Token::Default(_) => TokenKind::Default,
+            Token::Break(_) => TokenKind::Break,
+            Token::Continue(_) => TokenKind::Continue,
+            Token::Return(_) => TokenKind::Return,
+            Token::Goto(_) => TokenKind::Goto,
+            Token::Sizeof(_) => TokenKind::Sizeof,
+            Token::Null(_) => TokenKind::Null,
+            Token::Plus(_) => TokenKind::Plus,
+            Token::Minus(_) => TokenKind::Minus,
+            Token::Star(_) => TokenKind::Star,
+            Token::Slash(_) => TokenKind::Slash,
+            Token::Percent(_) => TokenKind::Percent,
+            Token::EqEq(_) => TokenKind::EqEq,
+            Token::NotEq(_) => TokenKind::NotEq,
+            Token::Lt(_) => TokenKind::Lt,
+            Token::Le(_) => TokenKind::Le,
+            Token::Gt(_) => TokenKind::Gt,
+            Token::Ge(_) => TokenKind::Ge,
+            Token::AndAnd(_) => TokenKind::AndAnd,
+            Token::OrOr(_) => TokenKind::OrOr,
+            Token::Bang(_) => TokenKind::Bang,
+            Token::Amp(_) => TokenKind::Amp,
+            Token::Pipe(_) => TokenKind::Pipe,
+            Token::Caret(_) => TokenKind::Caret,
+            Token::Tilde(_) => TokenKind::Tilde,
+            Token::LtLt(_) => TokenKind::LtLt,
+            Token::GtGt(_) => TokenKind::GtGt,
+            Token::Eq(_) => TokenKind::Eq,
+            Token::PlusEq(_) => TokenKind::PlusEq,
+            Token::MinusEq(_) => TokenKind::MinusEq,
+            Token::StarEq(_) => TokenKind::StarEq,
+            Token::SlashEq(_) => TokenKind::SlashEq,
+            Token::PercentEq(_) => TokenKind::PercentEq,
+            Token::PlusPlus(_) => TokenKind::PlusPlus,
+            Token::MinusMinus(_) => TokenKind::MinusMinus,
+            Token::Dot(_) => TokenKind::Dot,
+            Token::Arrow(_) => TokenKind::Arrow,
+            Token::Question(_) => TokenKind::Question,
+            Token::Colon(_) => TokenKind::Colon,
+            Token::LParen(_) => TokenKind::LParen,
+            Token::RParen(_) => TokenKind::RParen,
+            Token::LBrace(_) => TokenKind::LBrace,
+            Token::RBrace(_) => TokenKind::RBrace,
+            Token::LBracket(_) => TokenKind::LBracket,
+            Token::RBracket(_) => TokenKind::RBracket,
+            Token::Semicolon(_) => TokenKind::Semicolon,
+            Token::Comma(_) => TokenKind::Comma,
+            Token::Eof(_) => TokenKind::Eof,
+        }
+    }
+
     /// Returns the source location where this token appears.
     pub fn location(&self) -> SourceLocation {
         match self {
@@ -177,7 +333,7 @@ impl Token {
     }
 }
 
-impl fmt::Display for Token {
+impl fmt::Display for Token<'_> {
     fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
         match self {
             Token::IntLiteral(n, _) => write!(f, "int literal {}", n),
@@ -274,19 +430,27 @@ impl fmt::Display for LexError {
 
 impl std::error::Error for LexError {}
 
-/// Lexer for C source code
-pub struct Lexer {
-    input: Vec<char>,
+/// Lexer for C source code.
+///
+/// Scans the UTF-8 bytes of the source directly. Identifier and string
+/// literal payloads borrow from the source; a string literal is only copied
+/// when it contains an escape sequence. Line and column are tracked
+/// incrementally, counting columns in characters (UTF-8 continuation bytes
+/// do not advance the column).
+pub struct Lexer<'a> {
+    source: &'a str,
+    bytes: &'a [u8],
     position: usize,
     line: usize,
     column: usize,
 }
 
-impl Lexer {
+impl<'a> Lexer<'a> {
     /// Create a new lexer for the given source string.
-    pub fn new(input: &str) -> Self {
+    pub fn new(input: &'a str) -> Self {
         Self {
-            input: input.chars().collect(),
+            source: input,
+            bytes: input.as_bytes(),
             position: 0,
             line: 1,
             column: 1,
@@ -294,8 +458,9 @@ impl Lexer {
     }
 
     /// Tokenize the entire input
-    pub fn tokenize(&mut self) -> Result<Vec<Token>, LexError> {
-        let mut tokens = Vec::new();
+    pub fn tokenize(&mut self) -> Result<Vec<Token<'a>>, LexError> {
+        // Roughly one token per five bytes of typical C source
+        let mut tokens = Vec::with_capacity(self.bytes.len() / 5 + 1);
 
         loop {
             self.skip_whitespace_and_comments()?;
@@ -306,7 +471,7 @@ impl Lexer {
             }
 
             // Skip #include directives (per DISCOVERY.md)
-            if self.peek() == Some('#') {
+            if self.peek() == Some(b'#') {
                 self.skip_preprocessor_directive()?;
                 continue;
             }
@@ -318,8 +483,9 @@ impl Lexer {
     }
 
     /// Get next token
-    fn next_token(&mut self) -> Result<Token, LexError> {
+    fn next_token(&mut self) -> Result<Token<'a>, LexError> {
         let loc = self.current_location();
+        let start = self.position;
         let ch = self.advance().ok_or_else(|| LexError {
             message: "Unexpected end of file".to_string(),
             location: loc,
@@ -327,154 +493,127 @@ impl Lexer {
 
         match ch {
             // String literals
-            '"' => self.string_literal(),
+            b'"' => self.string_literal(loc),
 
             // Character literals
-            '\'' => self.char_literal(),
+            b'\'' => self.char_literal(loc),
 
             // Numeric literals
-            '0'..='9' => self.number_literal(ch),
+            b'0'..=b'9' => self.number_literal(start, loc),
 
             // Identifiers and keywords
-            'a'..='z' | 'A'..='Z' | '_' => self.identifier_or_keyword(ch),
+            b'a'..=b'z' | b'A'..=b'Z' | b'_' => {
+                Ok(self.identifier_or_keyword(start, loc))
+            }
 
             // Operators and punctuation
-            '+' => {
-                if self.peek() == Some('+') {
-                    self.advance();
-                    Ok(Token::PlusPlus(loc))
-                } else if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::PlusEq(loc))
-                } else {
-                    Ok(Token::Plus(loc))
-                }
-            }
-            '-' => {
-                if self.peek() == Some('-') {
-                    self.advance();
-                    Ok(Token::MinusMinus(loc))
-                } else if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::MinusEq(loc))
-                } else if self.peek() == Some('>') {
-                    self.advance();
-                    Ok(Token::Arrow(loc))
-                } else {
-                    Ok(Token::Minus(loc))
-                }
-            }
-            '*' => {
-                if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::StarEq(loc))
-                } else {
-                    Ok(Token::Star(loc))
-                }
-            }
-            '/' => {
-                if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::SlashEq(loc))
-                } else {
-                    Ok(Token::Slash(loc))
-                }
-            }
-            '%' => {
-                if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::PercentEq(loc))
-                } else {
-                    Ok(Token::Percent(loc))
-                }
-            }
-            '=' => {
-                if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::EqEq(loc))
-                } else {
-                    Ok(Token::Eq(loc))
-                }
-            }
-            '!' => {
-                if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::NotEq(loc))
-                } else {
-                    Ok(Token::Bang(loc))
-                }
-            }
-            '<' => {
-                if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::Le(loc))
-                } else if self.peek() == Some('<') {
-                    self.advance();
-                    Ok(Token::LtLt(loc))
-                } else {
-                    Ok(Token::Lt(loc))
-                }
-            }
-            '>' => {
-                if self.peek() == Some('=') {
-                    self.advance();
-                    Ok(Token::Ge(loc))
-                } else if self.peek() == Some('>') {
-                    self.advance();
-                    Ok(Token::GtGt(loc))
-                } else {
-                    Ok(Token::Gt(loc))
-                }
-            }
-            '&' => {
-                if self.peek() == Some('&') {
-                    self.advance();
-                    Ok(Token::AndAnd(loc))
-                } else {
-                    Ok(Token::Amp(loc))
-                }
-            }
-            '|' => {
-                if self.peek() == Some('|') {
-                    self.advance();
-                    Ok(Token::OrOr(loc))
-                } else {
-                    Ok(Token::Pipe(loc))
-                }
-            }
-            '^' => Ok(Token::Caret(loc)),
-            '~' => Ok(Token::Tilde(loc)),
-            '.' => Ok(Token::Dot(loc)),
-            '?' => Ok(Token::Question(loc)),
-            ':' => Ok(Token::Colon(loc)),
-            '(' => Ok(Token::LParen(loc)),
-            ')' => Ok(Token::RParen(loc)),
-            '{' => Ok(Token::LBrace(loc)),
-            '}' => Ok(Token::RBrace(loc)),
-            '[' => Ok(Token::LBracket(loc)),
-            ']' => Ok(Token::RBracket(loc)),
-            ';' => Ok(Token::Semicolon(loc)),
-            ',' => Ok(Token::Comma(loc)),
+            b'+' => Ok(match self.peek() {
+                Some(b'+') => self.bump(Token::PlusPlus(loc)),
+                Some(b'=') => self.bump(Token::PlusEq(loc)),
+                _ => Token::Plus(loc),
+            }),
+            b'-' => Ok(match self.peek() {
+                Some(b'-') => self.bump(Token::MinusMinus(loc)),
+                Some(b'=') => self.bump(Token::MinusEq(loc)),
+                Some(b'>') => self.bump(Token::Arrow(loc)),
+                _ => Token::Minus(loc),
+            }),
+            b'*' => Ok(match self.peek() {
+                Some(b'=') => self.bump(Token::StarEq(loc)),
+                _ => Token::Star(loc),
+            }),
+            b'/' => Ok(match self.peek() {
+                Some(b'=') => self.bump(Token::SlashEq(loc)),
+                _ => Token::Slash(loc),
+            }),
+            b'%' => Ok(match self.peek() {
+                Some(b'=') => self.bump(Token::PercentEq(loc)),
+                _ => Token::Percent(loc),
+            }),
+            b'=' => Ok(match self.peek() {
+                Some(b'=') => self.bump(Token::EqEq(loc)),
+                _ => Token::Eq(loc),
+            }),
+            b'!' => Ok(match self.peek() {
+                Some(b'=') => self.bump(Token::NotEq(loc)),
+                _ => Token::Bang(loc),
+            }),
+            b'<' => Ok(match self.peek() {
+                Some(b'=') => self.bump(Token::Le(loc)),
+                Some(b'<') => self.bump(Token::LtLt(loc)),
+                _ => Token::Lt(loc),
+            }),
+            b'>' => Ok(match self.peek() {
+                Some(b'=') => self.bump(Token::Ge(loc)),
+                Some(b'>') => self.bump(Token::GtGt(loc)),
+                _ => Token::Gt(loc),
+            }),
+            b'&' => Ok(match self.peek() {
+                Some(b'&') => self.bump(Token::AndAnd(loc)),
+                _ => Token::Amp(loc),
+            }),
+            b'|' => Ok(match self.peek() {
+                Some(b'|') => self.bump(Token::OrOr(loc)),
+                _ => Token::Pipe(loc),
+            }),
+            b'^' => Ok(Token::Caret(loc)),
+            b'~' => Ok(Token::Tilde(loc)),
+            b'.' => Ok(Token::Dot(loc)),
+            b'?' => Ok(Token::Question(loc)),
+            b':' => Ok(Token::Colon(loc)),
+            b'(' => Ok(Token::LParen(loc)),
+            b')' => Ok(Token::RParen(loc)),
+            b'{' => Ok(Token::LBrace(loc)),
+            b'}' => Ok(Token::RBrace(loc)),
+            b'[' => Ok(Token::LBracket(loc)),
+            b']' => Ok(Token::RBracket(loc)),
+            b';' => Ok(Token::Semicolon(loc)),
+            b',' => Ok(Token::Comma(loc)),
 
             _ => Err(LexError {
-                message: format!("Unexpected character: '{}'", ch),
+                message: format!(
+                    "Unexpected character: '{}'",
+                    self.char_at(start)
+                ),
                 location: loc,
             }),
         }
     }
 
-    /// Parse string literal
-    fn string_literal(&mut self) -> Result<Token, LexError> {
-        let loc = SourceLocation::new(self.line, self.column - 1);
-        let mut string = String::new();
+    /// Consume the second byte of a two-byte operator
+    #[inline]
+    fn bump(&mut self, token: Token<'a>) -> Token<'a> {
+        self.advance();
+        token
+    }
+
+    /// Parse string literal (opening quote already consumed)
+    fn string_literal(
+        &mut self,
+        loc: SourceLocation,
+    ) -> Result<Token<'a>, LexError> {
+        let start = self.position;
+        // Only allocated once an escape sequence is seen
+        let mut owned: Option<String> = None;
+        let mut run_start = start;
 
         while let Some(ch) = self.peek() {
-            if ch == '"' {
+            if ch == b'"' {
+                let tail = &self.source[run_start..self.position];
                 self.advance(); // consume closing quote
-                return Ok(Token::StringLiteral(string, loc));
+                let value = match owned {
+                    Some(mut s) => {
+                        s.push_str(tail);
+                        Cow::Owned(s)
+                    }
+                    None => Cow::Borrowed(tail),
+                };
+                return Ok(Token::StringLiteral(value, loc));
             }
 
-            if ch == '\\' {
+            if ch == b'\\' {
+                let buf = owned.get_or_insert_with(String::new);
+                buf.push_str(&self.source[run_start..self.position]);
                 self.advance();
                 let escaped = self.advance().ok_or_else(|| LexError {
                     message: "Unexpected end of file in string literal"
@@ -483,25 +622,25 @@ impl Lexer {
                 })?;
 
                 let unescaped = match escaped {
-                    'n' => '\n',
-                    't' => '\t',
-                    'r' => '\r',
-                    '\\' => '\\',
-                    '"' => '"',
-                    '0' => '\0',
+                    b'n' => '\n',
+                    b't' => '\t',
+                    b'r' => '\r',
+                    b'\\' => '\\',
+                    b'"' => '"',
+                    b'0' => '\0',
                     _ => {
                         return Err(LexError {
                             message: format!(
                                 "Unknown escape sequence: \\{}",
-                                escaped
+                                self.char_at(self.position - 1)
                             ),
                             location: self.current_location(),
                         });
                     }
                 };
-                string.push(unescaped);
+                buf.push(unescaped);
+                run_start = self.position;
             } else {
-                string.push(ch);
                 self.advance();
             }
         }
@@ -512,68 +651,78 @@ impl Lexer {
         })
     }
 
-    /// Parse character literal
-    fn char_literal(&mut self) -> Result<Token, LexError> {
-        let loc = SourceLocation::new(self.line, self.column - 1);
-
-        let ch = self.advance().ok_or_else(|| LexError {
+    /// Parse character literal (opening quote already consumed)
+    fn char_literal(
+        &mut self,
+        loc: SourceLocation,
+    ) -> Result<Token<'a>, LexError> {
+        let eof_error = |lexer: &Self| LexError {
             message: "Unexpected end of file in character literal".to_string(),
-            location: self.current_location(),
-        })?;
+            location: lexer.current_location(),
+        };
+
+        let start = self.position;
+        let ch = self.advance().ok_or_else(|| eof_error(self))?;
 
-        let value = if ch == '\\' {
+        let value = if ch == b'\\' {
             // Handle escape sequences
-            let escaped = self.advance().ok_or_else(|| LexError {
-                message: "Unexpected end of file in character literal"
-                    .to_string(),
-                location: self.current_location(),
-            })?;
+            let escaped = self.advance().ok_or_else(|| eof_error(self))?;
 
             match escaped {
-                'n' => '\n' as i8,
-                't' => '\t' as i8,
-                'r' => '\r' as i8,
-                '\\' => '\\' as i8,
-                '\'' => '\'' as i8,
-                '0' => 0,
-                'x' => {
+                b'n' => b'\n' as i8,
+                b't' => b'\t' as i8,
+                b'r' => b'\r' as i8,
+                b'\\' => b'\\' as i8,
+                b'\'' => b'\'' as i8,
+                b'0' => 0,
+                b'x' => {
                     // Hex escape: \xHH
-                    let hex1 = self.advance().ok_or_else(|| LexError {
+                    let incomplete = |lexer: &Self| LexError {
                         message: "Incomplete hex escape sequence".to_string(),
-                        location: self.current_location(),
-                    })?;
-                    let hex2 = self.advance().ok_or_else(|| LexError {
-                        message: "Incomplete hex escape sequence".to_string(),
-                        location: self.current_location(),
-                    })?;
-
-                    let hex_str = format!("{}{}", hex1, hex2);
-                    u8::from_str_radix(&hex_str, 16).map(|v| v as i8).map_err(
-                        |_| LexError {
-                            message: format!(
-                                "Invalid hex escape sequence: \\x{}",
-                                hex_str
-                            ),
-                            location: self.current_location(),
-                        },
-                    )?
+                        location: lexer.current_location(),
+                    };
+                    let hex_start = self.position;
+                    let hi = self.advance().ok_or_else(|| incomplete(self))?;
+                    let lo = self.advance().ok_or_else(|| incomplete(self))?;
+
+                    match (hex_digit(hi), hex_digit(lo)) {
+                        (Some(hi), Some(lo)) => ((hi << 4) | lo) as i8,
+                        _ => {
+                            return Err(LexError {
+                                message: format!(
+                                    "Invalid hex escape sequence: \\x{}",
+                                    self.source
+                                        .get(hex_start..self.position)
+                                        .unwrap_or("??")
+                                ),
+                                location: self.current_location(),
+                            });
+                        }
+                    }
                 }
                 _ => {
                     return Err(LexError {
                         message: format!(
                             "Unknown escape sequence: \\{}",
-                            escaped
+                            self.char_at(self.position - 1)
                         ),
                         location: self.current_location(),
                     });
                 }
             }
-        } else {
+        } else if ch.is_ascii() {
             ch as i8
+        } else {
+            // Multi-byte character: keep the old `char as i8` truncation
+            let c = self.char_at(start);
+            for _ in 1..c.len_utf8() {
+                self.advance();
+            }
+            c as i8
         };
 
         // Expect closing quote
-        if self.advance() != Some('\'') {
+        if self.advance() != Some(b'\'') {
             return Err(LexError {
                 message: "Expected closing quote in character literal"
                     .to_string(),
@@ -585,24 +734,25 @@ impl Lexer {
     }
 
     /// Parse numeric literal (integers only)
-    fn number_literal(&mut self, first_digit: char) -> Result<Token, LexError> {
-        let loc = SourceLocation::new(self.line, self.column - 1);
-        let mut num_str = String::new();
-        num_str.push(first_digit);
-
-        while let Some(ch) = self.peek() {
-            if ch.is_ascii_digit() {
-                num_str.push(ch);
-                self.advance();
-            } else {
-                break;
-            }
+    fn number_literal(
+        &mut self,
+        start: usize,
+        loc: SourceLocation,
+    ) -> Result<Token<'a>, LexError> {
+        while let Some(b'0'..=b'9') = self.peek() {
+            self.advance();
         }
 
-        let value = num_str.parse::<i32>().map_err(|_| LexError {
-            message: format!("Invalid integer literal: {}", num_str),
-            location: loc,
-        })?;
+        let digits = &self.source[start..self.position];
+        let value = digits
+            .bytes()
+            .try_fold(0i32, |acc, d| {
+                acc.checked_mul(10)?.checked_add((d - b'0') as i32)
+            })
+            .ok_or_else(|| LexError {
+                message: format!("Invalid integer literal: {}", digits),
+                location: loc,
+            })?;
 
         Ok(Token::IntLiteral(value, loc))
     }
@@ -610,60 +760,33 @@ impl Lexer {
     /// Parse identifier or keyword
     fn identifier_or_keyword(
         &mut self,
-        first_char: char,
-    ) -> Result<Token, LexError> {
-        let loc = SourceLocation::new(self.line, self.column - 1);
-        let mut ident = String::new();
-        ident.push(first_char);
-
+        start: usize,
+        loc: SourceLocation,
+    ) -> Token<'a> {
         while let Some(ch) = self.peek() {
-            if ch.is_ascii_alphanumeric() || ch == '_' {
-                ident.push(ch);
+            if ch.is_ascii_alphanumeric() || ch == b'_' {
                 self.advance();
             } else {
                 break;
             }
         }
 
-        // Check if it's a keyword
-        let token = match ident.as_str() {
-            "int" => Token::Int(loc),
-            "char" => Token::Char(loc),
-            "void" => Token::Void(loc),
-            "struct" => Token::Struct(loc),
-            "const" => Token::Const(loc),
-            "if" => Token::If(loc),
-            "else" => Token::Else(loc),
-            "while" => Token::While(loc),
-            "do" => Token::Do(loc),
-            "for" => Token::For(loc),
-            "switch" => Token::Switch(loc),
-            "case" => Token::Case(loc),
-            "default" => Token::Default(loc),
-            "break" => Token::Break(loc),
-            "continue" => Token::Continue(loc),
-            "return" => Token::Return(loc),
-            "goto" => Token::Goto(loc),
-            "sizeof" => Token::Sizeof(loc),
-            "NULL" => Token::Null(loc),
-            _ => Token::Ident(ident, loc),
-        };
-
-        Ok(token)
+        let ident = &self.source[start..self.position];
+        keyword(ident.as_bytes(), loc).unwrap_or(Token::Ident(ident, loc))
     }
 
     /// Skip whitespace and comments
     fn skip_whitespace_and_comments(&mut self) -> Result<(), LexError> {
         loop {
             match self.peek() {
-                Some(' ') | Some('\t') | Some('\r') | Some('\n') => {
+                Some(b' ') | Some(b'\t') | Some(b'\r') | Some(b'\n') => {
                     self.advance();
                 }
-                Some('/') => {
-                    if self.peek_ahead(1) == Some('/') {
+                Some(b'/') => {
+                    if self.peek_ahead(1) == Some(b'/') {
                         // Single-line comment
                         self.skip_line_comment();
-                    } else if self.peek_ahead(1) == Some('*') {
+                    } else if self.peek_ahead(1) == Some(b'*') {
                         // Multi-line comment
                         self.skip_block_comment()?;
                     } else {
@@ -678,12 +801,7 @@ impl Lexer {
 
     /// Skip single-line comment (// ...)
     fn skip_line_comment(&mut self) {
-        while let Some(ch) = self.peek() {
-            self.advance();
-            if ch == '\n' {
-                break;
-            }
-        }
+        self.skip_to_next_line();
     }
 
     /// Skip multi-line comment (/* ... */)
@@ -693,7 +811,7 @@ impl Lexer {
         self.advance(); // skip '*'
 
         while !self.is_at_end() {
-            if self.peek() == Some('*') && self.peek_ahead(1) == Some('/') {
+            if self.peek() == Some(b'*') && self.peek_ahead(1) == Some(b'/') {
                 self.advance(); // skip '*'
                 self.advance(); // skip '/'
                 return Ok(());
@@ -709,64 +827,138 @@ impl Lexer {
 
     /// Skip preprocessor directive (#include, etc.)
     fn skip_preprocessor_directive(&mut self) -> Result<(), LexError> {
-        while let Some(ch) = self.peek() {
-            self.advance();
-            if ch == '\n' {
-                break;
-            }
-        }
+        self.skip_to_next_line();
         Ok(())
     }
 
-    /// Peek at current character without consuming
-    fn peek(&self) -> Option<char> {
-        if self.position < self.input.len() {
-            Some(self.input[self.position])
-        } else {
-            None
+    /// Jump past the next newline (or to the end of input)
+    fn skip_to_next_line(&mut self) {
+        let rest = &self.bytes[self.position..];
+        match rest.iter().position(|&b| b == b'\n') {
+            Some(newline) => {
+                self.position += newline + 1;
+                self.line += 1;
+                self.column = 1;
+            }
+            None => {
+                self.column += count_chars(rest);
+                self.position = self.bytes.len();
+            }
         }
     }
 
-    /// Peek ahead n characters
-    fn peek_ahead(&self, n: usize) -> Option<char> {
-        let pos = self.position + n;
-        if pos < self.input.len() {
-            Some(self.input[pos])
-        } else {
-            None
-        }
+    /// Peek at current byte without consuming
+    #[inline]
+    fn peek(&self) -> Option<u8> {
+        self.bytes.get(self.position).copied()
     }
 
-    /// Advance to next character
-    fn advance(&mut self) -> Option<char> {
-        if self.position >= self.input.len() {
-            return None;
-        }
+    /// Peek ahead n bytes
+    #[inline]
+    fn peek_ahead(&self, n: usize) -> Option<u8> {
+        self.bytes.get(self.position + n).copied()
+    }
 
-        let ch = self.input[self.position];
+    /// Advance to next byte
+    #[inline]
+    fn advance(&mut self) -> Option<u8> {
+        let ch = *self.bytes.get(self.position)?;
         self.position += 1;
 
-        if ch == '\n' {
+        if ch == b'\n' {
             self.line += 1;
             self.column = 1;
-        } else {
+        } else if !is_continuation_byte(ch) {
             self.column += 1;
         }
 
         Some(ch)
     }
 
+    /// The full character starting at byte offset `pos` (for messages)
+    fn char_at(&self, pos: usize) -> char {
+        self.source
+            .get(pos..)
+            .and_then(|rest| rest.chars().next())
+            .unwrap_or(char::REPLACEMENT_CHARACTER)
+    }
+
     /// Check if at end of input
+    #[inline]
     fn is_at_end(&self) -> bool {
-        self.position >= self.input.len()
+        self.position >= self.bytes.len()
     }
 
     /// Get current source location
+    #[inline]
     fn current_location(&self) -> SourceLocation {
         SourceLocation::new(self.line, self.column)
     }
 }
 
+/// Keyword lookup, dispatched on length so most identifiers are rejected
+/// after a single comparison
+fn keyword(ident: &[u8], loc: SourceLocation) -> Option<Token<'static>> {
+    let token = match ident.len() {
+        2 => match ident {
+            b"if" => Token::If(loc),
+            b"do" => Token::Do(loc),
+            _ => return None,
+        },
+        3 => match ident {
+            b"int" => Token::Int(loc),
+            b"for" => Token::For(loc),
+            _ => return None,
+        },
+        4 => match ident {
+            b"char" => Token::Char(loc),
+            b"void" => Token::Void(loc),
+            b"else" => Token::Else(loc),
+            b"case" => Token::Case(loc),
+            b"goto" => Token::Goto(loc),
+            b"NULL" => Token::Null(loc),
+            _ => return None,
+        },
+        5 => match ident {
+            b"const" => Token::Const(loc),
+            b"while" => Token::While(loc),
+            b"break" => Token::Break(loc),
+            _ => return None,
+        },
+        6 => match ident {
+            b"struct" => Token::Struct(loc),
+            b"switch" => Token::Switch(loc),
+            b"return" => Token::Return(loc),
+            b"sizeof" => Token::Sizeof(loc),
+            _ => return None,
+        },
+        7 => match ident {
+            b"default" => Token::Default(loc),
+            _ => return None,
+        },
+        8 => match ident {
+            b"continue" => Token::Continue(loc),
+            _ => return None,
+        },
+        _ => return None,
+    };
+    Some(token)
+}
+
+/// UTF-8 continuation bytes (`10xxxxxx`) do not start a new character
+#[inline]
+fn is_continuation_byte(b: u8) -> bool {
+    b & 0xC0 == 0x80
+}
+
+fn count_chars(bytes: &[u8]) -> usize {
+    bytes.iter().filter(|&&b| !is_continuation_byte(b)).count()
+}
+
+fn hex_digit(b: u8) -> Option<u8> {
+    (b as char).to_digit(16).map(|d| d as u8)
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -777,7 +969,7 @@ mod tests {
         let tokens = lexer.tokenize().unwrap();
 
         assert!(matches!(tokens[0], Token::Int(_)));
-        assert!(matches!(tokens[1], Token::Ident(ref s, _) if s == "main"));
+        assert!(matches!(tokens[1], Token::Ident("main", _)));
         assert!(matches!(tokens[2], Token::LParen(_)));
         assert!(matches!(tokens[3], Token::RParen(_)));
         assert!(matches!(tokens[4], Token::LBrace(_)));
@@ -811,13 +1003,13 @@ mod tests {
 
         // Should skip comments
         assert!(matches!(tokens[0], Token::Int(_)));
-        assert!(matches!(tokens[1], Token::Ident(ref s, _) if s == "x"));
+        assert!(matches!(tokens[1], Token::Ident("x", _)));
         assert!(matches!(tokens[2], Token::Semicolon(_)));
         assert!(matches!(tokens[3], Token::Int(_)));
-        assert!(matches!(tokens[4], Token::Ident(ref s, _) if s == "y"));
+        assert!(matches!(tokens[4], Token::Ident("y", _)));
         assert!(matches!(tokens[5], Token::Semicolon(_)));
         assert!(matches!(tokens[6], Token::Int(_)));
-        assert!(matches!(tokens[7], Token::Ident(ref s, _) if s == "z"));
+        assert!(matches!(tokens[7], Token::Ident("z", _)));
     }
 
     #[test]
@@ -833,6 +1025,34 @@ mod tests {
         }
     }
 
+    #[test]
+    fn test_payloads_borrow_source() {
+        let mut lexer = Lexer::new(r#"count "plain" "esc\t""#);
+        let tokens = lexer.tokenize().unwrap();
+
+        assert!(matches!(tokens[0], Token::Ident("count", _)));
+        assert!(matches!(
+            &tokens[1],
+            Token::StringLiteral(Cow::Borrowed("plain"), _)
+        ));
+        assert!(matches!(
+            &tokens[2],
+            Token::StringLiteral(Cow::Owned(s), _) if s == "esc\t"
+        ));
+    }
+
+    #[test]
+    fn test_columns_count_characters() {
+        // 'é' is two bytes but one column
+        let mut lexer = Lexer::new("/* é */ x = '\\x41';\n\"ü\" y");
+        let tokens = lexer.tokenize().unwrap();
+
+        assert_eq!(tokens[0].location(), SourceLocation::new(1, 9));
+        assert!(matches!(tokens[2], Token::CharLiteral(0x41, _)));
+        assert_eq!(tokens[4].location(), SourceLocation::new(2, 1));
+        assert_eq!(tokens[5].location(), SourceLocation::new(2, 5));
+    }
+
     #[test]
     fn test_preprocessor_skip() {
         let mut lexer = Lexer::new("#include <stdio.h>\nint x;");
@@ -840,6 +1060,6 @@ mod tests {
 
         // Should skip #include line
         assert!(matches!(tokens[0], Token::Int(_)));
-        assert!(matches!(tokens[1], Token::Ident(ref s, _) if s == "x"));
+        assert!(matches!(tokens[1], Token::Ident("x", _)));
     }
 }
@@ -7,6 +7,7 @@
 //! - `statements`: Statement parsing (if, while, for, switch, etc.)
 //! - `expressions`: Expression parsing (operators, precedence)
 //! - [`ast`][]: AST node definitions
+//! - [`incremental`][]: Re-parsing only the top-level items that changed
 //!
 //! # Supported C Subset
 //!
@@ -23,6 +24,7 @@
 //! No external parser generator dependencies.
 
 pub mod ast;
+pub mod incremental;
 pub mod lexer;
 pub mod parse;
 
@@ -18,7 +18,7 @@
 //! maintaining access to the shared parser state.
 
 use crate::parser::ast::*;
-use crate::parser::lexer::{LexError, Lexer, Token};
+use crate::parser::lexer::{LexError, Lexer, Token, TokenKind};
 use std::fmt;
 
 /// Parser error type
@@ -50,18 +50,24 @@ impl From<LexError> for ParseError {
 }
 
 /// Recursive descent parser for C subset
-pub struct Parser {
-    pub(crate) tokens: Vec<Token>,
+///
+/// Tokens borrow identifier and string text from `source`, so the parser
+/// cannot outlive it.
+pub struct Parser<'a> {
+    pub(crate) tokens: Vec<Token<'a>>,
     pub(crate) position: usize,
+    /// Arena the parsed nodes are allocated into
+    pub(crate) ast: Ast,
 }
 
-impl Parser {
-    pub fn new(source: &str) -> Result<Self, ParseError> {
+impl<'a> Parser<'a> {
+    pub fn new(source: &'a str) -> Result<Self, ParseError> {
         let mut lexer = Lexer::new(source);
         let tokens = lexer.tokenize()?;
         Ok(Self {
             tokens,
             position: 0,
+            ast: Ast::new(),
         })
     }
 
@@ -75,26 +81,40 @@ impl Parser {
             program.nodes.push(decl);
         }
 
+        program.ast = std::mem::take(&mut self.ast);
         Ok(program)
     }
 
+    /// Parse the whole source as a single expression whose nodes are
+    /// appended to `ast`. Nodes already in `ast` keep their ids, so the
+    /// expression can be evaluated against the program `ast` belongs to.
+    pub fn parse_expression_into(
+        &mut self,
+        ast: Ast,
+    ) -> Result<(Ast, NodeId), ParseError> {
+        self.ast = ast;
+        let expr = self.parse_expression()?;
+        if !self.is_at_end() {
+            return Err(self.error_here("Expected end of expression"));
+        }
+        Ok((std::mem::take(&mut self.ast), expr))
+    }
+
     // ===== Helper methods =====
 
+    /// Move a finished node into the arena
+    #[inline]
+    pub(crate) fn alloc(&mut self, node: AstNode) -> NodeId {
+        self.ast.push(node)
+    }
+
     pub(crate) fn is_type_keyword(&self) -> bool {
-        matches!(
-            self.peek_token(),
-            Token::Int(_)
-                | Token::Char(_)
-                | Token::Void(_)
-                | Token::Struct(_)
-                | Token::Const(_)
-        )
+        self.peek_kind().is_type_keyword()
     }
 
-    pub(crate) fn match_token(&mut self, token: &Token) -> bool {
-        if std::mem::discriminant(&self.peek_token())
-            == std::mem::discriminant(token)
-        {
+    /// Consume the current token if it is of `kind`
+    pub(crate) fn match_token(&mut self, kind: TokenKind) -> bool {
+        if self.check(kind) {
             self.advance();
             true
         } else {
@@ -102,12 +122,12 @@ impl Parser {
         }
     }
 
-    pub(crate) fn check(&self, token: &Token) -> bool {
-        std::mem::discriminant(&self.peek_token())
-            == std::mem::discriminant(token)
+    #[inline]
+    pub(crate) fn check(&self, kind: TokenKind) -> bool {
+        self.peek_kind() == kind
     }
 
-    pub(crate) fn advance(&mut self) -> &Token {
+    pub(crate) fn advance(&mut self) -> &Token<'a> {
         if !self.is_at_end() {
             self.position += 1;
         }
@@ -115,22 +135,24 @@ impl Parser {
     }
 
     pub(crate) fn is_at_end(&self) -> bool {
-        matches!(self.peek_token(), Token::Eof(_))
+        self.check(TokenKind::Eof)
     }
 
-    pub(crate) fn peek(&self) -> &Token {
+    #[inline]
+    pub(crate) fn peek(&self) -> &Token<'a> {
         &self.tokens[self.position]
     }
 
-    pub(crate) fn peek_token(&self) -> Token {
-        self.tokens[self.position].clone()
+    #[inline]
+    pub(crate) fn peek_kind(&self) -> TokenKind {
+        self.peek().kind()
     }
 
-    pub(crate) fn peek_ahead(&self, n: usize) -> Option<&Token> {
+    pub(crate) fn peek_ahead(&self, n: usize) -> Option<&Token<'a>> {
         self.tokens.get(self.position + n)
     }
 
-    pub(crate) fn previous(&self) -> &Token {
+    pub(crate) fn previous(&self) -> &Token<'a> {
         &self.tokens[self.position - 1]
     }
 
@@ -144,17 +166,21 @@ impl Parser {
 
     pub(crate) fn expect_token(
         &mut self,
-        token: &Token,
+        kind: TokenKind,
         message: &str,
     ) -> Result<(), ParseError> {
-        if self.check(token) {
-            self.advance();
+        if self.match_token(kind) {
             Ok(())
         } else {
-            Err(ParseError {
-                message: format!("{}, found {}", message, self.peek()),
-                location: self.current_location(),
-            })
+            Err(self.error_here(message))
+        }
+    }
+
+    /// "`message`, found <current token>" at the current location
+    fn error_here(&self, message: &str) -> ParseError {
+        ParseError {
+            message: format!("{}, found {}", message, self.peek()),
+            location: self.current_location(),
         }
     }
 
@@ -162,61 +188,59 @@ impl Parser {
         &mut self,
         ctx: &str,
     ) -> Result<(), ParseError> {
-        self.expect_token(
-            &Token::LParen(self.current_location()),
-            &format!("Expected '(' {ctx}"),
-        )
+        if self.match_token(TokenKind::LParen) {
+            return Ok(());
+        }
+        Err(self.error_here(&format!("Expected '(' {ctx}")))
     }
 
     pub(crate) fn expect_rparen(
         &mut self,
         ctx: &str,
     ) -> Result<(), ParseError> {
-        self.expect_token(
-            &Token::RParen(self.current_location()),
-            &format!("Expected ')' {ctx}"),
-        )
+        if self.match_token(TokenKind::RParen) {
+            return Ok(());
+        }
+        Err(self.error_here(&format!("Expected ')' {ctx}")))
     }
 
     pub(crate) fn expect_lbrace(
         &mut self,
         ctx: &str,
     ) -> Result<(), ParseError> {
-        self.expect_token(
-            &Token::LBrace(self.current_location()),
-            &format!("Expected '{{' {ctx}"),
-        )
+        if self.match_token(TokenKind::LBrace) {
+            return Ok(());
+        }
+        Err(self.error_here(&format!("Expected '{{' {ctx}")))
     }
 
     pub(crate) fn expect_rbrace(
         &mut self,
         ctx: &str,
     ) -> Result<(), ParseError> {
-        self.expect_token(
-            &Token::RBrace(self.current_location()),
-            &format!("Expected '}}' {ctx}"),
-        )
+        if self.match_token(TokenKind::RBrace) {
+            return Ok(());
+        }
+        Err(self.error_here(&format!("Expected '}}' {ctx}")))
     }
 
     pub(crate) fn expect_semicolon(
         &mut self,
         ctx: &str,
     ) -> Result<(), ParseError> {
-        self.expect_token(
-            &Token::Semicolon(self.current_location()),
-            &format!("Expected ';' {ctx}"),
-        )
+        if self.match_token(TokenKind::Semicolon) {
+            return Ok(());
+        }
+        Err(self.error_here(&format!("Expected ';' {ctx}")))
     }
 
+    /// Consume an identifier; the name is copied out of the source only here
     pub(crate) fn expect_identifier(&mut self) -> Result<String, ParseError> {
-        if let Token::Ident(name, _) = self.peek_token() {
+        if let Token::Ident(name, _) = *self.peek() {
             self.advance();
-            Ok(name)
+            Ok(name.to_string())
         } else {
-            Err(ParseError {
-                message: format!("Expected identifier, found {}", self.peek()),
-                location: self.current_location(),
-            })
+            Err(self.error_here("Expected identifier"))
         }
     }
 }
@@ -232,7 +256,7 @@ mod tests {
         let program = parser.parse_program().unwrap();
 
         assert_eq!(program.nodes.len(), 1);
-        match &program.nodes[0] {
+        match &program.ast[program.nodes[0]] {
             AstNode::FunctionDef {
                 name,
                 params,
@@ -268,6 +292,29 @@ mod tests {
         assert_eq!(program.nodes.len(), 1);
     }
 
+    #[test]
+    fn test_parse_cast_vs_parenthesized() {
+        let source = "int main() { return (int)(1 + 2); }";
+        let mut parser = Parser::new(source).unwrap();
+        let program = parser.parse_program().unwrap();
+
+        let ast = &program.ast;
+        let AstNode::FunctionDef { body, .. } = &ast[program.nodes[0]] else {
+            panic!("Expected function definition");
+        };
+        match &ast[body[0]] {
+            AstNode::Return {
+                expr: Some(expr), ..
+            } => match &ast[*expr] {
+                AstNode::Cast { expr, .. } => {
+                    assert!(matches!(ast[*expr], AstNode::BinaryOp { .. }))
+                }
+                other => panic!("Expected cast, got {:?}", other),
+            },
+            other => panic!("Expected return, got {:?}", other),
+        }
+    }
+
     #[test]
     fn test_parse_struct() {
         let source = "struct Point { int x; int y; };";
@@ -275,7 +322,7 @@ mod tests {
         let program = parser.parse_program().unwrap();
 
         assert_eq!(program.nodes.len(), 1);
-        match &program.nodes[0] {
+        match &program.ast[program.nodes[0]] {
             AstNode::StructDef { name, fields, .. } => {
                 assert_eq!(name, "Point");
                 assert_eq!(fields.len(), 2);
@@ -283,4 +330,26 @@ mod tests {
             _ => panic!("Expected struct definition"),
         }
     }
+
+    #[test]
+    fn test_children_precede_parents() {
+        let source =
+            "int f(int a) { return a + 1; } int main() { return f(2); }";
+        let mut parser = Parser::new(source).unwrap();
+        let program = parser.parse_program().unwrap();
+
+        let mut previous = None;
+        for &id in &program.nodes {
+            // Each function occupies a contiguous run ending at its own node
+            if let Some(previous) = previous {
+                assert!(previous < id);
+            }
+            previous = Some(id);
+        }
+        for (id, node) in program.ast.iter() {
+            if let AstNode::BinaryOp { left, right, .. } = node {
+                assert!(*left < id && *right < id);
+            }
+        }
+    }
 }
@@ -19,19 +19,17 @@
 //! All parsing methods are implemented as `pub(crate)` methods on the [`Parser`] struct.
 
 use crate::parser::ast::*;
-use crate::parser::lexer::Token;
+use crate::parser::lexer::TokenKind;
 use crate::parser::parse::{ParseError, Parser};
 
-impl Parser {
+impl Parser<'_> {
     /// Parse block statements (inside braces, excluding the braces themselves)
     pub(crate) fn parse_block_statements(
         &mut self,
-    ) -> Result<Vec<AstNode>, ParseError> {
+    ) -> Result<Vec<NodeId>, ParseError> {
         let mut statements = Vec::new();
 
-        while !self.check(&Token::RBrace(self.current_location()))
-            && !self.is_at_end()
-        {
+        while !self.check(TokenKind::RBrace) && !self.is_at_end() {
             statements.push(self.parse_statement()?);
         }
 
@@ -39,91 +37,83 @@ impl Parser {
     }
 
     /// Parse a statement
-    pub(crate) fn parse_statement(&mut self) -> Result<AstNode, ParseError> {
+    pub(crate) fn parse_statement(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.current_location();
 
         // Check for keywords first
-        if self.match_token(&Token::Return(loc)) {
+        if self.match_token(TokenKind::Return) {
             return self.parse_return_statement();
         }
 
-        if self.match_token(&Token::If(loc)) {
+        if self.match_token(TokenKind::If) {
             return self.parse_if_statement();
         }
 
-        if self.match_token(&Token::While(loc)) {
+        if self.match_token(TokenKind::While) {
             return self.parse_while_statement();
         }
 
-        if self.match_token(&Token::Do(loc)) {
+        if self.match_token(TokenKind::Do) {
             return self.parse_do_while_statement();
         }
 
-        if self.match_token(&Token::For(loc)) {
+        if self.match_token(TokenKind::For) {
             return self.parse_for_statement();
         }
 
-        if self.match_token(&Token::Switch(loc)) {
+        if self.match_token(TokenKind::Switch) {
             return self.parse_switch_statement();
         }
 
-        if self.match_token(&Token::Break(loc)) {
+        if self.match_token(TokenKind::Break) {
             self.expect_token(
-                &Token::Semicolon(self.current_location()),
+                TokenKind::Semicolon,
                 "Expected ';' after 'break'",
             )?;
-            return Ok(AstNode::Break { location: loc });
+            return Ok(self.alloc(AstNode::Break { location: loc }));
         }
 
-        if self.match_token(&Token::Continue(loc)) {
+        if self.match_token(TokenKind::Continue) {
             self.expect_token(
-                &Token::Semicolon(self.current_location()),
+                TokenKind::Semicolon,
                 "Expected ';' after 'continue'",
             )?;
-            return Ok(AstNode::Continue { location: loc });
+            return Ok(self.alloc(AstNode::Continue { location: loc }));
         }
 
-        if self.match_token(&Token::Goto(loc)) {
+        if self.match_token(TokenKind::Goto) {
             let label = self.expect_identifier()?;
             self.expect_token(
-                &Token::Semicolon(self.current_location()),
+                TokenKind::Semicolon,
                 "Expected ';' after 'goto'",
             )?;
-            return Ok(AstNode::Goto {
+            return Ok(self.alloc(AstNode::Goto {
                 label,
                 location: loc,
-            });
+            }));
         }
 
-        if self.match_token(&Token::LBrace(loc)) {
+        if self.match_token(TokenKind::LBrace) {
             let statements = self.parse_block_statements()?;
-            self.expect_token(
-                &Token::RBrace(self.current_location()),
-                "Expected '}' after block",
-            )?;
-            return Ok(AstNode::Block {
+            self.expect_token(TokenKind::RBrace, "Expected '}' after block")?;
+            return Ok(self.alloc(AstNode::Block {
                 statements,
                 location: loc,
-            });
+            }));
         }
 
         // Check for label: identifier followed by colon
-        if let Token::Ident(_, _) = self.peek_token() {
-            if self
+        if self.check(TokenKind::Ident)
+            && self
                 .peek_ahead(1)
-                .map(|t| matches!(t, Token::Colon(_)))
-                .unwrap_or(false)
-            {
-                let name = self.expect_identifier()?;
-                self.expect_token(
-                    &Token::Colon(self.current_location()),
-                    "Expected ':' after label",
-                )?;
-                return Ok(AstNode::Label {
-                    name,
-                    location: loc,
-                });
-            }
+                .is_some_and(|t| t.kind() == TokenKind::Colon)
+        {
+            let name = self.expect_identifier()?;
+            self.expect_token(TokenKind::Colon, "Expected ':' after label")?;
+            return Ok(self.alloc(AstNode::Label {
+                name,
+                location: loc,
+            }));
         }
 
         // Check for variable declaration (type followed by identifier)
@@ -134,212 +124,195 @@ impl Parser {
         // Otherwise, it's an expression statement
         let expr = self.parse_expression()?;
         self.expect_token(
-            &Token::Semicolon(self.current_location()),
+            TokenKind::Semicolon,
             "Expected ';' after expression",
         )?;
-        Ok(AstNode::ExpressionStatement {
-            expr: Box::new(expr),
+        Ok(self.alloc(AstNode::ExpressionStatement {
+            expr,
             location: loc,
-        })
+        }))
     }
 
     /// Parse return statement
-    fn parse_return_statement(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_return_statement(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.previous_location();
 
-        let expr = if self.check(&Token::Semicolon(self.current_location())) {
+        let expr = if self.check(TokenKind::Semicolon) {
             None
         } else {
-            Some(Box::new(self.parse_expression()?))
+            Some(self.parse_expression()?)
         };
 
-        self.expect_token(
-            &Token::Semicolon(self.current_location()),
-            "Expected ';' after return",
-        )?;
+        self.expect_token(TokenKind::Semicolon, "Expected ';' after return")?;
 
-        Ok(AstNode::Return {
+        Ok(self.alloc(AstNode::Return {
             expr,
             location: loc,
-        })
+        }))
     }
 
     /// Parse if statement
-    fn parse_if_statement(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_if_statement(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.previous_location();
 
         self.expect_lparen("after 'if'")?;
-        let condition = Box::new(self.parse_expression()?);
+        let condition = self.parse_expression()?;
         self.expect_token(
-            &Token::RParen(self.current_location()),
+            TokenKind::RParen,
             "Expected ')' after if condition",
         )?;
 
         let then_branch = self.parse_statement_or_block()?;
 
-        let else_branch =
-            if self.match_token(&Token::Else(self.current_location())) {
-                Some(self.parse_statement_or_block()?)
-            } else {
-                None
-            };
+        let else_branch = if self.match_token(TokenKind::Else) {
+            Some(self.parse_statement_or_block()?)
+        } else {
+            None
+        };
 
-        Ok(AstNode::If {
+        Ok(self.alloc(AstNode::If {
             condition,
             then_branch,
             else_branch,
             location: loc,
-        })
+        }))
     }
 
     /// Parse while statement
-    fn parse_while_statement(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_while_statement(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.previous_location();
 
         self.expect_lparen("after 'while'")?;
-        let condition = Box::new(self.parse_expression()?);
+        let condition = self.parse_expression()?;
         self.expect_token(
-            &Token::RParen(self.current_location()),
+            TokenKind::RParen,
             "Expected ')' after while condition",
         )?;
 
         let body = self.parse_statement_or_block()?;
 
-        Ok(AstNode::While {
+        Ok(self.alloc(AstNode::While {
             condition,
             body,
             location: loc,
-        })
+        }))
     }
 
     /// Parse do-while statement
-    fn parse_do_while_statement(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_do_while_statement(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.previous_location();
 
         let body = self.parse_statement_or_block()?;
 
-        self.expect_token(
-            &Token::While(self.current_location()),
-            "Expected 'while' after do body",
-        )?;
+        self.expect_token(TokenKind::While, "Expected 'while' after do body")?;
         self.expect_lparen("after 'while'")?;
-        let condition = Box::new(self.parse_expression()?);
+        let condition = self.parse_expression()?;
         self.expect_token(
-            &Token::RParen(self.current_location()),
+            TokenKind::RParen,
             "Expected ')' after do-while condition",
         )?;
-        self.expect_token(
-            &Token::Semicolon(self.current_location()),
-            "Expected ';' after do-while",
-        )?;
+        self.expect_token(TokenKind::Semicolon, "Expected ';' after do-while")?;
 
-        Ok(AstNode::DoWhile {
+        Ok(self.alloc(AstNode::DoWhile {
             body,
             condition,
             location: loc,
-        })
+        }))
     }
 
     /// Parse for statement
-    fn parse_for_statement(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_for_statement(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.previous_location();
 
         self.expect_lparen("after 'for'")?;
 
         // Init (optional)
-        let init = if self.check(&Token::Semicolon(self.current_location())) {
+        let init = if self.check(TokenKind::Semicolon) {
             self.advance();
             None
         } else if self.is_type_keyword() {
             // Variable declaration
             let decl = self.parse_variable_declaration()?;
             // Declaration includes semicolon, so don't expect another
-            Some(Box::new(decl))
+            Some(decl)
         } else {
             // Expression
             let expr = self.parse_expression()?;
             self.expect_token(
-                &Token::Semicolon(self.current_location()),
+                TokenKind::Semicolon,
                 "Expected ';' after for init",
             )?;
-            Some(Box::new(expr))
+            Some(expr)
         };
 
         // Condition (optional)
-        let condition =
-            if self.check(&Token::Semicolon(self.current_location())) {
-                None
-            } else {
-                Some(Box::new(self.parse_expression()?))
-            };
+        let condition = if self.check(TokenKind::Semicolon) {
+            None
+        } else {
+            Some(self.parse_expression()?)
+        };
         self.expect_token(
-            &Token::Semicolon(self.current_location()),
+            TokenKind::Semicolon,
             "Expected ';' after for condition",
         )?;
 
         // Increment (optional)
-        let increment = if self.check(&Token::RParen(self.current_location())) {
+        let increment = if self.check(TokenKind::RParen) {
             None
         } else {
-            Some(Box::new(self.parse_expression()?))
+            Some(self.parse_expression()?)
         };
 
-        self.expect_token(
-            &Token::RParen(self.current_location()),
-            "Expected ')' after for clauses",
-        )?;
+        self.expect_token(TokenKind::RParen, "Expected ')' after for clauses")?;
 
         let body = self.parse_statement_or_block()?;
 
-        Ok(AstNode::For {
+        Ok(self.alloc(AstNode::For {
             init,
             condition,
             increment,
             body,
             location: loc,
-        })
+        }))
     }
 
     /// Parse switch statement
-    fn parse_switch_statement(&mut self) -> Result<AstNode, ParseError> {
+    fn parse_switch_statement(&mut self) -> Result<NodeId, ParseError> {
         let loc = self.previous_location();
 
         self.expect_lparen("after 'switch'")?;
-        let expr = Box::new(self.parse_expression()?);
+        let expr = self.parse_expression()?;
         self.expect_token(
-            &Token::RParen(self.current_location()),
+            TokenKind::RParen,
             "Expected ')' after switch expression",
         )?;
         self.expect_token(
-            &Token::LBrace(self.current_location()),
+            TokenKind::LBrace,
             "Expected '{' before switch body",
         )?;
 
         let mut cases = Vec::new();
 
-        while !self.check(&Token::RBrace(self.current_location()))
-            && !self.is_at_end()
-        {
-            if self.match_token(&Token::Case(self.current_location())) {
+        while !self.check(TokenKind::RBrace) && !self.is_at_end() {
+            if self.match_token(TokenKind::Case) {
                 let case_loc = self.previous_location(); // Capture case keyword location
                 let value = self.parse_expression()?;
                 self.expect_token(
-                    &Token::Colon(self.current_location()),
+                    TokenKind::Colon,
                     "Expected ':' after case value",
                 )?;
 
                 let statements = self.parse_case_body()?;
 
                 cases.push(CaseNode::Case {
-                    value: Box::new(value),
+                    value,
                     statements,
                     location: case_loc,
                 });
-            } else if self.match_token(&Token::Default(self.current_location()))
-            {
+            } else if self.match_token(TokenKind::Default) {
                 let default_loc = self.previous_location(); // Capture default keyword location
                 self.expect_token(
-                    &Token::Colon(self.current_location()),
+                    TokenKind::Colon,
                     "Expected ':' after 'default'",
                 )?;
 
@@ -358,23 +331,20 @@ impl Parser {
             }
         }
 
-        self.expect_token(
-            &Token::RBrace(self.current_location()),
-            "Expected '}' after switch body",
-        )?;
+        self.expect_token(TokenKind::RBrace, "Expected '}' after switch body")?;
 
-        Ok(AstNode::Switch {
+        Ok(self.alloc(AstNode::Switch {
             expr,
             cases,
             location: loc,
-        })
+        }))
     }
 
-    fn parse_case_body(&mut self) -> Result<Vec<AstNode>, ParseError> {
+    fn parse_case_body(&mut self) -> Result<Vec<NodeId>, ParseError> {
         let mut statements = Vec::new();
-        while !self.check(&Token::Case(self.current_location()))
-            && !self.check(&Token::Default(self.current_location()))
-            && !self.check(&Token::RBrace(self.current_location()))
+        while !self.check(TokenKind::Case)
+            && !self.check(TokenKind::Default)
+            && !self.check(TokenKind::RBrace)
             && !self.is_at_end()
         {
             statements.push(self.parse_statement()?);
@@ -386,14 +356,14 @@ impl Parser {
     /// Supports C-style array declarations: int arr[5];
     pub(crate) fn parse_variable_declaration(
         &mut self,
-    ) -> Result<AstNode, ParseError> {
+    ) -> Result<NodeId, ParseError> {
         let mut var_type = self.parse_type()?;
         let name = self.expect_identifier()?;
         let loc = self.previous_location();
 
         // Check for C-style array dimensions after the variable name: int arr[5];
-        while self.match_token(&Token::LBracket(self.current_location())) {
-            if self.check(&Token::RBracket(self.current_location())) {
+        while self.match_token(TokenKind::LBracket) {
+            if self.check(TokenKind::RBracket) {
                 // Unsized array []
                 var_type.array_dims.push(None);
                 self.advance();
@@ -401,7 +371,7 @@ impl Parser {
                 // Sized array [N]
                 let size_expr = self.parse_expression()?;
                 // For now, require compile-time constant (int literal)
-                if let AstNode::IntLiteral(n, _) = size_expr {
+                if let AstNode::IntLiteral(n, _) = self.ast[size_expr] {
                     var_type.array_dims.push(Some(n as usize));
                 } else {
                     return Err(ParseError {
@@ -411,41 +381,38 @@ impl Parser {
                     });
                 }
                 self.expect_token(
-                    &Token::RBracket(self.current_location()),
+                    TokenKind::RBracket,
                     "Expected ']' after array size",
                 )?;
             }
         }
 
-        let init = if self.match_token(&Token::Eq(self.current_location())) {
-            Some(Box::new(self.parse_expression()?))
+        let init = if self.match_token(TokenKind::Eq) {
+            Some(self.parse_expression()?)
         } else {
             None
         };
 
         self.expect_token(
-            &Token::Semicolon(self.current_location()),
+            TokenKind::Semicolon,
             "Expected ';' after variable declaration",
         )?;
 
-        Ok(AstNode::VarDecl {
+        Ok(self.alloc(AstNode::VarDecl {
             name,
             var_type,
             init,
             location: loc,
-        })
+        }))
     }
 
     /// Parse statement or block (for if/while/for bodies)
     pub(crate) fn parse_statement_or_block(
         &mut self,
-    ) -> Result<Vec<AstNode>, ParseError> {
-        if self.match_token(&Token::LBrace(self.current_location())) {
+    ) -> Result<Vec<NodeId>, ParseError> {
+        if self.match_token(TokenKind::LBrace) {
             let statements = self.parse_block_statements()?;
-            self.expect_token(
-                &Token::RBrace(self.current_location()),
-                "Expected '}' after block",
-            )?;
+            self.expect_token(TokenKind::RBrace, "Expected '}' after block")?;
             Ok(statements)
         } else {
             // Single statement
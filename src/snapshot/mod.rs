@@ -1,9 +1,10 @@
 // Snapshot management for reverse execution
 
 use crate::memory::{heap::Heap, stack::Stack, value::Value};
-use crate::parser::ast::{SourceLocation, Type};
-use rustc_hash::FxHashMap;
+use crate::parser::ast::SourceLocation;
 use std::collections::BTreeMap;
+use std::mem::size_of;
+use std::sync::Arc;
 
 /// Distinguishes program output (printf) from user input echoed by scanf
 #[derive(Debug, Clone, PartialEq, Eq)]
@@ -85,6 +86,32 @@ pub struct TerminalLine {
     pub kind: TerminalLineKind,
 }
 
+/// Bytes retained by execution history, per component
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct HistoryBytes {
+    /// Call frames and local variables, cloned whole per snapshot
+    pub stack: usize,
+    /// Heap pages not shared with the previous snapshot, plus block indexes
+    pub heap: usize,
+    /// Terminal lines, cloned whole per snapshot
+    pub terminal: usize,
+    /// Stack address map, return value and the snapshot record itself
+    pub side_tables: usize,
+}
+
+impl HistoryBytes {
+    pub fn total(&self) -> usize {
+        self.stack + self.heap + self.terminal + self.side_tables
+    }
+
+    fn add(&mut self, other: HistoryBytes) {
+        self.stack += other.stack;
+        self.heap += other.heap;
+        self.terminal += other.terminal;
+        self.side_tables += other.side_tables;
+    }
+}
+
 /// Snapshot of execution state
 #[derive(Debug, Clone)]
 pub struct Snapshot {
@@ -94,35 +121,55 @@ pub struct Snapshot {
     pub current_statement_index: usize, // Index into statement list
     pub source_location: SourceLocation,
     pub return_value: Option<Value>,
-    pub pointer_types: FxHashMap<u64, Type>,
     pub stack_address_map: BTreeMap<u64, (usize, String)>,
     pub next_stack_address: u64,
     pub execution_depth: usize,
 }
 
 impl Snapshot {
-    /// Estimate the memory usage of this snapshot in bytes
-    pub fn estimated_size(&self) -> usize {
-        // This is a rough estimate
-        // Stack: assume 100 bytes per frame on average
-        let stack_size = self.stack.depth() * 100;
-
-        // Heap: sum of all allocations
-        let heap_size = self.heap.total_allocated();
-
-        // Terminal: assume 50 bytes per line on average
-        let terminal_size = self.terminal.lines.len() * 50;
-
-        stack_size + heap_size + terminal_size
+    /// Bytes this snapshot holds that no earlier snapshot shares.
+    ///
+    /// Heap pages are shared copy-on-write (see the paged storage notes in
+    /// `memory::heap`), so only those created or copied since the previous
+    /// snapshot count; everything else is a full copy. The inline parts of
+    /// the stack, heap and terminal are counted with their component.
+    pub fn retained_bytes(&self) -> HistoryBytes {
+        let terminal = self
+            .terminal
+            .lines
+            .iter()
+            .map(|line| size_of::<TerminalLine>() + line.text.len())
+            .sum::<usize>();
+        let address_map = self
+            .stack_address_map
+            .values()
+            .map(|(_, name)| size_of::<(u64, (usize, String))>() + name.len())
+            .sum::<usize>();
+        let return_value = self
+            .return_value
+            .as_ref()
+            .map_or(0, |v| v.retained_bytes() - size_of::<Value>());
+        HistoryBytes {
+            stack: self.stack.retained_bytes(),
+            heap: self.heap.retained_bytes(),
+            terminal: size_of::<MockTerminal>() + terminal,
+            side_tables: size_of::<Snapshot>()
+                - size_of::<Stack>()
+                - size_of::<Heap>()
+                - size_of::<MockTerminal>()
+                + address_map
+                + return_value,
+        }
     }
 }
 
 /// Manages execution history for reverse execution
 #[derive(Debug)]
 pub struct SnapshotManager {
-    snapshots: Vec<Snapshot>,
+    /// Shared so the UI can hand snapshots to background threads
+    snapshots: Vec<Arc<Snapshot>>,
     max_memory: usize,
-    current_memory: usize,
+    retained: HistoryBytes,
 }
 
 impl SnapshotManager {
@@ -130,29 +177,37 @@ impl SnapshotManager {
         SnapshotManager {
             snapshots: Vec::new(),
             max_memory,
-            current_memory: 0,
+            retained: HistoryBytes::default(),
         }
     }
 
     /// Add a snapshot to history
     pub fn push(&mut self, snapshot: Snapshot) -> Result<(), String> {
-        let snapshot_size = snapshot.estimated_size();
+        let snapshot_bytes = snapshot.retained_bytes();
+        let current = self.retained.total();
 
-        if self.current_memory + snapshot_size > self.max_memory {
+        if current + snapshot_bytes.total() > self.max_memory {
             return Err(format!(
                 "Snapshot memory limit exceeded: {} + {} > {}",
-                self.current_memory, snapshot_size, self.max_memory
+                current,
+                snapshot_bytes.total(),
+                self.max_memory
             ));
         }
 
-        self.current_memory += snapshot_size;
-        self.snapshots.push(snapshot);
+        self.retained.add(snapshot_bytes);
+        self.snapshots.push(Arc::new(snapshot));
         Ok(())
     }
 
     /// Get a snapshot by index
     pub fn get(&self, index: usize) -> Option<&Snapshot> {
-        self.snapshots.get(index)
+        self.snapshots.get(index).map(|snapshot| &**snapshot)
+    }
+
+    /// Get a shared handle to a snapshot by index
+    pub fn get_shared(&self, index: usize) -> Option<Arc<Snapshot>> {
+        self.snapshots.get(index).cloned()
     }
 
     /// Get the number of snapshots
@@ -165,9 +220,14 @@ impl SnapshotManager {
         self.snapshots.is_empty()
     }
 
-    /// Get current memory usage
+    /// Bytes retained by all snapshots
     pub fn memory_usage(&self) -> usize {
-        self.current_memory
+        self.retained.total()
+    }
+
+    /// Bytes retained by all snapshots, per component
+    pub fn retained(&self) -> HistoryBytes {
+        self.retained
     }
 
     /// Get max memory limit
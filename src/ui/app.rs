@@ -2,8 +2,16 @@
 
 use crate::interpreter::engine::Interpreter;
 use crate::interpreter::errors::RuntimeError;
+use crate::interpreter::profiler::ProfileOrder;
+use crate::memory::access::hottest;
+use crate::memory::heap_profile::SiteOrder;
 use crate::parser::ast::SourceLocation;
 use crate::snapshot::{TerminalLine, TerminalLineKind};
+use crate::ui::model_cache::{ModelCache, ModelKey};
+use crate::ui::pointer_graph::PointerGraph;
+use crate::ui::source_text::SourceText;
+use crate::ui::value_plot::ValuePlot;
+use crate::ui::watch::{Reload, WatchEvent, Watcher};
 use crossterm::event::{self, Event, KeyCode, KeyEvent, KeyEventKind};
 use ratatui::{
     backend::Backend,
@@ -13,6 +21,33 @@ use ratatui::{
 use std::io;
 use std::time::{Duration, Instant};
 
+/// Auto-play rates in steps per second, selected with `-` / `+`
+const PLAY_SPEEDS: [u32; 13] = [
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1_000, 2_000, 5_000, 10_000,
+];
+
+/// Shortest time between auto-play frames; faster rates advance several
+/// steps per frame instead of drawing each one
+const PLAY_FRAME_INTERVAL: Duration = Duration::from_millis(33);
+
+/// Highlight windows cycled with `h`: values written in the last N steps
+/// (0 turns highlighting off)
+const CHANGE_WINDOWS: [usize; 4] = [1, 10, 100, 0];
+
+/// How often the watched file is checked while the UI is otherwise idle
+const WATCH_POLL_INTERVAL: Duration = Duration::from_millis(200);
+
+/// How often samples from the plot workers are merged while they run
+const PLOT_POLL_INTERVAL: Duration = Duration::from_millis(50);
+
+/// A run of navigation keys waiting to be applied as one seek
+struct PendingSeek {
+    first_key: KeyEvent,
+    keys: usize,
+    /// History position after the last key of the run
+    target: usize,
+}
+
 /// Which pane is currently focused
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub enum FocusedPane {
@@ -123,8 +158,8 @@ pub struct App {
     /// The interpreter instance
     pub interpreter: Interpreter,
 
-    /// The source code being executed
-    pub source_code: String,
+    /// The source code being executed, indexed by line
+    pub source: SourceText,
 
     /// Currently focused pane
     pub focused_pane: FocusedPane,
@@ -135,10 +170,16 @@ pub struct App {
     pub stack_scroll: super::panes::StackScrollState,
     /// Heap pane scroll state
     pub heap_scroll: super::panes::HeapScrollState,
+    /// Heap profile scroll state
+    pub heap_profile_scroll: super::panes::HeapProfileScrollState,
+    /// Guest profile scroll state
+    pub profile_scroll: super::panes::ProfileScrollState,
     /// Terminal scroll offset
     pub terminal_scroll: super::panes::TerminalScrollState,
     /// Input pane scroll state
     pub input_scroll: super::panes::InputScrollState,
+    /// Pointer graph scroll state
+    pub graph_scroll: super::panes::GraphScrollState,
 
     /// Whether the app should quit
     pub should_quit: bool,
@@ -155,6 +196,9 @@ pub struct App {
     /// Last time a step was taken in play mode
     pub last_play_time: Instant,
 
+    /// Index of the auto-play rate in [`PLAY_SPEEDS`]
+    pub play_speed: usize,
+
     /// Last time space was pressed (for debouncing)
     pub last_space_press: Instant,
 
@@ -166,18 +210,68 @@ pub struct App {
 
     /// All input terminal lines, preserved across snapshot navigation
     pub all_input_lines: Vec<TerminalLine>,
+
+    /// Whether the heap area shows the allocation-site profile
+    pub show_heap_profile: bool,
+
+    /// Sort order of the heap profile view
+    pub heap_profile_order: SiteOrder,
+
+    /// Whether the heap area shows the pointer graph
+    pub show_pointer_graph: bool,
+
+    /// Whether the heap area shows the per-line and per-function profile
+    /// (and the source gutter shows step counts)
+    pub show_guest_profile: bool,
+
+    /// Sort order of the guest profile view
+    pub guest_profile_order: ProfileOrder,
+
+    /// Pointer graph rows, rebuilt when the history position changes
+    pub pointer_graph: PointerGraph,
+
+    /// Source file watcher (`--watch`)
+    pub watcher: Option<Watcher>,
+
+    /// Stack and heap rows cached per history position
+    pub models: ModelCache,
+
+    /// Text typed into the "go to step" prompt; `None` when it is closed
+    pub goto_input: Option<String>,
+
+    /// Highlight values written in this many recent steps (0 for none)
+    pub change_window: usize,
+
+    /// Whether stack and heap rows are shaded by access count
+    pub show_heatmap: bool,
+
+    /// Whether the interpreter statistics line is shown above the status bar
+    pub show_stats: bool,
+
+    /// Text typed into the "plot expression" prompt; `None` when it is
+    /// closed
+    pub plot_input: Option<String>,
+
+    /// Series of the pinned expression, computed in the background
+    pub value_plot: ValuePlot,
+
+    /// Display lines of the terminal pane, kept in step with the history
+    /// position
+    pub terminal_index: super::panes::TerminalIndex,
 }
 
 impl App {
     /// Create a new app with the given interpreter and source code
     pub fn new(interpreter: Interpreter, source_code: String) -> Self {
         App {
+            models: ModelCache::new(&interpreter, &source_code),
             interpreter,
-            source_code,
+            source: SourceText::new(source_code),
             focused_pane: FocusedPane::Source,
             source_scroll: super::panes::SourceScrollState {
                 offset: 0,
                 target_line_row: None,
+                cursor_line: None,
             },
             stack_scroll: super::panes::StackScrollState {
                 offset: 0,
@@ -187,19 +281,39 @@ impl App {
                 offset: 0,
                 prev_item_count: 0,
             },
+            heap_profile_scroll: super::panes::HeapProfileScrollState {
+                offset: 0,
+            },
+            profile_scroll: super::panes::ProfileScrollState { offset: 0 },
             terminal_scroll: super::panes::TerminalScrollState { offset: 0 },
             input_scroll: super::panes::InputScrollState { offset: 0 },
+            graph_scroll: super::panes::GraphScrollState { offset: 0 },
             should_quit: false,
             status_message: String::from("Ready!"),
             error_state: None,
             is_playing: false,
             last_play_time: Instant::now(),
+            play_speed: 0,
             last_space_press: Instant::now()
                 .checked_sub(Duration::from_secs(1))
                 .unwrap_or(Instant::now()),
             scanf_input_buffer: String::new(),
             original_stdin_input: String::new(),
             all_input_lines: Vec::new(),
+            show_heap_profile: false,
+            heap_profile_order: SiteOrder::LiveBytes,
+            show_pointer_graph: false,
+            show_guest_profile: false,
+            guest_profile_order: ProfileOrder::Inclusive,
+            pointer_graph: PointerGraph::new(),
+            watcher: None,
+            goto_input: None,
+            change_window: CHANGE_WINDOWS[0],
+            show_heatmap: false,
+            show_stats: false,
+            plot_input: None,
+            value_plot: ValuePlot::new(),
+            terminal_index: super::panes::TerminalIndex::new(),
         }
     }
 
@@ -215,6 +329,12 @@ impl App {
         app
     }
 
+    /// Re-run the program whenever the watched file changes
+    pub fn with_watcher(mut self, watcher: Watcher) -> Self {
+        self.watcher = Some(watcher);
+        self
+    }
+
     /// Returns true when the TUI should present a scanf input prompt.
     ///
     /// This is the case only when we are at the very last available snapshot AND
@@ -271,80 +391,261 @@ impl App {
         // Activate scanf mode immediately if we start paused at one
         self.check_and_activate_scanf_mode();
 
+        // Redraw only when something changed: input, a resize, an auto-play
+        // step or a reload
+        let mut dirty = true;
         loop {
-            terminal.draw(|f| self.render(f))?;
+            dirty |= self.poll_watcher();
+            dirty |= self.value_plot.poll();
+            if dirty {
+                terminal.draw(|f| self.render(f))?;
+                dirty = false;
+            }
 
             if self.should_quit {
                 break;
             }
 
             // Handle auto-play mode
-            if self.is_playing {
-                // Stop playing if we hit an error or need scanf input
-                if self.error_state.is_some() || self.is_in_scanf_input_mode() {
-                    self.is_playing = false;
-                    if self.is_in_scanf_input_mode() {
-                        self.check_and_activate_scanf_mode();
-                    } else if let Some(error) = &self.error_state {
-                        self.status_message =
-                            format!("Stopped: {}", error.message());
-                    }
-                } else if self.last_play_time.elapsed()
-                    >= Duration::from_secs(1)
-                {
-                    match self.interpreter.step_forward() {
-                        Ok(()) => {
-                            self.status_message = "Playing...".to_string();
-                            self.terminal_scroll.offset = usize::MAX;
-                            self.check_and_activate_scanf_mode();
-                        }
-                        Err(e) => {
-                            if let RuntimeError::HistoryOperationFailed {
-                                message,
-                                ..
-                            } = &e
-                            {
-                                if message == "Reached end of execution" {
-                                    self.is_playing = false;
-                                    self.status_message = message.clone();
-                                    self.last_play_time = Instant::now();
-                                    return Ok(());
-                                }
-                            }
-                            self.error_state =
-                                Some(ErrorState::RuntimeError(e.clone()));
-                            self.is_playing = false;
-                            self.status_message = format!("Error: {}", e);
-                        }
-                    }
-                    self.last_play_time = Instant::now();
-                }
+            dirty |= self.advance_playback();
+
+            // Sleep until input arrives or auto-play / the watcher is due
+            let ready = match self.idle_timeout() {
+                Some(timeout) => event::poll(timeout)?,
+                None => true,
+            };
+            if !ready {
+                continue;
             }
 
-            // Use poll with timeout to allow auto-play to work
-            if event::poll(Duration::from_millis(50))? {
-                if let Event::Key(key) = event::read()? {
-                    if key.kind == KeyEventKind::Press {
-                        self.handle_key_event(key);
+            // Take everything already queued, so held-down keys are handled
+            // as one burst rather than one redraw per repeat
+            let mut keys = Vec::new();
+            loop {
+                match event::read()? {
+                    Event::Key(key) if key.kind == KeyEventKind::Press => {
+                        keys.push(key);
                     }
+                    Event::Resize(..) => dirty = true,
+                    _ => {}
                 }
+                if !event::poll(Duration::ZERO)? {
+                    break;
+                }
+            }
+            if !keys.is_empty() {
+                self.handle_key_burst(&keys);
+                dirty = true;
             }
         }
 
         Ok(())
     }
 
+    /// Advance auto-play if a frame is due, returning whether the view
+    /// changed. Playback stops, leaving the app running, at the end of
+    /// execution, on an error, or when scanf needs input.
+    pub fn advance_playback(&mut self) -> bool {
+        if !self.is_playing {
+            return false;
+        }
+        // Stop playing if we hit an error or need scanf input
+        if self.error_state.is_some() || self.is_in_scanf_input_mode() {
+            self.is_playing = false;
+            if self.is_in_scanf_input_mode() {
+                self.check_and_activate_scanf_mode();
+            } else if let Some(error) = &self.error_state {
+                self.status_message = format!("Stopped: {}", error.message());
+            }
+            return true;
+        }
+        if self.last_play_time.elapsed() < self.play_interval() {
+            return false;
+        }
+        match self.play_frame() {
+            Ok(()) => {
+                self.status_message = "Playing...".to_string();
+                self.terminal_scroll.offset = usize::MAX;
+                self.check_and_activate_scanf_mode();
+            }
+            Err(RuntimeError::HistoryOperationFailed { message, .. })
+                if message == "Reached end of execution" =>
+            {
+                self.is_playing = false;
+                self.status_message = message;
+            }
+            Err(e) => {
+                self.error_state = Some(ErrorState::RuntimeError(e.clone()));
+                self.is_playing = false;
+                self.status_message = format!("Error: {}", e);
+            }
+        }
+        self.last_play_time = Instant::now();
+        true
+    }
+
+    /// Time between auto-play frames at the current rate
+    fn play_interval(&self) -> Duration {
+        let rate = PLAY_SPEEDS[self.play_speed];
+        (Duration::from_secs(1) / rate).max(PLAY_FRAME_INTERVAL)
+    }
+
+    /// Advance auto-play by every step due since the last frame, using one
+    /// seek; at the last snapshot, step forward so the end of execution or
+    /// a pending error is reported as before
+    fn play_frame(&mut self) -> Result<(), RuntimeError> {
+        let rate = f64::from(PLAY_SPEEDS[self.play_speed]);
+        let due = self.last_play_time.elapsed().as_secs_f64() * rate;
+        let steps = (due as usize).max(1);
+        let from = self.interpreter.history_position();
+        let last = self.interpreter.total_snapshots().saturating_sub(1);
+        if from < last {
+            self.interpreter.seek((from + steps).min(last))
+        } else {
+            self.interpreter.step_forward()
+        }
+    }
+
+    /// Change the auto-play rate by `delta` entries of [`PLAY_SPEEDS`]
+    fn change_play_speed(&mut self, delta: isize) {
+        self.play_speed = self
+            .play_speed
+            .saturating_add_signed(delta)
+            .min(PLAY_SPEEDS.len() - 1);
+        self.status_message =
+            format!("Playback speed: {} steps/s", PLAY_SPEEDS[self.play_speed]);
+    }
+
+    /// Seek to the next execution of the source cursor line
+    fn run_to_cursor(&mut self) {
+        if let Some(error) = &self.error_state {
+            self.status_message = error.message();
+            return;
+        }
+        let Some(line) = self.source_scroll.cursor_line else {
+            self.status_message =
+                "Move the source cursor with j/k first".to_string();
+            return;
+        };
+        self.is_playing = false;
+        if self.interpreter.seek_next_line(line) {
+            self.status_message = format!("Ran to line {}", line);
+            self.terminal_scroll.offset = usize::MAX;
+            self.check_and_activate_scanf_mode();
+        } else {
+            self.status_message = format!("Line {} does not run again", line);
+        }
+    }
+
+    /// Move the source cursor by `delta` lines, starting from the
+    /// execution line
+    fn move_source_cursor(&mut self, delta: isize) {
+        let from = self
+            .source_scroll
+            .cursor_line
+            .unwrap_or(self.interpreter.current_location().line);
+        let line = from
+            .saturating_add_signed(delta)
+            .clamp(1, self.source.line_count().max(1));
+        self.source_scroll.cursor_line = Some(line);
+    }
+
+    /// How long the event loop may block waiting for input; `None` blocks
+    /// until the next event
+    fn idle_timeout(&self) -> Option<Duration> {
+        let play = self.is_playing.then(|| {
+            self.play_interval()
+                .saturating_sub(self.last_play_time.elapsed())
+        });
+        let watch = self.watcher.as_ref().map(|_| WATCH_POLL_INTERVAL);
+        let plot = self.value_plot.is_computing().then_some(PLOT_POLL_INTERVAL);
+        [play, watch, plot].into_iter().flatten().min()
+    }
+
+    /// Pick up edits to the watched file; returns whether anything changed
+    fn poll_watcher(&mut self) -> bool {
+        let Some(watcher) = self.watcher.as_mut() else {
+            return false;
+        };
+        match watcher.poll(&self.original_stdin_input) {
+            None => return false,
+            Some(WatchEvent::Started) => {
+                self.status_message = "Source changed, re-running…".to_string();
+            }
+            Some(WatchEvent::ParseError { source, error }) => {
+                self.is_playing = false;
+                self.source = SourceText::new(source);
+                self.models =
+                    ModelCache::new(&self.interpreter, self.source.as_str());
+                self.pointer_graph.invalidate();
+                self.value_plot.invalidate(&self.interpreter);
+                self.terminal_index.invalidate();
+                self.status_message = error.message();
+                self.error_state = Some(error);
+            }
+            Some(WatchEvent::Reloaded(reload)) => self.apply_reload(*reload),
+        }
+        true
+    }
+
+    /// Switch to a re-executed program, staying on the same source line
+    fn apply_reload(&mut self, reload: Reload) {
+        let line = self.interpreter.current_location().line;
+        let visit = self.interpreter.line_visit();
+
+        self.interpreter = reload.interpreter;
+        self.source = SourceText::new(reload.source);
+        self.models = ModelCache::new(&self.interpreter, self.source.as_str());
+        self.pointer_graph.invalidate();
+        self.value_plot.invalidate(&self.interpreter);
+        self.terminal_index.invalidate();
+        self.error_state = None;
+        self.is_playing = false;
+
+        // Input lines are collected at the end of the run
+        let _ = self.interpreter.jump_to_end();
+        self.sync_input_lines();
+        if !self.interpreter.seek_line(line, visit) {
+            let _ = self.interpreter.rewind_to_start();
+        }
+        self.terminal_scroll.offset = usize::MAX;
+        self.status_message = format!(
+            "Reloaded in {} ms ({} changed, {} unchanged)",
+            reload.elapsed.as_millis(),
+            reload.reparsed,
+            reload.reused
+        );
+        self.check_and_activate_scanf_mode();
+    }
+
     /// Render the UI
     fn render(&mut self, frame: &mut Frame) {
         let size = frame.area();
 
+        let status_height = if self.show_stats { 2 } else { 1 };
         let main_chunks = Layout::default()
             .direction(Direction::Vertical)
-            .constraints([Constraint::Min(0), Constraint::Length(1)])
+            .constraints([
+                Constraint::Min(0),
+                Constraint::Length(status_height),
+            ])
             .split(size);
 
         let pane_area = main_chunks[0];
-        let status_area = main_chunks[1];
+        let status_area = if self.show_stats {
+            let rows = Layout::default()
+                .direction(Direction::Vertical)
+                .constraints([Constraint::Length(1), Constraint::Length(1)])
+                .split(main_chunks[1]);
+            super::panes::render_stats_line(
+                frame,
+                rows[0],
+                &self.interpreter.stats(),
+            );
+            rows[1]
+        } else {
+            main_chunks[1]
+        };
 
         let columns = Layout::default()
             .direction(Direction::Horizontal)
@@ -381,15 +682,41 @@ impl App {
             (left_rows[1], None)
         };
 
+        // A pinned expression's plot sits under the source
+        let source_area = match self.value_plot.series() {
+            Some(series) => {
+                let chunks = Layout::default()
+                    .direction(Direction::Vertical)
+                    .constraints([
+                        Constraint::Min(0),
+                        Constraint::Length(super::panes::PLOT_PANE_HEIGHT),
+                    ])
+                    .split(left_rows[0]);
+                super::panes::render_plot_pane(
+                    frame,
+                    chunks[1],
+                    super::panes::PlotRenderData {
+                        series,
+                        position: self.interpreter.history_position(),
+                    },
+                );
+                chunks[0]
+            }
+            None => left_rows[0],
+        };
+
         super::panes::render_source_pane(
             frame,
-            left_rows[0],
+            source_area,
             super::panes::SourceRenderData {
-                source_code: &self.source_code,
+                source: &self.source,
                 current_line: self.interpreter.current_location().line,
                 is_error: self.error_state.as_ref().is_some(),
                 is_scanf: self.is_in_scanf_input_mode(),
                 is_focused: self.focused_pane == FocusedPane::Source,
+                profile: self
+                    .show_guest_profile
+                    .then(|| self.interpreter.guest_profile()),
                 scroll_state: &mut self.source_scroll,
             },
         );
@@ -400,6 +727,7 @@ impl App {
             terminal_area,
             super::panes::TerminalRenderData {
                 terminal: self.interpreter.terminal(),
+                index: &mut self.terminal_index,
                 is_focused: self.focused_pane == FocusedPane::Terminal,
                 scroll_state: &mut self.terminal_scroll,
                 is_scanf_input: scanf_mode,
@@ -422,7 +750,7 @@ impl App {
                     all_input_lines: &self.all_input_lines,
                     active_count: active_input_count,
                     is_focused: self.focused_pane == FocusedPane::Input,
-                    source_code: &self.source_code,
+                    source: &self.source,
                     scroll_state: &mut self.input_scroll,
                 },
             );
@@ -437,39 +765,110 @@ impl App {
             ])
             .split(columns[1]);
 
+        // Stack and heap rows prebuilt for this history position, if any
+        let error_address =
+            self.error_state.as_ref().and_then(|e| e.memory_address());
+        let position = self.interpreter.history_position();
+        let key = ModelKey {
+            position,
+            stack_width: right_rows[0].width,
+            heap_width: right_rows[1].width,
+            error_address,
+            change_window: self.change_window,
+            heatmap: self.show_heatmap,
+        };
+        let model = if position < self.interpreter.total_snapshots() {
+            let model = self.models.get(key);
+            self.models.prefetch(&self.interpreter, key);
+            model
+        } else {
+            None
+        };
+        let heat_max = self.show_heatmap.then(|| {
+            hottest(self.interpreter.stack(), self.interpreter.heap())
+        });
+
         super::panes::render_stack_pane(
             frame,
             right_rows[0],
             super::panes::StackRenderData {
-                stack: self.interpreter.stack(),
-                struct_defs: self.interpreter.struct_defs(),
-                source_code: &self.source_code,
-                return_value: self.interpreter.return_value(),
-                function_defs: self.interpreter.function_defs(),
-                error_address: self
-                    .error_state
-                    .as_ref()
-                    .and_then(|e| e.memory_address()),
+                content: super::panes::StackContent {
+                    stack: self.interpreter.stack(),
+                    struct_defs: self.interpreter.struct_defs(),
+                    source: &self.source,
+                    return_value: self.interpreter.return_value(),
+                    function_defs: self.interpreter.function_defs(),
+                    error_address,
+                    changed_since: key.changed_since(),
+                    heat_max,
+                },
+                cached_rows: model.as_ref().and_then(|m| m.stack.as_deref()),
                 is_focused: self.focused_pane == FocusedPane::Stack,
                 scroll_state: &mut self.stack_scroll,
             },
         );
 
-        super::panes::render_heap_pane(
-            frame,
-            right_rows[1],
-            super::panes::HeapRenderData {
-                heap: self.interpreter.heap(),
-                pointer_types: self.interpreter.pointer_types(),
-                struct_defs: self.interpreter.struct_defs(),
-                error_address: self
-                    .error_state
-                    .as_ref()
-                    .and_then(|e| e.memory_address()),
-                is_focused: self.focused_pane == FocusedPane::Heap,
-                scroll_state: &mut self.heap_scroll,
-            },
-        );
+        if self.show_pointer_graph {
+            self.pointer_graph.update(&self.interpreter);
+            super::panes::render_graph_pane(
+                frame,
+                right_rows[1],
+                super::panes::GraphRenderData {
+                    rows: self.pointer_graph.rows(),
+                    heap: self.interpreter.heap(),
+                    stack: self.interpreter.stack(),
+                    struct_defs: self.interpreter.struct_defs(),
+                    is_focused: self.focused_pane == FocusedPane::Heap,
+                    scroll_state: &mut self.graph_scroll,
+                },
+            );
+        } else if self.show_guest_profile {
+            super::panes::render_profile_pane(
+                frame,
+                right_rows[1],
+                super::panes::ProfileRenderData {
+                    profile: self.interpreter.guest_profile(),
+                    source: &self.source,
+                    order: self.guest_profile_order,
+                    is_focused: self.focused_pane == FocusedPane::Heap,
+                    scroll_state: &mut self.profile_scroll,
+                },
+            );
+        } else if self.show_heap_profile {
+            let at_exit = self.interpreter.is_execution_complete()
+                && self.interpreter.history_position() + 1
+                    >= self.interpreter.total_snapshots();
+            super::panes::render_heap_profile_pane(
+                frame,
+                right_rows[1],
+                super::panes::HeapProfileRenderData {
+                    profile: self.interpreter.heap_profile(),
+                    heap: self.interpreter.heap(),
+                    source: &self.source,
+                    order: self.heap_profile_order,
+                    at_exit,
+                    is_focused: self.focused_pane == FocusedPane::Heap,
+                    scroll_state: &mut self.heap_profile_scroll,
+                },
+            );
+        } else {
+            super::panes::render_heap_pane(
+                frame,
+                right_rows[1],
+                super::panes::HeapRenderData {
+                    content: super::panes::HeapContent {
+                        heap: self.interpreter.heap(),
+                        struct_defs: self.interpreter.struct_defs(),
+                        error_address,
+                        changed_since: key.changed_since(),
+                        heat_max,
+                    },
+                    cached_rows: model.as_ref().and_then(|m| m.heap.as_deref()),
+                    is_focused: self.focused_pane == FocusedPane::Heap,
+                    scroll_state: &mut self.heap_scroll,
+                },
+            );
+        }
 
         super::panes::render_status_bar(
             frame,
@@ -478,13 +877,197 @@ impl App {
                 message: &self.status_message,
                 current_step: self.interpreter.history_position(),
                 total_steps: self.total_steps_display(),
+                history_len: self.interpreter.total_snapshots(),
+                goto_input: self.goto_input.as_deref(),
+                plot_input: self.plot_input.as_deref(),
                 error_state: self.error_state.as_ref(),
                 is_playing: self.is_playing,
+                play_speed: PLAY_SPEEDS[self.play_speed],
                 is_scanf_input: scanf_mode,
             },
         );
     }
 
+    /// Handle a burst of queued key presses.
+    ///
+    /// Runs of history navigation keys (arrows and digit steps) are folded
+    /// into a single seek to where they would have ended up; every other key
+    /// is handled on its own.
+    fn handle_key_burst(&mut self, keys: &[KeyEvent]) {
+        let mut pending: Option<PendingSeek> = None;
+        for &key in keys {
+            let from = pending
+                .as_ref()
+                .map_or(self.interpreter.history_position(), |p| p.target);
+            match self.navigation_target(from, key) {
+                Some(target) => {
+                    let seek = pending.get_or_insert(PendingSeek {
+                        first_key: key,
+                        keys: 0,
+                        target,
+                    });
+                    seek.keys += 1;
+                    seek.target = target;
+                }
+                None => {
+                    if let Some(seek) = pending.take() {
+                        self.apply_seek(seek);
+                    }
+                    self.handle_key_event(key);
+                }
+            }
+        }
+        if let Some(seek) = pending {
+            self.apply_seek(seek);
+        }
+    }
+
+    /// History position a navigation key moves to from `from`, if it is a
+    /// plain move inside the recorded history (no error, scanf prompt or
+    /// end-of-history message to show)
+    fn navigation_target(&self, from: usize, key: KeyEvent) -> Option<usize> {
+        if self.error_state.is_some()
+            || self.goto_input.is_some()
+            || self.plot_input.is_some()
+        {
+            return None;
+        }
+        let last = self.interpreter.total_snapshots().checked_sub(1)?;
+        if from == last && self.interpreter.is_paused_at_scanf() {
+            // Keys go to the scanf prompt
+            return None;
+        }
+        let target = match key.code {
+            KeyCode::Right => from + 1,
+            KeyCode::Left => from.checked_sub(1)?,
+            KeyCode::Char(c @ '1'..='9') => from + c.to_digit(10)? as usize,
+            KeyCode::Char(']') => from + self.scrub_stride(),
+            KeyCode::Char('[') => from.checked_sub(self.scrub_stride())?,
+            _ => return None,
+        };
+        (target <= last).then_some(target)
+    }
+
+    /// Move to the end of a run of navigation keys with one restore
+    fn apply_seek(&mut self, seek: PendingSeek) {
+        if seek.keys == 1 {
+            // A lone key behaves exactly as it always has
+            self.handle_key_event(seek.first_key);
+            return;
+        }
+
+        let from = self.interpreter.history_position();
+        let message = if seek.target >= from {
+            format!("Stepped forward {} step(s)", seek.target - from)
+        } else {
+            format!("Stepped backward {} step(s)", from - seek.target)
+        };
+        self.seek_to(seek.target, message);
+    }
+
+    /// Jump straight to history position `target` with a single restore
+    fn seek_to(&mut self, target: usize, message: String) {
+        self.is_playing = false;
+        if let Err(e) = self.interpreter.seek(target) {
+            self.status_message = e.to_string();
+            return;
+        }
+        self.status_message = message;
+        self.terminal_scroll.offset = usize::MAX;
+        self.check_and_activate_scanf_mode();
+    }
+
+    /// Steps covered by one cell of the status bar scrubber
+    fn scrub_stride(&self) -> usize {
+        (self.interpreter.total_snapshots() / super::panes::SCRUBBER_WIDTH)
+            .max(1)
+    }
+
+    /// Move one scrubber cell forward or backward, clamped to the history
+    fn scrub(&mut self, forward: bool) {
+        if let Some(error) = &self.error_state {
+            self.status_message = error.message();
+            return;
+        }
+        let Some(last) = self.interpreter.total_snapshots().checked_sub(1)
+        else {
+            return;
+        };
+        let from = self.interpreter.history_position();
+        let target = if forward {
+            (from + self.scrub_stride()).min(last)
+        } else {
+            from.saturating_sub(self.scrub_stride())
+        };
+        self.seek_to(target, format!("Scrubbed to step {}", target + 1));
+    }
+
+    /// Handle a key while the "go to step" prompt is open
+    fn handle_goto_key(&mut self, key: KeyEvent) {
+        let Some(input) = self.goto_input.as_mut() else {
+            return;
+        };
+        match key.code {
+            KeyCode::Char(c @ ('0'..='9' | '%')) => input.push(c),
+            KeyCode::Backspace => {
+                input.pop();
+            }
+            KeyCode::Esc => {
+                self.goto_input = None;
+                self.status_message = "Go to step cancelled".to_string();
+            }
+            KeyCode::Enter => {
+                let input = self.goto_input.take().unwrap_or_default();
+                let total = self.interpreter.total_snapshots();
+                match parse_step_target(&input, total) {
+                    Some(target) => self.seek_to(
+                        target,
+                        format!("Jumped to step {}", target + 1),
+                    ),
+                    None => {
+                        self.status_message =
+                            format!("Invalid step \"{}\"", input);
+                    }
+                }
+            }
+            _ => {}
+        }
+    }
+
+    /// Handle a key while the "plot expression" prompt is open
+    fn handle_plot_key(&mut self, key: KeyEvent) {
+        let Some(input) = self.plot_input.as_mut() else {
+            return;
+        };
+        match key.code {
+            KeyCode::Char(c) => input.push(c),
+            KeyCode::Backspace => {
+                input.pop();
+            }
+            KeyCode::Esc => {
+                self.plot_input = None;
+                self.status_message = "Plot cancelled".to_string();
+            }
+            KeyCode::Enter => {
+                let input = self.plot_input.take().unwrap_or_default();
+                let expression = input.trim();
+                if expression.is_empty() {
+                    self.value_plot.unpin();
+                    self.status_message = "Plot cleared".to_string();
+                    return;
+                }
+                self.status_message = match self
+                    .value_plot
+                    .pin(&self.interpreter, expression)
+                {
+                    Ok(()) => format!("Plotting {}", expression),
+                    Err(e) => format!("Cannot plot \"{}\": {}", expression, e),
+                };
+            }
+            _ => {}
+        }
+    }
+
     /// Handle keyboard events
     fn handle_key_event(&mut self, key: KeyEvent) {
         // ── scanf input mode ──────────────────────────────────────────────────
@@ -498,7 +1081,13 @@ impl App {
                         }
                         self.original_stdin_input.push_str(&input);
                     }
-                    match self.interpreter.provide_scanf_input(input) {
+                    let result = self.interpreter.provide_scanf_input(input);
+                    // The history after the prompt was recorded again
+                    self.models.invalidate();
+                    self.pointer_graph.invalidate();
+                    self.value_plot.invalidate(&self.interpreter);
+                    self.terminal_index.invalidate();
+                    match result {
                         Ok(()) => {
                             // Capture any new input lines from the terminal
                             self.sync_input_lines();
@@ -538,32 +1127,90 @@ impl App {
             }
         }
 
+        // ── go to step prompt ─────────────────────────────────────────────────
+        if self.goto_input.is_some() {
+            self.handle_goto_key(key);
+            return;
+        }
+
+        // ── plot expression prompt ────────────────────────────────────────────
+        if self.plot_input.is_some() {
+            self.handle_plot_key(key);
+            return;
+        }
+
         // ── normal mode ───────────────────────────────────────────────────────
         match key.code {
             KeyCode::Char('q') | KeyCode::Char('Q') => {
                 self.should_quit = true;
             }
-            // Number keys step forward N times directly
+            // Number keys jump N steps forward with one seek
             KeyCode::Char(c @ '1'..='9') => {
                 if let Some(error) = &self.error_state {
                     self.status_message = error.message();
                     return;
                 }
 
+                let n = c.to_digit(10).unwrap_or(0) as usize;
+                let from = self.interpreter.history_position();
+                let last = self.interpreter.total_snapshots().saturating_sub(1);
+                let target = (from + n).min(last).max(from);
+                self.seek_to(
+                    target,
+                    format!("Stepped forward {} step(s)", target - from),
+                );
+            }
+            KeyCode::Char('g') | KeyCode::Char('G') => {
                 self.is_playing = false;
-                let n = c.to_digit(10).unwrap() as usize;
-                let mut stepped = 0;
-                for _ in 0..n {
-                    if self.interpreter.step_forward().is_ok() {
-                        stepped += 1;
-                    } else {
-                        break;
-                    }
-                }
-                self.status_message =
-                    format!("Stepped forward {} step(s)", stepped);
-                self.terminal_scroll.offset = usize::MAX;
-                self.check_and_activate_scanf_mode();
+                self.goto_input = Some(String::new());
+            }
+            KeyCode::Char('e') | KeyCode::Char('E') => {
+                self.is_playing = false;
+                let pinned = self.value_plot.series().map(|s| &s.expression);
+                self.plot_input = Some(pinned.cloned().unwrap_or_default());
+            }
+            KeyCode::Char(']') => self.scrub(true),
+            KeyCode::Char('[') => self.scrub(false),
+            KeyCode::Char('+') | KeyCode::Char('=') => {
+                self.change_play_speed(1)
+            }
+            KeyCode::Char('-') | KeyCode::Char('_') => {
+                self.change_play_speed(-1)
+            }
+            KeyCode::Char('j') if self.focused_pane == FocusedPane::Source => {
+                self.move_source_cursor(1)
+            }
+            KeyCode::Char('k') if self.focused_pane == FocusedPane::Source => {
+                self.move_source_cursor(-1)
+            }
+            KeyCode::Char('c') | KeyCode::Char('C') => self.run_to_cursor(),
+            KeyCode::Char('h') | KeyCode::Char('H') => {
+                let next = CHANGE_WINDOWS
+                    .iter()
+                    .position(|&w| w == self.change_window)
+                    .map_or(0, |i| (i + 1) % CHANGE_WINDOWS.len());
+                self.change_window = CHANGE_WINDOWS[next];
+                self.status_message = match self.change_window {
+                    0 => "Change highlighting off".to_string(),
+                    1 => "Highlighting values changed by the last step"
+                        .to_string(),
+                    n => format!(
+                        "Highlighting values changed in the last {} steps",
+                        n
+                    ),
+                };
+            }
+            KeyCode::Char('m') | KeyCode::Char('M') => {
+                self.show_heatmap = !self.show_heatmap;
+                self.status_message = if self.show_heatmap {
+                    "Access heatmap on".to_string()
+                } else {
+                    "Access heatmap off".to_string()
+                };
+            }
+            KeyCode::Esc if self.source_scroll.cursor_line.is_some() => {
+                self.source_scroll.cursor_line = None;
+                self.status_message = "Source cursor cleared".to_string();
             }
             KeyCode::Char('s') | KeyCode::Char('S') => {
                 self.is_playing = false;
@@ -573,6 +1220,64 @@ impl App {
                 self.is_playing = false;
                 self.step_back_over();
             }
+            KeyCode::Char('p') | KeyCode::Char('P') => {
+                self.show_heap_profile = !self.show_heap_profile;
+                self.show_pointer_graph = false;
+                self.show_guest_profile = false;
+                self.status_message = if self.show_heap_profile {
+                    "Heap profile view".to_string()
+                } else {
+                    "Heap memory view".to_string()
+                };
+            }
+            KeyCode::Char('v') | KeyCode::Char('V') => {
+                self.show_pointer_graph = !self.show_pointer_graph;
+                self.show_heap_profile = false;
+                self.show_guest_profile = false;
+                self.status_message = if self.show_pointer_graph {
+                    "Pointer graph view".to_string()
+                } else {
+                    "Heap memory view".to_string()
+                };
+            }
+            KeyCode::Char('i') | KeyCode::Char('I') => {
+                self.show_stats = !self.show_stats;
+                self.status_message = if self.show_stats {
+                    "Statistics on".to_string()
+                } else {
+                    "Statistics off".to_string()
+                };
+            }
+            KeyCode::Char('f') | KeyCode::Char('F') => {
+                self.show_guest_profile = !self.show_guest_profile;
+                self.show_heap_profile = false;
+                self.show_pointer_graph = false;
+                self.status_message = if self.show_guest_profile {
+                    "Guest profile view".to_string()
+                } else {
+                    "Heap memory view".to_string()
+                };
+            }
+            KeyCode::Char('o') | KeyCode::Char('O')
+                if self.show_guest_profile =>
+            {
+                self.guest_profile_order = self.guest_profile_order.next();
+                self.profile_scroll.offset = 0;
+                self.status_message = format!(
+                    "Guest profile sorted by {}",
+                    self.guest_profile_order.label()
+                );
+            }
+            KeyCode::Char('o') | KeyCode::Char('O')
+                if self.show_heap_profile =>
+            {
+                self.heap_profile_order = self.heap_profile_order.next();
+                self.heap_profile_scroll.offset = 0;
+                self.status_message = format!(
+                    "Heap profile sorted by {}",
+                    self.heap_profile_order.label()
+                );
+            }
             KeyCode::Tab => {
                 let has_input = self.has_scanf_input();
                 self.focused_pane = self.focused_pane.next(has_input);
@@ -602,6 +1307,18 @@ impl App {
                             self.stack_scroll.offset.saturating_sub(1);
                     }
                 }
+                FocusedPane::Heap if self.show_pointer_graph => {
+                    self.graph_scroll.offset =
+                        self.graph_scroll.offset.saturating_sub(1);
+                }
+                FocusedPane::Heap if self.show_guest_profile => {
+                    self.profile_scroll.offset =
+                        self.profile_scroll.offset.saturating_sub(1);
+                }
+                FocusedPane::Heap if self.show_heap_profile => {
+                    self.heap_profile_scroll.offset =
+                        self.heap_profile_scroll.offset.saturating_sub(1);
+                }
                 FocusedPane::Heap => {
                     if self.heap_scroll.offset > 0 {
                         self.heap_scroll.offset =
@@ -632,6 +1349,18 @@ impl App {
                     self.stack_scroll.offset =
                         self.stack_scroll.offset.saturating_add(1);
                 }
+                FocusedPane::Heap if self.show_pointer_graph => {
+                    self.graph_scroll.offset =
+                        self.graph_scroll.offset.saturating_add(1);
+                }
+                FocusedPane::Heap if self.show_guest_profile => {
+                    self.profile_scroll.offset =
+                        self.profile_scroll.offset.saturating_add(1);
+                }
+                FocusedPane::Heap if self.show_heap_profile => {
+                    self.heap_profile_scroll.offset =
+                        self.heap_profile_scroll.offset.saturating_add(1);
+                }
                 FocusedPane::Heap => {
                     self.heap_scroll.offset =
                         self.heap_scroll.offset.saturating_add(1);
@@ -652,7 +1381,7 @@ impl App {
                     self.is_playing = !self.is_playing;
                     if self.is_playing {
                         self.last_play_time = Instant::now()
-                            .checked_sub(Duration::from_secs(1))
+                            .checked_sub(self.play_interval())
                             .unwrap_or(Instant::now());
                         self.status_message = "Playing...".to_string();
                     } else {
@@ -667,14 +1396,7 @@ impl App {
                 }
 
                 self.is_playing = false;
-                let total = self.interpreter.total_snapshots();
-                if total > 0 {
-                    while self.interpreter.history_position() + 1 < total {
-                        if self.interpreter.step_forward().is_err() {
-                            break;
-                        }
-                    }
-                }
+                let _ = self.interpreter.jump_to_end();
                 self.status_message = "Jumped to end".to_string();
                 self.terminal_scroll.offset = usize::MAX;
                 self.check_and_activate_scanf_mode();
@@ -802,3 +1524,20 @@ impl App {
         }
     }
 }
+
+/// History position named by a "go to step" entry: a 1-based step number,
+/// or a percentage of the run when it ends in `%`. Steps past the end are
+/// clamped to the last one.
+fn parse_step_target(input: &str, total: usize) -> Option<usize> {
+    let last = total.checked_sub(1)?;
+    match input.strip_suffix('%') {
+        Some(percent) => {
+            let percent: usize = percent.parse().ok()?;
+            Some(last * percent.min(100) / 100)
+        }
+        None => {
+            let step: usize = input.parse().ok()?;
+            Some(step.saturating_sub(1).min(last))
+        }
+    }
+}
@@ -6,6 +6,14 @@
 //! - **[`panes`]** — stateless render functions for each visible pane (source, stack,
 //!   heap, terminal, status bar)
 //! - **[`theme`]** — centralized color palette used by all panes
+//! - **[`source_text`]** — line index and syntax-highlight cache for the source
+//! - **[`model_cache`]** — stack/heap rows cached per history position, prefetched
+//!   in the background
+//! - **[`pointer_graph`]** — pointer graph of stack and heap, laid out as rows for
+//!   the graph pane
+//! - **[`value_plot`]** — value of a pinned expression at every history position,
+//!   computed by worker threads
+//! - **[`watch`]** — `--watch` support: re-parse and re-run on file changes
 //!
 //! The entry point for consumers is [`App`]: construct it with an [`Interpreter`] and
 //! call [`App::run`] to start the event loop.
@@ -14,7 +22,12 @@
 //! [`App::run`]: app::App::run
 
 pub mod app;
+pub mod model_cache;
 pub mod panes;
+pub mod pointer_graph;
+pub mod source_text;
 pub mod theme;
+pub mod value_plot;
+pub mod watch;
 
 pub use app::App;
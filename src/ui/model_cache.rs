@@ -0,0 +1,269 @@
+//! Pane models cached by history position
+//!
+//! Building the stack and heap rows formats every value, decodes heap bytes
+//! and lays out structs. [`ModelCache`] keeps the complete row lists of
+//! recently shown history positions in a small LRU, and a background thread
+//! builds them ahead of time for the positions around the cursor, so
+//! stepping back and forth (or auto-play) renders by slicing a cached list
+//! instead of formatting the interpreter state again.
+//!
+//! Panes with more than [`MAX_MODEL_ROWS`] rows are not cached; they are
+//! rendered live, which only builds the visible rows anyway.
+
+use super::panes::{
+    build_heap_rows, build_stack_rows, HeapContent, StackContent,
+};
+use super::source_text::SourceText;
+use crate::interpreter::engine::{FunctionDef, Interpreter};
+use crate::memory::access::hottest;
+use crate::parser::ast::StructDef;
+use crate::snapshot::Snapshot;
+use ratatui::widgets::ListItem;
+use rustc_hash::{FxHashMap, FxHashSet};
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::sync::Arc;
+use std::thread;
+
+/// Models kept in the LRU
+const CACHE_CAPACITY: usize = 32;
+
+/// Positions on each side of the cursor that are built ahead of time
+const PREFETCH_RADIUS: usize = 8;
+
+/// Panes with more rows than this are rendered live instead of cached
+pub const MAX_MODEL_ROWS: usize = 20_000;
+
+/// What a model depends on besides the program
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct ModelKey {
+    pub position: usize,
+    pub stack_width: u16,
+    pub heap_width: u16,
+    /// Address highlighted by the current error, if any
+    pub error_address: Option<u64>,
+    /// Number of recent steps whose writes are highlighted (0 for none)
+    pub change_window: usize,
+    /// Whether rows are shaded by access count
+    pub heatmap: bool,
+}
+
+impl ModelKey {
+    /// First history step whose writes are highlighted
+    pub fn changed_since(&self) -> Option<usize> {
+        (self.change_window > 0)
+            .then(|| (self.position + 1).saturating_sub(self.change_window))
+    }
+}
+
+/// Prebuilt rows of the stack and heap panes for one history position
+pub struct PaneModel {
+    /// `None` when the pane has more than [`MAX_MODEL_ROWS`] rows
+    pub stack: Option<Vec<ListItem<'static>>>,
+    pub heap: Option<Vec<ListItem<'static>>>,
+}
+
+struct Job {
+    generation: u64,
+    key: ModelKey,
+    snapshot: Arc<Snapshot>,
+}
+
+/// A finished job; `model` is `None` if the job was dropped as stale
+struct Built {
+    generation: u64,
+    key: ModelKey,
+    model: Option<Arc<PaneModel>>,
+}
+
+/// State the worker checks to drop jobs that are no longer wanted
+#[derive(Default)]
+struct Shared {
+    generation: AtomicU64,
+    cursor: AtomicUsize,
+}
+
+/// Program data the worker needs besides a snapshot
+struct Program {
+    struct_defs: FxHashMap<String, StructDef>,
+    function_defs: FxHashMap<String, Arc<FunctionDef>>,
+    source: SourceText,
+}
+
+/// LRU of pane models plus the background thread that fills it
+pub struct ModelCache {
+    /// Most recently used first
+    models: VecDeque<(ModelKey, Arc<PaneModel>)>,
+    /// Keys queued on the worker
+    pending: FxHashSet<ModelKey>,
+    generation: u64,
+    shared: Arc<Shared>,
+    jobs: Option<Sender<Job>>,
+    built: Receiver<Built>,
+}
+
+impl ModelCache {
+    /// Cache models for `interpreter`'s program, whose source is `source`
+    pub fn new(interpreter: &Interpreter, source: &str) -> Self {
+        let program = Program {
+            struct_defs: interpreter.struct_defs().clone(),
+            function_defs: interpreter.function_defs().clone(),
+            source: SourceText::new(source.to_string()),
+        };
+        let shared = Arc::new(Shared::default());
+        let (job_sender, job_receiver) = mpsc::channel();
+        let (built_sender, built) = mpsc::channel();
+        let worker_shared = Arc::clone(&shared);
+        // Without a worker the cache still serves models built so far
+        let jobs = thread::Builder::new()
+            .name("crustty-models".to_string())
+            .spawn(move || {
+                build_models(
+                    program,
+                    &worker_shared,
+                    job_receiver,
+                    built_sender,
+                )
+            })
+            .ok()
+            .map(|_| job_sender);
+
+        ModelCache {
+            models: VecDeque::with_capacity(CACHE_CAPACITY),
+            pending: FxHashSet::default(),
+            generation: 0,
+            shared,
+            jobs,
+            built,
+        }
+    }
+
+    /// Forget every model, e.g. after the history was re-recorded
+    pub fn invalidate(&mut self) {
+        self.generation += 1;
+        self.shared
+            .generation
+            .store(self.generation, Ordering::Relaxed);
+        self.models.clear();
+        self.pending.clear();
+    }
+
+    /// The model for `key`, if it has been built
+    pub fn get(&mut self, key: ModelKey) -> Option<Arc<PaneModel>> {
+        self.collect_built();
+        let idx = self.models.iter().position(|(k, _)| *k == key)?;
+        let entry = self.models.remove(idx)?;
+        let model = Arc::clone(&entry.1);
+        self.models.push_front(entry);
+        Some(model)
+    }
+
+    /// Queue models for the positions around `key.position` that are
+    /// neither cached nor already queued
+    pub fn prefetch(&mut self, interpreter: &Interpreter, key: ModelKey) {
+        let Some(jobs) = &self.jobs else {
+            return;
+        };
+        self.shared.cursor.store(key.position, Ordering::Relaxed);
+        let first = key.position.saturating_sub(PREFETCH_RADIUS);
+        let last = (key.position + PREFETCH_RADIUS)
+            .min(interpreter.total_snapshots().saturating_sub(1));
+
+        // Nearest positions first
+        let mut positions: Vec<usize> = (first..=last).collect();
+        positions.sort_by_key(|&p| p.abs_diff(key.position));
+        for position in positions {
+            let key = ModelKey { position, ..key };
+            if self.pending.contains(&key)
+                || self.models.iter().any(|(k, _)| *k == key)
+            {
+                continue;
+            }
+            let Some(snapshot) = interpreter.snapshot(position) else {
+                continue;
+            };
+            let job = Job {
+                generation: self.generation,
+                key,
+                snapshot,
+            };
+            if jobs.send(job).is_err() {
+                self.jobs = None;
+                return;
+            }
+            self.pending.insert(key);
+        }
+    }
+
+    /// Move finished models from the worker into the LRU
+    fn collect_built(&mut self) {
+        while let Ok(built) = self.built.try_recv() {
+            if built.generation != self.generation {
+                continue;
+            }
+            self.pending.remove(&built.key);
+            if let Some(model) = built.model {
+                self.models.push_front((built.key, model));
+                self.models.truncate(CACHE_CAPACITY);
+            }
+        }
+    }
+}
+
+/// Worker loop: build each queued model unless the cursor moved away from
+/// it or the cache was invalidated
+fn build_models(
+    program: Program,
+    shared: &Shared,
+    jobs: Receiver<Job>,
+    built: Sender<Built>,
+) {
+    for job in jobs {
+        let wanted = job.generation
+            == shared.generation.load(Ordering::Relaxed)
+            && job
+                .key
+                .position
+                .abs_diff(shared.cursor.load(Ordering::Relaxed))
+                <= PREFETCH_RADIUS;
+        let model = wanted.then(|| Arc::new(build_model(&program, &job)));
+        let done = Built {
+            generation: job.generation,
+            key: job.key,
+            model,
+        };
+        if built.send(done).is_err() {
+            return;
+        }
+    }
+}
+
+fn build_model(program: &Program, job: &Job) -> PaneModel {
+    let snapshot = &job.snapshot;
+    let heat_max = job
+        .key
+        .heatmap
+        .then(|| hottest(&snapshot.stack, &snapshot.heap));
+    let stack = StackContent {
+        stack: &snapshot.stack,
+        struct_defs: &program.struct_defs,
+        source: &program.source,
+        return_value: snapshot.return_value.as_ref(),
+        function_defs: &program.function_defs,
+        error_address: job.key.error_address,
+        changed_since: job.key.changed_since(),
+        heat_max,
+    };
+    let heap = HeapContent {
+        heap: &snapshot.heap,
+        struct_defs: &program.struct_defs,
+        error_address: job.key.error_address,
+        changed_since: job.key.changed_since(),
+        heat_max,
+    };
+    PaneModel {
+        stack: build_stack_rows(&stack, job.key.stack_width, MAX_MODEL_ROWS),
+        heap: build_heap_rows(&heap, job.key.heap_width, MAX_MODEL_ROWS),
+    }
+}
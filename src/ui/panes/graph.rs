@@ -0,0 +1,248 @@
+//! Pointer graph pane rendering
+//!
+//! Alternative view of the heap pane area that draws the rows laid out by
+//! [`PointerGraph`]: stack variables with the heap blocks they reach, one
+//! `label ─▶ target` row per pointer. Only the rows in view are formatted;
+//! block summaries (type and first scalar fields) are read from the heap as
+//! they are drawn.
+//!
+//! [`PointerGraph`]: crate::ui::pointer_graph::PointerGraph
+
+use super::utils::{
+    calculate_field_offsets, format_type_annotation, read_typed_value,
+};
+use crate::memory::heap::Heap;
+use crate::memory::stack::Stack;
+use crate::memory::value::Address;
+use crate::parser::ast::{BaseType, StructDef};
+use crate::ui::pointer_graph::{GraphRow, RowTarget};
+use crate::ui::theme::DEFAULT_THEME;
+use ratatui::{
+    layout::Rect,
+    style::{Modifier, Style},
+    text::{Line, Span},
+    widgets::{Block, Borders, List, ListItem},
+    Frame,
+};
+use std::collections::HashMap;
+use std::hash::BuildHasher;
+
+/// Deepest indentation drawn; deeper rows are shifted left
+const MAX_DRAWN_INDENT: usize = 12;
+
+/// Scalar struct fields shown in a block summary
+const SUMMARY_FIELDS: usize = 3;
+
+/// Scroll state for the pointer graph pane
+pub struct GraphScrollState {
+    pub offset: usize,
+}
+
+/// Data needed to render the pointer graph pane
+pub struct GraphRenderData<'a, T: BuildHasher> {
+    pub rows: &'a [GraphRow],
+    pub heap: &'a Heap,
+    pub stack: &'a Stack,
+    pub struct_defs: &'a HashMap<String, StructDef, T>,
+    pub is_focused: bool,
+    pub scroll_state: &'a mut GraphScrollState,
+}
+
+/// Render the pointer graph pane
+pub fn render_graph_pane<T: BuildHasher>(
+    frame: &mut Frame,
+    area: Rect,
+    data: GraphRenderData<T>,
+) {
+    let border_style = if data.is_focused {
+        Style::default()
+            .fg(DEFAULT_THEME.border_focused)
+            .add_modifier(Modifier::BOLD)
+    } else {
+        Style::default().fg(DEFAULT_THEME.border_normal)
+    };
+
+    let block = Block::default()
+        .title(" Pointer Graph ")
+        .borders(Borders::ALL)
+        .border_style(border_style);
+
+    // Clamp scroll
+    let visible_height = area.height.saturating_sub(2) as usize;
+    let max_scroll = data.rows.len().saturating_sub(visible_height);
+    data.scroll_state.offset = data.scroll_state.offset.min(max_scroll);
+
+    let items: Vec<ListItem> = if data.rows.is_empty() {
+        vec![ListItem::new("(no pointers)")
+            .style(Style::default().fg(DEFAULT_THEME.comment))]
+    } else {
+        data.rows
+            .iter()
+            .skip(data.scroll_state.offset)
+            .take(visible_height)
+            .map(|row| graph_row(row, &data))
+            .collect()
+    };
+
+    let list = List::new(items).block(block);
+    frame.render_widget(list, area);
+}
+
+fn graph_row<'a, T: BuildHasher>(
+    row: &'a GraphRow,
+    data: &GraphRenderData<T>,
+) -> ListItem<'a> {
+    let comment = Style::default().fg(DEFAULT_THEME.comment);
+    let indent = "  ".repeat(row.indent.min(MAX_DRAWN_INDENT));
+    let mut spans = vec![Span::raw(indent)];
+
+    match &row.target {
+        RowTarget::Frame(function) => {
+            spans.push(Span::styled(
+                format!("{}()", function),
+                Style::default()
+                    .fg(DEFAULT_THEME.function)
+                    .add_modifier(Modifier::BOLD),
+            ));
+            return ListItem::new(Line::from(spans));
+        }
+        RowTarget::Unreachable => {
+            spans.push(Span::styled(
+                "unreachable blocks",
+                Style::default()
+                    .fg(DEFAULT_THEME.error)
+                    .add_modifier(Modifier::BOLD),
+            ));
+            return ListItem::new(Line::from(spans));
+        }
+        RowTarget::Collapsed(count) => {
+            spans.push(Span::styled(
+                format!("⋯ {} more blocks along {} ⋯", count, row.label),
+                comment,
+            ));
+            return ListItem::new(Line::from(spans));
+        }
+        _ => {}
+    }
+
+    if !row.label.is_empty() {
+        spans.push(Span::styled(
+            row.label.as_str(),
+            Style::default().fg(DEFAULT_THEME.fg),
+        ));
+    }
+    if row.target == RowTarget::Group {
+        spans.push(Span::styled(":", Style::default().fg(DEFAULT_THEME.fg)));
+        return ListItem::new(Line::from(spans));
+    }
+    if !row.label.is_empty() {
+        spans.push(Span::styled(" ─▶ ", comment));
+    }
+
+    match &row.target {
+        RowTarget::Block { base, offset } => {
+            spans.push(address_span(*base, *offset, DEFAULT_THEME.primary));
+            spans.extend(block_summary(*base, data));
+        }
+        RowTarget::Seen { base, offset } => {
+            spans.push(Span::styled("↺ ", comment));
+            spans.push(address_span(*base, *offset, DEFAULT_THEME.comment));
+        }
+        RowTarget::Var { frame, name } => {
+            let function = data
+                .stack
+                .frames()
+                .get(*frame)
+                .map_or("?", |f| f.function_name.as_str());
+            spans.push(Span::styled(
+                format!("&{}", name),
+                Style::default().fg(DEFAULT_THEME.secondary),
+            ));
+            spans.push(Span::styled(format!(" in {}()", function), comment));
+        }
+        RowTarget::Dangling(address) => spans.push(Span::styled(
+            format!("0x{:08x} (dangling)", address),
+            Style::default()
+                .fg(DEFAULT_THEME.error)
+                .add_modifier(Modifier::BOLD),
+        )),
+        RowTarget::Unexplored(address) => spans.push(Span::styled(
+            format!("0x{:08x} (not explored)", address),
+            comment,
+        )),
+        _ => {}
+    }
+    ListItem::new(Line::from(spans))
+}
+
+fn address_span(
+    base: Address,
+    offset: usize,
+    color: ratatui::style::Color,
+) -> Span<'static> {
+    let text = if offset == 0 {
+        format!("0x{:08x}", base)
+    } else {
+        format!("0x{:08x}+{}", base, offset)
+    };
+    Span::styled(text, Style::default().fg(color))
+}
+
+/// ` type {field: value, …}` for the block at `base`
+fn block_summary<T: BuildHasher>(
+    base: Address,
+    data: &GraphRenderData<T>,
+) -> Vec<Span<'static>> {
+    let Ok((block, _)) = data.heap.block_at(base) else {
+        return Vec::new();
+    };
+    let Some(layout) = &block.layout else {
+        return vec![Span::styled(
+            format!(" ({} bytes)", block.size),
+            Style::default().fg(DEFAULT_THEME.comment),
+        )];
+    };
+
+    let elements = block.size / layout.stride.max(1);
+    let mut type_str =
+        format_type_annotation(&layout.elem_type, data.struct_defs);
+    if elements > 1 {
+        type_str = format!("{}[{}]", type_str, elements);
+    }
+    let mut spans = vec![Span::styled(
+        format!(" {}", type_str),
+        Style::default().fg(DEFAULT_THEME.type_name),
+    )];
+
+    // First few scalar fields of a single struct, e.g. `{value: 3}`
+    let typ = &layout.elem_type;
+    let struct_def = match &typ.base {
+        BaseType::Struct(name) if typ.pointer_depth == 0 && elements == 1 => {
+            data.struct_defs.get(name)
+        }
+        _ => None,
+    };
+    if let Some(def) = struct_def {
+        let fields: Vec<String> =
+            calculate_field_offsets(&def.fields, data.struct_defs)
+                .into_iter()
+                .filter(|(_, _, _, t)| {
+                    t.pointer_depth == 0 && t.array_dims.is_empty()
+                })
+                .filter(|(_, _, _, t)| !matches!(t.base, BaseType::Struct(_)))
+                .take(SUMMARY_FIELDS)
+                .filter_map(|(name, offset, size, t)| {
+                    let (bytes, init) = block.read_range(offset, size);
+                    read_typed_value(&bytes, &init, &t, data.struct_defs)
+                        .map(|v| format!("{}: {}", name, v))
+                })
+                .collect();
+        if !fields.is_empty() {
+            spans.push(Span::styled(
+                format!(" {{{}}}", fields.join(", ")),
+                Style::default().fg(DEFAULT_THEME.secondary),
+            ));
+        }
+    }
+    spans
+}
@@ -9,7 +9,11 @@
 //! - Allocation status indicators (allocated, freed, never allocated)
 //! - Typed value rendering for allocated blocks
 //! - Hex dump view for raw memory inspection
-//! - Scroll support for large heaps
+//! - Scroll support for large heaps; only the rows in view are built
+//! - Rows whose bytes were written in recent steps are highlighted, using the
+//!   heap's per-page modification stamps
+//! - Optional access heatmap: each block is shaded by how often it has been
+//!   read and written up to the current step, with the counts in its header
 //!
 //! # Display Modes
 //!
@@ -18,9 +22,12 @@
 //! - **Struct Layout**: Visualizes struct field layout with offsets
 
 use super::utils::{
-    calculate_field_offsets, format_type_annotation, read_typed_value,
+    build_all_rows, cached_window, calculate_field_offsets, changed_style,
+    follow_scroll, format_type_annotation, heat_style, read_typed_value,
+    RowSink,
 };
-use crate::memory::{heap::BlockState, heap::Heap, sizeof_type};
+use crate::memory::heap::{Heap, HeapBlock};
+use crate::memory::sizeof_type;
 use crate::parser::ast::{BaseType, StructDef, Type};
 use crate::ui::theme::DEFAULT_THEME;
 use ratatui::{
@@ -30,8 +37,10 @@ use ratatui::{
     widgets::{Block, Borders, List, ListItem},
     Frame,
 };
-
+use std::collections::HashMap;
+use std::fmt::Write;
 use std::hash::BuildHasher;
+use std::ops::Range;
 
 /// Scroll state for the heap pane
 pub struct HeapScrollState {
@@ -39,21 +48,43 @@ pub struct HeapScrollState {
     pub prev_item_count: usize,
 }
 
-/// Data needed to render the heap pane
-pub struct HeapRenderData<'a, S: BuildHasher, T: BuildHasher> {
+/// Program state shown in the heap pane
+pub struct HeapContent<'a, T: BuildHasher> {
     pub heap: &'a Heap,
-    pub pointer_types: &'a std::collections::HashMap<u64, Type, S>,
-    pub struct_defs: &'a std::collections::HashMap<String, StructDef, T>,
+    pub struct_defs: &'a HashMap<String, StructDef, T>,
     pub error_address: Option<u64>,
+    /// Highlight bytes written at this history step or later
+    pub changed_since: Option<usize>,
+    /// Color blocks by access count relative to this maximum (heatmap on)
+    pub heat_max: Option<u64>,
+}
+
+/// Data needed to render the heap pane
+pub struct HeapRenderData<'a, T: BuildHasher> {
+    pub content: HeapContent<'a, T>,
+    /// Every row of `content`, built ahead of time by [`build_heap_rows`]
+    /// for this pane width
+    pub cached_rows: Option<&'a [ListItem<'static>]>,
     pub is_focused: bool,
     pub scroll_state: &'a mut HeapScrollState,
 }
 
+/// Build every row of the heap pane for a pane `width` columns wide, or
+/// `None` if there are more than `max_rows`
+pub fn build_heap_rows<T: BuildHasher>(
+    content: &HeapContent<T>,
+    width: u16,
+    max_rows: usize,
+) -> Option<Vec<ListItem<'static>>> {
+    let layout = HeapLayout::new(content, width);
+    build_all_rows(max_rows, |rows| layout.emit(rows))
+}
+
 /// Render the heap pane
-pub fn render_heap_pane<S: BuildHasher, T: BuildHasher>(
+pub fn render_heap_pane<T: BuildHasher>(
     frame: &mut Frame,
     area: Rect,
-    data: HeapRenderData<S, T>,
+    data: HeapRenderData<T>,
 ) {
     let border_style = if data.is_focused {
         Style::default()
@@ -68,474 +99,479 @@ pub fn render_heap_pane<S: BuildHasher, T: BuildHasher>(
         .borders(Borders::ALL)
         .border_style(border_style);
 
-    let content_width = area.width.saturating_sub(2) as usize; // borders
+    let visible_height = area.height.saturating_sub(2).max(1) as usize; // Account for borders, min 1
+
+    // Auto-scroll to the bottom when a new allocation adds rows
+    let scroll = &mut *data.scroll_state;
+    let items = match data.cached_rows {
+        Some(cached) => {
+            follow_scroll(
+                &mut scroll.offset,
+                &mut scroll.prev_item_count,
+                cached.len(),
+                visible_height,
+            );
+            cached_window(cached, scroll.offset..scroll.offset + visible_height)
+        }
+        None => {
+            let layout = HeapLayout::new(&data.content, area.width);
+            follow_scroll(
+                &mut scroll.offset,
+                &mut scroll.prev_item_count,
+                layout.total_rows(),
+                visible_height,
+            );
+            let mut rows =
+                RowSink::window(scroll.offset..scroll.offset + visible_height);
+            layout.emit(&mut rows);
+            rows.into_items()
+        }
+    };
+
+    let list = List::new(items).block(block);
+    frame.render_widget(list, area);
+}
 
-    let allocations = data.heap.allocations();
-    let mut all_items = Vec::new();
+/// Heap blocks in address order with the number of rows each takes
+struct HeapLayout<'a, T: BuildHasher> {
+    ctx: BlockLayoutCtx<'a, T>,
+    /// Only live blocks are tracked, already in address order
+    blocks: Vec<(u64, &'a HeapBlock)>,
+    /// Rows per block, counted without building them
+    block_rows: Vec<usize>,
+    /// Shown instead of the blocks when there are none
+    empty_message: Option<&'static str>,
+}
 
-    if allocations.is_empty() {
-        all_items.push(
-            ListItem::new("(no allocations)")
-                .style(Style::default().fg(DEFAULT_THEME.comment)),
-        );
-    } else {
-        // Filter out tombstones (freed blocks)
-        let mut sorted_allocs: Vec<_> = allocations
+impl<'a, T: BuildHasher> HeapLayout<'a, T> {
+    fn new(content: &HeapContent<'a, T>, width: u16) -> Self {
+        let ctx = BlockLayoutCtx {
+            struct_defs: content.struct_defs,
+            error_address: content.error_address,
+            changed_since: content.changed_since,
+            heat_max: content.heat_max,
+            area_width: width as usize,
+            content_width: width.saturating_sub(2) as usize, // borders
+        };
+        let blocks: Vec<_> = content.heap.blocks().collect();
+        let block_rows = blocks
             .iter()
-            .filter(|(_, block)| block.state == BlockState::Allocated)
+            .map(|&(addr, block)| {
+                let mut counter = RowSink::counter();
+                heap_block_rows(&mut counter, addr, block, &ctx);
+                counter.rows()
+            })
             .collect();
-        sorted_allocs.sort_by_key(|(addr, _)| *addr);
+        let empty_message = if content.heap.block_count() == 0
+            && content.heap.tombstone_count() == 0
+        {
+            Some("(no allocations)")
+        } else if blocks.is_empty() {
+            Some("(no active allocations)")
+        } else {
+            None
+        };
+        HeapLayout {
+            ctx,
+            blocks,
+            block_rows,
+            empty_message,
+        }
+    }
+
+    /// Total rows; blocks are separated by a blank row
+    fn total_rows(&self) -> usize {
+        if self.blocks.is_empty() {
+            1
+        } else {
+            self.block_rows.iter().sum::<usize>() + self.blocks.len() - 1
+        }
+    }
 
-        let alloc_count = sorted_allocs.len();
+    /// Emit every row of the pane into `rows`
+    fn emit(&self, rows: &mut RowSink) {
+        if let Some(message) = self.empty_message {
+            rows.push(|| {
+                ListItem::new(message)
+                    .style(Style::default().fg(DEFAULT_THEME.comment))
+            });
+        }
 
-        if alloc_count == 0 {
-            all_items.push(
-                ListItem::new("(no active allocations)")
-                    .style(Style::default().fg(DEFAULT_THEME.comment)),
-            );
+        for (i, &(addr, block)) in self.blocks.iter().enumerate() {
+            if rows.is_full() {
+                break;
+            }
+            rows.section(self.block_rows[i], |rows| {
+                heap_block_rows(rows, addr, block, &self.ctx);
+            });
+
+            if i < self.blocks.len() - 1 {
+                rows.push(|| {
+                    ListItem::new(Line::from(Span::styled(
+                        "",
+                        Style::default().fg(DEFAULT_THEME.comment),
+                    )))
+                });
+            }
         }
+    }
+}
 
-        for (i, (addr, block)) in sorted_allocs.into_iter().enumerate() {
-            let _style = match block.state {
-                BlockState::Allocated => {
-                    Style::default().fg(DEFAULT_THEME.success)
-                }
-                BlockState::Tombstone => {
-                    Style::default().fg(DEFAULT_THEME.error)
-                }
-            };
+/// Settings shared by the rows of every heap block
+struct BlockLayoutCtx<'a, T: BuildHasher> {
+    struct_defs: &'a HashMap<String, StructDef, T>,
+    error_address: Option<u64>,
+    changed_since: Option<usize>,
+    heat_max: Option<u64>,
+    area_width: usize,
+    content_width: usize,
+}
 
-            // Build header with type annotation if available
-            let type_str = if let Some(typ) = data.pointer_types.get(addr) {
-                format_type_annotation(typ, data.struct_defs)
-            } else {
-                String::new()
-            };
+impl<T: BuildHasher> BlockLayoutCtx<'_, T> {
+    /// Row style for the bytes `range` of `block`: shaded by the block's
+    /// heat, and highlighted if they were written recently
+    fn row_style(&self, block: &HeapBlock, range: Range<usize>) -> Style {
+        heat_style(block.access, self.heat_max).patch(changed_style(
+            self.changed_since
+                .is_some_and(|step| block.modified_since(range, step)),
+        ))
+    }
+}
 
-            // Check if this address matches the error address
-            let addr_style = if Some(*addr) == data.error_address {
-                Style::default()
-                    .fg(DEFAULT_THEME.error)
-                    .add_modifier(Modifier::BOLD)
+/// `  0xADDR: ` followed by the hex bytes of `range`, `??` where unset
+fn hex_dump(block: &HeapBlock, address: u64, range: Range<usize>) -> String {
+    let mut hex_part = format!("  0x{:08x}: ", address);
+    for i in range {
+        if let Some(byte) = block.byte_at(i) {
+            let _ = write!(hex_part, "{:02x} ", byte);
+        } else {
+            hex_part.push_str("?? ");
+        }
+    }
+    hex_part
+}
+
+/// Length of `hex_dump` prefix: "  0xADDR: "
+const HEX_PREFIX_LEN: usize = 14;
+
+/// Style for a decoded value: errors for NULL and uninitialized data
+fn value_style(value: &str) -> Style {
+    if value == "NULL" || value.starts_with('[') {
+        Style::default().fg(DEFAULT_THEME.error)
+    } else {
+        Style::default().fg(DEFAULT_THEME.secondary)
+    }
+}
+
+/// Emit the header and contents of one heap block
+fn heap_block_rows<T: BuildHasher>(
+    rows: &mut RowSink,
+    addr: u64,
+    block: &HeapBlock,
+    layout: &BlockLayoutCtx<T>,
+) {
+    // Element type from the block's shadow layout, if known
+    let typ_opt = block.layout.as_ref().map(|l| &l.elem_type);
+
+    // Build header with type annotation if available
+    rows.push(|| {
+        let type_str = if let Some(typ) = typ_opt {
+            format_type_annotation(typ, layout.struct_defs)
+        } else {
+            String::new()
+        };
+
+        // Check if this address matches the error address
+        let addr_style = if Some(addr) == layout.error_address {
+            Style::default()
+                .fg(DEFAULT_THEME.error)
+                .add_modifier(Modifier::BOLD)
+        } else {
+            Style::default().fg(DEFAULT_THEME.comment)
+        };
+
+        let mut spans = vec![
+            Span::styled(format!("0x{:08x}", addr), addr_style),
+            Span::raw(" | "),
+            Span::styled(
+                format!("{} bytes", block.size),
+                Style::default().fg(DEFAULT_THEME.primary),
+            ),
+        ];
+        // Access counts while the heatmap is on: " | 12r 3w"
+        let counts = layout.heat_max.map(|_| {
+            format!(" | {}r {}w", block.access.reads, block.access.writes)
+        });
+        let counts_len = counts.as_ref().map_or(0, String::len);
+        if let Some(counts) = counts {
+            spans.push(Span::styled(
+                counts,
+                Style::default().fg(DEFAULT_THEME.comment),
+            ));
+        }
+        if !type_str.is_empty() {
+            // Calculate padding for right alignment
+            // Left part: "0xADDR | SIZE bytes" plus any access counts
+            // 10 chars for addr, 3 for " | ", len of size + " bytes"
+            let left_len =
+                10 + 3 + format!("{} bytes", block.size).len() + counts_len;
+            let right_len = type_str.len();
+            let padding =
+                layout.content_width.saturating_sub(left_len + right_len);
+            spans.push(Span::raw(" ".repeat(padding)));
+            spans.push(Span::styled(
+                type_str,
+                Style::default().fg(DEFAULT_THEME.type_name),
+            ));
+        }
+        let changed = layout
+            .changed_since
+            .is_some_and(|step| block.modified_step >= step);
+        ListItem::new(Line::from(spans)).style(
+            heat_style(block.access, layout.heat_max)
+                .patch(changed_style(changed)),
+        )
+    });
+
+    match typ_opt {
+        Some(Type {
+            base: BaseType::Struct(struct_name),
+            ..
+        }) => {
+            // Show struct with field annotations
+            if let Some(struct_def) = layout.struct_defs.get(struct_name) {
+                struct_field_rows(rows, addr, block, struct_def, layout);
+            }
+        }
+        Some(typ) => {
+            // Regular display for non-struct types (primitives, arrays, pointers)
+            let elem_size = sizeof_type(typ, layout.struct_defs);
+            if elem_size > 0 && block.size >= elem_size {
+                element_rows(rows, addr, block, typ, elem_size, layout);
             } else {
-                Style::default().fg(DEFAULT_THEME.comment)
-            };
+                // Fallback: element size is 0 or invalid, show raw hex dump
+                raw_hex_rows(rows, addr, block, layout);
+            }
+        }
+        // No type info, show raw hex dump
+        None => raw_hex_rows(rows, addr, block, layout),
+    }
+}
+
+/// One or two rows per field: its bytes and the decoded value, wrapped onto
+/// a second line when the pane is too narrow
+fn struct_field_rows<T: BuildHasher>(
+    rows: &mut RowSink,
+    addr: u64,
+    block: &HeapBlock,
+    struct_def: &StructDef,
+    layout: &BlockLayoutCtx<T>,
+) {
+    let field_info =
+        calculate_field_offsets(&struct_def.fields, layout.struct_defs);
+    let max_field_len = field_info
+        .iter()
+        .map(|(n, _, _, _)| n.len())
+        .max()
+        .unwrap_or(0);
+
+    // Calculate formatting constants
+    // Find the largest field size to determine hex alignment
+    let max_field_size = field_info
+        .iter()
+        .map(|(_, _, size, _)| *size)
+        .max()
+        .unwrap_or(4);
+    let target_len = HEX_PREFIX_LEN + max_field_size * 3; // Each byte is "XX "
+
+    // Check available width to decide layout
+    let max_width = layout.area_width.saturating_sub(4); // Borders/padding
+
+    for (field_name, offset, size, field_type) in field_info {
+        if rows.is_full() {
+            return;
+        }
+        let field_end = (offset + size).min(block.size);
+
+        // The decoded value decides whether the field needs a second row
+        let (bytes, init) = block.read_range(offset, size);
+        let value_str_opt =
+            read_typed_value(&bytes, &init, &field_type, layout.struct_defs);
+        // "=> " + "." + padded_field_name + " : " + value
+        let annotation_len = 3
+            + 1
+            + max_field_len
+            + 3
+            + value_str_opt.as_ref().map_or(1, String::len);
+        let hex_len = (HEX_PREFIX_LEN + field_end.saturating_sub(offset) * 3)
+            .max(target_len);
+        let indent_len = 2; // "  " spacing
+        let single_line = hex_len + indent_len + annotation_len <= max_width;
+
+        rows.section(if single_line { 1 } else { 2 }, |rows| {
+            let row_style = layout.row_style(block, offset..field_end);
+            // Pad hex part for alignment
+            let mut hex_part =
+                hex_dump(block, addr + offset as u64, offset..field_end);
+            if hex_part.len() < target_len {
+                hex_part.push_str(&" ".repeat(target_len - hex_part.len()));
+            }
+
+            let mut annotation_spans = vec![
+                Span::styled("=> ", Style::default().fg(DEFAULT_THEME.comment)),
+                Span::styled(".", Style::default().fg(DEFAULT_THEME.fg)),
+                Span::styled(
+                    format!("{:<width$} : ", field_name, width = max_field_len),
+                    Style::default().fg(DEFAULT_THEME.fg),
+                ),
+            ];
+            annotation_spans.push(match value_str_opt {
+                Some(val) => {
+                    let style = value_style(&val);
+                    Span::styled(val, style)
+                }
+                None => Span::styled(
+                    "?",
+                    Style::default().fg(DEFAULT_THEME.comment),
+                ),
+            });
 
-            let header = if type_str.is_empty() {
-                Line::from(vec![
-                    Span::styled(format!("0x{:08x}", addr), addr_style),
-                    Span::raw(" | "),
+            if single_line {
+                let mut line_spans = vec![
                     Span::styled(
-                        format!("{} bytes", block.size),
-                        Style::default().fg(DEFAULT_THEME.primary),
+                        hex_part,
+                        Style::default().fg(DEFAULT_THEME.comment),
                     ),
-                ])
+                    Span::raw("  "),
+                ];
+                line_spans.extend(annotation_spans);
+                rows.push(|| {
+                    ListItem::new(Line::from(line_spans)).style(row_style)
+                });
             } else {
-                // Calculate padding for right alignment
-                // Left part: "0xADDR | SIZE bytes"
-                // 10 chars for addr, 3 for " | ", len of size + " bytes"
-                let left_len = 10 + 3 + format!("{} bytes", block.size).len();
-                let right_len = type_str.len();
-                let padding =
-                    content_width.saturating_sub(left_len + right_len);
-
-                Line::from(vec![
-                    Span::styled(format!("0x{:08x}", addr), addr_style),
-                    Span::raw(" | "),
-                    Span::styled(
-                        format!("{} bytes", block.size),
-                        Style::default().fg(DEFAULT_THEME.primary),
-                    ),
-                    Span::raw(" ".repeat(padding)),
-                    Span::styled(
-                        type_str,
-                        Style::default().fg(DEFAULT_THEME.type_name),
-                    ),
-                ])
-            };
-            all_items.push(ListItem::new(header));
-
-            // Show hex dump of allocated data with dynamic wrapping
-            if block.state == BlockState::Allocated {
-                let typ_opt = data.pointer_types.get(addr);
-
-                // Check if this is a struct type
-                let is_struct = typ_opt
-                    .is_some_and(|t| matches!(t.base, BaseType::Struct(_)));
-
-                if is_struct {
-                    // Show struct with field annotations
-                    if let Some(Type {
-                        base: BaseType::Struct(struct_name),
-                        ..
-                    }) = typ_opt
-                    {
-                        if let Some(struct_def) =
-                            data.struct_defs.get(struct_name)
-                        {
-                            let field_info = calculate_field_offsets(
-                                &struct_def.fields,
-                                data.struct_defs,
-                            );
-                            let max_field_len = field_info
-                                .iter()
-                                .map(|(n, _, _, _)| n.len())
-                                .max()
-                                .unwrap_or(0);
-
-                            // Calculate formatting constants
-                            // Find the largest field size to determine hex alignment
-                            let max_field_size = field_info
-                                .iter()
-                                .map(|(_, _, size, _)| *size)
-                                .max()
-                                .unwrap_or(4);
-                            let target_hex_width = max_field_size * 3; // Each byte is "XX "
-
-                            for (field_name, offset, size, field_type) in
-                                field_info
-                            {
-                                // Show hex dump for this field
-                                let field_end = (offset + size).min(block.size);
-
-                                // Build hex part with full address
-                                let full_addr = *addr + offset as u64;
-                                let mut hex_part =
-                                    format!("  0x{:08x}: ", full_addr);
-                                for i in offset..field_end {
-                                    if block.init_map[i] {
-                                        hex_part.push_str(&format!(
-                                            "{:02x} ",
-                                            block.data[i]
-                                        ));
-                                    } else {
-                                        hex_part.push_str("?? ");
-                                    }
-                                }
-
-                                // Pad hex part for alignment
-                                // hex_part starts with "  0xADDR: " (14 chars), so target length is 14 + target_hex_width
-                                let target_len = 14 + target_hex_width;
-                                if hex_part.len() < target_len {
-                                    let padding =
-                                        " ".repeat(target_len - hex_part.len());
-                                    hex_part.push_str(&padding);
-                                }
-
-                                // Prepare annotation parts
-                                let value_str_opt = read_typed_value(
-                                    &block.data[offset..],
-                                    &block.init_map[offset..],
-                                    &field_type,
-                                    data.struct_defs,
-                                );
-                                let mut annotation_spans = vec![
-                                    Span::styled(
-                                        "=> ",
-                                        Style::default()
-                                            .fg(DEFAULT_THEME.comment),
-                                    ),
-                                    Span::styled(
-                                        ".",
-                                        Style::default().fg(DEFAULT_THEME.fg),
-                                    ),
-                                    Span::styled(
-                                        format!(
-                                            "{:<width$} : ",
-                                            field_name,
-                                            width = max_field_len
-                                        ),
-                                        Style::default().fg(DEFAULT_THEME.fg),
-                                    ),
-                                ];
-
-                                let mut annotation_len =
-                                    3 + 1 + max_field_len + 3; // "=> " + "." + padded_field_name + " : "
-
-                                if let Some(ref val) = value_str_opt {
-                                    if val == "NULL" {
-                                        annotation_spans.push(Span::styled(
-                                            "NULL",
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.error),
-                                        ));
-                                        annotation_len += 4;
-                                    } else if val.starts_with("[") {
-                                        // Uninitialized or partially initialized value
-                                        annotation_spans.push(Span::styled(
-                                            val.clone(),
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.error),
-                                        ));
-                                        annotation_len += val.len();
-                                    } else {
-                                        annotation_spans.push(Span::styled(
-                                            val.clone(),
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.secondary),
-                                        ));
-                                        annotation_len += val.len();
-                                    }
-                                } else {
-                                    annotation_spans.push(Span::styled(
-                                        "?",
-                                        Style::default()
-                                            .fg(DEFAULT_THEME.comment),
-                                    ));
-                                    annotation_len += 1;
-                                }
-
-                                // Check available width to decide layout
-                                let max_width =
-                                    area.width.saturating_sub(4) as usize; // Borders/padding
-                                let hex_len = hex_part.len();
-                                let indent_len = 2; // "  " spacing
-
-                                if hex_len + indent_len + annotation_len
-                                    <= max_width
-                                {
-                                    // Single line layout
-                                    let mut line_spans = vec![
-                                        Span::styled(
-                                            hex_part,
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.comment),
-                                        ),
-                                        Span::raw("  "),
-                                    ];
-                                    line_spans.extend(annotation_spans);
-                                    all_items.push(ListItem::new(Line::from(
-                                        line_spans,
-                                    )));
-                                } else {
-                                    // Multi-line layout
-                                    all_items.push(
-                                        ListItem::new(hex_part).style(
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.comment),
-                                        ),
-                                    );
-
-                                    let mut next_line_spans =
-                                        vec![Span::raw("          ")]; // Indent
-                                    next_line_spans.extend(annotation_spans);
-
-                                    all_items.push(ListItem::new(Line::from(
-                                        next_line_spans,
-                                    )));
-                                }
-                            }
-                        }
-                    }
-                } else {
-                    // Regular display for non-struct types (primitives, arrays, pointers)
-                    // For arrays, show each element with its value
-                    if let Some(typ) = typ_opt {
-                        let elem_size = sizeof_type(typ, data.struct_defs);
-                        if elem_size > 0 && block.size >= elem_size {
-                            // Display as array of elements
-                            let num_elements = block.size / elem_size;
-                            let max_elem_size = elem_size;
-                            let target_hex_width = max_elem_size * 3; // Each byte is "XX "
-
-                            for elem_idx in 0..num_elements {
-                                let offset = elem_idx * elem_size;
-                                let elem_end =
-                                    (offset + elem_size).min(block.size);
-
-                                // Build hex part for this element with full address
-                                let full_addr = *addr + offset as u64;
-                                let mut hex_part =
-                                    format!("  0x{:08x}: ", full_addr);
-                                for i in offset..elem_end {
-                                    if block.init_map[i] {
-                                        hex_part.push_str(&format!(
-                                            "{:02x} ",
-                                            block.data[i]
-                                        ));
-                                    } else {
-                                        hex_part.push_str("?? ");
-                                    }
-                                }
-
-                                // Pad hex part for alignment
-                                let target_len = 14 + target_hex_width;
-                                if hex_part.len() < target_len {
-                                    let padding =
-                                        " ".repeat(target_len - hex_part.len());
-                                    hex_part.push_str(&padding);
-                                }
-
-                                // Get value interpretation for this element
-                                let mut line_spans = vec![Span::styled(
-                                    hex_part,
-                                    Style::default().fg(DEFAULT_THEME.comment),
-                                )];
-
-                                if let Some(value_str) = read_typed_value(
-                                    &block.data[offset..],
-                                    &block.init_map[offset..],
-                                    typ,
-                                    data.struct_defs,
-                                ) {
-                                    line_spans.push(Span::styled(
-                                        "  => ",
-                                        Style::default()
-                                            .fg(DEFAULT_THEME.comment),
-                                    ));
-                                    if value_str == "NULL" {
-                                        line_spans.push(Span::styled(
-                                            value_str,
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.error),
-                                        ));
-                                    } else if value_str.starts_with("[") {
-                                        // Uninitialized or partially initialized value
-                                        line_spans.push(Span::styled(
-                                            value_str,
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.error),
-                                        ));
-                                    } else {
-                                        line_spans.push(Span::styled(
-                                            value_str,
-                                            Style::default()
-                                                .fg(DEFAULT_THEME.secondary),
-                                        ));
-                                    }
-                                }
-
-                                all_items.push(ListItem::new(Line::from(
-                                    line_spans,
-                                )));
-                            }
-
-                            // If there are remaining bytes that don't fit in an element, show them
-                            let remaining_offset = num_elements * elem_size;
-                            if remaining_offset < block.size {
-                                let full_addr = *addr + remaining_offset as u64;
-                                let mut hex_part =
-                                    format!("  0x{:08x}: ", full_addr);
-                                for i in remaining_offset..block.size {
-                                    if block.init_map[i] {
-                                        hex_part.push_str(&format!(
-                                            "{:02x} ",
-                                            block.data[i]
-                                        ));
-                                    } else {
-                                        hex_part.push_str("?? ");
-                                    }
-                                }
-                                all_items.push(ListItem::new(hex_part).style(
-                                    Style::default().fg(DEFAULT_THEME.comment),
-                                ));
-                            }
-                        } else {
-                            // Fallback: element size is 0 or invalid, show raw hex dump
-                            let available_width =
-                                area.width.saturating_sub(40) as usize;
-                            let max_bytes_per_line =
-                                (available_width / 3).max(1);
-                            let bytes_per_line = 16.min(max_bytes_per_line);
-
-                            for line_start in
-                                (0..block.size).step_by(bytes_per_line)
-                            {
-                                let line_end = (line_start + bytes_per_line)
-                                    .min(block.size);
-                                let full_addr = *addr + line_start as u64;
-                                let mut hex_part =
-                                    format!("  0x{:08x}: ", full_addr);
-                                for i in line_start..line_end {
-                                    if block.init_map[i] {
-                                        hex_part.push_str(&format!(
-                                            "{:02x} ",
-                                            block.data[i]
-                                        ));
-                                    } else {
-                                        hex_part.push_str("?? ");
-                                    }
-                                }
-                                all_items.push(ListItem::new(hex_part).style(
-                                    Style::default().fg(DEFAULT_THEME.comment),
-                                ));
-                            }
-                        }
-                    } else {
-                        // No type info, show raw hex dump
-                        let available_width =
-                            area.width.saturating_sub(40) as usize;
-                        let max_bytes_per_line = (available_width / 3).max(1);
-                        let bytes_per_line = 16.min(max_bytes_per_line);
-
-                        for line_start in
-                            (0..block.size).step_by(bytes_per_line)
-                        {
-                            let line_end =
-                                (line_start + bytes_per_line).min(block.size);
-                            let full_addr = *addr + line_start as u64;
-                            let mut hex_part =
-                                format!("  0x{:08x}: ", full_addr);
-                            for i in line_start..line_end {
-                                if block.init_map[i] {
-                                    hex_part.push_str(&format!(
-                                        "{:02x} ",
-                                        block.data[i]
-                                    ));
-                                } else {
-                                    hex_part.push_str("?? ");
-                                }
-                            }
-                            all_items.push(ListItem::new(hex_part).style(
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ));
-                        }
-                    }
-                }
+                rows.push(|| {
+                    ListItem::new(hex_part).style(
+                        Style::default()
+                            .fg(DEFAULT_THEME.comment)
+                            .patch(row_style),
+                    )
+                });
+                rows.push(|| {
+                    let mut next_line_spans = vec![Span::raw("          ")]; // Indent
+                    next_line_spans.extend(annotation_spans);
+                    ListItem::new(Line::from(next_line_spans)).style(row_style)
+                });
+            }
+        });
+    }
+}
+
+/// One row per element with its bytes and value, plus a row for trailing
+/// bytes that do not fill an element
+fn element_rows<T: BuildHasher>(
+    rows: &mut RowSink,
+    addr: u64,
+    block: &HeapBlock,
+    typ: &Type,
+    elem_size: usize,
+    layout: &BlockLayoutCtx<T>,
+) {
+    let num_elements = block.size / elem_size;
+    let target_len = HEX_PREFIX_LEN + elem_size * 3; // Each byte is "XX "
+
+    // Jump to the first visible element
+    let first = rows.rows_before_window().min(num_elements);
+    rows.skip(first);
+
+    for elem_idx in first..num_elements {
+        if rows.is_full() {
+            return;
+        }
+        rows.push(|| {
+            let offset = elem_idx * elem_size;
+            let elem_end = (offset + elem_size).min(block.size);
+
+            // Pad hex part for alignment
+            let mut hex_part =
+                hex_dump(block, addr + offset as u64, offset..elem_end);
+            if hex_part.len() < target_len {
+                hex_part.push_str(&" ".repeat(target_len - hex_part.len()));
             }
 
-            if i < alloc_count - 1 {
-                let separator = Line::from(Span::styled(
-                    "",
+            // Get value interpretation for this element
+            let mut line_spans = vec![Span::styled(
+                hex_part,
+                Style::default().fg(DEFAULT_THEME.comment),
+            )];
+
+            let (bytes, init) = block.read_range(offset, elem_size);
+            if let Some(value_str) =
+                read_typed_value(&bytes, &init, typ, layout.struct_defs)
+            {
+                line_spans.push(Span::styled(
+                    "  => ",
                     Style::default().fg(DEFAULT_THEME.comment),
                 ));
-                all_items.push(ListItem::new(separator));
+                let style = value_style(&value_str);
+                line_spans.push(Span::styled(value_str, style));
             }
-        }
+
+            ListItem::new(Line::from(line_spans))
+                .style(layout.row_style(block, offset..elem_end))
+        });
     }
 
-    // Calculate visible range for scrolling
-    let total_items = all_items.len();
-    let visible_height = area.height.saturating_sub(2).max(1) as usize; // Account for borders, min 1
+    // If there are remaining bytes that don't fit in an element, show them
+    let remaining_offset = num_elements * elem_size;
+    if remaining_offset < block.size {
+        rows.push(|| {
+            ListItem::new(hex_dump(
+                block,
+                addr + remaining_offset as u64,
+                remaining_offset..block.size,
+            ))
+            .style(
+                Style::default().fg(DEFAULT_THEME.comment).patch(
+                    layout.row_style(block, remaining_offset..block.size),
+                ),
+            )
+        });
+    }
+}
 
-    // Smart auto-scroll: scroll to bottom only when content grows (new allocation)
-    if total_items > data.scroll_state.prev_item_count {
-        // Content grew (new allocation), auto-scroll to bottom
-        if total_items > visible_height {
-            data.scroll_state.offset = total_items - visible_height;
-        } else {
-            data.scroll_state.offset = 0;
-        }
-    } else {
-        // Content same or shrank, respect user's scroll position (just clamp)
-        if total_items > visible_height {
-            let max_scroll = total_items - visible_height;
-            data.scroll_state.offset = data.scroll_state.offset.min(max_scroll);
-        } else {
-            data.scroll_state.offset = 0;
+/// Raw hex dump, as many bytes per row as fit (at most 16)
+fn raw_hex_rows<T: BuildHasher>(
+    rows: &mut RowSink,
+    addr: u64,
+    block: &HeapBlock,
+    layout: &BlockLayoutCtx<T>,
+) {
+    let available_width = layout.area_width.saturating_sub(40);
+    let max_bytes_per_line = (available_width / 3).max(1);
+    let bytes_per_line = 16.min(max_bytes_per_line);
+    let lines = block.size.div_ceil(bytes_per_line);
+
+    // Jump to the first visible line
+    let first = rows.rows_before_window().min(lines);
+    rows.skip(first);
+
+    for line in first..lines {
+        if rows.is_full() {
+            return;
         }
+        rows.push(|| {
+            let line_start = line * bytes_per_line;
+            let line_end = (line_start + bytes_per_line).min(block.size);
+            ListItem::new(hex_dump(
+                block,
+                addr + line_start as u64,
+                line_start..line_end,
+            ))
+            .style(
+                Style::default()
+                    .fg(DEFAULT_THEME.comment)
+                    .patch(layout.row_style(block, line_start..line_end)),
+            )
+        });
     }
-
-    // Update previous item count for next render
-    data.scroll_state.prev_item_count = total_items;
-
-    // Take only visible items
-    let visible_items: Vec<ListItem> = all_items
-        .into_iter()
-        .skip(data.scroll_state.offset)
-        .take(visible_height)
-        .collect();
-
-    let list = List::new(visible_items).block(block);
-    frame.render_widget(list, area);
 }
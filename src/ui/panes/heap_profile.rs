@@ -0,0 +1,136 @@
+//! Heap profile pane rendering
+//!
+//! Alternative view of the heap pane area that lists allocation sites
+//! instead of blocks. Live bytes come from the heap at the current step;
+//! peak and churn are whole-run figures from the [`HeapProfile`]. Once the
+//! program has finished and the cursor is on the last step, live bytes are
+//! shown as leaked.
+
+use crate::memory::heap::Heap;
+use crate::memory::heap_profile::{HeapProfile, SiteOrder, SiteStats};
+use crate::ui::source_text::SourceText;
+use crate::ui::theme::DEFAULT_THEME;
+use ratatui::{
+    layout::Rect,
+    style::{Modifier, Style},
+    text::{Line, Span},
+    widgets::{Block, Borders, List, ListItem},
+    Frame,
+};
+
+/// Scroll state for the heap profile pane
+pub struct HeapProfileScrollState {
+    pub offset: usize,
+}
+
+/// Data needed to render the heap profile pane
+pub struct HeapProfileRenderData<'a> {
+    pub profile: &'a HeapProfile,
+    pub heap: &'a Heap,
+    pub source: &'a SourceText,
+    pub order: SiteOrder,
+    /// Whether live bytes at this step are leaks (program ended here)
+    pub at_exit: bool,
+    pub is_focused: bool,
+    pub scroll_state: &'a mut HeapProfileScrollState,
+}
+
+/// Render the heap profile pane
+pub fn render_heap_profile_pane(
+    frame: &mut Frame,
+    area: Rect,
+    data: HeapProfileRenderData,
+) {
+    let border_style = if data.is_focused {
+        Style::default()
+            .fg(DEFAULT_THEME.border_focused)
+            .add_modifier(Modifier::BOLD)
+    } else {
+        Style::default().fg(DEFAULT_THEME.border_normal)
+    };
+
+    let title = format!(" Heap Profile (by {}) ", data.order.label());
+    let block = Block::default()
+        .title(title)
+        .borders(Borders::ALL)
+        .border_style(border_style);
+
+    let live = HeapProfile::live_at(data.heap);
+    let live_of = |s: &SiteStats| live.get(&s.site).copied().unwrap_or(0);
+
+    let mut sites: Vec<&SiteStats> = data.profile.sites().collect();
+    let key = |s: &SiteStats| match data.order {
+        SiteOrder::LiveBytes => live_of(s),
+        SiteOrder::PeakBytes => s.peak_live_bytes,
+        SiteOrder::Churn => s.bytes_freed,
+    };
+    sites.sort_by(|a, b| key(b).cmp(&key(a)).then(a.site.cmp(&b.site)));
+
+    let mut all_items = Vec::new();
+    if sites.is_empty() {
+        all_items.push(
+            ListItem::new("(no allocations)")
+                .style(Style::default().fg(DEFAULT_THEME.comment)),
+        );
+    } else {
+        let live_label = if data.at_exit { "leaked" } else { "live" };
+        all_items.push(ListItem::new(Line::from(Span::styled(
+            format!(
+                "{:>6} {:>9} {:>9} {:>9} {:>6}",
+                "line", live_label, "peak", "churn", "allocs"
+            ),
+            Style::default()
+                .fg(DEFAULT_THEME.comment)
+                .add_modifier(Modifier::BOLD),
+        ))));
+    }
+
+    for s in sites {
+        let live_bytes = live_of(s);
+        let live_style = if data.at_exit && live_bytes > 0 {
+            Style::default()
+                .fg(DEFAULT_THEME.error)
+                .add_modifier(Modifier::BOLD)
+        } else {
+            Style::default().fg(DEFAULT_THEME.primary)
+        };
+        let snippet = data.source.line(s.site.line).unwrap_or("").trim();
+        all_items.push(ListItem::new(Line::from(vec![
+            Span::styled(
+                format!("{:>6} ", s.site.line),
+                Style::default().fg(DEFAULT_THEME.comment),
+            ),
+            Span::styled(format!("{:>9} ", live_bytes), live_style),
+            Span::styled(
+                format!("{:>9} ", s.peak_live_bytes),
+                Style::default().fg(DEFAULT_THEME.number),
+            ),
+            Span::styled(
+                format!("{:>9} ", s.bytes_freed),
+                Style::default().fg(DEFAULT_THEME.fg),
+            ),
+            Span::styled(
+                format!("{:>6}  ", s.allocations),
+                Style::default().fg(DEFAULT_THEME.fg),
+            ),
+            Span::styled(
+                snippet.to_string(),
+                Style::default().fg(DEFAULT_THEME.comment),
+            ),
+        ])));
+    }
+
+    // Clamp scroll
+    let visible_height = area.height.saturating_sub(2) as usize;
+    let max_scroll = all_items.len().saturating_sub(visible_height);
+    data.scroll_state.offset = data.scroll_state.offset.min(max_scroll);
+
+    let visible_items: Vec<ListItem> = all_items
+        .into_iter()
+        .skip(data.scroll_state.offset)
+        .take(visible_height)
+        .collect();
+
+    let list = List::new(visible_items).block(block);
+    frame.render_widget(list, area);
+}
@@ -1,6 +1,7 @@
 //! Input pane rendering for displaying original stdin input
 
 use crate::snapshot::{TerminalLine, TerminalLineKind};
+use crate::ui::source_text::SourceText;
 use ratatui::{
     layout::Rect,
     style::{Modifier, Style},
@@ -21,7 +22,7 @@ pub struct InputRenderData<'a> {
     /// Lines beyond this index are shown dimmed/greyed out.
     pub active_count: usize,
     pub is_focused: bool,
-    pub source_code: &'a str,
+    pub source: &'a SourceText,
     pub scroll_state: &'a mut InputScrollState,
 }
 
@@ -100,11 +101,7 @@ pub fn render_input_pane(frame: &mut Frame, area: Rect, data: InputRenderData) {
             ));
 
             // Source code — syntax highlighted if active, dimmed if future
-            let src_line = data
-                .source_code
-                .lines()
-                .nth(line_num.saturating_sub(1))
-                .unwrap_or("");
+            let src_line = data.source.line(*line_num).unwrap_or("");
             if is_active {
                 spans.extend(highlight_source_code(src_line.trim()).spans);
             } else {
@@ -8,6 +8,10 @@
 //! - [`source`]: Source code display with syntax highlighting and current line indicator
 //! - [`stack`]: Call stack visualization with local variables and function frames
 //! - [`heap`]: Heap memory display with allocation tracking and hex dumps
+//! - [`heap_profile`]: Allocation sites ranked by live bytes, peak or churn
+//! - [`profile`]: Functions and lines ranked by steps, calls or heap bytes
+//! - [`graph`]: Pointer graph of stack variables and the heap blocks they reach
+//! - [`plot`]: Value of a pinned expression over the whole history
 //! - [`terminal`]: Terminal output from `printf` and other output functions
 //! - [`status`]: Status bar with keybindings and execution state
 //! - `utils`: Shared utility functions for value formatting and rendering
@@ -24,19 +28,38 @@
 
 mod utils;
 
+pub mod graph;
 pub mod heap;
+pub mod heap_profile;
 pub mod input;
+pub mod plot;
+pub mod profile;
 pub mod source;
 pub mod stack;
 pub mod status;
 pub mod terminal;
 
 // Re-export render functions for convenience
-pub use heap::{render_heap_pane, HeapRenderData, HeapScrollState};
+pub use graph::{render_graph_pane, GraphRenderData, GraphScrollState};
+pub use heap::{
+    build_heap_rows, render_heap_pane, HeapContent, HeapRenderData,
+    HeapScrollState,
+};
+pub use heap_profile::{
+    render_heap_profile_pane, HeapProfileRenderData, HeapProfileScrollState,
+};
 pub use input::{render_input_pane, InputRenderData, InputScrollState};
+pub use plot::{render_plot_pane, PlotRenderData, PLOT_PANE_HEIGHT};
+pub use profile::{render_profile_pane, ProfileRenderData, ProfileScrollState};
 pub use source::{render_source_pane, SourceRenderData, SourceScrollState};
-pub use stack::{render_stack_pane, StackRenderData, StackScrollState};
-pub use status::{render_status_bar, StatusRenderData};
+pub use stack::{
+    build_stack_rows, render_stack_pane, StackContent, StackRenderData,
+    StackScrollState,
+};
+pub use status::{
+    render_stats_line, render_status_bar, StatusRenderData, SCRUBBER_WIDTH,
+};
 pub use terminal::{
-    render_terminal_pane, TerminalRenderData, TerminalScrollState,
+    render_terminal_pane, TerminalIndex, TerminalRenderData,
+    TerminalScrollState,
 };
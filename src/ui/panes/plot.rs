@@ -0,0 +1,119 @@
+//! Value plot pane rendering
+//!
+//! Draws a pinned expression's [`Series`] as a bar chart over the whole
+//! history: each column covers an equal share of the positions and shows
+//! the value at the last of them, in eighth-cell steps. Positions the
+//! workers have not reached yet are left blank, positions without a value
+//! are dotted, and the column holding the current position is highlighted.
+
+use crate::ui::theme::DEFAULT_THEME;
+use crate::ui::value_plot::{Sample, Series};
+use ratatui::{
+    layout::Rect,
+    style::{Modifier, Style},
+    text::{Line, Span},
+    widgets::{Block, Borders, Paragraph},
+    Frame,
+};
+
+/// Rows the plot pane takes, including its border
+pub const PLOT_PANE_HEIGHT: u16 = 8;
+
+/// Partial cell fills, in eighths
+const BAR_CELLS: [char; 9] = [' ', '▁', '▂', '▃', '▄', '▅', '▆', '▇', '█'];
+
+/// Data needed to render the plot pane
+pub struct PlotRenderData<'a> {
+    pub series: &'a Series,
+    /// Current history position
+    pub position: usize,
+}
+
+/// Render the plot pane
+pub fn render_plot_pane(frame: &mut Frame, area: Rect, data: PlotRenderData) {
+    let series = data.series;
+    let current = match series.samples.get(data.position) {
+        Some(Sample::Value(v)) => format_sample(*v),
+        Some(Sample::Pending) => "…".to_string(),
+        _ => "—".to_string(),
+    };
+    let progress = if series.is_complete() {
+        String::new()
+    } else {
+        format!(" {}%", series.computed * 100 / series.samples.len().max(1))
+    };
+    let range = series.range.map_or(String::new(), |(lo, hi)| {
+        format!(" [{} … {}]", format_sample(lo), format_sample(hi))
+    });
+    let block = Block::default()
+        .title(format!(
+            " {} = {}{}{} ",
+            series.expression, current, range, progress
+        ))
+        .borders(Borders::ALL)
+        .border_style(Style::default().fg(DEFAULT_THEME.border_normal));
+
+    let width = area.width.saturating_sub(2) as usize;
+    let height = area.height.saturating_sub(2) as usize;
+    let len = series.samples.len();
+    if width == 0 || height == 0 || len == 0 {
+        frame.render_widget(block, area);
+        return;
+    }
+
+    // Last position of each column, and the column of the cursor
+    let columns: Vec<usize> = (0..width.min(len))
+        .map(|c| ((c + 1) * len).div_ceil(width.min(len)) - 1)
+        .collect();
+    let cursor_column = columns.partition_point(|&p| p < data.position);
+    let (lo, hi) = series.range.unwrap_or((0.0, 0.0));
+
+    let lines: Vec<Line> = (0..height)
+        .map(|row| {
+            // Eighths of the bar below this row
+            let floor = (height - 1 - row) * 8;
+            let spans = columns
+                .iter()
+                .enumerate()
+                .map(|(column, &position)| {
+                    let cell = match series.samples[position] {
+                        Sample::Value(v) => {
+                            let level = bar_level(v, lo, hi, height);
+                            BAR_CELLS[level.saturating_sub(floor).min(8)]
+                        }
+                        Sample::Missing if row + 1 == height => '·',
+                        Sample::Missing | Sample::Pending => ' ',
+                    };
+                    let mut style = Style::default().fg(DEFAULT_THEME.primary);
+                    if column == cursor_column {
+                        style = style
+                            .fg(DEFAULT_THEME.secondary)
+                            .bg(DEFAULT_THEME.current_line_bg)
+                            .add_modifier(Modifier::BOLD);
+                    }
+                    Span::styled(cell.to_string(), style)
+                })
+                .collect::<Vec<_>>();
+            Line::from(spans)
+        })
+        .collect();
+
+    frame.render_widget(Paragraph::new(lines).block(block), area);
+}
+
+/// Height of the bar for `value`, in eighths of a cell (at least one, so
+/// the minimum stays visible)
+fn bar_level(value: f64, lo: f64, hi: f64, height: usize) -> usize {
+    let cells = (height * 8) as f64;
+    let fraction = if hi > lo {
+        (value - lo) / (hi - lo)
+    } else {
+        0.5
+    };
+    ((fraction * (cells - 1.0)) as usize) + 1
+}
+
+/// Samples are whole numbers (ints, chars and addresses)
+fn format_sample(value: f64) -> String {
+    format!("{}", value as i64)
+}
@@ -0,0 +1,137 @@
+//! Guest profile pane rendering
+//!
+//! Alternative view of the heap pane area that ranks the program's
+//! functions, then its source lines, by the steps and heap bytes charged to
+//! them over the whole run (see [`GuestProfile`]). The same per-line step
+//! counts are shown in the source pane gutter while this view is open.
+
+use crate::interpreter::profiler::{CostStats, GuestProfile, ProfileOrder};
+use crate::ui::source_text::SourceText;
+use crate::ui::theme::DEFAULT_THEME;
+use ratatui::{
+    layout::Rect,
+    style::{Modifier, Style},
+    text::{Line, Span},
+    widgets::{Block, Borders, List, ListItem},
+    Frame,
+};
+
+/// Scroll state for the guest profile pane
+pub struct ProfileScrollState {
+    pub offset: usize,
+}
+
+/// Data needed to render the guest profile pane
+pub struct ProfileRenderData<'a> {
+    pub profile: &'a GuestProfile,
+    pub source: &'a SourceText,
+    pub order: ProfileOrder,
+    pub is_focused: bool,
+    pub scroll_state: &'a mut ProfileScrollState,
+}
+
+/// Render the guest profile pane
+pub fn render_profile_pane(
+    frame: &mut Frame,
+    area: Rect,
+    data: ProfileRenderData,
+) {
+    let border_style = if data.is_focused {
+        Style::default()
+            .fg(DEFAULT_THEME.border_focused)
+            .add_modifier(Modifier::BOLD)
+    } else {
+        Style::default().fg(DEFAULT_THEME.border_normal)
+    };
+
+    let title = format!(" Profile (by {}) ", data.order.label());
+    let block = Block::default()
+        .title(title)
+        .borders(Borders::ALL)
+        .border_style(border_style);
+
+    let header_style = Style::default()
+        .fg(DEFAULT_THEME.comment)
+        .add_modifier(Modifier::BOLD);
+    let header = |first: &str| {
+        ListItem::new(Line::from(Span::styled(
+            format!(
+                "{:>12} {:>8} {:>8} {:>7} {:>8}",
+                first, "incl", "excl", "count", "heap"
+            ),
+            header_style,
+        )))
+    };
+    let cost_spans = |s: &CostStats| {
+        vec![
+            Span::styled(
+                format!("{:>8} ", s.inclusive_steps),
+                Style::default().fg(DEFAULT_THEME.primary),
+            ),
+            Span::styled(
+                format!("{:>8} ", s.steps),
+                Style::default().fg(DEFAULT_THEME.number),
+            ),
+            Span::styled(
+                format!("{:>7} ", s.count),
+                Style::default().fg(DEFAULT_THEME.fg),
+            ),
+            Span::styled(
+                format!("{:>8}  ", s.inclusive_heap_bytes),
+                Style::default().fg(DEFAULT_THEME.fg),
+            ),
+        ]
+    };
+
+    let functions = data.profile.top_functions(data.order, usize::MAX);
+    let lines = data.profile.top_lines(data.order, usize::MAX);
+
+    let mut all_items = Vec::new();
+    if functions.is_empty() && lines.is_empty() {
+        all_items.push(
+            ListItem::new("(nothing executed)")
+                .style(Style::default().fg(DEFAULT_THEME.comment)),
+        );
+    }
+    if !functions.is_empty() {
+        all_items.push(header("function"));
+    }
+    for (name, stats) in functions {
+        let mut spans = vec![Span::styled(
+            format!("{:>12} ", name),
+            Style::default().fg(DEFAULT_THEME.function),
+        )];
+        spans.extend(cost_spans(stats));
+        all_items.push(ListItem::new(Line::from(spans)));
+    }
+    if !lines.is_empty() {
+        all_items.push(header("line"));
+    }
+    for (line, stats) in lines {
+        let snippet = data.source.line(line).unwrap_or("").trim();
+        let mut spans = vec![Span::styled(
+            format!("{:>12} ", line),
+            Style::default().fg(DEFAULT_THEME.comment),
+        )];
+        spans.extend(cost_spans(stats));
+        spans.push(Span::styled(
+            snippet.to_string(),
+            Style::default().fg(DEFAULT_THEME.comment),
+        ));
+        all_items.push(ListItem::new(Line::from(spans)));
+    }
+
+    // Clamp scroll
+    let visible_height = area.height.saturating_sub(2) as usize;
+    let max_scroll = all_items.len().saturating_sub(visible_height);
+    data.scroll_state.offset = data.scroll_state.offset.min(max_scroll);
+
+    let visible_items: Vec<ListItem> = all_items
+        .into_iter()
+        .skip(data.scroll_state.offset)
+        .take(visible_height)
+        .collect();
+
+    let list = List::new(visible_items).block(block);
+    frame.render_widget(list, area);
+}
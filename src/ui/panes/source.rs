@@ -9,12 +9,17 @@
 //! - Current line highlighting with arrow indicator
 //! - Scroll state management for navigating large files
 //! - Line numbering
+//! - A cursor line for "run to cursor", marked in the gutter
+//! - Optional per-line step counts from the guest profile in the gutter
 //!
 //! # Rendering
 //!
 //! The pane uses a simple character-by-character tokenizer to apply syntax
-//! highlighting styles without requiring a full lexer.
+//! highlighting styles without requiring a full lexer. Highlighted lines are
+//! cached in [`SourceText`], so each line is tokenized once per source load.
 
+use crate::interpreter::profiler::GuestProfile;
+use crate::ui::source_text::SourceText;
 use crate::ui::theme::DEFAULT_THEME;
 use ratatui::{
     layout::Rect,
@@ -25,7 +30,7 @@ use ratatui::{
 };
 
 /// Simple syntax highlighting for C-like C code
-pub fn highlight_source_code(line: &str) -> Line<'_> {
+pub fn highlight_source_code(line: &str) -> Line<'static> {
     let mut spans = Vec::new();
     let mut current_word = String::new();
 
@@ -142,18 +147,35 @@ fn get_keyword_style(word: &str, is_function: bool) -> Style {
 pub struct SourceScrollState {
     pub offset: usize,
     pub target_line_row: Option<usize>,
+    /// Line picked for "run to cursor"; while set, the view follows it
+    /// instead of the execution line
+    pub cursor_line: Option<usize>,
 }
 
 /// Data required to render the source pane
 pub struct SourceRenderData<'a> {
-    pub source_code: &'a str,
+    pub source: &'a SourceText,
     pub current_line: usize,
     pub is_error: bool,
     pub is_scanf: bool,
     pub is_focused: bool,
+    /// Annotate each line with the steps charged to it
+    pub profile: Option<&'a GuestProfile>,
     pub scroll_state: &'a mut SourceScrollState,
 }
 
+/// Gutter annotation for `line`: exclusive steps, abbreviated to fit six
+/// columns
+fn profile_gutter(profile: &GuestProfile, line: usize) -> String {
+    let steps = profile.line(line).map_or(0, |s| s.steps);
+    match steps {
+        0 => " ".repeat(7),
+        n if n < 100_000 => format!("{:>6} ", n),
+        n if n < 100_000_000 => format!("{:>5}k ", n / 1000),
+        n => format!("{:>5}M ", n / 1_000_000),
+    }
+}
+
 /// Render the source code pane
 pub fn render_source_pane(
     frame: &mut Frame,
@@ -173,8 +195,7 @@ pub fn render_source_pane(
         .borders(Borders::ALL)
         .border_style(border_style);
 
-    let lines: Vec<&str> = data.source_code.lines().collect();
-    let total_lines = lines.len();
+    let total_lines = data.source.line_count();
 
     // Calculate visible range
     let visible_height = area.height.saturating_sub(2).max(1) as usize; // Account for borders (2), min 1
@@ -192,10 +213,13 @@ pub fn render_source_pane(
         .min(visible_height.saturating_sub(1));
     data.scroll_state.target_line_row = Some(target_row);
 
-    // Calculate scroll offset to keep current line at target visual row
+    // Calculate scroll offset to keep the cursor (or else the current line)
+    // at target visual row
     let current_line = data.current_line;
-    if current_line > 0 && current_line <= total_lines {
-        let target_line_idx = current_line.saturating_sub(1); // Convert to 0-based
+    let cursor_line = data.scroll_state.cursor_line;
+    let anchor_line = cursor_line.unwrap_or(current_line);
+    if anchor_line > 0 && anchor_line <= total_lines {
+        let target_line_idx = anchor_line.saturating_sub(1); // Convert to 0-based
         let offset = target_line_idx.saturating_sub(target_row);
 
         // Clamp scroll offset to valid range
@@ -220,15 +244,17 @@ pub fn render_source_pane(
     let is_scanf = data.is_scanf;
     // current_line is already captured above
 
-    let visible_lines: Vec<Line> = lines
-        .iter()
-        .enumerate()
-        .skip(data.scroll_state.offset)
-        .take(visible_height)
-        .map(|(idx, line)| {
-            let line_num = idx + 1;
+    let first_line = data.scroll_state.offset + 1;
+    let last_line = (first_line + visible_height).min(total_lines + 1);
+    let visible_lines: Vec<Line> = (first_line..last_line)
+        .map(|line_num| {
             let is_current = line_num == current_line;
-            let line_num_str = format!("{:4} ", line_num);
+            let is_cursor = cursor_line == Some(line_num);
+            let line_num_str = if is_cursor {
+                format!("{:4}▸", line_num)
+            } else {
+                format!("{:4} ", line_num)
+            };
 
             // Base style for the line
             let (num_style, content_base_style) = if is_error && is_current {
@@ -260,6 +286,13 @@ pub fn render_source_pane(
                         .add_modifier(Modifier::BOLD),
                     Style::default().bg(DEFAULT_THEME.current_line_bg),
                 )
+            } else if is_cursor {
+                (
+                    Style::default()
+                        .fg(DEFAULT_THEME.primary)
+                        .add_modifier(Modifier::BOLD),
+                    Style::default(),
+                )
             } else {
                 (
                     Style::default().fg(DEFAULT_THEME.comment), // Line numbers
@@ -267,24 +300,36 @@ pub fn render_source_pane(
                 )
             };
 
-            // Highlight syntax
-            let mut content_line = highlight_source_code(line);
+            // Cached syntax highlighting, borrowed rather than copied
+            let content_spans = data
+                .source
+                .highlighted(line_num)
+                .map(|line| line.spans.as_slice())
+                .unwrap_or_default()
+                .iter()
+                .map(|span| {
+                    // Apply background style
+                    let style = if is_error && is_current {
+                        // For error lines, override all styling with error style
+                        content_base_style
+                    } else if is_current {
+                        // For current line, just apply background
+                        span.style.patch(content_base_style)
+                    } else {
+                        span.style
+                    };
+                    Span::styled(span.content.as_ref(), style)
+                });
 
-            // Apply background style
-            if is_error && is_current {
-                // For error lines, override all styling with error style
-                for span in &mut content_line.spans {
-                    span.style = content_base_style;
-                }
-            } else if is_current {
-                // For current line, just apply background
-                for span in &mut content_line.spans {
-                    span.style = span.style.patch(content_base_style);
-                }
+            let mut final_spans = Vec::new();
+            if let Some(profile) = data.profile {
+                final_spans.push(Span::styled(
+                    profile_gutter(profile, line_num),
+                    Style::default().fg(DEFAULT_THEME.number),
+                ));
             }
-
-            let mut final_spans = vec![Span::styled(line_num_str, num_style)];
-            final_spans.extend(content_line.spans);
+            final_spans.push(Span::styled(line_num_str, num_style));
+            final_spans.extend(content_spans);
 
             Line::from(final_spans)
         })
@@ -8,8 +8,10 @@
 //! - Call stack visualization with function names and parameters
 //! - Local variable display with types, values, and memory addresses
 //! - Nested structure and array rendering
-//! - Scroll support for large stacks
+//! - Scroll support for large stacks; only the rows in view are built
 //! - Type annotations for complex data types
+//! - Optional access heatmap: variables are shaded by how often they have
+//!   been read and written up to the current step
 //!
 //! # Layout
 //!
@@ -19,11 +21,15 @@
 //! - Nested structures and arrays with indentation
 
 use super::utils::{
-    format_type_annotation, format_value_styled, render_array_elements,
-    render_struct_fields, RenderCtx,
+    build_all_rows, cached_window, changed_style, follow_scroll,
+    format_type_annotation, format_value_styled, heat_style,
+    render_array_elements, render_struct_fields, RenderCtx, RowSink,
 };
-use crate::memory::{stack::Stack, value::Value};
+use crate::interpreter::engine::FunctionDef;
+use crate::memory::stack::{InitState, LocalVar, Stack};
+use crate::memory::value::Value;
 use crate::parser::ast::StructDef;
+use crate::ui::source_text::SourceText;
 use crate::ui::theme::DEFAULT_THEME;
 use ratatui::{
     layout::Rect,
@@ -34,6 +40,7 @@ use ratatui::{
 };
 use std::collections::HashMap;
 use std::hash::BuildHasher;
+use std::sync::Arc;
 
 /// Scroll state for the stack pane
 pub struct StackScrollState {
@@ -41,19 +48,45 @@ pub struct StackScrollState {
     pub prev_item_count: usize,
 }
 
-/// Data needed to render the stack pane
-pub struct StackRenderData<'a, S: BuildHasher, T: BuildHasher> {
+/// Program state shown in the stack pane
+pub struct StackContent<'a, S: BuildHasher, T: BuildHasher> {
     pub stack: &'a Stack,
     pub struct_defs: &'a HashMap<String, StructDef, S>,
-    pub source_code: &'a str,
+    pub source: &'a SourceText,
     pub return_value: Option<&'a Value>,
-    pub function_defs:
-        &'a HashMap<String, crate::interpreter::engine::FunctionDef, T>,
+    pub function_defs: &'a HashMap<String, Arc<FunctionDef>, T>,
     pub error_address: Option<u64>,
+    /// Highlight variables written at this history step or later
+    pub changed_since: Option<usize>,
+    /// Color variables by access count relative to this maximum (heatmap
+    /// on)
+    pub heat_max: Option<u64>,
+}
+
+/// Data needed to render the stack pane
+pub struct StackRenderData<'a, S: BuildHasher, T: BuildHasher> {
+    pub content: StackContent<'a, S, T>,
+    /// Every row of `content`, built ahead of time by [`build_stack_rows`]
+    /// for this pane width
+    pub cached_rows: Option<&'a [ListItem<'static>]>,
     pub is_focused: bool,
     pub scroll_state: &'a mut StackScrollState,
 }
 
+/// Build every row of the stack pane for a pane `width` columns wide, or
+/// `None` if there are more than `max_rows`
+pub fn build_stack_rows<S: BuildHasher, T: BuildHasher>(
+    content: &StackContent<S, T>,
+    width: u16,
+    max_rows: usize,
+) -> Option<Vec<ListItem<'static>>> {
+    let content_width = width.saturating_sub(2) as usize;
+    let call_sites = CallSites::new(content, content_width);
+    build_all_rows(max_rows, |rows| {
+        stack_rows(rows, content, &call_sites, content_width)
+    })
+}
+
 /// Render the stack pane
 pub fn render_stack_pane<S: BuildHasher, T: BuildHasher>(
     frame: &mut Frame,
@@ -73,21 +106,148 @@ pub fn render_stack_pane<S: BuildHasher, T: BuildHasher>(
         .borders(Borders::ALL)
         .border_style(border_style);
 
-    let frames = data.stack.frames();
-    let mut all_items = Vec::new();
-
     // Calculate available width for text wrapping (account for borders)
     let content_width = area.width.saturating_sub(2) as usize; // borders only
+    let visible_height = area.height.saturating_sub(2).max(1) as usize; // Account for borders, min 1
+
+    let scroll = &mut *data.scroll_state;
+    let items = match data.cached_rows {
+        Some(cached) => {
+            follow_scroll(
+                &mut scroll.offset,
+                &mut scroll.prev_item_count,
+                cached.len(),
+                visible_height,
+            );
+            cached_window(cached, scroll.offset..scroll.offset + visible_height)
+        }
+        None => {
+            let content = &data.content;
+            let call_sites = CallSites::new(content, content_width);
+
+            // Size the list, then build only the rows in view
+            let mut counter = RowSink::counter();
+            stack_rows(&mut counter, content, &call_sites, content_width);
+            follow_scroll(
+                &mut scroll.offset,
+                &mut scroll.prev_item_count,
+                counter.rows(),
+                visible_height,
+            );
+
+            let mut rows =
+                RowSink::window(scroll.offset..scroll.offset + visible_height);
+            stack_rows(&mut rows, content, &call_sites, content_width);
+            rows.into_items()
+        }
+    };
+
+    let list = List::new(items).block(block);
+    frame.render_widget(list, area);
+}
+
+/// Call sites of the stack frames and the rows each takes once wrapped.
+///
+/// Every frame repeats the call chain from `main`, so the chain of frame
+/// `d` is the first `d` sites; prefix sums give its height without walking
+/// it.
+struct CallSites<'s> {
+    /// Trimmed source line of the call into frame `d` (index 0 is unused)
+    lines: Vec<Option<&'s str>>,
+    /// Rows of each site
+    rows: Vec<usize>,
+    /// `chain_rows[d]`: rows of the call chain shown under frame `d`
+    chain_rows: Vec<usize>,
+}
+
+impl<'s> CallSites<'s> {
+    fn new<S: BuildHasher, T: BuildHasher>(
+        data: &StackContent<'s, S, T>,
+        content_width: usize,
+    ) -> Self {
+        let frames = data.stack.frames();
+        let mut sites = CallSites {
+            lines: Vec::with_capacity(frames.len()),
+            rows: Vec::with_capacity(frames.len()),
+            chain_rows: Vec::with_capacity(frames.len()),
+        };
+        let mut chain = 0;
+        for (depth, stack_frame) in frames.iter().enumerate() {
+            let line = if depth == 0 {
+                None
+            } else {
+                // Get the line content from source code
+                stack_frame.return_location.as_ref().map(|loc| {
+                    data.source.line(loc.line).unwrap_or("???").trim()
+                })
+            };
+            let rows = line.map_or(0, |trimmed| {
+                let caller_info =
+                    caller_info(depth - 1, &frames[depth - 1].function_name);
+                wrapped_rows(caller_info.len(), trimmed, content_width)
+            });
+            chain += rows;
+            sites.lines.push(line);
+            sites.rows.push(rows);
+            sites.chain_rows.push(chain);
+        }
+        sites
+    }
+}
+
+/// Prefix of a call-site row: `  ↪ [N] function() → `
+fn caller_info(frame_num: usize, caller_name: &str) -> String {
+    format!("  ↪ [{}] {}() → ", frame_num, caller_name)
+}
+
+/// Indent for continuation lines of a wrapped call site
+const CALL_SITE_INDENT: usize = 4;
+
+/// Rows a call site takes: the first line after the caller info, then
+/// indented continuation lines
+fn wrapped_rows(info_len: usize, trimmed: &str, content_width: usize) -> usize {
+    if info_len + trimmed.len() <= content_width {
+        return 1;
+    }
+    let (_, mut remaining) =
+        split_at_char_boundary(trimmed, content_width.saturating_sub(info_len));
+    let mut rows = 1;
+    while !remaining.is_empty() {
+        remaining = split_at_char_boundary(
+            remaining,
+            content_width.saturating_sub(CALL_SITE_INDENT),
+        )
+        .1;
+        rows += 1;
+    }
+    rows
+}
+
+/// Emit every row of the stack pane into `rows`
+fn stack_rows<S: BuildHasher, T: BuildHasher>(
+    rows: &mut RowSink,
+    data: &StackContent<S, T>,
+    call_sites: &CallSites,
+    content_width: usize,
+) {
+    let frames = data.stack.frames();
 
     if frames.is_empty() {
-        all_items.push(
+        rows.push(|| {
             ListItem::new("(empty)")
-                .style(Style::default().fg(DEFAULT_THEME.comment)),
-        );
-    } else {
-        for (depth, stack_frame) in frames.iter().enumerate() {
-            // Create emphasized frame header with box-drawing characters
-            let frame_header = Line::from(vec![
+                .style(Style::default().fg(DEFAULT_THEME.comment))
+        });
+        return;
+    }
+
+    for (depth, stack_frame) in frames.iter().enumerate() {
+        if rows.is_full() {
+            return;
+        }
+
+        // Create emphasized frame header with box-drawing characters
+        rows.push(|| {
+            ListItem::new(Line::from(vec![
                 Span::styled(
                     "▸ ",
                     Style::default().fg(DEFAULT_THEME.secondary),
@@ -103,465 +263,336 @@ pub fn render_stack_pane<S: BuildHasher, T: BuildHasher>(
                         .fg(DEFAULT_THEME.function)
                         .add_modifier(Modifier::BOLD),
                 ),
-            ]);
-
-            all_items.push(ListItem::new(frame_header));
+            ]))
+        });
 
-            // Show the complete call chain from main to this frame
-            // Collect all call sites from frame 1 up to current frame
+        // Show the complete call chain from main to this frame
+        rows.section(call_sites.chain_rows[depth], |rows| {
             for caller_depth in 1..=depth {
-                if let Some(loc) = &frames[caller_depth].return_location {
-                    // Get the line content from source code
-                    let line_content = data
-                        .source_code
-                        .lines()
-                        .nth(loc.line.saturating_sub(1))
-                        .unwrap_or("???");
-                    let trimmed = line_content.trim();
-
-                    // Get caller function name and frame number
-                    let caller_name = &frames[caller_depth - 1].function_name;
-                    let frame_num = caller_depth - 1;
-
-                    // Format: ↪ [N] function() → call_site
-                    let caller_info =
-                        format!("  ↪ [{}] {}() → ", frame_num, caller_name);
-
-                    // Wrap the call site text if it's too long
-                    if caller_info.len() + trimmed.len() <= content_width {
-                        // Fits on one line
-                        let location_line = Line::from(vec![
-                            Span::styled(
-                                "  ↪ ",
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                            Span::styled(
-                                format!("[{}] ", frame_num),
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                            Span::styled(
-                                format!("{}()", caller_name),
-                                Style::default()
-                                    .fg(DEFAULT_THEME.muted_function),
-                            ),
-                            Span::styled(
-                                " → ",
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                            Span::styled(
-                                trimmed.to_string(),
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                        ]);
-                        all_items.push(ListItem::new(location_line));
-                    } else {
-                        // Need to wrap - first line has the caller info
-                        let call_site_indent = 4; // Indent for continuation lines
-                        let first_line_chars =
-                            content_width.saturating_sub(caller_info.len());
-                        let (first_part, rest) =
-                            split_at_char_boundary(trimmed, first_line_chars);
-
-                        let first_line = Line::from(vec![
-                            Span::styled(
-                                "  ↪ ",
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                            Span::styled(
-                                format!("[{}] ", frame_num),
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                            Span::styled(
-                                format!("{}()", caller_name),
-                                Style::default()
-                                    .fg(DEFAULT_THEME.muted_function),
-                            ),
-                            Span::styled(
-                                " → ",
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                            Span::styled(
-                                first_part.to_string(),
-                                Style::default().fg(DEFAULT_THEME.comment),
-                            ),
-                        ]);
-                        all_items.push(ListItem::new(first_line));
-
-                        // Wrap remaining text
-                        let mut remaining = rest;
-                        while !remaining.is_empty() {
-                            let wrap_width =
-                                content_width.saturating_sub(call_site_indent);
-                            let (part, next_rest) =
-                                split_at_char_boundary(remaining, wrap_width);
-                            let continuation = Line::from(vec![
-                                Span::raw("    "), // Indent continuation lines
-                                Span::styled(
-                                    part.to_string(),
-                                    Style::default().fg(DEFAULT_THEME.comment),
-                                ),
-                            ]);
-                            all_items.push(ListItem::new(continuation));
-                            remaining = next_rest;
-                        }
-                    }
+                let Some(trimmed) = call_sites.lines[caller_depth] else {
+                    continue;
+                };
+                rows.section(call_sites.rows[caller_depth], |rows| {
+                    call_site_rows(
+                        rows,
+                        caller_depth - 1,
+                        &frames[caller_depth - 1].function_name,
+                        trimmed,
+                        content_width,
+                    );
+                });
+                if rows.is_full() {
+                    return;
                 }
             }
-
-            // Display return value if present (only for top frame - the currently executing function)
-            if depth == frames.len() - 1 {
-                if let Some(ret_val) = data.return_value {
-                    let val_spans =
-                        format_value_styled(ret_val, data.struct_defs, 0);
-
-                    // Get return type from function definition
-                    let return_type_str = data
-                        .function_defs
-                        .get(&stack_frame.function_name)
-                        .map(|func_def| {
-                            format_type_annotation(
-                                &func_def.return_type,
-                                data.struct_defs,
-                            )
-                        })
-                        .unwrap_or_else(|| "?".to_string());
-
-                    // Calculate widths for alignment
-                    let val_width: usize =
-                        val_spans.iter().map(|s| s.content.len()).sum();
-                    // "     ↖ " (7) + "return " (7) + ": " (2) = 16
-                    let left_width = 16 + val_width;
-                    let right_width = return_type_str.len();
-                    let padding =
-                        content_width.saturating_sub(left_width + right_width);
-
-                    let mut spans = vec![
-                        Span::styled(
-                            "     ↖ ",
-                            Style::default()
-                                .fg(DEFAULT_THEME.return_value)
-                                .add_modifier(Modifier::BOLD),
-                        ),
-                        Span::styled(
-                            "return ",
-                            Style::default()
-                                .fg(DEFAULT_THEME.return_value)
-                                .add_modifier(Modifier::BOLD),
-                        ),
-                        Span::styled(
-                            ": ",
-                            Style::default().fg(DEFAULT_THEME.return_value),
-                        ),
-                    ];
-
-                    spans.extend(val_spans.into_iter().map(|span| {
-                        Span::styled(
-                            span.content.to_string(),
-                            span.style.fg(DEFAULT_THEME.return_value),
-                        )
-                    }));
-
-                    spans.push(Span::raw(" ".repeat(padding)));
-
-                    spans.push(Span::styled(
-                        return_type_str,
-                        Style::default().fg(DEFAULT_THEME.type_name),
-                    ));
-
-                    let line = Line::from(spans);
-                    all_items.push(ListItem::new(line));
-                }
+        });
+
+        // Display return value if present (only for top frame - the currently executing function)
+        if depth == frames.len() - 1 {
+            if let Some(ret_val) = data.return_value {
+                rows.push(|| {
+                    return_value_row(
+                        ret_val,
+                        &stack_frame.function_name,
+                        data,
+                        content_width,
+                    )
+                });
             }
+        }
 
-            // Local variables
-            // Iterate in declaration order (insertion_order)
-            for var_name in &stack_frame.insertion_order {
-                if let Some(local_var) = stack_frame.locals.get(var_name) {
-                    let init_state = match &local_var.init_state {
-                        crate::memory::stack::InitState::Initialized => None,
-                        crate::memory::stack::InitState::Uninitialized => Some(" [uninit]"),
-                        crate::memory::stack::InitState::PartiallyInitialized(_) => {
-                            Some(" [partial]")
-                        }
-                    };
-
-                    // Format the address
-                    let addr_style =
-                        if Some(local_var.address) == data.error_address {
-                            Style::default()
-                                .fg(DEFAULT_THEME.error)
-                                .add_modifier(Modifier::BOLD)
-                        } else {
-                            Style::default().fg(DEFAULT_THEME.comment)
-                        };
-
-                    let addr_span = Span::styled(
-                        format!("0x{:08x} ", local_var.address),
-                        addr_style,
-                    );
-
-                    // Show structs with fields on separate lines
-                    match &local_var.value {
-                        Value::Array(elements) => {
-                            // Treat arrays similarly to structs - show each index with address
-                            let init_span = if let Some(s) = init_state {
-                                Span::styled(
-                                    s,
-                                    Style::default().fg(DEFAULT_THEME.error),
-                                )
-                            } else {
-                                Span::raw("")
-                            };
-
-                            // Get the array type name
-                            let type_str = format_type_annotation(
-                                &local_var.var_type,
-                                data.struct_defs,
-                            );
-
-                            // Align type to right
-                            let type_width = type_str.len();
-                            let init_len = if let Some(s) = init_state {
-                                s.len()
-                            } else {
-                                0
-                            };
-                            // addr(11) + " " + name + " " + ": " + init = 15 + name + init
-                            let left_width = 15 + var_name.len() + init_len;
-                            let padding = content_width
-                                .saturating_sub(left_width + type_width);
-
-                            let header = Line::from(vec![
-                                addr_span,
-                                Span::styled(
-                                    format!(" {} ", var_name),
-                                    Style::default().fg(DEFAULT_THEME.fg),
-                                ),
-                                Span::styled(
-                                    ": ",
-                                    Style::default().fg(DEFAULT_THEME.fg),
-                                ),
-                                init_span,
-                                Span::raw(" ".repeat(padding)),
-                                Span::styled(
-                                    type_str,
-                                    Style::default()
-                                        .fg(DEFAULT_THEME.type_name),
-                                ),
-                            ]);
-
-                            all_items.push(ListItem::new(header));
-
-                            // Render array elements with addresses
-                            let ctx = RenderCtx {
-                                struct_defs: data.struct_defs,
-                                content_width,
-                            };
-                            // Render array elements with addresses
-                            render_array_elements(
-                                &mut all_items,
-                                elements,
-                                &local_var.var_type,
-                                local_var.address,
-                                1, // indent level
-                                &ctx,
-                            );
-                        }
-                        Value::Struct(fields) => {
-                            let init_span = if let Some(s) = init_state {
-                                Span::styled(
-                                    s,
-                                    Style::default().fg(DEFAULT_THEME.error),
-                                )
-                            } else {
-                                Span::raw("")
-                            };
-
-                            // Get the struct type name
-                            let type_str = format_type_annotation(
-                                &local_var.var_type,
-                                data.struct_defs,
-                            );
-
-                            // Align type to right
-                            let type_width = type_str.len();
-                            let init_len = if let Some(s) = init_state {
-                                s.len()
-                            } else {
-                                0
-                            };
-                            // addr(11) + " " + name + " " + ": " + init = 15 + name + init
-                            let left_width = 15 + var_name.len() + init_len;
-                            let padding = content_width
-                                .saturating_sub(left_width + type_width);
-
-                            let header = Line::from(vec![
-                                addr_span,
-                                Span::styled(
-                                    format!(" {} ", var_name),
-                                    Style::default().fg(DEFAULT_THEME.fg),
-                                ),
-                                Span::styled(
-                                    ": ",
-                                    Style::default().fg(DEFAULT_THEME.fg),
-                                ),
-                                init_span,
-                                Span::raw(" ".repeat(padding)),
-                                Span::styled(
-                                    type_str,
-                                    Style::default()
-                                        .fg(DEFAULT_THEME.type_name),
-                                ),
-                            ]);
-
-                            all_items.push(ListItem::new(header));
-
-                            // Render struct fields recursively
-                            let ctx = RenderCtx {
-                                struct_defs: data.struct_defs,
-                                content_width,
-                            };
-                            // Render struct fields recursively
-                            render_struct_fields(
-                                &mut all_items,
-                                fields,
-                                &local_var.var_type,
-                                local_var.address,
-                                1, // indent level
-                                &ctx,
-                            );
-                        }
-                        _ => {
-                            let val_spans = format_value_styled(
-                                &local_var.value,
-                                data.struct_defs,
-                                0,
-                            );
-
-                            // Only add init_span if the value isn't already displaying its uninitialized state
-                            let init_span = if matches!(
-                                local_var.value,
-                                Value::Uninitialized
-                            ) {
-                                // Value::Uninitialized already displays [uninit], don't duplicate
-                                Span::raw("")
-                            } else if let Some(s) = init_state {
-                                Span::styled(
-                                    s,
-                                    Style::default().fg(DEFAULT_THEME.error),
-                                )
-                            } else {
-                                Span::raw("")
-                            };
-
-                            // Add type annotation for non-struct variables
-                            let type_str = format_type_annotation(
-                                &local_var.var_type,
-                                data.struct_defs,
-                            );
-                            let type_width = if type_str.is_empty() {
-                                0
-                            } else {
-                                type_str.len()
-                            };
-
-                            // Width calculation for alignment
-                            let val_width: usize =
-                                val_spans.iter().map(|s| s.content.len()).sum();
-                            let init_content: &str = if matches!(
-                                local_var.value,
-                                Value::Uninitialized
-                            ) {
-                                ""
-                            } else {
-                                init_state.unwrap_or_default()
-                            };
-
-                            // addr(11) + name + " " + ": " + val + init = 14 + name + val + init
-                            let left_width = 14
-                                + var_name.len()
-                                + val_width
-                                + init_content.len();
-                            let padding = content_width
-                                .saturating_sub(left_width + type_width);
-
-                            let mut spans = vec![
-                                addr_span,
-                                Span::styled(
-                                    format!("{} ", var_name),
-                                    Style::default().fg(DEFAULT_THEME.fg),
-                                ),
-                                Span::styled(
-                                    ": ",
-                                    Style::default().fg(DEFAULT_THEME.fg),
-                                ),
-                            ];
-
-                            spans.extend(val_spans);
-                            spans.push(init_span);
-
-                            // Add type annotation aligned to right
-                            if !type_str.is_empty() {
-                                spans.push(Span::raw(" ".repeat(padding)));
-                                spans.push(Span::styled(
-                                    type_str,
-                                    Style::default()
-                                        .fg(DEFAULT_THEME.type_name),
-                                ));
-                            }
-
-                            let line = Line::from(spans);
-                            all_items.push(ListItem::new(line));
-                        }
-                    }
-                }
+        // Local variables
+        // Iterate in declaration order (insertion_order)
+        for var_name in &stack_frame.insertion_order {
+            if rows.is_full() {
+                return;
             }
+            if let Some(local_var) = stack_frame.locals.get(var_name) {
+                local_rows(rows, var_name, local_var, data, content_width);
+            }
+        }
 
-            // Add spacing between frames
-            if depth < frames.len() - 1 {
-                let separator = Line::from(Span::styled(
+        // Add spacing between frames
+        if depth < frames.len() - 1 {
+            rows.push(|| {
+                ListItem::new(Line::from(Span::styled(
                     "",
                     Style::default().fg(DEFAULT_THEME.comment),
-                ));
-                all_items.push(ListItem::new(separator));
-            }
+                )))
+            });
         }
     }
+}
 
-    // Calculate visible range for scrolling
-    let total_items = all_items.len();
-    let visible_height = area.height.saturating_sub(2).max(1) as usize; // Account for borders, min 1
-
-    // Smart auto-scroll: scroll to bottom only when content grows
-    if total_items > data.scroll_state.prev_item_count {
-        // Content grew (new frame/variable added), auto-scroll to bottom
-        if total_items > visible_height {
-            data.scroll_state.offset = total_items - visible_height;
-        } else {
-            data.scroll_state.offset = 0;
-        }
+/// Emit the rows of one call site, wrapping the call text if it is too long
+fn call_site_rows(
+    rows: &mut RowSink,
+    frame_num: usize,
+    caller_name: &str,
+    trimmed: &str,
+    content_width: usize,
+) {
+    // Format: ↪ [N] function() → call_site
+    let info_len = caller_info(frame_num, caller_name).len();
+    let (first_part, rest) = if info_len + trimmed.len() <= content_width {
+        // Fits on one line
+        (trimmed, "")
     } else {
-        // Content same or shrank, respect user's scroll position (just clamp)
-        if total_items > visible_height {
-            let max_scroll = total_items - visible_height;
-            data.scroll_state.offset = data.scroll_state.offset.min(max_scroll);
-        } else {
-            data.scroll_state.offset = 0;
-        }
+        // Need to wrap - first line has the caller info
+        split_at_char_boundary(trimmed, content_width.saturating_sub(info_len))
+    };
+
+    rows.push(|| {
+        ListItem::new(Line::from(vec![
+            Span::styled("  ↪ ", Style::default().fg(DEFAULT_THEME.comment)),
+            Span::styled(
+                format!("[{}] ", frame_num),
+                Style::default().fg(DEFAULT_THEME.comment),
+            ),
+            Span::styled(
+                format!("{}()", caller_name),
+                Style::default().fg(DEFAULT_THEME.muted_function),
+            ),
+            Span::styled(" → ", Style::default().fg(DEFAULT_THEME.comment)),
+            Span::styled(
+                first_part.to_string(),
+                Style::default().fg(DEFAULT_THEME.comment),
+            ),
+        ]))
+    });
+
+    // Wrap remaining text
+    let mut remaining = rest;
+    while !remaining.is_empty() && !rows.is_full() {
+        let wrap_width = content_width.saturating_sub(CALL_SITE_INDENT);
+        let (part, next_rest) = split_at_char_boundary(remaining, wrap_width);
+        rows.push(|| {
+            ListItem::new(Line::from(vec![
+                Span::raw("    "), // Indent continuation lines
+                Span::styled(
+                    part.to_string(),
+                    Style::default().fg(DEFAULT_THEME.comment),
+                ),
+            ]))
+        });
+        remaining = next_rest;
     }
+}
 
-    // Update previous item count for next render
-    data.scroll_state.prev_item_count = total_items;
+/// Row showing the value being returned by the top frame
+fn return_value_row<'r, S: BuildHasher, T: BuildHasher>(
+    ret_val: &Value,
+    function_name: &str,
+    data: &StackContent<S, T>,
+    content_width: usize,
+) -> ListItem<'r> {
+    let val_spans = format_value_styled(ret_val, data.struct_defs, 0);
+
+    // Get return type from function definition
+    let return_type_str = data
+        .function_defs
+        .get(function_name)
+        .map(|func_def| {
+            format_type_annotation(&func_def.return_type, data.struct_defs)
+        })
+        .unwrap_or_else(|| "?".to_string());
+
+    // Calculate widths for alignment
+    let val_width: usize = val_spans.iter().map(|s| s.content.len()).sum();
+    // "     ↖ " (7) + "return " (7) + ": " (2) = 16
+    let left_width = 16 + val_width;
+    let right_width = return_type_str.len();
+    let padding = content_width.saturating_sub(left_width + right_width);
+
+    let mut spans = vec![
+        Span::styled(
+            "     ↖ ",
+            Style::default()
+                .fg(DEFAULT_THEME.return_value)
+                .add_modifier(Modifier::BOLD),
+        ),
+        Span::styled(
+            "return ",
+            Style::default()
+                .fg(DEFAULT_THEME.return_value)
+                .add_modifier(Modifier::BOLD),
+        ),
+        Span::styled(": ", Style::default().fg(DEFAULT_THEME.return_value)),
+    ];
+
+    spans.extend(val_spans.into_iter().map(|span| {
+        Span::styled(
+            span.content.to_string(),
+            span.style.fg(DEFAULT_THEME.return_value),
+        )
+    }));
+
+    spans.push(Span::raw(" ".repeat(padding)));
+
+    spans.push(Span::styled(
+        return_type_str,
+        Style::default().fg(DEFAULT_THEME.type_name),
+    ));
+
+    ListItem::new(Line::from(spans))
+}
 
-    // Take only visible items
-    let visible_items: Vec<ListItem> = all_items
-        .into_iter()
-        .skip(data.scroll_state.offset)
-        .take(visible_height)
-        .collect();
+/// Emit the rows of one local variable: a single line for scalars, or a
+/// header followed by elements or fields for arrays and structs
+fn local_rows<S: BuildHasher, T: BuildHasher>(
+    rows: &mut RowSink,
+    var_name: &str,
+    local_var: &LocalVar,
+    data: &StackContent<S, T>,
+    content_width: usize,
+) {
+    let init_state = match &local_var.init_state {
+        InitState::Initialized => None,
+        InitState::Uninitialized => Some(" [uninit]"),
+        InitState::PartiallyInitialized(_) => Some(" [partial]"),
+    };
 
-    let list = List::new(visible_items).block(block);
-    frame.render_widget(list, area);
+    // Format the address
+    let addr_span = || {
+        let addr_style = if Some(local_var.address) == data.error_address {
+            Style::default()
+                .fg(DEFAULT_THEME.error)
+                .add_modifier(Modifier::BOLD)
+        } else {
+            Style::default().fg(DEFAULT_THEME.comment)
+        };
+        Span::styled(format!("0x{:08x} ", local_var.address), addr_style)
+    };
+
+    let ctx = RenderCtx {
+        struct_defs: data.struct_defs,
+        content_width,
+    };
+    let row_style =
+        heat_style(local_var.access, data.heat_max).patch(changed_style(
+            data.changed_since
+                .is_some_and(|step| local_var.modified_step >= step),
+        ));
+
+    // Show arrays and structs with elements/fields on separate lines
+    match &local_var.value {
+        Value::Array(_) | Value::Struct(_) => {
+            rows.push(|| {
+                let init_span = if let Some(s) = init_state {
+                    Span::styled(s, Style::default().fg(DEFAULT_THEME.error))
+                } else {
+                    Span::raw("")
+                };
+
+                // Get the array/struct type name
+                let type_str = format_type_annotation(
+                    &local_var.var_type,
+                    data.struct_defs,
+                );
+
+                // Align type to right
+                let type_width = type_str.len();
+                let init_len = init_state.map_or(0, str::len);
+                // addr(11) + " " + name + " " + ": " + init = 15 + name + init
+                let left_width = 15 + var_name.len() + init_len;
+                let padding =
+                    content_width.saturating_sub(left_width + type_width);
+
+                ListItem::new(Line::from(vec![
+                    addr_span(),
+                    Span::styled(
+                        format!(" {} ", var_name),
+                        Style::default().fg(DEFAULT_THEME.fg),
+                    ),
+                    Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
+                    init_span,
+                    Span::raw(" ".repeat(padding)),
+                    Span::styled(
+                        type_str,
+                        Style::default().fg(DEFAULT_THEME.type_name),
+                    ),
+                ]))
+                .style(row_style)
+            });
+
+            match &local_var.value {
+                Value::Array(elements) => render_array_elements(
+                    rows,
+                    elements,
+                    &local_var.var_type,
+                    local_var.address,
+                    1, // indent level
+                    &ctx,
+                ),
+                Value::Struct(fields) => render_struct_fields(
+                    rows,
+                    fields,
+                    &local_var.var_type,
+                    local_var.address,
+                    1, // indent level
+                    &ctx,
+                ),
+                _ => {}
+            }
+        }
+        _ => rows.push(|| {
+            let val_spans =
+                format_value_styled(&local_var.value, data.struct_defs, 0);
+
+            // Value::Uninitialized already displays [uninit], don't duplicate
+            let init_content =
+                if matches!(local_var.value, Value::Uninitialized) {
+                    ""
+                } else {
+                    init_state.unwrap_or_default()
+                };
+            let init_span = if init_content.is_empty() {
+                Span::raw("")
+            } else {
+                Span::styled(
+                    init_content,
+                    Style::default().fg(DEFAULT_THEME.error),
+                )
+            };
+
+            // Add type annotation for non-struct variables
+            let type_str =
+                format_type_annotation(&local_var.var_type, data.struct_defs);
+
+            // Width calculation for alignment
+            let val_width: usize =
+                val_spans.iter().map(|s| s.content.len()).sum();
+
+            // addr(11) + name + " " + ": " + val + init = 14 + name + val + init
+            let left_width =
+                14 + var_name.len() + val_width + init_content.len();
+            let padding =
+                content_width.saturating_sub(left_width + type_str.len());
+
+            let mut spans = vec![
+                addr_span(),
+                Span::styled(
+                    format!("{} ", var_name),
+                    Style::default().fg(DEFAULT_THEME.fg),
+                ),
+                Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
+            ];
+
+            spans.extend(val_spans);
+            spans.push(init_span);
+
+            // Add type annotation aligned to right
+            if !type_str.is_empty() {
+                spans.push(Span::raw(" ".repeat(padding)));
+                spans.push(Span::styled(
+                    type_str,
+                    Style::default().fg(DEFAULT_THEME.type_name),
+                ));
+            }
+
+            ListItem::new(Line::from(spans)).style(row_style)
+        }),
+    }
 }
 
 /// Split a string at a character boundary, ensuring we don't cut in the middle of a char
@@ -1,5 +1,9 @@
 //! Status bar rendering with keybindings and state indicators
+//!
+//! An optional second line above the bar shows the interpreter statistics:
+//! work counters and the memory retained by history.
 
+use crate::interpreter::stats::InterpreterStats;
 use crate::ui::theme::DEFAULT_THEME;
 use ratatui::{
     layout::{Alignment, Rect},
@@ -9,13 +13,43 @@ use ratatui::{
     Frame,
 };
 
+/// Width of the timeline scrubber in cells
+pub const SCRUBBER_WIDTH: usize = 20;
+
+/// Keybind hints in display order, with the rank they are kept by when the
+/// bar is too narrow for all of them (lower ranks are kept first)
+const KEY_HINTS: [(&str, &str, u8); 14] = [
+    (" ←/→ ", " step ", 0),
+    (" g ", " go to ", 2),
+    (" s ", " step over ", 1),
+    (" p ", " profile ", 3),
+    (" v ", " graph ", 3),
+    (" f ", " hotspots ", 3),
+    (" m ", " heatmap ", 3),
+    (" i ", " stats ", 3),
+    (" e ", " plot ", 3),
+    (" ⎵ ", " play ", 1),
+    (" -/+ ", " speed ", 2),
+    (" c ", " run to cursor ", 2),
+    (" ↵ / ⌫ ", " end/start ", 1),
+    (" q ", " quit ", 0),
+];
+
 /// Data needed to render the status bar
 pub struct StatusRenderData<'a> {
     pub message: &'a str,
     pub current_step: usize,
     pub total_steps: Option<usize>,
+    /// Number of recorded history positions (known even at a scanf)
+    pub history_len: usize,
+    /// Text typed into the "go to step" prompt, when it is open
+    pub goto_input: Option<&'a str>,
+    /// Text typed into the "plot expression" prompt, if it is open
+    pub plot_input: Option<&'a str>,
     pub error_state: Option<&'a crate::ui::app::ErrorState>,
     pub is_playing: bool,
+    /// Auto-play rate in steps per second
+    pub play_speed: u32,
     pub is_scanf_input: bool,
 }
 
@@ -46,7 +80,7 @@ pub fn render_status_bar(
         format!(" Step {}/? ", data.current_step + 1)
     };
 
-    let left_spans = vec![
+    let mut left_spans = vec![
         Span::styled(
             step_text,
             Style::default()
@@ -60,13 +94,30 @@ pub fn render_status_bar(
                 .fg(Color::Black)
                 .add_modifier(Modifier::BOLD),
         ),
+        scrubber_span(data.current_step, data.history_len),
         Span::styled(
             " | ",
             Style::default()
                 .bg(DEFAULT_THEME.current_line_bg)
                 .fg(DEFAULT_THEME.comment),
         ),
-        Span::styled(
+    ];
+    let prompt = match (data.goto_input, data.plot_input) {
+        (Some(input), _) => Some(format!(" Go to step (N or N%): {}▏", input)),
+        (None, Some(input)) => {
+            Some(format!(" Plot expression (empty to clear): {}▏", input))
+        }
+        (None, None) => None,
+    };
+    match prompt {
+        Some(prompt) => left_spans.push(Span::styled(
+            prompt,
+            Style::default()
+                .bg(DEFAULT_THEME.current_line_bg)
+                .fg(DEFAULT_THEME.secondary)
+                .add_modifier(Modifier::BOLD),
+        )),
+        None => left_spans.push(Span::styled(
             format!(" {} ", data.message),
             Style::default().bg(DEFAULT_THEME.current_line_bg).fg(
                 if data.error_state.is_some() {
@@ -75,8 +126,8 @@ pub fn render_status_bar(
                     DEFAULT_THEME.fg
                 },
             ),
-        ),
-    ];
+        )),
+    }
 
     let left_paragraph = Paragraph::new(Line::from(left_spans))
         .style(Style::default().bg(DEFAULT_THEME.current_line_bg))
@@ -93,69 +144,54 @@ pub fn render_status_bar(
         .bg(DEFAULT_THEME.current_line_bg)
         .fg(DEFAULT_THEME.comment);
 
-    let mut right_spans = vec![
-        Span::styled(" ←/→ ", key_style),
-        Span::styled(" step ", desc_style),
-        Span::styled("│", sep_style),
-        Span::styled(" ", desc_style),
-        Span::styled(" s ", key_style),
-        Span::styled(" step over ", desc_style),
-        Span::styled("│", sep_style),
-        Span::styled(" ", desc_style),
-        Span::styled(" ⎵ ", key_style),
-        Span::styled(" play ", desc_style),
-        Span::styled("│", sep_style),
-        Span::styled(" ", desc_style),
-        Span::styled(" ↵ / ⌫ ", key_style),
-        Span::styled(" end/start ", desc_style),
-        Span::styled("│", sep_style),
-        Span::styled(" ", desc_style),
-        Span::styled("q", key_style),
-        Span::styled(" quit ", desc_style),
-    ];
-
     // Show status indicators based on position and state
     let is_at_start = data.current_step == 0;
     let is_at_end = data
         .total_steps
         .is_some_and(|total| data.current_step + 1 >= total);
-
-    if data.is_scanf_input {
-        right_spans.push(Span::styled("│", sep_style));
-        right_spans.push(Span::styled(
-            " ⌨ INPUT ",
-            Style::default()
-                .bg(DEFAULT_THEME.secondary)
-                .fg(Color::Black)
-                .add_modifier(Modifier::BOLD),
-        ));
+    let indicator = if data.is_scanf_input {
+        Some((" ⌨ INPUT ".to_string(), DEFAULT_THEME.secondary))
     } else if data.is_playing {
-        right_spans.push(Span::styled("│", sep_style));
-        right_spans.push(Span::styled(
-            " ▶ PLAYING ",
-            Style::default()
-                .bg(DEFAULT_THEME.secondary)
-                .fg(Color::Black)
-                .add_modifier(Modifier::BOLD),
-        ));
+        Some((
+            format!(" ▶ PLAYING {}/s ", data.play_speed),
+            DEFAULT_THEME.secondary,
+        ))
     } else if is_at_end {
-        right_spans.push(Span::styled("│", sep_style));
-        right_spans.push(Span::styled(
-            " END ",
-            Style::default()
-                .bg(DEFAULT_THEME.error)
-                .fg(Color::Black)
-                .add_modifier(Modifier::BOLD),
-        ));
+        Some((" END ".to_string(), DEFAULT_THEME.error))
     } else if is_at_start {
-        right_spans.push(Span::styled("│", sep_style));
-        right_spans.push(Span::styled(
-            " START ",
+        Some((" START ".to_string(), DEFAULT_THEME.success))
+    } else {
+        None
+    };
+    let indicator = indicator.map(|(text, bg)| {
+        Span::styled(
+            text,
             Style::default()
-                .bg(DEFAULT_THEME.success)
+                .bg(bg)
                 .fg(Color::Black)
                 .add_modifier(Modifier::BOLD),
-        ));
+        )
+    });
+
+    // Keybinds that fit next to the indicator
+    let indicator_width = indicator.as_ref().map_or(0, |s| s.width() + 1);
+    let shown =
+        fit_hints(usize::from(layout[1].width).saturating_sub(indicator_width));
+    let mut right_spans = Vec::new();
+    for (&(key, desc, _), shown) in KEY_HINTS.iter().zip(shown) {
+        if !shown {
+            continue;
+        }
+        if !right_spans.is_empty() {
+            right_spans.push(Span::styled("│", sep_style));
+            right_spans.push(Span::styled(" ", desc_style));
+        }
+        right_spans.push(Span::styled(key, key_style));
+        right_spans.push(Span::styled(desc, desc_style));
+    }
+    if let Some(indicator) = indicator {
+        right_spans.push(Span::styled("│", sep_style));
+        right_spans.push(indicator);
     }
 
     let right_paragraph = Paragraph::new(Line::from(right_spans))
@@ -164,3 +200,140 @@ pub fn render_status_bar(
 
     frame.render_widget(right_paragraph, layout[1]);
 }
+
+/// Which of [`KEY_HINTS`] fit in `width` cells, taken by rank and then in
+/// display order until one does not fit; hints after the first take a
+/// two-cell separator
+fn fit_hints(width: usize) -> [bool; KEY_HINTS.len()] {
+    let mut order: Vec<usize> = (0..KEY_HINTS.len()).collect();
+    order.sort_by_key(|&i| KEY_HINTS[i].2);
+    let mut shown = [false; KEY_HINTS.len()];
+    let mut used = 0;
+    for i in order {
+        let (key, desc, _) = KEY_HINTS[i];
+        let separator = if used == 0 { 0 } else { 2 };
+        let cost = Span::raw(key).width() + Span::raw(desc).width() + separator;
+        if used + cost > width {
+            break;
+        }
+        used += cost;
+        shown[i] = true;
+    }
+    shown
+}
+
+/// Human-readable byte count (B, KiB, MiB, GiB)
+fn format_bytes(bytes: usize) -> String {
+    const UNITS: [&str; 4] = ["B", "KiB", "MiB", "GiB"];
+    let mut value = bytes as f64;
+    let mut unit = 0;
+    while value >= 1024.0 && unit + 1 < UNITS.len() {
+        value /= 1024.0;
+        unit += 1;
+    }
+    if unit == 0 {
+        format!("{} B", bytes)
+    } else {
+        format!("{:.1} {}", value, UNITS[unit])
+    }
+}
+
+/// Render the statistics line shown above the status bar
+pub fn render_stats_line(
+    frame: &mut Frame,
+    area: Rect,
+    stats: &InterpreterStats,
+) {
+    let label_style = Style::default()
+        .bg(DEFAULT_THEME.current_line_bg)
+        .fg(DEFAULT_THEME.comment);
+    let value_style = Style::default()
+        .bg(DEFAULT_THEME.current_line_bg)
+        .fg(DEFAULT_THEME.number);
+    let history = stats.history;
+    let fields = [
+        ("snapshots", stats.snapshots.to_string()),
+        (
+            "history",
+            format!(
+                "{} of {}",
+                format_bytes(history.total()),
+                format_bytes(stats.memory_limit)
+            ),
+        ),
+        ("stack", format_bytes(history.stack)),
+        ("heap", format_bytes(history.heap)),
+        ("terminal", format_bytes(history.terminal)),
+        ("tables", format_bytes(history.side_tables)),
+        ("stmts", stats.statements.to_string()),
+        ("exprs", stats.expressions.to_string()),
+        (
+            "malloc/free",
+            format!("{}/{}", stats.allocations, stats.frees),
+        ),
+        ("peak heap", format_bytes(stats.peak_heap_bytes)),
+    ];
+
+    let mut spans = Vec::new();
+    for (label, value) in fields {
+        spans.push(Span::styled(format!(" {} ", label), label_style));
+        spans.push(Span::styled(format!("{} ", value), value_style));
+        spans.push(Span::styled("│", label_style));
+    }
+    spans.pop();
+
+    let paragraph = Paragraph::new(Line::from(spans))
+        .style(Style::default().bg(DEFAULT_THEME.current_line_bg))
+        .alignment(Alignment::Left);
+    frame.render_widget(paragraph, area);
+}
+
+/// Timeline of the recorded history with a marker at `position`; each cell
+/// is one `[` / `]` jump
+fn scrubber_span(position: usize, history_len: usize) -> Span<'static> {
+    let head = match history_len {
+        0 | 1 => 0,
+        len => position.min(len - 1) * (SCRUBBER_WIDTH - 1) / (len - 1),
+    };
+    let bar: String = (0..SCRUBBER_WIDTH)
+        .map(|cell| match cell.cmp(&head) {
+            std::cmp::Ordering::Less => '━',
+            std::cmp::Ordering::Equal => '●',
+            std::cmp::Ordering::Greater => '─',
+        })
+        .collect();
+    Span::styled(
+        format!(" {} ", bar),
+        Style::default()
+            .bg(DEFAULT_THEME.current_line_bg)
+            .fg(DEFAULT_THEME.primary),
+    )
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_hints_dropped_by_rank() {
+        assert!(fit_hints(usize::MAX).iter().all(|&shown| shown));
+        assert!(fit_hints(0).iter().all(|&shown| !shown));
+
+        // Only step and quit fit in 22 cells
+        let shown = fit_hints(22);
+        let kept: Vec<&str> = KEY_HINTS
+            .iter()
+            .zip(shown)
+            .filter(|(_, shown)| *shown)
+            .map(|(hint, _)| hint.1)
+            .collect();
+        assert_eq!(kept, [" step ", " quit "]);
+
+        // A narrower bar never shows a hint a wider one drops
+        for width in 0..200 {
+            let narrow = fit_hints(width);
+            let wide = fit_hints(width + 1);
+            assert!(narrow.iter().zip(wide).all(|(&n, w)| !n || w));
+        }
+    }
+}
@@ -1,4 +1,9 @@
 //! Terminal output pane rendering
+//!
+//! Output is shown through a [`TerminalIndex`]: byte ranges of the display
+//! lines inside the terminal's stored lines. Within one run output only
+//! grows, so moving through history extends or truncates the index instead
+//! of splitting all output again, and drawing touches only the visible rows.
 
 use crate::snapshot::{MockTerminal, TerminalLineKind};
 use crate::ui::theme::DEFAULT_THEME;
@@ -15,9 +20,120 @@ pub struct TerminalScrollState {
     pub offset: usize,
 }
 
+/// Most recent rows the pane scrolls through
+const SCROLLBACK_ROWS: usize = 10_000;
+
+/// One display line: `start..end` of the text of terminal line `line`
+#[derive(Debug, Clone, Copy)]
+struct TerminalRow {
+    line: usize,
+    start: usize,
+    end: usize,
+}
+
+/// Display lines of a [`MockTerminal`], kept in step with it as the history
+/// position moves.
+///
+/// Rows match [`MockTerminal::get_output`]: each stored line split on `\n`,
+/// without an empty segment after a trailing newline. The index assumes the
+/// terminal it follows only gains output or loses it from the end, which
+/// holds within one recorded run; call [`invalidate`](Self::invalidate)
+/// when the history is recorded again.
+#[derive(Default)]
+pub struct TerminalIndex {
+    rows: Vec<TerminalRow>,
+    /// Terminal lines covered by `rows`
+    lines: usize,
+    /// Bytes of the last covered line that `rows` cover
+    last_len: usize,
+}
+
+impl TerminalIndex {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Forget all rows, e.g. after the program was re-run
+    pub fn invalidate(&mut self) {
+        *self = Self::default();
+    }
+
+    /// Number of display lines
+    pub fn len(&self) -> usize {
+        self.rows.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.rows.is_empty()
+    }
+
+    /// Bring the rows up to date with `terminal`
+    pub fn sync(&mut self, terminal: &MockTerminal) {
+        let lines = &terminal.lines;
+
+        // Stepping back removes output from the end: drop the rows past it
+        // and index the (possibly shortened) last line again
+        let shrunk = self.lines > lines.len()
+            || self.lines > 0
+                && lines[self.lines - 1].text.len() < self.last_len;
+        if shrunk {
+            let line = self.lines.min(lines.len()).saturating_sub(1);
+            let keep = self.rows.partition_point(|r| r.line < line);
+            self.rows.truncate(keep);
+            // Lines before the last one no longer change
+            self.lines = line;
+            self.last_len =
+                line.checked_sub(1).map_or(0, |l| lines[l].text.len());
+        }
+
+        // printf may have appended to the last line
+        if let Some(last) = self.lines.checked_sub(1) {
+            self.extend_line(last, &lines[last].text);
+        }
+        for (line, stored) in lines.iter().enumerate().skip(self.lines) {
+            self.lines = line + 1;
+            self.last_len = 0;
+            self.extend_line(line, &stored.text);
+        }
+    }
+
+    /// Index the part of the last covered line past `last_len`
+    fn extend_line(&mut self, line: usize, text: &str) {
+        if text.len() == self.last_len {
+            return;
+        }
+        // A row ending at `last_len` had no newline yet; it may continue
+        let mut start = self.last_len;
+        if let Some(row) = self.rows.last() {
+            if row.line == line && row.end == self.last_len {
+                start = row.start;
+                self.rows.pop();
+            }
+        }
+        while let Some(i) = text[start..].find('\n') {
+            self.rows.push(TerminalRow {
+                line,
+                start,
+                end: start + i,
+            });
+            start += i + 1;
+        }
+        if start < text.len() {
+            self.rows.push(TerminalRow {
+                line,
+                start,
+                end: text.len(),
+            });
+        }
+        self.last_len = text.len();
+    }
+}
+
 /// Data needed to render the terminal pane
 pub struct TerminalRenderData<'a> {
     pub terminal: &'a MockTerminal,
+    /// Display lines of `terminal`; synced before drawing
+    pub index: &'a mut TerminalIndex,
     pub is_focused: bool,
     pub scroll_state: &'a mut TerminalScrollState,
     pub is_scanf_input: bool,
@@ -47,13 +163,20 @@ pub fn render_terminal_pane(
         " Terminal "
     };
 
+    data.index.sync(data.terminal);
+    let total_rows = data.index.len();
+    let first_row = total_rows.saturating_sub(SCROLLBACK_ROWS);
+    let title = if first_row > 0 {
+        format!("{}(last {} lines) ", title, SCROLLBACK_ROWS)
+    } else {
+        title.to_string()
+    };
+
     let block = Block::default()
         .title(title)
         .borders(Borders::ALL)
         .border_style(border_style);
 
-    let lines = data.terminal.get_output();
-
     // Always reserve 1 row at the bottom for the stdin input bar
     let inner_height = area.height.saturating_sub(2) as usize;
     let content_height = inner_height.saturating_sub(1).max(1);
@@ -63,15 +186,28 @@ pub fn render_terminal_pane(
     // Pre-compute inner area before block is consumed by the List widget
     let inner = block.inner(area);
 
-    // Build list items; show a placeholder when there is no output yet
-    let all_items: Vec<ListItem> = if lines.is_empty() {
+    // Clamp scroll within the scrollback
+    let scrollback = total_rows - first_row;
+    if scrollback > content_height {
+        let max_scroll = scrollback - content_height;
+        data.scroll_state.offset = data.scroll_state.offset.min(max_scroll);
+    } else {
+        data.scroll_state.offset = 0;
+    }
+
+    // Build only the visible rows; show a placeholder when there is no
+    // output yet
+    let visible_items: Vec<ListItem> = if data.index.is_empty() {
         vec![ListItem::new("(no output)")
             .style(Style::default().fg(DEFAULT_THEME.comment))]
     } else {
-        lines
+        let start = first_row + data.scroll_state.offset;
+        let end = (start + content_height).min(total_rows);
+        data.index.rows[start..end]
             .iter()
-            .map(|(text, kind)| {
-                let style = match kind {
+            .map(|row| {
+                let line = &data.terminal.lines[row.line];
+                let style = match line.kind {
                     TerminalLineKind::Output => {
                         Style::default().fg(DEFAULT_THEME.fg)
                     }
@@ -79,32 +215,17 @@ pub fn render_terminal_pane(
                         .fg(DEFAULT_THEME.secondary)
                         .add_modifier(Modifier::ITALIC),
                 };
-                ListItem::new(text.as_str()).style(style)
+                ListItem::new(&line.text[row.start..row.end]).style(style)
             })
             .collect()
     };
 
-    let total_items = all_items.len();
-
-    // Clamp scroll
-    if total_items > content_height {
-        let max_scroll = total_items - content_height;
-        data.scroll_state.offset = data.scroll_state.offset.min(max_scroll);
-    } else {
-        data.scroll_state.offset = 0;
-    }
-
-    let visible_items: Vec<ListItem> = all_items
-        .into_iter()
-        .skip(data.scroll_state.offset)
-        .take(content_height)
-        .collect();
-
     let list = List::new(visible_items).block(block);
     frame.render_widget(list, area);
 
     // Always render the stdin input bar at the very bottom of the inner area.
-    // Active (waiting for input): bright accent colour + blinking cursor.
+    // Active (waiting for input): bright accent colour + steady cursor (the
+    // TUI only redraws on change, so a blink would freeze mid-phase).
     // Inactive: dimmed, no cursor — shows the pre-fill buffer if any.
     if inner.height > 0 {
         let prompt_y = inner.y + inner.height - 1;
@@ -116,11 +237,6 @@ pub fn render_terminal_pane(
         };
 
         let prompt_line = if data.is_scanf_input {
-            let cursor = if (frame.count() / 8).is_multiple_of(2) {
-                "█"
-            } else {
-                " "
-            };
             Line::from(vec![
                 Span::styled(
                     "> ",
@@ -134,10 +250,7 @@ pub fn render_terminal_pane(
                         .fg(Color::White)
                         .add_modifier(Modifier::BOLD),
                 ),
-                Span::styled(
-                    cursor,
-                    Style::default().fg(DEFAULT_THEME.secondary),
-                ),
+                Span::styled("█", Style::default().fg(DEFAULT_THEME.secondary)),
             ])
         } else {
             Line::from(vec![
@@ -159,3 +272,94 @@ pub fn render_terminal_pane(
         frame.render_widget(prompt_para, prompt_area);
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::parser::ast::SourceLocation;
+
+    /// Sync `index` to `terminal` and check its rows against the output
+    fn check(index: &mut TerminalIndex, terminal: &MockTerminal) {
+        index.sync(terminal);
+        let rows: Vec<(String, TerminalLineKind)> = index
+            .rows
+            .iter()
+            .map(|row| {
+                let line = &terminal.lines[row.line];
+                (line.text[row.start..row.end].to_string(), line.kind.clone())
+            })
+            .collect();
+        assert_eq!(rows, terminal.get_output());
+    }
+
+    /// Terminal states after each print, as history would record them;
+    /// source line 0 stands for a scanf input echo
+    fn history(prints: &[(&str, usize)]) -> Vec<MockTerminal> {
+        let mut terminal = MockTerminal::new();
+        let mut states = vec![terminal.clone()];
+        for &(text, line) in prints {
+            let location = SourceLocation::new(line, 1);
+            if line == 0 {
+                terminal.print_input(text.to_string(), location);
+            } else {
+                terminal.print(text.to_string(), location);
+            }
+            states.push(terminal.clone());
+        }
+        states
+    }
+
+    #[test]
+    fn test_output_appended_to_unterminated_line() {
+        let states = history(&[
+            ("ab", 1),
+            ("c", 1),
+            ("\nd", 1),
+            ("e\n", 1),
+            ("\n", 1),
+            ("f", 2),
+        ]);
+        let mut index = TerminalIndex::new();
+        for state in &states {
+            check(&mut index, state);
+        }
+    }
+
+    #[test]
+    fn test_step_back_into_middle_of_line() {
+        let states = history(&[("one\ntw", 1), ("o\nthree", 1), ("\n", 1)]);
+        let mut index = TerminalIndex::new();
+        check(&mut index, &states[3]);
+        check(&mut index, &states[1]);
+        check(&mut index, &states[2]);
+        check(&mut index, &states[1]);
+        check(&mut index, &states[3]);
+    }
+
+    #[test]
+    fn test_step_back_across_lines() {
+        let states = history(&[
+            ("a\nb", 1),
+            ("c\n", 2),
+            ("42", 0),
+            ("d", 3),
+            ("e\nf", 3),
+            ("g\n", 4),
+        ]);
+        let mut index = TerminalIndex::new();
+        check(&mut index, &states[6]);
+        check(&mut index, &states[1]);
+        check(&mut index, &states[5]);
+        check(&mut index, &states[0]);
+        check(&mut index, &states[6]);
+
+        // Any position reached from any other
+        for from in &states {
+            for to in &states {
+                let mut index = TerminalIndex::new();
+                check(&mut index, from);
+                check(&mut index, to);
+            }
+        }
+    }
+}
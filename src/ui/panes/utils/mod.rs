@@ -1,6 +1,6 @@
 //! Shared rendering utilities used by the TUI panes.
 //!
-//! Re-exports everything from three focused submodules so that pane code can write
+//! Re-exports everything from four focused submodules so that pane code can write
 //! `use crate::ui::panes::utils::*` and access all helpers from a single namespace.
 //!
 //! | Submodule      | Contents |
@@ -8,11 +8,14 @@
 //! | [`formatting`] | Value/address formatting helpers (hex, decimal, type labels) |
 //! | [`memory`]     | Helpers for reading and presenting stack/heap memory data |
 //! | [`rendering`]  | Low-level ratatui span/line builders used across panes |
+//! | [`rows`]       | Virtualized row sink that builds only the visible window |
 
 pub mod formatting;
 pub mod memory;
 pub mod rendering;
+pub mod rows;
 
 pub(crate) use formatting::*;
 pub(crate) use memory::*;
 pub(crate) use rendering::*;
+pub(crate) use rows::*;
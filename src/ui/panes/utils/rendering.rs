@@ -1,6 +1,7 @@
 use super::formatting::{format_type_annotation, format_value_styled};
 use super::memory::calculate_field_offsets;
-use crate::memory::{sizeof_type, value::Value};
+use super::rows::RowSink;
+use crate::memory::{access::AccessCounts, sizeof_type, value::Value};
 use crate::parser::ast::{BaseType, StructDef, Type};
 use crate::ui::theme::DEFAULT_THEME;
 use ratatui::{
@@ -12,19 +13,123 @@ use rustc_hash::FxHashMap;
 use std::collections::HashMap;
 use std::hash::BuildHasher;
 
+/// Row style for a value written within the highlighted steps
+pub(crate) fn changed_style(changed: bool) -> Style {
+    if changed {
+        Style::default().bg(DEFAULT_THEME.changed_bg)
+    } else {
+        Style::default()
+    }
+}
+
+/// Row background for the access heatmap; `max` is the hottest count at this
+/// step, or `None` when the heatmap is off
+pub(crate) fn heat_style(counts: AccessCounts, max: Option<u64>) -> Style {
+    let level = max.map_or(0, |max| counts.heat(max));
+    match level
+        .checked_sub(1)
+        .and_then(|i| DEFAULT_THEME.heat_bg.get(i))
+    {
+        Some(&color) => Style::default().bg(color),
+        None => Style::default(),
+    }
+}
+
 pub(crate) struct RenderCtx<'a, S: BuildHasher> {
     pub struct_defs: &'a HashMap<String, StructDef, S>,
     pub content_width: usize,
 }
 
-/// Render array elements recursively with proper nesting and indentation
-pub(crate) fn render_array_elements<'a, S: BuildHasher>(
-    all_items: &mut Vec<ListItem<'a>>,
+/// Header row for a nested array or struct: `addr  [idx] :     type`
+fn nested_header<'r, S: BuildHasher>(
+    address: u64,
+    indent_level: usize,
+    label: String,
+    type_: Option<&Type>,
+    ctx: &RenderCtx<'_, S>,
+) -> ListItem<'r> {
+    let indent = "  ".repeat(indent_level);
+    let type_str = type_
+        .map(|t| format_type_annotation(t, ctx.struct_defs))
+        .unwrap_or_default();
+
+    // addr(11) + indent + label + ": "
+    let left_width = 11 + indent.len() + label.len() + 2;
+    let padding = ctx
+        .content_width
+        .saturating_sub(left_width + type_str.len());
+
+    let mut spans = vec![
+        Span::styled(
+            format!("0x{:08x} ", address),
+            Style::default().fg(DEFAULT_THEME.comment),
+        ),
+        Span::raw(indent),
+        Span::styled(label, Style::default().fg(DEFAULT_THEME.fg)),
+        Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
+    ];
+
+    if !type_str.is_empty() {
+        spans.push(Span::raw(" ".repeat(padding)));
+        spans.push(Span::styled(
+            type_str,
+            Style::default().fg(DEFAULT_THEME.type_name),
+        ));
+    }
+
+    ListItem::new(Line::from(spans))
+}
+
+/// Single row for a primitive element or field: `addr  label : value  type`
+fn value_row<'r, S: BuildHasher>(
+    address_span: Span<'r>,
+    indent_level: usize,
+    label: String,
+    value: &Value,
+    type_str: String,
+    ctx: &RenderCtx<'_, S>,
+) -> ListItem<'r> {
+    let indent = "  ".repeat(indent_level);
+    let val_spans = format_value_styled(value, ctx.struct_defs, 1);
+
+    // Calculate padding for right-alignment
+    let val_width: usize = val_spans.iter().map(|s| s.content.len()).sum();
+    let left_width = 11 + indent.len() + label.len() + 2 + val_width; // +2 for ": "
+    let padding = ctx
+        .content_width
+        .saturating_sub(left_width + type_str.len());
+
+    let mut spans = vec![
+        address_span,
+        Span::raw(indent),
+        Span::styled(label, Style::default().fg(DEFAULT_THEME.fg)),
+        Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
+    ];
+
+    spans.extend(val_spans);
+
+    if !type_str.is_empty() {
+        spans.push(Span::raw(" ".repeat(padding)));
+        spans.push(Span::styled(
+            type_str,
+            Style::default().fg(DEFAULT_THEME.type_name),
+        ));
+    }
+
+    ListItem::new(Line::from(spans))
+}
+
+/// Render array elements recursively with proper nesting and indentation.
+///
+/// Rows outside the sink's window are only counted; arrays of primitives
+/// jump straight to the first visible element.
+pub(crate) fn render_array_elements<'r, S: BuildHasher>(
+    rows: &mut RowSink<'r>,
     elements: &[Value],
     array_type: &Type,
     base_address: u64,
     indent_level: usize,
-    ctx: &RenderCtx<'a, S>,
+    ctx: &RenderCtx<'_, S>,
 ) {
     // Get the element type (strip one array dimension)
     let elem_type = if !array_type.array_dims.is_empty() {
@@ -38,53 +143,42 @@ pub(crate) fn render_array_elements<'a, S: BuildHasher>(
     // Calculate element size
     let elem_size = sizeof_type(&elem_type, ctx.struct_defs) as u64;
 
-    for (idx, elem_value) in elements.iter().enumerate() {
-        let elem_address = base_address + (idx as u64 * elem_size);
-        let addr_span = Span::styled(
-            format!("0x{:08x} ", elem_address),
-            Style::default().fg(DEFAULT_THEME.comment),
-        );
+    // Arrays are homogeneous: elements of primitive arrays take one row each
+    let nested = matches!(
+        elements.first(),
+        Some(Value::Array(_)) | Some(Value::Struct(_))
+    );
+    let first = if nested {
+        0
+    } else {
+        let first = rows.rows_before_window().min(elements.len());
+        rows.skip(first);
+        first
+    };
 
-        let indent = "  ".repeat(indent_level);
+    for (idx, elem_value) in elements.iter().enumerate().skip(first) {
+        if rows.is_full() {
+            return;
+        }
+        let elem_address = base_address + (idx as u64 * elem_size);
 
         // Check if this element is itself a nested array or struct
         match elem_value {
             Value::Array(nested_elements) => {
                 // Nested array - show header and recurse
-                let type_str =
-                    format_type_annotation(&elem_type, ctx.struct_defs); // struct_defs added
-
-                // Calculate padding for right-alignment
-                // addr(11) + indent + "[idx] " + ": " = 11 + indent + index_str + 2
-                let index_str = format!("[{}] ", idx);
-                let left_width = 11 + indent.len() + index_str.len() + 2; // +2 for ": "
-                let type_width = type_str.len();
-                let padding =
-                    ctx.content_width.saturating_sub(left_width + type_width);
-
-                let mut spans = vec![
-                    addr_span,
-                    Span::raw(indent),
-                    Span::styled(
-                        index_str,
-                        Style::default().fg(DEFAULT_THEME.fg),
-                    ),
-                    Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
-                ];
-
-                if !type_str.is_empty() {
-                    spans.push(Span::raw(" ".repeat(padding)));
-                    spans.push(Span::styled(
-                        type_str,
-                        Style::default().fg(DEFAULT_THEME.type_name),
-                    ));
-                }
-
-                all_items.push(ListItem::new(Line::from(spans)));
+                rows.push(|| {
+                    nested_header(
+                        elem_address,
+                        indent_level,
+                        format!("[{}] ", idx),
+                        Some(&elem_type),
+                        ctx,
+                    )
+                });
 
                 // Recursively render nested array
                 render_array_elements(
-                    all_items,
+                    rows,
                     nested_elements,
                     &elem_type,
                     elem_address,
@@ -94,39 +188,19 @@ pub(crate) fn render_array_elements<'a, S: BuildHasher>(
             }
             Value::Struct(fields) => {
                 // Struct element - show header and recurse
-                let type_str =
-                    format_type_annotation(&elem_type, ctx.struct_defs);
-
-                // Calculate padding for right-alignment
-                let index_str = format!("[{}] ", idx);
-                let left_width = 11 + indent.len() + index_str.len() + 2; // +2 for ": "
-                let type_width = type_str.len();
-                let padding =
-                    ctx.content_width.saturating_sub(left_width + type_width);
-
-                let mut spans = vec![
-                    addr_span,
-                    Span::raw(indent),
-                    Span::styled(
-                        index_str,
-                        Style::default().fg(DEFAULT_THEME.fg),
-                    ),
-                    Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
-                ];
-
-                if !type_str.is_empty() {
-                    spans.push(Span::raw(" ".repeat(padding)));
-                    spans.push(Span::styled(
-                        type_str,
-                        Style::default().fg(DEFAULT_THEME.type_name),
-                    ));
-                }
-
-                all_items.push(ListItem::new(Line::from(spans)));
+                rows.push(|| {
+                    nested_header(
+                        elem_address,
+                        indent_level,
+                        format!("[{}] ", idx),
+                        Some(&elem_type),
+                        ctx,
+                    )
+                });
 
                 // Recursively render struct fields
                 render_struct_fields(
-                    all_items,
+                    rows,
                     fields,
                     &elem_type,
                     elem_address,
@@ -136,54 +210,32 @@ pub(crate) fn render_array_elements<'a, S: BuildHasher>(
             }
             _ => {
                 // Primitive value - show on single line
-                let val_spans =
-                    format_value_styled(elem_value, ctx.struct_defs, 1);
-                let type_str =
-                    format_type_annotation(&elem_type, ctx.struct_defs);
-
-                // Calculate padding for right-alignment
-                let index_str = format!("[{}] ", idx);
-                let val_width: usize =
-                    val_spans.iter().map(|s| s.content.len()).sum();
-                let left_width =
-                    11 + indent.len() + index_str.len() + 2 + val_width;
-                let type_width = type_str.len();
-                let padding =
-                    ctx.content_width.saturating_sub(left_width + type_width);
-
-                let mut spans = vec![
-                    addr_span,
-                    Span::raw(indent),
-                    Span::styled(
-                        index_str,
-                        Style::default().fg(DEFAULT_THEME.fg),
-                    ),
-                    Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
-                ];
-
-                spans.extend(val_spans);
-
-                if !type_str.is_empty() {
-                    spans.push(Span::raw(" ".repeat(padding)));
-                    spans.push(Span::styled(
-                        type_str,
-                        Style::default().fg(DEFAULT_THEME.type_name),
-                    ));
-                }
-
-                all_items.push(ListItem::new(Line::from(spans)));
+                rows.push(|| {
+                    value_row(
+                        Span::styled(
+                            format!("0x{:08x} ", elem_address),
+                            Style::default().fg(DEFAULT_THEME.comment),
+                        ),
+                        indent_level,
+                        format!("[{}] ", idx),
+                        elem_value,
+                        format_type_annotation(&elem_type, ctx.struct_defs),
+                        ctx,
+                    )
+                });
             }
         }
     }
 }
 
-pub(crate) fn render_struct_fields<'a, S: BuildHasher>(
-    all_items: &mut Vec<ListItem<'a>>,
+/// Render struct fields recursively, sorted by name
+pub(crate) fn render_struct_fields<'r, S: BuildHasher>(
+    rows: &mut RowSink<'r>,
     fields: &FxHashMap<String, Value>,
     parent_type: &Type,
     base_address: u64,
     indent_level: usize,
-    ctx: &RenderCtx<'a, S>,
+    ctx: &RenderCtx<'_, S>,
 ) {
     // Calculate field offsets to show addresses and types
     let field_info: std::collections::HashMap<String, (usize, Type)> =
@@ -207,95 +259,76 @@ pub(crate) fn render_struct_fields<'a, S: BuildHasher>(
     sorted_fields.sort_by_key(|(k, _)| *k);
 
     for (field_name, field_value) in sorted_fields {
-        // Calculate field address and get type if we have field information
-        let (field_addr_span, type_annotation, field_type_opt) =
-            if let Some((offset, field_type)) = field_info.get(field_name) {
-                let addr_span = Span::styled(
-                    format!("0x{:08x} ", base_address + (*offset as u64)),
-                    Style::default().fg(DEFAULT_THEME.comment),
-                );
-                let type_str =
-                    format_type_annotation(field_type, ctx.struct_defs);
-                (addr_span, type_str, Some(field_type.clone()))
-            } else {
-                (Span::raw("              "), String::new(), None)
-            };
-
-        let indent = "  ".repeat(indent_level);
+        if rows.is_full() {
+            return;
+        }
+        let info = field_info.get(field_name);
 
         // Check if this field is itself a struct
         if let Value::Struct(nested_fields) = field_value {
             // Struct field - render header and recurse
-            // Calculate padding for right-alignment
-            let field_str = format!(".{} ", field_name);
-            let left_width = 11 + indent.len() + field_str.len() + 2; // +2 for ": "
-            let type_width = type_annotation.len();
-            let padding =
-                ctx.content_width.saturating_sub(left_width + type_width);
-
-            let mut spans = vec![
-                field_addr_span,
-                Span::raw(indent),
-                Span::styled(field_str, Style::default().fg(DEFAULT_THEME.fg)),
-                Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
-            ];
-
-            if !type_annotation.is_empty() {
-                spans.push(Span::raw(" ".repeat(padding)));
-                spans.push(Span::styled(
-                    type_annotation,
-                    Style::default().fg(DEFAULT_THEME.type_name),
-                ));
-            }
-
-            all_items.push(ListItem::new(Line::from(spans)));
+            rows.push(|| match info {
+                Some((offset, field_type)) => nested_header(
+                    base_address + (*offset as u64),
+                    indent_level,
+                    format!(".{} ", field_name),
+                    Some(field_type),
+                    ctx,
+                ),
+                None => {
+                    let indent = "  ".repeat(indent_level);
+                    ListItem::new(Line::from(vec![
+                        Span::raw("              "),
+                        Span::raw(indent),
+                        Span::styled(
+                            format!(".{} ", field_name),
+                            Style::default().fg(DEFAULT_THEME.fg),
+                        ),
+                        Span::styled(
+                            ": ",
+                            Style::default().fg(DEFAULT_THEME.fg),
+                        ),
+                    ]))
+                }
+            });
 
             // Recursively render nested struct fields
-            if let Some(field_type) = field_type_opt {
-                if let Some((offset, _)) = field_info.get(field_name) {
-                    render_struct_fields(
-                        all_items,
-                        nested_fields,
-                        &field_type,
-                        base_address + (*offset as u64),
-                        indent_level + 1,
-                        ctx,
-                    );
-                }
+            if let Some((offset, field_type)) = info {
+                render_struct_fields(
+                    rows,
+                    nested_fields,
+                    field_type,
+                    base_address + (*offset as u64),
+                    indent_level + 1,
+                    ctx,
+                );
             }
         } else {
             // Non-struct field - render as a single line
-            let val_spans =
-                format_value_styled(field_value, ctx.struct_defs, 1);
-
-            // Calculate padding for right-alignment
-            let field_str = format!(".{} ", field_name);
-            let val_width: usize =
-                val_spans.iter().map(|s| s.content.len()).sum();
-            let left_width =
-                11 + indent.len() + field_str.len() + 2 + val_width; // +2 for ": "
-            let type_width = type_annotation.len();
-            let padding =
-                ctx.content_width.saturating_sub(left_width + type_width);
-
-            let mut spans = vec![
-                field_addr_span,
-                Span::raw(indent),
-                Span::styled(field_str, Style::default().fg(DEFAULT_THEME.fg)),
-                Span::styled(": ", Style::default().fg(DEFAULT_THEME.fg)),
-            ];
-
-            spans.extend(val_spans);
-
-            if !type_annotation.is_empty() {
-                spans.push(Span::raw(" ".repeat(padding)));
-                spans.push(Span::styled(
-                    type_annotation,
-                    Style::default().fg(DEFAULT_THEME.type_name),
-                ));
-            }
-
-            all_items.push(ListItem::new(Line::from(spans)));
+            rows.push(|| {
+                // Field address and type, if we have field information
+                let (addr_span, type_str) = match info {
+                    Some((offset, field_type)) => (
+                        Span::styled(
+                            format!(
+                                "0x{:08x} ",
+                                base_address + (*offset as u64)
+                            ),
+                            Style::default().fg(DEFAULT_THEME.comment),
+                        ),
+                        format_type_annotation(field_type, ctx.struct_defs),
+                    ),
+                    None => (Span::raw("              "), String::new()),
+                };
+                value_row(
+                    addr_span,
+                    indent_level,
+                    format!(".{} ", field_name),
+                    field_value,
+                    type_str,
+                    ctx,
+                )
+            });
         }
     }
 }
@@ -0,0 +1,149 @@
+//! Virtualized list rows
+//!
+//! The stack and heap panes can hold far more rows than fit on screen, so
+//! they emit their rows in order into a [`RowSink`], which builds only the
+//! rows inside the visible window and merely counts the others. A pane is
+//! rendered in two passes: a counting pass that sizes the list for
+//! scrolling, then a pass that materializes the window. Emitters skip whole
+//! sections whose row count is known up front, so neither pass walks rows it
+//! can jump over.
+//!
+//! The same emitters can also build a pane's complete row list ahead of
+//! time (see `ui::model_cache`), which is then rendered by slicing.
+
+use ratatui::widgets::ListItem;
+use std::ops::Range;
+
+/// Receives the rows of a list, building only those inside a window
+pub(crate) struct RowSink<'a> {
+    /// Rows to build; `None` only counts
+    window: Option<Range<usize>>,
+    /// Index of the next row
+    row: usize,
+    items: Vec<ListItem<'a>>,
+}
+
+impl<'a> RowSink<'a> {
+    /// A sink that counts rows without building any
+    pub(crate) fn counter() -> Self {
+        RowSink {
+            window: None,
+            row: 0,
+            items: Vec::new(),
+        }
+    }
+
+    /// A sink that builds the rows in `window`
+    pub(crate) fn window(window: Range<usize>) -> Self {
+        RowSink {
+            items: Vec::with_capacity(window.len()),
+            window: Some(window),
+            row: 0,
+        }
+    }
+
+    /// Number of rows emitted so far
+    pub(crate) fn rows(&self) -> usize {
+        self.row
+    }
+
+    /// Whether every row of the window has been emitted; later rows are
+    /// ignored, so emitters may stop early
+    pub(crate) fn is_full(&self) -> bool {
+        self.window.as_ref().is_some_and(|w| self.row >= w.end)
+    }
+
+    /// Whether any of the next `rows` rows would be built
+    pub(crate) fn overlaps(&self, rows: usize) -> bool {
+        self.window
+            .as_ref()
+            .is_some_and(|w| self.row < w.end && self.row + rows > w.start)
+    }
+
+    /// Number of upcoming rows that precede the window (all of them when
+    /// counting)
+    pub(crate) fn rows_before_window(&self) -> usize {
+        match &self.window {
+            Some(w) => w.start.saturating_sub(self.row),
+            None => usize::MAX,
+        }
+    }
+
+    /// Account for `rows` rows without building them
+    pub(crate) fn skip(&mut self, rows: usize) {
+        self.row += rows;
+    }
+
+    /// Emit one row; `build` runs only if the row is visible
+    pub(crate) fn push(&mut self, build: impl FnOnce() -> ListItem<'a>) {
+        if self.overlaps(1) {
+            self.items.push(build());
+        }
+        self.row += 1;
+    }
+
+    /// Emit `rows` rows when visible, or skip them all otherwise
+    pub(crate) fn section(
+        &mut self,
+        rows: usize,
+        emit: impl FnOnce(&mut Self),
+    ) {
+        if self.overlaps(rows) {
+            let end = self.row + rows;
+            emit(self);
+            // Emitters may stop at the end of the window
+            self.row = end;
+        } else {
+            self.skip(rows);
+        }
+    }
+
+    /// The rows built for the window
+    pub(crate) fn into_items(self) -> Vec<ListItem<'a>> {
+        self.items
+    }
+}
+
+/// Build every row `emit` produces, unless there are more than `max_rows`
+pub(crate) fn build_all_rows(
+    max_rows: usize,
+    emit: impl Fn(&mut RowSink<'static>),
+) -> Option<Vec<ListItem<'static>>> {
+    let mut counter = RowSink::counter();
+    emit(&mut counter);
+    if counter.rows() > max_rows {
+        return None;
+    }
+    let mut rows = RowSink::window(0..counter.rows());
+    emit(&mut rows);
+    Some(rows.into_items())
+}
+
+/// The rows of `window` from a list built ahead of time
+pub(crate) fn cached_window<'a>(
+    rows: &[ListItem<'a>],
+    window: Range<usize>,
+) -> Vec<ListItem<'a>> {
+    let end = window.end.min(rows.len());
+    rows[window.start.min(end)..end].to_vec()
+}
+
+/// Scroll state shared by the virtualized panes.
+///
+/// The view follows the bottom of the list when it grows (a new frame,
+/// variable or allocation) and otherwise keeps the user's position, clamped
+/// to the new length.
+pub(crate) fn follow_scroll(
+    offset: &mut usize,
+    prev_item_count: &mut usize,
+    total_items: usize,
+    visible_height: usize,
+) {
+    let max_scroll = total_items.saturating_sub(visible_height);
+    *offset = if total_items > *prev_item_count {
+        max_scroll
+    } else {
+        (*offset).min(max_scroll)
+    };
+    *prev_item_count = total_items;
+}
@@ -0,0 +1,815 @@
+//! Pointer graph of the stack and heap, laid out as rows
+//!
+//! Stack variables that hold pointers are the roots; heap blocks are the
+//! nodes, and every initialized non-null pointer is an edge. [`PointerGraph`]
+//! turns the graph into indented rows for the graph pane:
+//!
+//! - The walk is breadth-first with a visited set, so cycles end in a
+//!   back-reference row instead of recursing, and it stops after
+//!   [`MAX_GRAPH_NODES`] blocks.
+//! - A run of blocks that each lead to exactly one new block (a linked list)
+//!   is drawn at one indentation level, and long runs are collapsed to their
+//!   first and last few blocks.
+//! - The pointers stored in each block are kept together with the block's
+//!   modification stamp, so moving to an adjacent step only decodes the
+//!   blocks that step wrote.
+//! - Nothing is done per frame. When the history position changes, the
+//!   frames, stack pointers and block stamps are compared with those of the
+//!   last walk, and the graph is walked again only if one of them differs.
+//!   The comparison itself is linear in the number of live blocks, and a
+//!   step that writes any block (even a non-pointer field) re-walks the
+//!   whole graph.
+//!
+//! Blocks no stack variable reaches are listed last, under their own heading.
+
+use crate::interpreter::constants::HEAP_ADDRESS_START;
+use crate::interpreter::engine::Interpreter;
+use crate::memory::heap::{Heap, HeapBlock};
+use crate::memory::sizeof_type;
+use crate::memory::stack::Stack;
+use crate::memory::value::{Address, Value};
+use crate::parser::ast::{BaseType, StructDef, Type};
+use rustc_hash::{FxHashMap, FxHashSet};
+use std::collections::{BTreeMap, VecDeque};
+use std::sync::Arc;
+
+/// Blocks visited before the walk gives up
+pub const MAX_GRAPH_NODES: usize = 50_000;
+
+/// Pointers read from a single variable or block
+const MAX_NODE_EDGES: usize = 256;
+
+/// Blocks shown at the start and end of a collapsed chain
+const CHAIN_HEAD: usize = 3;
+const CHAIN_TAIL: usize = 2;
+
+/// Struct nesting followed when looking for pointer fields
+const MAX_FIELD_DEPTH: usize = 8;
+
+/// What a graph row points at
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum RowTarget {
+    /// Heading for the roots of a stack frame (function name)
+    Frame(String),
+    /// Heading above the blocks no stack variable reaches
+    Unreachable,
+    /// A variable or block with several pointers, listed below it
+    Group,
+    /// First appearance of a heap block; its pointers follow
+    Block { base: Address, offset: usize },
+    /// A heap block already shown above
+    Seen { base: Address, offset: usize },
+    /// A stack variable (frame index and name)
+    Var { frame: usize, name: String },
+    /// A pointer that is not into any live block or variable
+    Dangling(Address),
+    /// Blocks left out of the middle of a chain
+    Collapsed(usize),
+    /// A block the walk did not reach before [`MAX_GRAPH_NODES`]
+    Unexplored(Address),
+}
+
+/// One row of the graph pane: `label ─▶ target`
+#[derive(Debug, Clone)]
+pub struct GraphRow {
+    pub indent: usize,
+    /// Variable name or pointer path (`.next`, `[2]`)
+    pub label: String,
+    pub target: RowTarget,
+}
+
+/// Pointers stored in one block, valid while its stamp is unchanged
+struct BlockEdges {
+    modified_step: usize,
+    edges: Arc<[(String, Address)]>,
+}
+
+/// Where a pointer leads, as seen by the walk
+enum Link {
+    /// First visit of a block; it is expanded here
+    Tree {
+        base: Address,
+        offset: usize,
+    },
+    Seen {
+        base: Address,
+        offset: usize,
+    },
+    Var {
+        frame: usize,
+        name: String,
+    },
+    Dangling(Address),
+    Unexplored(Address),
+}
+
+/// Stack variable that holds pointers
+#[derive(Clone, PartialEq)]
+struct Root {
+    frame: usize,
+    name: String,
+    edges: Vec<(String, Address)>,
+}
+
+/// Everything a walk reads, so an unchanged graph is not walked again
+#[derive(PartialEq)]
+struct WalkInputs {
+    frame_names: Vec<String>,
+    /// `(address, end address, frame, name)` of every stack variable
+    vars: Vec<(Address, Address, usize, String)>,
+    roots: Vec<Root>,
+    /// Tagged base and modification stamp of every live block
+    blocks: Vec<(Address, usize)>,
+}
+
+/// Pointer graph rows for the current history position, re-walked when the
+/// position changes and the graph with it
+#[derive(Default)]
+pub struct PointerGraph {
+    /// Position the rows were built for
+    position: Option<usize>,
+    /// What the rows were built from
+    inputs: Option<WalkInputs>,
+    /// Pointers per block, keyed by tagged base address
+    block_edges: FxHashMap<Address, BlockEdges>,
+    rows: Vec<GraphRow>,
+}
+
+impl PointerGraph {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Forget the cached layout and block pointers, e.g. after the history
+    /// was re-recorded
+    pub fn invalidate(&mut self) {
+        self.position = None;
+        self.inputs = None;
+        self.block_edges.clear();
+        self.rows.clear();
+    }
+
+    /// The rows for the position last passed to [`update`](Self::update)
+    pub fn rows(&self) -> &[GraphRow] {
+        &self.rows
+    }
+
+    /// Bring the rows up to date with the interpreter's current position
+    pub fn update(&mut self, interpreter: &Interpreter) {
+        let position = interpreter.history_position();
+        if self.position == Some(position) {
+            return;
+        }
+        self.position = Some(position);
+
+        let heap = interpreter.heap();
+        let struct_defs = interpreter.struct_defs();
+        let walk = Walk::new(interpreter.stack(), heap, struct_defs);
+        let inputs = walk.inputs();
+        if self.inputs.as_ref() == Some(&inputs) {
+            return;
+        }
+        self.refresh_block_edges(heap, struct_defs);
+        self.rows = walk.layout(&self.block_edges, MAX_GRAPH_NODES);
+        self.inputs = Some(inputs);
+    }
+
+    /// Re-read the pointers of blocks written since they were cached and
+    /// drop blocks that are no longer live
+    fn refresh_block_edges(
+        &mut self,
+        heap: &Heap,
+        struct_defs: &FxHashMap<String, StructDef>,
+    ) {
+        let live: FxHashSet<Address> =
+            heap.blocks().map(|(base, _)| base).collect();
+        self.block_edges.retain(|base, _| live.contains(base));
+        for (base, block) in heap.blocks() {
+            let stale = self
+                .block_edges
+                .get(&base)
+                .is_none_or(|e| e.modified_step != block.modified_step);
+            if stale {
+                self.block_edges.insert(
+                    base,
+                    BlockEdges {
+                        modified_step: block.modified_step,
+                        edges: block_pointers(block, struct_defs).into(),
+                    },
+                );
+            }
+        }
+    }
+}
+
+/// Pointers stored in `block`, labelled by element index and field path
+fn block_pointers(
+    block: &HeapBlock,
+    struct_defs: &FxHashMap<String, StructDef>,
+) -> Vec<(String, Address)> {
+    let Some(layout) = &block.layout else {
+        return Vec::new();
+    };
+    let mut slots = Vec::new();
+    pointer_slots(&layout.elem_type, struct_defs, "", 0, 0, &mut slots);
+    if slots.is_empty() || layout.stride == 0 {
+        return Vec::new();
+    }
+
+    let elements = block.size / layout.stride;
+    let mut edges = Vec::new();
+    for index in 0..elements {
+        for (path, offset) in &slots {
+            if edges.len() >= MAX_NODE_EDGES {
+                return edges;
+            }
+            let mut bytes = [0; 8];
+            let at = index * layout.stride + offset;
+            if block.read_initialized(at, &mut bytes).is_err() {
+                continue;
+            }
+            let address = u64::from_le_bytes(bytes);
+            if address == 0 {
+                continue;
+            }
+            let label = if elements > 1 {
+                format!("[{}]{}", index, path)
+            } else {
+                path.clone()
+            };
+            edges.push((label, address));
+        }
+    }
+    edges
+}
+
+/// Offsets of the pointers inside a value of type `typ`, with their field
+/// paths
+fn pointer_slots(
+    typ: &Type,
+    struct_defs: &FxHashMap<String, StructDef>,
+    path: &str,
+    offset: usize,
+    depth: usize,
+    out: &mut Vec<(String, usize)>,
+) {
+    if !typ.array_dims.is_empty() || depth > MAX_FIELD_DEPTH {
+        return;
+    }
+    if typ.pointer_depth > 0 {
+        out.push((path.to_string(), offset));
+        return;
+    }
+    let BaseType::Struct(name) = &typ.base else {
+        return;
+    };
+    let Some(def) = struct_defs.get(name) else {
+        return;
+    };
+    let mut field_offset = offset;
+    for field in &def.fields {
+        pointer_slots(
+            &field.field_type,
+            struct_defs,
+            &format!("{}.{}", path, field.name),
+            field_offset,
+            depth + 1,
+            out,
+        );
+        field_offset += sizeof_type(&field.field_type, struct_defs);
+    }
+}
+
+/// Pointers held in a stack value, labelled by their path from `label`
+fn value_pointers(
+    value: &Value,
+    typ: &Type,
+    struct_defs: &FxHashMap<String, StructDef>,
+    label: String,
+    out: &mut Vec<(String, Address)>,
+) {
+    if out.len() >= MAX_NODE_EDGES {
+        return;
+    }
+    match value {
+        Value::Pointer(address) => out.push((label, *address)),
+        Value::Array(elements) => {
+            let elem_type = Type {
+                array_dims: typ.array_dims.iter().skip(1).copied().collect(),
+                ..typ.clone()
+            };
+            for (i, element) in elements.iter().enumerate() {
+                let label = format!("{}[{}]", label, i);
+                value_pointers(element, &elem_type, struct_defs, label, out);
+            }
+        }
+        Value::Struct(fields) => {
+            let BaseType::Struct(name) = &typ.base else {
+                return;
+            };
+            let Some(def) = struct_defs.get(name) else {
+                return;
+            };
+            for field in &def.fields {
+                if let Some(field_value) = fields.get(&field.name) {
+                    let label = format!("{}.{}", label, field.name);
+                    value_pointers(
+                        field_value,
+                        &field.field_type,
+                        struct_defs,
+                        label,
+                        out,
+                    );
+                }
+            }
+        }
+        _ => {}
+    }
+}
+
+/// One pass over the graph for a single history position
+struct Walk<'a> {
+    heap: &'a Heap,
+    frame_names: Vec<&'a str>,
+    roots: Vec<Root>,
+    /// Stack variables by address: `(end address, frame, name)`
+    vars: BTreeMap<Address, (Address, usize, &'a str)>,
+}
+
+impl<'a> Walk<'a> {
+    fn new(
+        stack: &'a Stack,
+        heap: &'a Heap,
+        struct_defs: &FxHashMap<String, StructDef>,
+    ) -> Self {
+        let mut roots = Vec::new();
+        let mut vars = BTreeMap::new();
+        for (frame_idx, frame) in stack.frames().iter().enumerate() {
+            for name in &frame.insertion_order {
+                let Some(var) = frame.locals.get(name) else {
+                    continue;
+                };
+                let size = sizeof_type(&var.var_type, struct_defs).max(1);
+                vars.insert(
+                    var.address,
+                    (var.address + size as u64, frame_idx, name.as_str()),
+                );
+                let mut edges = Vec::new();
+                value_pointers(
+                    &var.value,
+                    &var.var_type,
+                    struct_defs,
+                    String::new(),
+                    &mut edges,
+                );
+                if !edges.is_empty() {
+                    roots.push(Root {
+                        frame: frame_idx,
+                        name: name.clone(),
+                        edges,
+                    });
+                }
+            }
+        }
+        Walk {
+            heap,
+            frame_names: stack
+                .frames()
+                .iter()
+                .map(|f| f.function_name.as_str())
+                .collect(),
+            roots,
+            vars,
+        }
+    }
+
+    fn inputs(&self) -> WalkInputs {
+        WalkInputs {
+            frame_names: self
+                .frame_names
+                .iter()
+                .map(|name| name.to_string())
+                .collect(),
+            vars: self
+                .vars
+                .iter()
+                .map(|(&address, &(end, frame, name))| {
+                    (address, end, frame, name.to_string())
+                })
+                .collect(),
+            roots: self.roots.clone(),
+            blocks: self
+                .heap
+                .blocks()
+                .map(|(base, block)| (base, block.modified_step))
+                .collect(),
+        }
+    }
+
+    /// What `address` points into: a block (by tagged base and offset), a
+    /// variable, or nothing
+    fn resolve(&self, address: Address) -> Link {
+        if let Ok((_, offset)) = self.heap.block_at(address) {
+            return Link::Tree {
+                base: address - offset as u64,
+                offset,
+            };
+        }
+        if address < HEAP_ADDRESS_START {
+            if let Some((_, &(end, frame, name))) =
+                self.vars.range(..=address).next_back()
+            {
+                if address < end {
+                    return Link::Var {
+                        frame,
+                        name: name.to_string(),
+                    };
+                }
+            }
+        }
+        Link::Dangling(address)
+    }
+
+    /// Breadth-first walk from the roots (then from unreached blocks) that
+    /// expands at most `max_nodes` blocks, followed by the row layout
+    fn layout(
+        &self,
+        block_edges: &FxHashMap<Address, BlockEdges>,
+        max_nodes: usize,
+    ) -> Vec<GraphRow> {
+        let mut visited: FxHashSet<Address> = FxHashSet::default();
+        let mut queue = VecDeque::new();
+        // Each expanded block's pointers, resolved
+        let mut links: FxHashMap<Address, Vec<(String, Link)>> =
+            FxHashMap::default();
+
+        let claim = |address: Address,
+                     visited: &mut FxHashSet<Address>,
+                     queue: &mut VecDeque<Address>| {
+            match self.resolve(address) {
+                Link::Tree { base, offset } => {
+                    if visited.contains(&base) {
+                        Link::Seen { base, offset }
+                    } else if visited.len() >= max_nodes {
+                        Link::Unexplored(address)
+                    } else {
+                        visited.insert(base);
+                        queue.push_back(base);
+                        Link::Tree { base, offset }
+                    }
+                }
+                other => other,
+            }
+        };
+        let expand =
+            |visited: &mut FxHashSet<Address>,
+             queue: &mut VecDeque<Address>,
+             links: &mut FxHashMap<Address, Vec<_>>| {
+                while let Some(base) = queue.pop_front() {
+                    let edges = block_edges
+                        .get(&base)
+                        .map(|e| Arc::clone(&e.edges))
+                        .unwrap_or_else(|| Arc::from(Vec::new()));
+                    let resolved = edges
+                        .iter()
+                        .map(|(label, address)| {
+                            (label.clone(), claim(*address, visited, queue))
+                        })
+                        .collect();
+                    links.insert(base, resolved);
+                }
+            };
+
+        let mut root_links = Vec::with_capacity(self.roots.len());
+        for root in &self.roots {
+            let resolved: Vec<(String, Link)> = root
+                .edges
+                .iter()
+                .map(|(label, address)| {
+                    (label.clone(), claim(*address, &mut visited, &mut queue))
+                })
+                .collect();
+            root_links.push(resolved);
+            expand(&mut visited, &mut queue, &mut links);
+        }
+
+        let mut unreachable = Vec::new();
+        for (base, _) in self.heap.blocks() {
+            if visited.contains(&base) || visited.len() >= max_nodes {
+                continue;
+            }
+            visited.insert(base);
+            queue.push_back(base);
+            unreachable.push(base);
+            expand(&mut visited, &mut queue, &mut links);
+        }
+
+        let mut layout = Layout {
+            links: &links,
+            rows: Vec::new(),
+            work: Vec::new(),
+        };
+        let mut frame = None;
+        for (root, resolved) in self.roots.iter().zip(&root_links) {
+            if frame != Some(root.frame) {
+                frame = Some(root.frame);
+                let name = self.frame_names.get(root.frame).copied();
+                layout.row(
+                    0,
+                    String::new(),
+                    RowTarget::Frame(name.unwrap_or("?").to_string()),
+                );
+            }
+            layout.root(1, &root.name, resolved);
+        }
+        if !unreachable.is_empty() {
+            layout.row(0, String::new(), RowTarget::Unreachable);
+            for base in unreachable {
+                layout.emit_block(1, String::new(), base, 0);
+                layout.drain();
+            }
+        }
+        layout.rows
+    }
+}
+
+/// Row builder over the walked graph; an explicit work stack keeps deep
+/// graphs from recursing
+struct Layout<'l> {
+    links: &'l FxHashMap<Address, Vec<(String, Link)>>,
+    rows: Vec<GraphRow>,
+    work: Vec<(usize, String, &'l Link)>,
+}
+
+impl<'l> Layout<'l> {
+    fn row(&mut self, indent: usize, label: String, target: RowTarget) {
+        self.rows.push(GraphRow {
+            indent,
+            label,
+            target,
+        });
+    }
+
+    /// A stack variable and everything reached through it first
+    fn root(&mut self, indent: usize, name: &str, links: &'l [(String, Link)]) {
+        if let [(path, link)] = links {
+            self.emit(indent, format!("{}{}", name, path), link);
+        } else {
+            self.row(indent, name.to_string(), RowTarget::Group);
+            for (path, link) in links.iter().rev() {
+                self.work
+                    .push((indent + 1, format!("{}{}", name, path), link));
+            }
+        }
+        self.drain();
+    }
+
+    /// Emit queued links until the work stack is empty
+    fn drain(&mut self) {
+        while let Some((indent, label, link)) = self.work.pop() {
+            self.emit(indent, label, link);
+        }
+    }
+
+    fn emit(&mut self, indent: usize, label: String, link: &'l Link) {
+        let target = match link {
+            Link::Tree { base, offset } => {
+                self.emit_block(indent, label, *base, *offset);
+                return;
+            }
+            Link::Seen { base, offset } => RowTarget::Seen {
+                base: *base,
+                offset: *offset,
+            },
+            Link::Var { frame, name } => RowTarget::Var {
+                frame: *frame,
+                name: name.clone(),
+            },
+            Link::Dangling(address) => RowTarget::Dangling(*address),
+            Link::Unexplored(address) => RowTarget::Unexplored(*address),
+        };
+        self.row(indent, label, target);
+    }
+
+    /// A block reached for the first time, followed along its chain of
+    /// single new successors at the same indentation
+    fn emit_block(
+        &mut self,
+        indent: usize,
+        label: String,
+        base: Address,
+        offset: usize,
+    ) {
+        let links = self.links;
+        // Each chain step: the label and block, plus the block's links
+        let mut chain = vec![(label, base, offset)];
+        loop {
+            let (_, current, _) = chain[chain.len() - 1];
+            let next = match links.get(&current).map(Vec::as_slice) {
+                Some(node_links) => {
+                    let mut tree =
+                        node_links.iter().filter_map(|(l, link)| match link {
+                            Link::Tree { base, offset } => {
+                                Some((l.clone(), *base, *offset))
+                            }
+                            _ => None,
+                        });
+                    match (tree.next(), tree.next()) {
+                        (Some(only), None) => Some(only),
+                        _ => None,
+                    }
+                }
+                None => None,
+            };
+            match next {
+                Some(step) => chain.push(step),
+                None => break,
+            }
+        }
+
+        let len = chain.len();
+        let collapse = len > CHAIN_HEAD + CHAIN_TAIL + 1;
+        for (i, (label, base, offset)) in chain.into_iter().enumerate() {
+            let last = i + 1 == len;
+            if collapse && i >= CHAIN_HEAD && i < len - CHAIN_TAIL {
+                if i == CHAIN_HEAD {
+                    self.row(
+                        indent,
+                        label,
+                        RowTarget::Collapsed(len - CHAIN_HEAD - CHAIN_TAIL),
+                    );
+                }
+                continue;
+            }
+            self.row(indent, label, RowTarget::Block { base, offset });
+            let Some(node_links) = links.get(&base) else {
+                continue;
+            };
+            if last {
+                // The chain ends here: every link hangs below the block
+                for (path, link) in node_links.iter().rev() {
+                    self.work.push((indent + 1, path.clone(), link));
+                }
+            } else {
+                // Back-references and the like; the successor is next
+                for (path, link) in node_links.iter() {
+                    if !matches!(link, Link::Tree { .. }) {
+                        self.emit(indent + 1, path.clone(), link);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::memory::stack::InitState;
+    use crate::parser::parse::Parser;
+
+    const NODE: &str = "struct Node { int value; struct Node* next; };\n";
+
+    /// Run `body` as `main` and stop at the last step that still has a
+    /// stack frame
+    fn run(body: &str) -> Interpreter {
+        let source =
+            format!("{}int main() {{\n{}\nreturn 0;\n}}\n", NODE, body);
+        let mut parser = Parser::new(&source).expect("Parser creation failed");
+        let program = parser.parse_program().expect("Parsing failed");
+        let mut interpreter = Interpreter::new(program, 64 * 1024 * 1024);
+        interpreter.run().expect("Execution failed");
+        while interpreter.stack().is_empty() {
+            interpreter.step_backward().expect("No step with a frame");
+        }
+        interpreter
+    }
+
+    /// A list of `len` nodes built front to back from `head`
+    fn list(len: usize) -> String {
+        format!(
+            "struct Node* head = (struct Node*)malloc(sizeof(struct Node));
+            struct Node* node = head;
+            for (int i = 1; i < {}; i++) {{
+                node->next = (struct Node*)malloc(sizeof(struct Node));
+                node = node->next;
+            }}
+            node->next = 0;
+            node = 0;",
+            len
+        )
+    }
+
+    fn targets(rows: &[GraphRow]) -> Vec<&RowTarget> {
+        rows.iter().map(|row| &row.target).collect()
+    }
+
+    #[test]
+    fn test_cycle_ends_in_seen_row() {
+        let interpreter =
+            run("struct Node* a = (struct Node*)malloc(sizeof(struct Node));
+            struct Node* b = (struct Node*)malloc(sizeof(struct Node));
+            a->next = b;
+            b->next = a;
+            b = 0;");
+        let mut graph = PointerGraph::new();
+        graph.update(&interpreter);
+        let rows = targets(graph.rows());
+
+        assert!(matches!(rows[0], RowTarget::Frame(name) if name == "main"));
+        let RowTarget::Block { base: a, .. } = rows[1] else {
+            panic!("expected a block row, got {:?}", rows[1]);
+        };
+        assert!(matches!(rows[2], RowTarget::Block { .. }));
+        assert_eq!(
+            rows[3],
+            &RowTarget::Seen {
+                base: *a,
+                offset: 0
+            }
+        );
+        assert_eq!(graph.rows()[3].label, ".next");
+        assert_eq!(rows.len(), 4);
+    }
+
+    #[test]
+    fn test_long_list_collapses_to_head_and_tail() {
+        // Built directly: ten thousand steps of history would not fit the
+        // snapshot budget
+        let len = 10_000;
+        let mut heap = Heap::new(len * 64);
+        let bases: Vec<Address> =
+            (0..len).map(|_| heap.allocate(16).unwrap()).collect();
+        let block_edges = bases
+            .windows(2)
+            .map(|pair| {
+                let edges = vec![(".next".to_string(), pair[1])];
+                let edges = BlockEdges {
+                    modified_step: 0,
+                    edges: edges.into(),
+                };
+                (pair[0], edges)
+            })
+            .collect();
+        let mut stack = Stack::new();
+        stack.push_frame("main".to_string(), None);
+        let frame = stack.current_frame_mut().unwrap();
+        frame.declare_var(
+            "head".to_string(),
+            Type::new(BaseType::Int).with_pointer(),
+            InitState::Initialized,
+            0x1000,
+        );
+        frame.get_var_mut("head").unwrap().value = Value::Pointer(bases[0]);
+
+        let walk = Walk::new(&stack, &heap, &FxHashMap::default());
+        let rows = walk.layout(&block_edges, MAX_GRAPH_NODES);
+        let targets = targets(&rows);
+
+        let block = |base: Address| RowTarget::Block { base, offset: 0 };
+        let mut expected = vec![RowTarget::Frame("main".to_string())];
+        expected.extend(bases[..CHAIN_HEAD].iter().map(|&b| block(b)));
+        expected.push(RowTarget::Collapsed(len - CHAIN_HEAD - CHAIN_TAIL));
+        expected.extend(bases[len - CHAIN_TAIL..].iter().map(|&b| block(b)));
+        assert_eq!(targets, expected.iter().collect::<Vec<_>>());
+        assert!(rows[1..].iter().all(|row| row.indent == 1));
+    }
+
+    #[test]
+    fn test_node_limit_leaves_rest_unexplored() {
+        let interpreter = run(&list(10));
+        let mut graph = PointerGraph::new();
+        graph
+            .refresh_block_edges(interpreter.heap(), interpreter.struct_defs());
+        let walk = Walk::new(
+            interpreter.stack(),
+            interpreter.heap(),
+            interpreter.struct_defs(),
+        );
+        let rows = walk.layout(&graph.block_edges, 4);
+        let rows = targets(&rows);
+
+        let block_rows = rows
+            .iter()
+            .filter(|t| matches!(t, RowTarget::Block { .. }))
+            .count();
+        assert_eq!(block_rows, 4);
+        assert!(matches!(rows.last(), Some(RowTarget::Unexplored(_))));
+        assert!(!rows.contains(&&RowTarget::Unreachable));
+    }
+
+    #[test]
+    fn test_unchanged_graph_is_not_walked_again() {
+        let mut interpreter = run(&format!("{}\nint x = 1;\nx = 2;", list(3)));
+        let mut graph = PointerGraph::new();
+        graph.update(&interpreter);
+        let rows = graph.rows().as_ptr();
+
+        // `x = 2` touches neither the heap nor the stack's pointers
+        interpreter
+            .step_backward()
+            .expect("No step before the last");
+        graph.update(&interpreter);
+        assert_eq!(graph.rows().as_ptr(), rows);
+    }
+}
@@ -0,0 +1,71 @@
+//! Source text with a line index and a syntax-highlight cache
+//!
+//! [`SourceText`] is built once per source load (and again when `--watch`
+//! picks up an edit). Line lookups go through a table of line start
+//! offsets, and each line is syntax-highlighted the first time it is drawn,
+//! so scrolling and stepping never rescan the source.
+
+use super::panes::source::highlight_source_code;
+use ratatui::text::Line;
+use std::cell::OnceCell;
+
+/// The program source as shown by the TUI panes
+pub struct SourceText {
+    text: String,
+    /// Byte offset of the start of each line
+    line_starts: Vec<usize>,
+    /// Highlighted lines, filled in as they are first drawn
+    highlighted: Vec<OnceCell<Line<'static>>>,
+}
+
+impl SourceText {
+    pub fn new(text: String) -> Self {
+        let mut line_starts = Vec::new();
+        let mut start = 0;
+        while start < text.len() {
+            line_starts.push(start);
+            start = match text[start..].find('\n') {
+                Some(i) => start + i + 1,
+                None => text.len(),
+            };
+        }
+        SourceText {
+            highlighted: line_starts.iter().map(|_| OnceCell::new()).collect(),
+            line_starts,
+            text,
+        }
+    }
+
+    /// The whole source
+    pub fn as_str(&self) -> &str {
+        &self.text
+    }
+
+    /// Number of lines, as counted by [`str::lines`]
+    pub fn line_count(&self) -> usize {
+        self.line_starts.len()
+    }
+
+    /// Text of 1-based line `line`, without its line terminator
+    pub fn line(&self, line: usize) -> Option<&str> {
+        let idx = line.checked_sub(1)?;
+        let start = *self.line_starts.get(idx)?;
+        let end = self
+            .line_starts
+            .get(idx + 1)
+            .copied()
+            .unwrap_or(self.text.len());
+        let text = &self.text[start..end];
+        Some(match text.strip_suffix('\n') {
+            Some(text) => text.strip_suffix('\r').unwrap_or(text),
+            None => text,
+        })
+    }
+
+    /// Syntax-highlighted 1-based line `line`
+    pub fn highlighted(&self, line: usize) -> Option<&Line<'static>> {
+        let cell = self.highlighted.get(line.checked_sub(1)?)?;
+        let text = self.line(line)?;
+        Some(cell.get_or_init(|| highlight_source_code(text)))
+    }
+}
@@ -28,6 +28,8 @@ pub struct Theme {
     pub muted_function: Color, // Muted yellow for call chain functions
     pub type_name: Color,      // Cyan for type names
     pub return_value: Color,   // Special color for return values
+    pub changed_bg: Color,     // Background of values changed recently
+    pub heat_bg: [Color; 3],   // Heatmap backgrounds, least to most accessed
 }
 
 /// The default Catppuccin Mocha-inspired color palette used by CRusTTY.
@@ -48,4 +50,10 @@ pub const DEFAULT_THEME: Theme = Theme {
     muted_function: Color::Rgb(180, 165, 120), // Muted yellow for call chain
     type_name: Color::Rgb(148, 226, 213),    // Cyan/teal for type names
     return_value: Color::Rgb(245, 194, 231), // Pink for return values
+    changed_bg: Color::Rgb(45, 70, 55),      // Dark green for changed values
+    heat_bg: [
+        Color::Rgb(40, 50, 80),  // Dark blue: accessed a few times
+        Color::Rgb(85, 65, 35),  // Dark amber: warm
+        Color::Rgb(100, 40, 55), // Dark red: hottest
+    ],
 };
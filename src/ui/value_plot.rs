@@ -0,0 +1,280 @@
+//! Value-over-time series of a pinned expression
+//!
+//! Pinning an expression (`i`, `sum`, `list_length(head)`) plots its value
+//! at every recorded history position. Snapshots are immutable, so the
+//! series is computed by a pool of worker threads, each with its own
+//! [`Probe`], that claim chunks of positions and send back their samples.
+//! The UI thread merges chunks as they arrive, so the plot fills in while
+//! the program stays navigable.
+//!
+//! Finished series are kept per expression until the history is recorded
+//! again, so switching between pinned expressions does not recompute them.
+//!
+//! [`Probe`]: crate::interpreter::probe::Probe
+
+use crate::interpreter::constants::INTERPRETER_STACK_SIZE;
+use crate::interpreter::engine::Interpreter;
+use crate::interpreter::probe::Probe;
+use crate::memory::value::Value;
+use crate::snapshot::Snapshot;
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::sync::Arc;
+use std::thread;
+
+/// History positions a worker claims at a time
+const CHUNK_SIZE: usize = 256;
+
+/// Upper bound on worker threads
+const MAX_WORKERS: usize = 8;
+
+/// Finished series kept besides the pinned one
+const CACHED_SERIES: usize = 8;
+
+/// The expression's value at one history position
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum Sample {
+    /// Not evaluated yet
+    Pending,
+    /// No numeric value (out of scope, uninitialized, a struct, …)
+    Missing,
+    Value(f64),
+}
+
+/// The values of one expression over the history
+pub struct Series {
+    pub expression: String,
+    /// One sample per history position
+    pub samples: Vec<Sample>,
+    /// Positions whose sample has arrived
+    pub computed: usize,
+    /// Smallest and largest sample so far
+    pub range: Option<(f64, f64)>,
+}
+
+impl Series {
+    fn new(expression: String, len: usize) -> Self {
+        Series {
+            expression,
+            samples: vec![Sample::Pending; len],
+            computed: 0,
+            range: None,
+        }
+    }
+
+    /// Whether every position has been evaluated
+    pub fn is_complete(&self) -> bool {
+        self.computed >= self.samples.len()
+    }
+
+    fn merge(&mut self, start: usize, samples: &[Sample]) {
+        for (slot, &sample) in self.samples[start..].iter_mut().zip(samples) {
+            *slot = sample;
+            if let Sample::Value(v) = sample {
+                self.range = Some(match self.range {
+                    Some((lo, hi)) => (lo.min(v), hi.max(v)),
+                    None => (v, v),
+                });
+            }
+        }
+        self.computed += samples.len();
+    }
+}
+
+/// Samples for positions `start..` computed by a worker
+struct Chunk {
+    generation: u64,
+    start: usize,
+    samples: Vec<Sample>,
+}
+
+/// The pinned expression's series and the workers computing it
+pub struct ValuePlot {
+    pinned: Option<Series>,
+    /// Finished series, most recently pinned first
+    cached: VecDeque<Series>,
+    /// Bumped whenever the workers' results stop being wanted
+    generation: Arc<AtomicU64>,
+    chunks: Receiver<Chunk>,
+    sender: Sender<Chunk>,
+}
+
+impl Default for ValuePlot {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl ValuePlot {
+    pub fn new() -> Self {
+        let (sender, chunks) = mpsc::channel();
+        ValuePlot {
+            pinned: None,
+            cached: VecDeque::new(),
+            generation: Arc::new(AtomicU64::new(0)),
+            chunks,
+            sender,
+        }
+    }
+
+    /// The pinned expression's series, possibly still filling in
+    pub fn series(&self) -> Option<&Series> {
+        self.pinned.as_ref()
+    }
+
+    /// Whether workers are still computing the pinned series
+    pub fn is_computing(&self) -> bool {
+        self.pinned.as_ref().is_some_and(|s| !s.is_complete())
+    }
+
+    /// Pin `expression` and start computing its series over the history
+    pub fn pin(
+        &mut self,
+        interpreter: &Interpreter,
+        expression: &str,
+    ) -> Result<(), String> {
+        let probe = interpreter.probe(expression).map_err(|e| e.message)?;
+        self.unpin();
+
+        if let Some(idx) =
+            self.cached.iter().position(|s| s.expression == expression)
+        {
+            self.pinned = self.cached.remove(idx);
+            return Ok(());
+        }
+
+        let snapshots: Arc<[Option<Arc<Snapshot>>]> = (0..interpreter
+            .total_snapshots())
+            .map(|p| interpreter.snapshot(p))
+            .collect();
+        self.pinned =
+            Some(Series::new(expression.to_string(), snapshots.len()));
+        self.spawn_workers(probe, snapshots);
+        Ok(())
+    }
+
+    /// Stop plotting; a finished series is kept for the next pin
+    pub fn unpin(&mut self) {
+        self.generation.fetch_add(1, Ordering::Relaxed);
+        if let Some(series) = self.pinned.take() {
+            if series.is_complete() {
+                self.cached.push_front(series);
+                self.cached.truncate(CACHED_SERIES);
+            }
+        }
+    }
+
+    /// Drop every series after the history was recorded again, then
+    /// recompute the pinned one against `interpreter`
+    pub fn invalidate(&mut self, interpreter: &Interpreter) {
+        self.generation.fetch_add(1, Ordering::Relaxed);
+        self.cached.clear();
+        if let Some(series) = self.pinned.take() {
+            // The expression may no longer parse against an edited program
+            let _ = self.pin(interpreter, &series.expression);
+        }
+    }
+
+    /// Merge the chunks that arrived; returns whether any did
+    pub fn poll(&mut self) -> bool {
+        let generation = self.generation.load(Ordering::Relaxed);
+        let mut merged = false;
+        while let Ok(chunk) = self.chunks.try_recv() {
+            if chunk.generation != generation {
+                continue;
+            }
+            if let Some(series) = self.pinned.as_mut() {
+                series.merge(chunk.start, &chunk.samples);
+                merged = true;
+            }
+        }
+        merged
+    }
+
+    fn spawn_workers(
+        &self,
+        probe: Probe,
+        snapshots: Arc<[Option<Arc<Snapshot>>]>,
+    ) {
+        let generation = self.generation.load(Ordering::Relaxed);
+        let chunk_count = snapshots.len().div_ceil(CHUNK_SIZE);
+        let workers = thread::available_parallelism()
+            .map_or(1, |n| n.get().saturating_sub(1))
+            .clamp(1, MAX_WORKERS)
+            .min(chunk_count);
+        let next_chunk = Arc::new(AtomicUsize::new(0));
+
+        for _ in 0..workers {
+            let worker = Worker {
+                probe: probe.fork(),
+                snapshots: Arc::clone(&snapshots),
+                next_chunk: Arc::clone(&next_chunk),
+                generation,
+                current: Arc::clone(&self.generation),
+                sender: self.sender.clone(),
+            };
+            // Probes recurse through the host stack like the interpreter;
+            // if no worker starts the series simply stays empty
+            let _ = thread::Builder::new()
+                .name("crustty-plot".to_string())
+                .stack_size(INTERPRETER_STACK_SIZE)
+                .spawn(move || worker.run());
+        }
+    }
+}
+
+/// One thread's share of a series computation
+struct Worker {
+    probe: Probe,
+    snapshots: Arc<[Option<Arc<Snapshot>>]>,
+    next_chunk: Arc<AtomicUsize>,
+    /// Generation this computation belongs to
+    generation: u64,
+    current: Arc<AtomicU64>,
+    sender: Sender<Chunk>,
+}
+
+impl Worker {
+    /// Claim and evaluate chunks until none are left or the series is no
+    /// longer wanted
+    fn run(mut self) {
+        loop {
+            let start =
+                self.next_chunk.fetch_add(1, Ordering::Relaxed) * CHUNK_SIZE;
+            if start >= self.snapshots.len() {
+                return;
+            }
+            let end = (start + CHUNK_SIZE).min(self.snapshots.len());
+            let mut samples = Vec::with_capacity(end - start);
+            for snapshot in &self.snapshots[start..end] {
+                if self.current.load(Ordering::Relaxed) != self.generation {
+                    return;
+                }
+                let value = snapshot.as_deref().and_then(|s| {
+                    self.probe.evaluate(s).ok().and_then(plot_value)
+                });
+                samples.push(value.map_or(Sample::Missing, Sample::Value));
+            }
+            let chunk = Chunk {
+                generation: self.generation,
+                start,
+                samples,
+            };
+            if self.sender.send(chunk).is_err() {
+                return;
+            }
+        }
+    }
+}
+
+/// The plotted number for a value, if it has one
+fn plot_value(value: Value) -> Option<f64> {
+    match value {
+        Value::Int(n) => Some(f64::from(n)),
+        Value::Char(c) => Some(f64::from(c)),
+        Value::Pointer(address) => Some(address as f64),
+        Value::Null => Some(0.0),
+        Value::Struct(_) | Value::Array(_) | Value::Uninitialized => None,
+    }
+}
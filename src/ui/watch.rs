@@ -0,0 +1,149 @@
+//! Source file watching for `--watch`
+//!
+//! [`Watcher`] is polled from the TUI event loop and checks the watched
+//! file's modification time and length. When they change, the source is
+//! re-parsed with an [`IncrementalParser`] (only edited functions and structs
+//! are parsed again) and the program is re-executed on a background thread,
+//! so the TUI stays responsive and keeps showing the previous run until the
+//! new one is ready.
+
+use super::app::ErrorState;
+use crate::interpreter::constants::INTERPRETER_STACK_SIZE;
+use crate::interpreter::engine::Interpreter;
+use crate::parser::incremental::IncrementalParser;
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::thread;
+use std::time::{Duration, Instant, SystemTime};
+
+/// A finished background run of the edited program
+pub struct Reload {
+    pub interpreter: Interpreter,
+    pub source: String,
+    /// Top-level items kept from the previous parse
+    pub reused: usize,
+    /// Top-level items parsed again
+    pub reparsed: usize,
+    /// Time from noticing the change to the run finishing
+    pub elapsed: Duration,
+}
+
+/// A change the TUI should react to
+pub enum WatchEvent {
+    /// The file changed and the program is being re-executed
+    Started,
+    /// The edited source does not parse
+    ParseError { source: String, error: ErrorState },
+    /// The edited program finished running
+    Reloaded(Box<Reload>),
+}
+
+struct Run {
+    generation: u64,
+    reload: Reload,
+}
+
+/// Watches a source file and re-runs it when it changes
+pub struct Watcher {
+    path: PathBuf,
+    /// Modification time and length seen at the last check
+    stamp: Option<(SystemTime, u64)>,
+    parser: IncrementalParser,
+    snapshot_limit: usize,
+    /// Incremented per edit; results of superseded runs are dropped
+    generation: u64,
+    sender: Sender<Run>,
+    receiver: Receiver<Run>,
+}
+
+impl Watcher {
+    /// Watch `path`, whose current contents `parser` has already parsed
+    pub fn new(
+        path: impl Into<PathBuf>,
+        parser: IncrementalParser,
+        snapshot_limit: usize,
+    ) -> Self {
+        let path = path.into();
+        let (sender, receiver) = mpsc::channel();
+        Watcher {
+            stamp: file_stamp(&path),
+            path,
+            parser,
+            snapshot_limit,
+            generation: 0,
+            sender,
+            receiver,
+        }
+    }
+
+    /// Collect a finished run, or start one if the file changed.
+    ///
+    /// `stdin` is fed to the re-executed program's `scanf` calls.
+    pub fn poll(&mut self, stdin: &str) -> Option<WatchEvent> {
+        let mut latest = None;
+        while let Ok(run) = self.receiver.try_recv() {
+            if run.generation == self.generation {
+                latest = Some(run.reload);
+            }
+        }
+        if let Some(reload) = latest {
+            return Some(WatchEvent::Reloaded(Box::new(reload)));
+        }
+
+        let stamp = file_stamp(&self.path);
+        if stamp.is_none() || stamp == self.stamp {
+            return None;
+        }
+        let started = Instant::now();
+        // An unreadable file (e.g. mid-save) is retried on the next poll
+        let source = fs::read_to_string(&self.path).ok()?;
+        self.stamp = stamp;
+        self.generation += 1;
+
+        let reparse = match self.parser.parse(&source) {
+            Ok(reparse) => reparse,
+            Err(e) => {
+                return Some(WatchEvent::ParseError {
+                    source,
+                    error: ErrorState::ParseError {
+                        message: e.message,
+                        location: e.location,
+                    },
+                });
+            }
+        };
+
+        let generation = self.generation;
+        let sender = self.sender.clone();
+        let snapshot_limit = self.snapshot_limit;
+        let stdin = stdin.to_string();
+        let spawned = thread::Builder::new()
+            .name("crustty-watch".to_string())
+            .stack_size(INTERPRETER_STACK_SIZE)
+            .spawn(move || {
+                let mut interpreter =
+                    Interpreter::new(reparse.program, snapshot_limit);
+                interpreter.queue_stdin(&stdin);
+                // A runtime error is kept by the interpreter and shown when
+                // the user steps to it
+                let _ = interpreter.run();
+                let _ = sender.send(Run {
+                    generation,
+                    reload: Reload {
+                        interpreter,
+                        source,
+                        reused: reparse.reused,
+                        reparsed: reparse.reparsed,
+                        elapsed: started.elapsed(),
+                    },
+                });
+            });
+        spawned.ok().map(|_| WatchEvent::Started)
+    }
+}
+
+fn file_stamp(path: &Path) -> Option<(SystemTime, u64)> {
+    let metadata = fs::metadata(path).ok()?;
+    Some((metadata.modified().ok()?, metadata.len()))
+}
@@ -1,6 +1,9 @@
 // Integration tests for the C interpreter
 
 use crustty::interpreter::engine::Interpreter;
+use crustty::interpreter::profiler::ProfileOrder;
+use crustty::memory::heap_profile::SiteOrder;
+use crustty::memory::value::Value;
 use crustty::parser::parse::Parser;
 
 #[test]
@@ -443,6 +446,129 @@ fn test_reverse_execution_preserves_state() {
     // State should be consistent - test passes if we reach here without panicking
 }
 
+#[test]
+fn test_seek_matches_stepping() {
+    let source = r#"
+        int main() {
+            int x = 1;
+            x = x + 1;
+            x = x * 10;
+            x = x - 3;
+            return x;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.run().expect("Execution failed");
+    interpreter.rewind_to_start().expect("Rewind failed");
+    for _ in 0..3 {
+        interpreter.step_forward().expect("Step forward failed");
+    }
+    let stepped_line = interpreter.current_location().line;
+    let stepped_x = interpreter.stack().current_frame().unwrap().locals["x"]
+        .value
+        .clone();
+
+    interpreter.rewind_to_start().expect("Rewind failed");
+    interpreter.seek(3).expect("Seek failed");
+    assert_eq!(interpreter.history_position(), 3);
+    assert_eq!(interpreter.current_location().line, stepped_line);
+    assert_eq!(
+        interpreter.stack().current_frame().unwrap().locals["x"].value,
+        stepped_x
+    );
+
+    let total = interpreter.total_snapshots();
+    assert!(interpreter.seek(total).is_err());
+    assert_eq!(interpreter.history_position(), 3);
+}
+
+#[test]
+fn test_modification_stamps_follow_writes() {
+    let source = r#"
+        int main() {
+            int a = 1;
+            int b = 2;
+            a = a + b;
+            int *p = malloc(sizeof(int));
+            *p = 5;
+            b = 0;
+            return 0;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.run().expect("Execution failed");
+    interpreter.rewind_to_start().expect("Rewind failed");
+
+    // At each step, exactly the variables written by that step carry its
+    // stamp, and no stamp is from the future
+    let mut a_steps = Vec::new();
+    loop {
+        let step = interpreter.history_position();
+        if let Some(frame) = interpreter.stack().current_frame() {
+            for var in frame.locals.values() {
+                assert!(var.modified_step <= step);
+            }
+            if let Some(a) = frame.locals.get("a") {
+                if a.modified_step == step {
+                    a_steps.push(interpreter.current_location().line);
+                }
+            }
+        }
+        for (_, block) in interpreter.heap().blocks() {
+            assert!(block.modified_step <= step);
+            if interpreter.current_location().line == 7 {
+                assert!(block.modified_since(0..4, step));
+            }
+        }
+        if interpreter.step_forward().is_err() {
+            break;
+        }
+    }
+    assert_eq!(a_steps, vec![3, 5]);
+}
+
+#[test]
+fn test_seek_next_line() {
+    let source = r#"
+        int main() {
+            int sum = 0;
+            for (int i = 0; i < 3; i++) {
+                sum = sum + i;
+            }
+            return sum;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.run().expect("Execution failed");
+    interpreter.rewind_to_start().expect("Rewind failed");
+
+    // Each call lands on the next iteration of the loop body
+    let mut positions = Vec::new();
+    while interpreter.seek_next_line(5) {
+        assert_eq!(interpreter.current_location().line, 5);
+        positions.push(interpreter.history_position());
+    }
+    assert_eq!(positions.len(), 3);
+    assert!(positions.windows(2).all(|w| w[0] < w[1]));
+
+    // No later visit: stay put
+    let before = interpreter.history_position();
+    assert!(!interpreter.seek_next_line(5));
+    assert_eq!(interpreter.history_position(), before);
+}
+
 // ================== CONVERTED C FILE TESTS ==================
 
 #[test]
@@ -1076,6 +1202,40 @@ fn test_recursive_function_output() {
     assert_eq!(lines, vec!["120", "3628800"]);
 }
 
+#[test]
+fn test_one_past_end_pointer_keeps_block_type() {
+    let lines = run_and_collect_output(
+        r#"
+        struct Big {
+            int x;
+            int y;
+            int z;
+        };
+        int main() {
+            int *a = (int*)malloc(16);
+            struct Big *b = (struct Big*)malloc(sizeof(struct Big));
+            int *c = (int*)malloc(12);
+            for (int i = 0; i < 4; i++) {
+                a[i] = i + 1;
+            }
+            c[2] = 9;
+            b->x = 7;
+            int *end = a + 4;
+            printf("%d\n", end - a);
+            printf("%d\n", *(end - 1));
+            end--;
+            printf("%d\n", *end);
+            int *c_end = c + 3;
+            printf("%d %d\n", c_end - c, *(c_end - 1));
+            b->y = 8;
+            printf("%d %d\n", b->x, b->y);
+            return 0;
+        }
+    "#,
+    );
+    assert_eq!(lines, vec!["4", "4", "4", "3 9", "7 8"]);
+}
+
 #[test]
 fn test_struct_printf_output() {
     let lines = run_and_collect_output(
@@ -1262,9 +1422,9 @@ fn test_infinite_recursion_errors_cleanly() {
     "#;
 
     // The interpreter recurses through the native stack in proportion to the C
-    // call depth, so — like the real binary (see `INTERPRETER_STACK_SIZE` in
-    // main.rs) — drive it on a thread with a generous stack. This guarantees the
-    // depth cap fires as a clean error rather than overflowing the small default
+    // call depth, so — like the real binary (see `INTERPRETER_STACK_SIZE`) —
+    // drive it on a thread with a generous stack. This guarantees the depth cap
+    // fires as a clean error rather than overflowing the small default
     // test-thread stack first.
     let result = std::thread::Builder::new()
         .stack_size(64 * 1024 * 1024)
@@ -1308,3 +1468,588 @@ fn test_bounded_recursion_still_works() {
     );
     assert_eq!(lines, vec!["55"]);
 }
+
+/// Allocate-and-free churn must reuse freed ranges instead of growing the
+/// heap's address space without bound.
+#[test]
+fn test_heap_churn_reaches_steady_state() {
+    let source = r#"
+        struct Node {
+            int value;
+            struct Node* next;
+        };
+
+        int main() {
+            struct Node* head = NULL;
+            for (int i = 0; i < 200; i++) {
+                struct Node* n = (struct Node*)malloc(sizeof(struct Node));
+                n->value = i;
+                n->next = head;
+                head = n;
+                if (i % 2 == 1) {
+                    struct Node* a = head;
+                    struct Node* b = head->next;
+                    head = b->next;
+                    free(a);
+                    free(b);
+                }
+            }
+            return 0;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    let result = interpreter.run();
+
+    assert!(result.is_ok(), "Execution failed: {:?}", result);
+    assert_eq!(interpreter.heap().total_allocated(), 0);
+    // At most two nodes are ever live at once, so the peak footprint over
+    // the whole run stays at two blocks only if freed ranges are reused
+    let peak = (0..interpreter.total_snapshots())
+        .filter_map(|i| interpreter.snapshot(i))
+        .map(|snapshot| snapshot.heap.address_space_used())
+        .max()
+        .unwrap_or(0);
+    assert!(peak > 0);
+    assert!(peak <= 64, "heap grew to {} bytes", peak);
+}
+
+/// A dangling pointer into memory that has since been handed out again must
+/// still be reported as use-after-free rather than aliasing the new block.
+#[test]
+fn test_heap_use_after_free_into_reused_block() {
+    let source = r#"
+        int main() {
+            int* p = (int*)malloc(sizeof(int));
+            *p = 1;
+            free(p);
+            int* q = (int*)malloc(sizeof(int));
+            *q = 2;
+            int val = *p;
+            return val;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    let result = interpreter.run();
+
+    assert!(result.is_err(), "Expected use-after-free error");
+    let error_msg = format!("{:?}", result.unwrap_err());
+    assert!(
+        error_msg.contains("UseAfterFree"),
+        "Expected UseAfterFree, got: {}",
+        error_msg
+    );
+}
+
+/// Pointers derived by arithmetic from a cast pointer must be typed through
+/// the block's layout, for scalars and struct elements alike.
+#[test]
+fn test_heap_interior_pointer_walk() {
+    let lines = run_and_collect_output(
+        r#"
+        struct Point {
+            int x;
+            int y;
+        };
+
+        int main() {
+            int* a = (int*)malloc(4 * sizeof(int));
+            for (int i = 0; i < 4; i++) {
+                a[i] = i * 10;
+            }
+            int* p = a;
+            int sum = 0;
+            for (int i = 0; i < 4; i++) {
+                sum = sum + *p;
+                p++;
+            }
+            int* q = a + 2;
+            printf("%d %d %d\n", sum, *q, q[1]);
+
+            struct Point* pts =
+                (struct Point*)malloc(3 * sizeof(struct Point));
+            for (int i = 0; i < 3; i++) {
+                struct Point* e = pts + i;
+                e->x = i;
+                e->y = i * i;
+            }
+            struct Point* last = pts + 2;
+            printf("%d %d\n", last->x, last->y);
+            return 0;
+        }
+    "#,
+    );
+    assert_eq!(lines, vec!["60 20 30", "2 4"]);
+}
+
+#[test]
+fn test_heap_profile_reports_leaking_site() {
+    let source = r#"
+int* make(int n) {
+    return (int*)malloc(n * sizeof(int));
+}
+
+int main() {
+    for (int i = 0; i < 4; i++) {
+        int* tmp = make(4);
+        free(tmp);
+    }
+    int* leak = (int*)malloc(12);
+    return 0;
+}
+"#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    let result = interpreter.run();
+
+    assert!(result.is_ok(), "Execution failed: {:?}", result);
+    let profile = interpreter.heap_profile();
+    assert_eq!(profile.site_count(), 2);
+
+    let top = profile.top_sites(SiteOrder::LiveBytes, 10);
+    assert_eq!(top.len(), 1);
+    assert_eq!(top[0].site.line, 11);
+    assert_eq!(top[0].live_bytes, 12);
+
+    let churn = profile.top_sites(SiteOrder::Churn, 10);
+    assert_eq!(churn[0].site.line, 3);
+    assert_eq!(churn[0].allocations, 4);
+    assert_eq!(churn[0].bytes_freed, 64);
+    assert_eq!(churn[0].peak_live_bytes, 16);
+    assert_eq!(churn[0].max_call_depth, 2);
+}
+
+#[test]
+fn test_string_literals_are_not_heap_profile_sites() {
+    let source = r#"
+int main() {
+    for (int i = 0; i < 5; i++) {
+        char *s = "abc";
+        printf("%s\n", s);
+    }
+    return 0;
+}
+"#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.run().expect("Execution failed");
+
+    assert_eq!(interpreter.heap_profile().site_count(), 0);
+    assert!(!interpreter.heap_profile().report(10, true).contains("leak"));
+    let stats = interpreter.stats();
+    assert_eq!(stats.allocations, 0);
+    assert_eq!(stats.peak_heap_bytes, 0);
+}
+
+#[test]
+fn test_rerun_with_queued_stdin_returns_to_same_line() {
+    let source = r#"
+int main() {
+    int n;
+    scanf("%d", &n);
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        total = total + i;
+    }
+    printf("%d\n", total);
+    return 0;
+}
+"#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.queue_stdin("4");
+    let result = interpreter.run();
+
+    assert!(result.is_ok(), "Execution failed: {:?}", result);
+    assert!(!interpreter.is_paused_at_scanf());
+    assert!(interpreter.is_execution_complete());
+
+    assert!(interpreter.seek_line(7, 2));
+    assert_eq!(interpreter.current_location().line, 7);
+    assert_eq!(interpreter.line_visit(), 2);
+
+    // Fewer visits than requested: stay on the line's last visit
+    assert!(interpreter.seek_line(7, 10));
+    assert_eq!(interpreter.line_visit(), 3);
+    assert!(!interpreter.seek_line(99, 0));
+}
+
+#[test]
+fn test_probe_evaluates_expression_across_history() {
+    let source = r#"
+        struct Node {
+            int value;
+            struct Node *next;
+        };
+
+        int length(struct Node *n) {
+            int count = 0;
+            while (n != NULL) {
+                count = count + 1;
+                n = n->next;
+            }
+            return count;
+        }
+
+        int main() {
+            struct Node *head = NULL;
+            int i;
+            for (i = 0; i < 3; i++) {
+                struct Node *node = malloc(sizeof(struct Node));
+                node->value = i;
+                node->next = head;
+                head = node;
+            }
+            return 0;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.run().expect("Execution failed");
+
+    let position = interpreter.history_position();
+    let mut probe = interpreter.probe("length(head)").expect("Bad expression");
+    let mut forked = probe.fork();
+    let lengths: Vec<i32> = (0..interpreter.total_snapshots())
+        .filter_map(|p| interpreter.snapshot(p))
+        .filter_map(|s| probe.evaluate(&s).ok())
+        .filter_map(|v| v.as_int())
+        .collect();
+    assert_eq!(lengths.first(), Some(&0));
+    assert_eq!(lengths.last(), Some(&3));
+    assert!(lengths.windows(2).all(|w| w[1] >= w[0]));
+
+    // The debugged run is untouched and a fork evaluates the same values
+    let last = interpreter
+        .snapshot(interpreter.total_snapshots() - 1)
+        .expect("No final snapshot");
+    assert_eq!(forked.evaluate(&last).ok(), Some(Value::Int(3)));
+    assert_eq!(interpreter.history_position(), position);
+
+    assert!(interpreter.probe("head +").is_err());
+    assert!(interpreter.probe("i i").is_err());
+}
+
+#[test]
+fn test_access_counts_accumulate_per_block_and_variable() {
+    let source = r#"
+        int main() {
+            int *hot = (int*)malloc(4 * sizeof(int));
+            int *cold = (int*)malloc(sizeof(int));
+            int i;
+            int sum = 0;
+            *cold = 1;
+            for (i = 0; i < 4; i++) {
+                hot[i] = i;
+            }
+            for (i = 0; i < 4; i++) {
+                sum = sum + hot[i];
+            }
+            return sum;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.run().expect("Execution failed");
+
+    let last = interpreter
+        .snapshot(interpreter.total_snapshots() - 1)
+        .expect("No final snapshot");
+    let blocks: Vec<_> = last.heap.blocks().map(|(_, b)| b.access).collect();
+    assert_eq!(blocks.len(), 2);
+    assert_eq!((blocks[0].reads, blocks[0].writes), (4, 4));
+    assert_eq!((blocks[1].reads, blocks[1].writes), (0, 1));
+
+    let main = &last.stack.frames()[0];
+    let sum = main.get_var("sum").expect("sum").access;
+    // Four loop reads plus the return; the initializer and four stores
+    assert_eq!((sum.reads, sum.writes), (5, 5));
+    assert!(main.get_var("i").unwrap().access.total() > sum.total());
+
+    // Earlier snapshots keep the counts of their own step
+    let early = interpreter.snapshot(3).expect("No early snapshot");
+    assert!(early.heap.blocks().all(|(_, b)| b.access.reads == 0));
+    let hottest = crustty::memory::access::hottest(&last.stack, &last.heap);
+    assert_eq!(hottest, main.get_var("i").unwrap().access.total());
+}
+
+#[test]
+fn test_guest_profile_charges_lines_and_functions() {
+    let source = r#"
+        int fact(int n) {
+            if (n <= 1) {
+                return 1;
+            }
+            return n * fact(n - 1);
+        }
+        int main() {
+            int *p = (int*)malloc(8);
+            int r = fact(4);
+            free(p);
+            return r;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    interpreter.run().expect("Execution failed");
+
+    let profile = interpreter.guest_profile();
+    // Every step after the initial snapshot is charged somewhere
+    assert_eq!(
+        profile.total_steps() as usize,
+        interpreter.total_snapshots() - 1
+    );
+
+    let main = profile.function("main").expect("main profiled");
+    assert_eq!(main.count, 1);
+    assert_eq!(main.inclusive_steps, profile.total_steps());
+    assert_eq!(main.heap_bytes, 8);
+
+    let fact = profile.function("fact").expect("fact profiled");
+    assert_eq!(fact.count, 4);
+    // Recursive calls are nested in the outermost one
+    assert_eq!(fact.inclusive_steps, fact.steps);
+    assert_eq!(main.inclusive_steps, main.steps + fact.inclusive_steps);
+
+    // The call line includes all of fact; the recursive return runs 3 times
+    let call_line = profile.line(10).expect("call line profiled");
+    assert!(call_line.inclusive_steps >= fact.inclusive_steps);
+    assert_eq!(profile.line(6).expect("return line").count, 3);
+    assert_eq!(profile.line(9).expect("malloc line").heap_bytes, 8);
+
+    let top = profile.top_functions(ProfileOrder::Inclusive, 1);
+    assert_eq!(top[0].0, "main");
+}
+
+#[test]
+fn test_stats_count_work_and_history_bytes() {
+    let run = |source: &str| {
+        let mut parser = Parser::new(source).expect("Parser creation failed");
+        let program = parser.parse_program().expect("Parsing failed");
+        let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+        interpreter.run().expect("Execution failed");
+        interpreter
+    };
+
+    let interpreter = run(r#"
+        int main() {
+            int *a = (int*)malloc(16);
+            int *b = (int*)malloc(32);
+            free(a);
+            printf("done\n");
+            return 0;
+        }
+    "#);
+    let stats = interpreter.stats();
+    assert_eq!(stats.snapshots, interpreter.total_snapshots());
+    assert_eq!(stats.statements, 5);
+    assert!(stats.expressions > stats.statements);
+    assert_eq!((stats.allocations, stats.frees), (2, 1));
+    assert_eq!(stats.peak_heap_bytes, 48);
+    assert!(stats.history.terminal > 0 && stats.history.heap > 0);
+    assert!(stats.to_json().contains("\"peak_bytes\":48"));
+
+    // Stack values are accounted, so a large local array costs more
+    let small = run("int main() { int a[2]; a[0] = 1; return 0; }").stats();
+    let large = run("int main() { int a[200]; a[0] = 1; return 0; }").stats();
+    assert!(large.history.stack > small.history.stack + 190 * 4);
+    assert_eq!(
+        large.history.total(),
+        large.history.stack
+            + large.history.heap
+            + large.history.terminal
+            + large.history.side_tables
+    );
+}
+
+/// Writer that keeps what it is given, shared with the test
+#[derive(Clone, Default)]
+struct SharedBuffer(std::sync::Arc<std::sync::Mutex<Vec<u8>>>);
+
+impl std::io::Write for SharedBuffer {
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        self.0.lock().unwrap().extend_from_slice(buf);
+        Ok(buf.len())
+    }
+    fn flush(&mut self) -> std::io::Result<()> {
+        Ok(())
+    }
+}
+
+#[test]
+fn test_trace_out_streams_calls_heap_events_and_errors() {
+    use crustty::interpreter::trace::TraceWriter;
+
+    let source = r#"
+        int square(int x) {
+            return x * x;
+        }
+        int main() {
+            int n;
+            scanf("%d", &n);
+            int *p = (int*)malloc(8);
+            free(p);
+            int s = square(n);
+            int *q = NULL;
+            return *q + s;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    let buffer = SharedBuffer::default();
+    interpreter.set_trace(TraceWriter::new(buffer.clone()));
+    interpreter.run().expect("Paused at scanf");
+    assert!(interpreter.is_paused_at_scanf());
+    // The rerun replays main's start, which must not be written twice
+    assert!(interpreter.provide_scanf_input("3".to_string()).is_err());
+    interpreter.finish_trace().expect("Trace written");
+
+    let text = String::from_utf8(buffer.0.lock().unwrap().clone()).unwrap();
+    assert!(text.starts_with('[') && text.ends_with("]\n"));
+    let count = |needle: &str| text.matches(needle).count();
+    assert_eq!(count("\"ph\":\"B\""), 2);
+    assert_eq!(count("\"ph\":\"E\""), 2);
+    assert_eq!(count("\"name\":\"malloc\""), 1);
+    assert_eq!(count("\"name\":\"free\""), 1);
+    assert_eq!(count("\"name\":\"runtime error\""), 1);
+    assert!(text.contains("\"name\":\"square\""));
+    assert!(text.contains("\"args\":{\"bytes\":8}"));
+    assert!(text.contains("\"args\":{\"depth\":2}"));
+    assert!(text.trim_end().ends_with("\"args\":{\"depth\":0}}\n]"));
+}
+
+#[test]
+fn test_exec_log_without_history() {
+    use crustty::interpreter::exec_log::ExecLog;
+
+    let source = r#"
+        int main() {
+            int n;
+            scanf("%d", &n);
+            int sum = 0;
+            for (int i = 0; i < n; i++) {
+                sum += i;
+            }
+            printf("sum %d\n", sum);
+            return 0;
+        }
+    "#;
+
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+    let buffer = SharedBuffer::default();
+    interpreter.set_exec_log(ExecLog::new(buffer.clone()).unwrap());
+    interpreter.set_record_history(false);
+    interpreter.run().expect("Paused at scanf");
+    assert!(interpreter.is_paused_at_scanf());
+    interpreter
+        .provide_scanf_input("4".to_string())
+        .expect("Run completed");
+    assert!(interpreter.is_execution_complete());
+    assert_eq!(interpreter.total_snapshots(), 0);
+    interpreter.finish_exec_log().expect("Log written");
+
+    let text = String::from_utf8(buffer.0.lock().unwrap().clone()).unwrap();
+    let records: Vec<&str> = text.lines().collect();
+    // One record per step, none repeated by the scanf rerun
+    for (step, record) in records.iter().enumerate() {
+        assert!(
+            record.starts_with(&format!("{{\"step\":{},", step)),
+            "record {} out of order: {}",
+            step,
+            record
+        );
+    }
+    assert!(text.contains("{\"frame\":0,\"name\":\"sum\",\"value\":6}"));
+    assert!(text.contains("\"function\":\"main\",\"depth\":1"));
+    assert_eq!(text.matches("\"output\":\"sum 6\\n\"").count(), 1);
+}
+
+#[test]
+fn test_playback_to_end_keeps_app_running() {
+    use crustty::ui::App;
+    use std::time::{Duration, Instant};
+
+    let source = r#"
+        int main() {
+            int sum = 0;
+            for (int i = 0; i < 20; i++) {
+                sum += i;
+            }
+            return sum;
+        }
+    "#;
+    let mut parser = Parser::new(source).expect("Parser creation failed");
+    let program = parser.parse_program().expect("Parsing failed");
+    let mut interpreter = Interpreter::new(program, 64 * 1024 * 1024);
+    interpreter.run().expect("Execution failed");
+    interpreter.rewind_to_start().expect("Rewind failed");
+
+    let mut app = App::new(interpreter, source.to_string());
+    app.is_playing = true;
+    let mut frames = 0;
+    while app.is_playing && frames < 1000 {
+        // Make every frame due, with many steps to catch up on
+        app.last_play_time = Instant::now() - Duration::from_secs(1);
+        assert!(app.advance_playback());
+        frames += 1;
+    }
+
+    assert!(!app.is_playing, "Playback did not stop at the end");
+    assert!(!app.should_quit);
+    assert!(app.error_state.is_none());
+    assert_eq!(app.status_message, "Reached end of execution");
+    assert_eq!(
+        app.interpreter.history_position() + 1,
+        app.interpreter.total_snapshots()
+    );
+    assert!(!app.advance_playback());
+}
+
+#[test]
+fn test_free_site_comes_from_tombstone() {
+    use crustty::interpreter::errors::RuntimeError;
+    let run = |body: &str| {
+        let source = format!(
+            "int main() {{\n    int* p = (int*)malloc(8);\n    free(p);\n{}\n    return 0;\n}}\n",
+            body
+        );
+        let mut parser = Parser::new(&source).expect("Parser creation failed");
+        let program = parser.parse_program().expect("Parsing failed");
+        let mut interpreter = Interpreter::new(program, 1024 * 1024 * 100);
+        interpreter.run().expect_err("Expected a heap error")
+    };
+
+    match run("    int x = *p;") {
+        RuntimeError::UseAfterFree { freed_at, .. } => {
+            assert_eq!(freed_at.map(|site| site.line), Some(3))
+        }
+        e => panic!("Expected UseAfterFree, got {:?}", e),
+    }
+    match run("    free(p);") {
+        RuntimeError::DoubleFree { freed_at, .. } => {
+            assert_eq!(freed_at.map(|site| site.line), Some(3))
+        }
+        e => panic!("Expected DoubleFree, got {:?}", e),
+    }
+}